@@ -33,6 +33,22 @@ class Dispatcher {
 public:
   virtual ~Dispatcher() {}
 
+  /**
+   * Initialize stats for this dispatcher. Note that this can't generally be done at construction
+   * time, since the main and worker thread dispatchers are constructed before the stats store is
+   * ready for them. This must be called before run() is called on the dispatcher's thread.
+   * @param scope supplies the scope to create stats in.
+   * @param prefix supplies the stat prefix for this dispatcher, including the trailing '.'.
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
+
+  /**
+   * @return uint32_t the recent utilization of the event loop in percent, i.e. the share of time
+   *         spent running callbacks, or 0 if stats have not been initialized. May be called from
+   *         any thread.
+   */
+  virtual uint32_t loopUtilization() const PURE;
+
   /**
    * Clear any items in the deferred deletion queue.
    */
@@ -104,6 +120,15 @@ public:
                                               Network::ListenerCallbacks& cb, bool bind_to_port,
                                               bool hand_off_restored_destination_connections) PURE;
 
+  /**
+   * Create a listener on a bound datagram socket.
+   * @param socket supplies the socket to receive on.
+   * @param cb supplies the callbacks to invoke for received datagrams.
+   * @return Network::UdpListenerPtr a new listener that is owned by the caller.
+   */
+  virtual Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                                    Network::UdpListenerCallbacks& cb) PURE;
+
   /**
    * Allocate a timer. @see Event::Timer for docs on how to use the timer.
    * @param cb supplies the callback to invoke when the timer fires.
@@ -4,6 +4,7 @@
 #include <functional>
 #include <memory>
 
+#include "envoy/buffer/buffer.h"
 #include "envoy/common/pure.h"
 
 namespace Envoy {
@@ -45,6 +46,25 @@ public:
    * registered events and fire callbacks when they are active.
    */
   virtual void setEnabled(uint32_t events) PURE;
+
+  /**
+   * Have the event receive data from its file on the owner's behalf, batched with the rest of the
+   * dispatcher's I/O, rather than only report the file readable. Once enabled, a read event means
+   * that receive() has data, the end of the stream or an error to hand over, and the owner must no
+   * longer read from the file itself. Only edge triggered events can receive.
+   * @return bool whether the event receives on the owner's behalf.
+   */
+  virtual bool enableReceive() PURE;
+
+  /**
+   * Move data that the event received on the owner's behalf into a buffer. Only valid once
+   * enableReceive() has returned true.
+   * @param buffer supplies the buffer to append the data to.
+   * @param max_length supplies the maximum number of bytes to move.
+   * @return int the number of bytes moved, 0 at the end of the stream, or -1 with errno set, to
+   *         EAGAIN if there is nothing to hand over yet, as Buffer::Instance::read() does.
+   */
+  virtual int receive(Buffer::Instance& buffer, uint64_t max_length) PURE;
 };
 
 typedef std::unique_ptr<FileEvent> FileEventPtr;
@@ -197,6 +197,8 @@ struct Http1Settings {
   bool accept_http_10_{false};
   // Set a default host if no Host: header is present for HTTP/1.0 requests.`
   std::string default_host_for_http_10_;
+  // Parse with the vectorized scanning parser rather than http_parser.
+  bool scanning_parser_{false};
 };
 
 /**
@@ -208,6 +210,15 @@ struct Http2Settings {
   uint32_t max_concurrent_streams_{DEFAULT_MAX_CONCURRENT_STREAMS};
   uint32_t initial_stream_window_size_{DEFAULT_INITIAL_STREAM_WINDOW_SIZE};
   uint32_t initial_connection_window_size_{DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE};
+  // Defer sending frames to the end of the event loop iteration, so that the frames of all streams
+  // that encode during it are written together.
+  bool coalesce_writes_{false};
+  // Tune the stream and connection windows to the bandwidth-delay product of the connection,
+  // between adaptive_window_min_size_ and adaptive_window_max_size_, rather than advertising
+  // initial_stream_window_size_ and initial_connection_window_size_.
+  bool adaptive_window_{false};
+  uint32_t adaptive_window_min_size_{MIN_INITIAL_STREAM_WINDOW_SIZE};
+  uint32_t adaptive_window_max_size_{DEFAULT_ADAPTIVE_WINDOW_MAX_SIZE};
 
   // disable HPACK compression
   static const uint32_t MIN_HPACK_TABLE_SIZE = 0;
@@ -241,6 +252,9 @@ struct Http2Settings {
   // our default connection-level window also equals to our stream-level
   static const uint32_t DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE = 256 * 1024 * 1024;
   static const uint32_t MAX_INITIAL_CONNECTION_WINDOW_SIZE = (1U << 31) - 1;
+
+  // adaptive windows start at the HTTP/2 default and grow up to 16MiB unless configured otherwise
+  static const uint32_t DEFAULT_ADAPTIVE_WINDOW_MAX_SIZE = 16 * 1024 * 1024;
 };
 
 /**
@@ -95,6 +95,13 @@ public:
    */
   virtual void drainConnections() PURE;
 
+  /**
+   * Open connections ahead of demand, so that the streams created next do not wait for them to
+   * connect. Connections that are already open or connecting count towards the number.
+   * @param connections supplies the number of connections the pool should have.
+   */
+  virtual void prefetch(uint32_t connections) PURE;
+
   /**
    * Create a new stream on the pool.
    * @param response_decoder supplies the decoder events to fire when the response is
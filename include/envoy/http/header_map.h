@@ -68,8 +68,8 @@ public:
   ~HeaderString();
 
   /**
-   * Append data to an existing string. If the string is a reference string the reference data is
-   * not copied.
+   * Append data to an existing string. If the string is a reference string the referenced data is
+   * copied first, and the append goes to the copy.
    */
   void append(const char* data, uint32_t size);
 
@@ -148,6 +148,16 @@ public:
    */
   void setReference(const std::string& ref_value);
 
+  /**
+   * Set the value of the string to a reference to memory that is not a std::string, such as a
+   * codec's read buffer.
+   * @param ref_value MUST be followed by a null terminator at ref_value[size], and MUST stay valid
+   *        for as long as the string refers to it. HeaderMapImpl::retain() can keep it alive for
+   *        the lifetime of a header map.
+   * @param size supplies the length of the string, not including the null terminator.
+   */
+  void setReference(const char* ref_value, uint32_t size);
+
   /**
    * @return the size of the string, not including the null terminator.
    */
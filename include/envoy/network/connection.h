@@ -233,6 +233,13 @@ public:
    * Get the socket options set on this connection.
    */
   virtual const ConnectionSocket::OptionsSharedPtr& socketOptions() const PURE;
+
+  /**
+   * @return int the file descriptor of the underlying socket, or -1 if the socket has been closed.
+   *         Callers that move data on the descriptor directly must keep the connection read
+   *         disabled and must not interleave such data with buffered connection writes.
+   */
+  virtual int fd() const PURE;
 };
 
 typedef std::unique_ptr<Connection> ConnectionPtr;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * The connection handler of a worker, as seen by a ConnectionBalancer. Handlers live as long as
+ * their worker, so a balancer may hold on to them after the listener on a worker is gone.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint32_t the recent utilization of the worker's event loop in percent. May be called
+   *         from any thread.
+   */
+  virtual uint32_t loopUtilization() const PURE;
+
+  /**
+   * Hand over a socket accepted by another worker. May be called from any thread. The socket is
+   * processed on the handler's worker, as if it had been accepted there, or closed if the worker
+   * no longer runs the listener.
+   * @param listener_tag supplies the tag of the listener that accepted the socket.
+   * @param socket supplies the accepted socket.
+   */
+  virtual void post(uint64_t listener_tag, ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * Balances the connections accepted on a listener across the workers running it. Workers call
+ * into the balancer from their own threads, so implementations must be thread safe.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register the handler of a worker that runs the listener.
+   * @param worker_index supplies the index of the worker.
+   * @param handler supplies the worker's handler.
+   */
+  virtual void registerHandler(uint32_t worker_index, BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister the handler of a worker that stopped running the listener. Connections are no
+   * longer handed to it.
+   * @param worker_index supplies the index of the worker.
+   */
+  virtual void unregisterHandler(uint32_t worker_index) PURE;
+
+  /**
+   * Report the number of connections, including sockets in listener filters, a worker holds on
+   * the listener.
+   * @param worker_index supplies the index of the worker.
+   * @param connections supplies the number of connections.
+   */
+  virtual void onConnectionCount(uint32_t worker_index, uint64_t connections) PURE;
+
+  /**
+   * Pick the worker that should handle a socket just accepted by a worker, before any filter runs
+   * on it.
+   * @param worker_index supplies the index of the worker that accepted the socket.
+   * @return BalancedConnectionHandler& the handler of the worker to hand the socket to. This is the
+   *         accepting worker's own handler if the socket should stay where it is.
+   */
+  virtual BalancedConnectionHandler& pickTargetHandler(uint32_t worker_index) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
@@ -12,6 +12,8 @@ namespace Network {
 
 class Connection;
 class ConnectionSocket;
+class UdpListener;
+struct UdpRecvData;
 
 /**
  * Status codes returned by filters that can cause future filters to not get iterated to.
@@ -71,6 +73,13 @@ public:
    * Set the currently selected upstream host for the connection.
    */
   virtual void upstreamHost(Upstream::HostDescriptionConstSharedPtr host) PURE;
+
+  /**
+   * @return whether the connection has read or write filters other than this one. A filter that
+   *         moves data without passing it through the connection's buffers, so that no other
+   *         filter sees it, must only do so when there are none.
+   */
+  virtual bool hasOtherFilters() PURE;
 };
 
 /**
@@ -234,6 +243,75 @@ public:
  */
 typedef std::function<void(ListenerFilterManager& filter_manager)> ListenerFilterFactoryCb;
 
+/**
+ * Callbacks used by individual UDP listener filter instances to communicate with the listener.
+ */
+class UdpReadFilterCallbacks {
+public:
+  virtual ~UdpReadFilterCallbacks() {}
+
+  /**
+   * @return UdpListener& the listener the filter receives datagrams from, and that replies to
+   *         peers are sent through.
+   */
+  virtual UdpListener& udpListener() PURE;
+
+  /**
+   * @return the Dispatcher of the worker that owns the listener, for the filter's own file events
+   *         and timers.
+   */
+  virtual Event::Dispatcher& dispatcher() PURE;
+};
+
+/**
+ * A read path UDP listener filter. Unlike network filters, a single instance sees the datagrams of
+ * all peers of the listener on a worker.
+ */
+class UdpListenerReadFilter {
+public:
+  virtual ~UdpListenerReadFilter() {}
+
+  /**
+   * Called for each datagram received by the listener.
+   * @param data supplies the datagram. The filter may move the buffer out.
+   */
+  virtual void onData(UdpRecvData& data) PURE;
+
+  /**
+   * Called after each batch of datagrams has been delivered through onData(), so that filters can
+   * write what they queued in as few system calls as possible.
+   */
+  virtual void onReadComplete() PURE;
+};
+
+typedef std::unique_ptr<UdpListenerReadFilter> UdpListenerReadFilterPtr;
+
+/**
+ * Interface for adding UDP listener filters to a manager.
+ */
+class UdpListenerFilterManager {
+public:
+  virtual ~UdpListenerFilterManager() {}
+
+  /**
+   * Add a read filter to the listener. Filters are invoked in FIFO order (the filter added
+   * first is called first).
+   * @param filter supplies the filter being added.
+   */
+  virtual void addReadFilter(UdpListenerReadFilterPtr&& filter) PURE;
+};
+
+/**
+ * This function is used to wrap the creation of a UDP listener filter chain for each worker's UDP
+ * listener. Filter factories create the lambda at configuration initialization time, and then
+ * they are used at runtime.
+ * @param filter_manager supplies the filter manager for the listener to install filters to.
+ * @param callbacks supplies the callbacks the filters can use to reach the listener.
+ */
+typedef std::function<void(UdpListenerFilterManager& filter_manager,
+                           UdpReadFilterCallbacks& callbacks)>
+    UdpListenerFilterFactoryCb;
+
 /**
  * Interface representing a single filter chain.
  */
@@ -294,6 +372,15 @@ public:
    * @return true if filter chain was created successfully. Otherwise false.
    */
   virtual bool createListenerFilterChain(ListenerFilterManager& listener) PURE;
+
+  /**
+   * Called to create the filter chain of a UDP listener.
+   * @param udp_listener supplies the listener filter manager to create the chain on.
+   * @param callbacks supplies the callbacks the filters use to reach the listener.
+   * @return true if filter chain was created successfully. Otherwise false.
+   */
+  virtual bool createUdpListenerFilterChain(UdpListenerFilterManager& udp_listener,
+                                            UdpReadFilterCallbacks& callbacks) PURE;
 };
 
 } // namespace Network
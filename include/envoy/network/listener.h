@@ -4,11 +4,14 @@
 #include <memory>
 #include <string>
 
+#include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
+#include "envoy/stats/stats.h"
 
 namespace Envoy {
 namespace Network {
@@ -38,6 +41,13 @@ public:
    */
   virtual Socket& socket() PURE;
 
+  /**
+   * @param worker_index supplies the index of the worker that is going to accept on the socket.
+   * @return Socket* the listen socket owned by the worker if the listener binds one socket per
+   *         worker, or nullptr if all workers accept on socket().
+   */
+  virtual Socket* workerSocket(uint32_t worker_index) PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
@@ -59,6 +69,30 @@ public:
    */
   virtual uint32_t perConnectionBufferLimitBytes() PURE;
 
+  /**
+   * @return uint32_t the maximum number of connections to accept each time the listen socket
+   *         becomes readable before yielding to other events. 0 means no limit.
+   */
+  virtual uint32_t acceptBatchSize() const PURE;
+
+  /**
+   * @return uint32_t the maximum number of connections each worker keeps open on the listener.
+   *         Accepting pauses while the limit is reached. 0 means no limit.
+   */
+  virtual uint32_t maxConnectionsPerWorker() const PURE;
+
+  /**
+   * @return Address::SocketType the type of socket the listener receives on. Stream listeners
+   *         accept connections, datagram listeners hand datagrams to UDP listener filters.
+   */
+  virtual Address::SocketType socketType() const PURE;
+
+  /**
+   * @return ConnectionBalancer* the balancer that moves accepted connections between workers, or
+   *         nullptr if connections stay on the worker that accepted them.
+   */
+  virtual ConnectionBalancer* connectionBalancer() PURE;
+
   /**
    * @return Stats::Scope& the stats scope to use for all listener specific stats.
    */
@@ -104,11 +138,130 @@ public:
  */
 class Listener {
 public:
+  struct AcceptStats {
+    // Number of connections accepted each time the listen socket became readable.
+    Stats::Histogram& accept_batch_size_;
+    // Microseconds from the start of an accept batch until each connection was handed off.
+    Stats::Histogram& accept_latency_us_;
+  };
+
   virtual ~Listener() {}
+
+  /**
+   * Stop accepting connections. Connections that arrive in the meantime stay queued in the
+   * kernel's backlog.
+   */
+  virtual void disable() PURE;
+
+  /**
+   * Resume accepting connections after disable().
+   */
+  virtual void enable() PURE;
+
+  /**
+   * Set the maximum number of connections to accept each time the listen socket becomes readable.
+   * @param batch_size supplies the limit. 0 means accept until the backlog is empty.
+   */
+  virtual void setAcceptBatchSize(uint32_t batch_size) PURE;
+
+  /**
+   * Set the stats the listener reports about accepting connections.
+   */
+  virtual void setAcceptStats(const AcceptStats& stats) PURE;
 };
 
 typedef std::unique_ptr<Listener> ListenerPtr;
 
+/**
+ * A datagram received by a UDP listener.
+ */
+struct UdpRecvData {
+  // The address the datagram was received on.
+  Address::InstanceConstSharedPtr local_address_;
+  // The address the datagram was sent from.
+  Address::InstanceConstSharedPtr peer_address_;
+  // The payload. Callees may move it out.
+  Buffer::InstancePtr buffer_;
+};
+
+/**
+ * Callbacks invoked by a UDP listener.
+ */
+class UdpListenerCallbacks {
+public:
+  virtual ~UdpListenerCallbacks() {}
+
+  /**
+   * Called for each datagram read from the socket.
+   * @param data supplies the datagram.
+   */
+  virtual void onData(UdpRecvData& data) PURE;
+
+  /**
+   * Called after each batch of datagrams has been delivered through onData(). Datagrams queued
+   * with UdpListener::send() are flushed after this returns.
+   */
+  virtual void onReadComplete() PURE;
+};
+
+/**
+ * A listener on a datagram socket. Free the listener to stop receiving on the socket.
+ */
+class UdpListener {
+public:
+  struct UdpStats {
+    // Datagrams read from the socket.
+    Stats::Counter& rx_datagrams_;
+    // Datagrams that were larger than the receive buffer and were cut short.
+    Stats::Counter& rx_datagrams_truncated_;
+    // Datagrams written to the socket.
+    Stats::Counter& tx_datagrams_;
+    // Datagrams that could not be written, for example because the send buffer was full.
+    Stats::Counter& tx_datagrams_dropped_;
+    // Number of datagrams read each time the socket became readable.
+    Stats::Histogram& rx_batch_size_;
+  };
+
+  virtual ~UdpListener() {}
+
+  /**
+   * Stop reading from the socket. Datagrams that arrive in the meantime stay queued in the kernel
+   * until its receive buffer is full.
+   */
+  virtual void disable() PURE;
+
+  /**
+   * Resume reading after disable().
+   */
+  virtual void enable() PURE;
+
+  /**
+   * @return const Address::InstanceConstSharedPtr& the address the listener receives on.
+   */
+  virtual const Address::InstanceConstSharedPtr& localAddress() const PURE;
+
+  /**
+   * Queue a datagram to be sent from the listen socket. Queued datagrams are written in as few
+   * system calls as possible by flush(), which also runs after each read batch.
+   * @param peer_address supplies the destination of the datagram.
+   * @param data supplies the payload, which is drained.
+   */
+  virtual void send(const Address::InstanceConstSharedPtr& peer_address,
+                    Buffer::Instance& data) PURE;
+
+  /**
+   * Write all datagrams queued with send().
+   */
+  virtual void flush() PURE;
+
+  /**
+   * Set the stats the listener reports about datagrams.
+   */
+  virtual void setStats(const UdpStats& stats) PURE;
+};
+
+typedef std::unique_ptr<UdpListener> UdpListenerPtr;
+
 /**
  * Thrown when there is a runtime error creating/binding a listener.
  */
@@ -73,6 +73,22 @@ public:
    * @param event supplies the connection event
    */
   virtual void raiseEvent(ConnectionEvent event) PURE;
+
+  /**
+   * Have the connection's file event receive data from fd() on the transport socket's behalf.
+   * @return bool whether it does. From then on the transport socket must read with receive()
+   *         rather than from fd(). @see Event::FileEvent::enableReceive().
+   */
+  virtual bool enableReceive() PURE;
+
+  /**
+   * Move data that was received on the transport socket's behalf into a buffer.
+   * @param buffer supplies the buffer to append the data to.
+   * @param max_length supplies the maximum number of bytes to move.
+   * @return int the number of bytes moved, 0 at the end of the stream, or -1 with errno set.
+   *         @see Event::FileEvent::receive().
+   */
+  virtual int receive(Buffer::Instance& buffer, uint64_t max_length) PURE;
 };
 
 /**
@@ -162,6 +162,19 @@ public:
    * @return uint32_t a local OR of RETRY_ON values above.
    */
   virtual uint32_t retryOn() const PURE;
+
+  /**
+   * @return std::chrono::milliseconds how long to wait for the response headers of a complete
+   *         request before sending a second attempt to another host, or 0 if requests are not
+   *         hedged.
+   */
+  virtual std::chrono::milliseconds hedgeDelay() const PURE;
+
+  /**
+   * @return double the percentile of the cluster's recent response times to wait for instead of
+   *         hedgeDelay() once enough of them are known, or 0 to always wait for hedgeDelay().
+   */
+  virtual double hedgeLatencyPercentile() const PURE;
 };
 
 /**
@@ -223,6 +236,26 @@ public:
   virtual const std::string& runtimeKey() const PURE;
 };
 
+/**
+ * Request coalescing policy for a route. Concurrent identical GET requests share one upstream
+ * request, and the others wait for its response.
+ */
+class RequestCoalescingPolicy {
+public:
+  virtual ~RequestCoalescingPolicy() {}
+
+  /**
+   * @return uint32_t the maximum number of requests that wait for one upstream request.
+   */
+  virtual uint32_t maxWaiters() const PURE;
+
+  /**
+   * @return std::chrono::milliseconds how long a request waits for the response of the request it
+   *         was coalesced with to start before it goes upstream on its own.
+   */
+  virtual std::chrono::milliseconds maxWait() const PURE;
+};
+
 /**
  * Virtual cluster definition (allows splitting a virtual host into virtual clusters orthogonal to
  * routes for stat tracking and priority purposes).
@@ -459,6 +492,11 @@ public:
    */
   virtual const ShadowPolicy& shadowPolicy() const PURE;
 
+  /**
+   * @return const RequestCoalescingPolicy* the optional request coalescing policy for the route.
+   */
+  virtual const RequestCoalescingPolicy* requestCoalescingPolicy() const PURE;
+
   /**
    * @return std::chrono::milliseconds the route's timeout.
    */
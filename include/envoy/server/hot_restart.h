@@ -45,6 +45,17 @@ public:
    */
   virtual int duplicateParentListenSocket(const std::string& address) PURE;
 
+  /**
+   * Retrieve one of the per-worker listening sockets on the specified address from the parent
+   * process. The socket will be duplicated across process boundaries.
+   * @param address supplies the address of the socket to duplicate, e.g. tcp://127.0.0.1:5000.
+   * @param worker_index supplies the index of the worker that the socket belongs to.
+   * @return int the fd or -1 if the parent has no listener with a socket per worker on the address,
+   *         or it has fewer workers.
+   */
+  virtual int duplicateParentWorkerListenSocket(const std::string& address,
+                                                uint32_t worker_index) PURE;
+
   /**
    * Retrieve stats from our parent process.
    * @param info will be filled with information from our parent if it can be retrieved.
@@ -52,6 +52,36 @@ public:
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
 
+  /**
+   * Creates a group of SO_REUSEPORT sockets bound to the same address, one for each worker.
+   * @param address supplies the sockets' address.
+   * @param options to be set on the created sockets just before calling 'bind()'.
+   * @param num_sockets supplies the number of sockets to create.
+   * @param cpu_steering supplies whether connections are steered to the socket with the same index
+   *        as the CPU that received them.
+   * @return std::vector<Network::SocketSharedPtr> the bound and listening sockets, in worker order.
+   */
+  virtual std::vector<Network::SocketSharedPtr>
+  createWorkerListenSockets(Network::Address::InstanceConstSharedPtr address,
+                            const Network::Socket::OptionsSharedPtr& options,
+                            uint32_t num_sockets, bool cpu_steering) PURE;
+
+  /**
+   * Creates a group of SO_REUSEPORT datagram sockets bound to the same address, one for each
+   * worker. The kernel hashes each peer to one of the sockets, so all datagrams of a peer are
+   * received by the same worker.
+   * @param address supplies the sockets' address.
+   * @param options to be set on the created sockets just before calling 'bind()'.
+   * @param num_sockets supplies the number of sockets to create.
+   * @param cpu_steering supplies whether datagrams are steered to the socket with the same index
+   *        as the CPU that received them.
+   * @return std::vector<Network::SocketSharedPtr> the bound sockets, in worker order.
+   */
+  virtual std::vector<Network::SocketSharedPtr>
+  createUdpListenSockets(Network::Address::InstanceConstSharedPtr address,
+                         const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets,
+                         bool cpu_steering) PURE;
+
   /**
    * Creates a list of filter factories.
    * @param filters supplies the proto configuration.
@@ -72,6 +102,16 @@ public:
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context) PURE;
 
+  /**
+   * Creates a list of UDP listener filter factories.
+   * @param filters supplies the proto configuration.
+   * @param context supplies the factory creation context.
+   * @return std::vector<Network::UdpListenerFilterFactoryCb> the list of filter factories.
+   */
+  virtual std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+      Configuration::ListenerFactoryContext& context) PURE;
+
   /**
    * @return DrainManagerPtr a new drain manager.
    * @param drain_type supplies the type of draining to do for the owning listener.
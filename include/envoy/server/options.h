@@ -158,6 +158,30 @@ public:
    * @return bool indicating whether the hot restart functionality has been disabled via cli flags.
    */
   virtual bool hotRestartDisabled() const PURE;
+
+  /**
+   * @return bool indicating whether buffers should use the libevent evbuffer implementation
+   *         instead of the native slice-based implementation.
+   */
+  virtual bool libeventBuffersEnabled() const PURE;
+
+  /**
+   * @return bool indicating whether file events should be polled through io_uring instead of
+   *         libevent where the kernel supports it.
+   */
+  virtual bool ioUringEnabled() const PURE;
+
+  /**
+   * @return bool indicating whether each worker thread should be pinned to the CPU with the same
+   *         index as the worker.
+   */
+  virtual bool workerCpuAffinity() const PURE;
+
+  /**
+   * @return bool indicating whether dispatchers should run timers on a hierarchical timer wheel
+   *         instead of libevent's timer heap.
+   */
+  virtual bool timerWheelEnabled() const PURE;
 };
 
 } // namespace Server
@@ -3,6 +3,7 @@
 #include <functional>
 
 #include "envoy/server/guarddog.h"
+#include "envoy/stats/stats.h"
 
 namespace Envoy {
 namespace Server {
@@ -31,6 +32,14 @@ public:
   virtual void addListener(Network::ListenerConfig& listener,
                            AddListenerCompletion completion) PURE;
 
+  /**
+   * Initialize stats for this worker's dispatcher, if available. The worker will output
+   * thread-specific stats under the given scope.
+   * @param scope the scope to contain the new per-dispatcher stats created here.
+   * @param prefix the stats prefix to identify this dispatcher, including the trailing '.'.
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
+
   /**
    * @return uint64_t the number of connections across all listeners that the worker owns.
    */
@@ -82,9 +91,11 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param index supplies the position of the worker among the server's workers. A worker accepts
+   *        on the listen socket with the same index for listeners that bind a socket per worker.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker() PURE;
+  virtual WorkerPtr createWorker(uint32_t index) PURE;
 };
 
 } // namespace Server
@@ -329,6 +329,9 @@ public:
   COUNTER  (upstream_cx_protocol_error)                                                            \
   COUNTER  (upstream_cx_max_requests)                                                              \
   COUNTER  (upstream_cx_none_healthy)                                                              \
+  COUNTER  (upstream_cx_prefetch_total)                                                            \
+  COUNTER  (upstream_cx_prefetch_used)                                                             \
+  COUNTER  (upstream_cx_prefetch_wasted)                                                           \
   COUNTER  (upstream_rq_total)                                                                     \
   GAUGE    (upstream_rq_active)                                                                    \
   COUNTER  (upstream_rq_pending_total)                                                             \
@@ -344,6 +347,9 @@ public:
   COUNTER  (upstream_rq_retry)                                                                     \
   COUNTER  (upstream_rq_retry_success)                                                             \
   COUNTER  (upstream_rq_retry_overflow)                                                            \
+  COUNTER  (upstream_rq_hedge)                                                                     \
+  COUNTER  (upstream_rq_hedge_won)                                                                 \
+  COUNTER  (upstream_rq_hedge_overflow)                                                            \
   COUNTER  (upstream_flow_control_paused_reading_total)                                            \
   COUNTER  (upstream_flow_control_resumed_reading_total)                                           \
   COUNTER  (upstream_flow_control_backed_up_total)                                                 \
@@ -435,6 +441,31 @@ public:
    */
   virtual const Http::Http2Settings& http2Settings() const PURE;
 
+  /**
+   * @return uint32_t the most connections that an HTTP/2 connection pool keeps open to a host for
+   *         new streams.
+   */
+  virtual uint32_t http2MaxConnectionsPerHost() const PURE;
+
+  /**
+   * @return uint32_t the active streams at which an HTTP/2 connection pool connection is busy, and
+   *         the pool prefers opening another connection to the host if it may.
+   */
+  virtual uint32_t http2BusyStreamThreshold() const PURE;
+
+  /**
+   * @return float the capacity of the connections that each connection pool keeps connected or
+   *         connecting, as a multiple of the requests it has active and pending. 1 opens
+   *         connections only for requests that find none ready.
+   */
+  virtual float perUpstreamPrefetchRatio() const PURE;
+
+  /**
+   * @return uint32_t the connections that each worker opens to each host of the cluster as soon as
+   *         the host is added, before any request needs them.
+   */
+  virtual uint32_t warmConnectionsPerHost() const PURE;
+
   /**
    * @return const envoy::api::v2::Cluster::CommonLbConfig& the common configuration for all
    *         load balancers for this cluster.
@@ -20,78 +20,344 @@ static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
 static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
               "RawSlice != evbuffer_iovec");
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+bool OwnedImpl::use_old_impl_ = false;
 
-void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
-  evbuffer_add_reference(
-      buffer_.get(), fragment.data(), fragment.size(),
-      [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); }, &fragment);
+void OwnedImpl::useOldImpl(bool use_old_impl) { use_old_impl_ = use_old_impl; }
+
+bool OwnedImpl::isSameBufferImpl(const Instance& rhs) const {
+  const OwnedImpl* other = dynamic_cast<const OwnedImpl*>(&rhs);
+  if (other == nullptr) {
+    return false;
+  }
+  return old_impl_ == other->old_impl_;
 }
 
-void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
+void OwnedImpl::add(const void* data, uint64_t size) {
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data, size);
+    return;
+  }
+
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  bool new_slice_needed = slices_.empty();
+  while (size != 0) {
+    if (new_slice_needed) {
+      slices_.emplace_back(OwnedSlice::create(size));
+    }
+    const uint64_t copy_size = slices_.back()->append(src, size);
+    src += copy_size;
+    size -= copy_size;
+    length_ += copy_size;
+    new_slice_needed = true;
+  }
 }
 
+void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
+  if (old_impl_) {
+    evbuffer_add_reference(
+        buffer_.get(), fragment.data(), fragment.size(),
+        [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); },
+        &fragment);
+    return;
+  }
+
+  length_ += fragment.size();
+  slices_.emplace_back(std::make_unique<UnownedSlice>(fragment));
+}
+
+void OwnedImpl::add(const std::string& data) { add(data.data(), data.size()); }
+
 void OwnedImpl::add(const Instance& data) {
+  ASSERT(&data != this);
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
   data.getRawSlices(slices, num_slices);
-  for (RawSlice& slice : slices) {
+  for (const RawSlice& slice : slices) {
     add(slice.mem_, slice.len_);
   }
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc =
+        evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(rc == 0);
+    return;
+  }
+
+  if (num_iovecs == 0 || slices_.empty()) {
+    return;
+  }
+  // Find the slices in the buffer that correspond to the iovecs:
+  // First, scan backward from the end of the buffer to find the last slice containing any
+  // content. Reservations are made from the end of the buffer, and out-of-order commits aren't
+  // supported, so any slices before this point cannot match the iovecs being committed.
+  ssize_t slice_index = static_cast<ssize_t>(slices_.size()) - 1;
+  while (slice_index >= 0 && slices_[slice_index]->dataSize() == 0) {
+    slice_index--;
+  }
+  if (slice_index < 0) {
+    // There was no slice containing any data, so rewind the iterator to the first slice.
+    slice_index = 0;
+  }
+
+  // Next, scan forward and attempt to match the slices against iovecs.
+  uint64_t num_slices_committed = 0;
+  while (num_slices_committed < num_iovecs &&
+         slice_index < static_cast<ssize_t>(slices_.size())) {
+    if (slices_[slice_index]->commit(iovecs[num_slices_committed])) {
+      length_ += iovecs[num_slices_committed].len_;
+      num_slices_committed++;
+    }
+    slice_index++;
+  }
 }
 
 void OwnedImpl::copyOut(size_t start, uint64_t size, void* data) const {
   ASSERT(start + size <= length());
 
-  evbuffer_ptr start_ptr;
-  int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
-  ASSERT(rc != -1);
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
+    ASSERT(rc != -1);
+
+    ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
+    ASSERT(static_cast<uint64_t>(copied) == size);
+    return;
+  }
 
-  ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
-  ASSERT(static_cast<uint64_t>(copied) == size);
+  uint64_t bytes_to_skip = start;
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  for (const auto& slice : slices_) {
+    if (size == 0) {
+      break;
+    }
+    const uint64_t data_size = slice->dataSize();
+    if (data_size <= bytes_to_skip) {
+      // The offset where the caller wants to start copying is after the end of this slice,
+      // so just skip over this slice completely.
+      bytes_to_skip -= data_size;
+      continue;
+    }
+    const uint64_t copy_size = std::min(size, data_size - bytes_to_skip);
+    memcpy(dest, static_cast<const uint8_t*>(slice->data()) + bytes_to_skip, copy_size);
+    size -= copy_size;
+    dest += copy_size;
+    // Now that we've started copying, there are no bytes left to skip over. If there
+    // is any more data to be copied, the next iteration can start copying from the very
+    // beginning of the next slice.
+    bytes_to_skip = 0;
+  }
+  ASSERT(size == 0);
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
+
+  if (old_impl_) {
+    int rc = evbuffer_drain(buffer_.get(), size);
+    ASSERT(rc == 0);
+    return;
+  }
+
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
+}
+
+void OwnedImpl::drainRetained(uint64_t size, std::vector<SliceSharedPtr>& retained) {
+  ASSERT(!old_impl_);
+  ASSERT(size <= length());
+
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      retained.emplace_back(std::move(slices_.front()));
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      SliceSharedPtr parent(std::move(slices_.front()));
+      slices_.front() = std::make_unique<SharedSliceView>(parent);
+      retained.emplace_back(std::move(parent));
+      length_ -= size;
+      size = 0;
+    }
+  }
+  postProcess();
+}
+
+void OwnedImpl::addSharedSlices(const std::vector<SliceSharedPtr>& slices) {
+  ASSERT(!old_impl_);
+  for (const SliceSharedPtr& slice : slices) {
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    length_ += slice->dataSize();
+    slices_.emplace_back(std::make_unique<SharedSliceView>(slice));
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  if (old_impl_) {
+    return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
+                         out_size);
+  }
+
+  uint64_t num_slices = 0;
+  for (const auto& slice : slices_) {
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = const_cast<void*>(slice->data());
+      out[num_slices].len_ = slice->dataSize();
+    }
+    // Per the definition of getRawSlices in include/envoy/buffer/buffer.h, we need to return
+    // the total number of slices needed to access all the data in the buffer, which can be
+    // larger than out_size. So we keep iterating and counting non-empty slices here, even
+    // if all the caller-supplied slices have been filled.
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::ownedSliceSize(uint64_t index) const {
+  ASSERT(!old_impl_);
+  for (const auto& slice : slices_) {
+    // Empty slices are skipped, as they are by getRawSlices().
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (index-- == 0) {
+      return dynamic_cast<const OwnedSlice*>(slice.get()) != nullptr ? slice->size() : 0;
+    }
+  }
+  NOT_REACHED;
+}
+
+uint64_t OwnedImpl::length() const {
+  if (old_impl_) {
+    return evbuffer_get_length(buffer_.get());
+  }
+  return length_;
+}
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+
+  if (old_impl_) {
+    return evbuffer_pullup(buffer_.get(), size);
+  }
+
+  if (slices_.empty()) {
+    return nullptr;
+  }
+  uint64_t linearized_size = 0;
+  uint64_t num_slices_to_linearize = 0;
+  for (const auto& slice : slices_) {
+    num_slices_to_linearize++;
+    linearized_size += slice->dataSize();
+    if (linearized_size >= size) {
+      break;
+    }
+  }
+  if (num_slices_to_linearize > 1) {
+    SlicePtr new_slice = OwnedSlice::create(linearized_size);
+    for (uint64_t i = 0; i < num_slices_to_linearize; i++) {
+      new_slice->append(slices_.front()->data(), slices_.front()->dataSize());
+      slices_.pop_front();
+    }
+    ASSERT(new_slice->dataSize() == linearized_size);
+    slices_.emplace_front(std::move(new_slice));
+  }
+  return slices_.front()->data();
+}
+
+void OwnedImpl::moveByCopy(Instance& rhs, uint64_t length) {
+  uint64_t num_slices = rhs.getRawSlices(nullptr, 0);
+  RawSlice slices[num_slices];
+  rhs.getRawSlices(slices, num_slices);
+  uint64_t bytes_copied = 0;
+  for (uint64_t i = 0; i < num_slices && bytes_copied < length; i++) {
+    const uint64_t copy_size = std::min(static_cast<uint64_t>(slices[i].len_), length - bytes_copied);
+    add(slices[i].mem_, copy_size);
+    bytes_copied += copy_size;
+  }
+  rhs.drain(bytes_copied);
 }
 
 void OwnedImpl::move(Instance& rhs) {
+  ASSERT(&rhs != this);
+  if (!isSameBufferImpl(rhs)) {
+    moveByCopy(rhs, rhs.length());
+    return;
+  }
+
   // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
-  // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  // now and this is safe. Moving slices (or using the evbuffer move routines) requires access to
+  // the internals of both buffers.
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_add_buffer(buffer_.get(), other.buffer().get());
+    ASSERT(rc == 0);
+  } else {
+    for (SlicePtr& slice : other.slices_) {
+      if (slice->dataSize() == 0) {
+        continue;
+      }
+      length_ += slice->dataSize();
+      slices_.emplace_back(std::move(slice));
+    }
+    other.slices_.clear();
+    other.length_ = 0;
+  }
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
+  ASSERT(&rhs != this);
+  if (!isSameBufferImpl(rhs)) {
+    moveByCopy(rhs, length);
+    return;
+  }
+
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_remove_buffer(other.buffer().get(), buffer_.get(), length);
+    ASSERT(static_cast<uint64_t>(rc) == length);
+  } else {
+    while (length != 0 && !other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.front()->dataSize();
+      const uint64_t copy_size = std::min(slice_size, length);
+      if (copy_size == 0) {
+        other.slices_.pop_front();
+      } else if (copy_size < slice_size) {
+        // Only part of the slice is wanted, so copy those bytes instead of splitting the slice.
+        add(other.slices_.front()->data(), copy_size);
+        other.slices_.front()->drain(copy_size);
+        other.length_ -= copy_size;
+      } else {
+        slices_.emplace_back(std::move(other.slices_.front()));
+        other.slices_.pop_front();
+        length_ += slice_size;
+        other.length_ -= slice_size;
+      }
+      length -= copy_size;
+    }
+  }
+  other.postProcess();
 }
 
 int OwnedImpl::read(int fd, uint64_t max_length) {
@@ -134,21 +400,139 @@ int OwnedImpl::read(int fd, uint64_t max_length) {
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  if (old_impl_) {
+    uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
+                                          reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(ret >= 1);
+    return ret;
+  }
+
+  if (num_iovecs == 0 || length == 0) {
+    return 0;
+  }
+
+  // Check whether there are any empty slices with reservable space at the end of the buffer.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // There is some content in this slice, so anything in front of it is non-reservable.
+      break;
+    }
+  }
+
+  // Having found the sequence of reservable slices at the back of the buffer, reserve as much
+  // space as possible from each one.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  size_t slice_index = first_reservable_slice;
+  while (slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs) {
+    auto& slice = slices_[slice_index];
+    const uint64_t reservation_size = std::min(slice->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // There is only one iovec left, and this next slice does not have enough space to complete
+      // the reservation. Stop iterating, with the last iovec still unpopulated, so the code
+      // following this loop can allocate a new slice to hold the rest of the reservation.
+      break;
+    }
+    iovecs[num_slices_used] = slice->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+    slice_index++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
-    return -1;
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+      return -1;
+    }
+
+    evbuffer_ptr result_ptr =
+        evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
+    return result_ptr.pos;
   }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+  // This implementation uses the same search algorithm as evbuffer_search(), a naive scan that
+  // requires O(M*N) comparisons in the worst case.
+  if (start > length_) {
+    return -1;
+  }
+  if (size == 0) {
+    return start;
+  }
+  ssize_t offset = 0;
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const auto& slice = slices_[slice_index];
+    const uint64_t slice_size = slice->dataSize();
+    if (slice_size <= start) {
+      start -= slice_size;
+      offset += slice_size;
+      continue;
+    }
+    const uint8_t* slice_start = static_cast<const uint8_t*>(slice->data());
+    const uint8_t* haystack = slice_start + start;
+    const uint8_t* haystack_end = slice_start + slice_size;
+    while (haystack < haystack_end) {
+      // Search within this slice for the first byte of the needle.
+      const uint8_t* first_byte_match =
+          static_cast<const uint8_t*>(memchr(haystack, needle[0], haystack_end - haystack));
+      if (first_byte_match == nullptr) {
+        break;
+      }
+      // After finding a match for the first byte of the needle, check whether the following
+      // bytes in the buffer match the remainder of the needle. Note that the match can span two
+      // or more slices.
+      size_t i = 1;
+      size_t match_index = slice_index;
+      const uint8_t* match_next = first_byte_match + 1;
+      const uint8_t* match_end = haystack_end;
+      while (i < size) {
+        if (match_next >= match_end) {
+          // We've hit the end of this slice, so continue checking against the next slice.
+          match_index++;
+          if (match_index == slices_.size()) {
+            // We've hit the end of the entire buffer.
+            return -1;
+          }
+          const auto& match_slice = slices_[match_index];
+          match_next = static_cast<const uint8_t*>(match_slice->data());
+          match_end = match_next + match_slice->dataSize();
+          continue;
+        }
+        if (*match_next++ != needle[i]) {
+          break;
+        }
+        i++;
+      }
+      if (i == size) {
+        // Successful match of the entire needle.
+        return offset + (first_byte_match - slice_start);
+      }
+      // If this wasn't a successful match, start scanning again at the next byte.
+      haystack = first_byte_match + 1;
+    }
+    start = 0;
+    offset += slice_size;
+  }
+  return -1;
 }
 
 int OwnedImpl::write(int fd) {
@@ -175,7 +559,8 @@ int OwnedImpl::write(int fd) {
   return static_cast<int>(rc);
 }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl()
+    : old_impl_(use_old_impl_), buffer_(old_impl_ ? evbuffer_new() : nullptr) {}
 
 OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
@@ -183,5 +568,31 @@ OwnedImpl::OwnedImpl(const Instance& data) : OwnedImpl() { add(data); }
 
 OwnedImpl::OwnedImpl(const void* data, uint64_t size) : OwnedImpl() { add(data, size); }
 
+OwnedImpl::OwnedImpl(OwnedImpl&& other)
+    : old_impl_(other.old_impl_), slices_(std::move(other.slices_)), length_(other.length_),
+      buffer_(std::move(other.buffer_)) {
+  other.resetAfterMove();
+}
+
+OwnedImpl& OwnedImpl::operator=(OwnedImpl&& other) {
+  if (this != &other) {
+    old_impl_ = other.old_impl_;
+    slices_ = std::move(other.slices_);
+    length_ = other.length_;
+    buffer_ = std::move(other.buffer_);
+    other.resetAfterMove();
+  }
+  return *this;
+}
+
+void OwnedImpl::resetAfterMove() {
+  // A moved-from deque is valid but unspecified, so clear it explicitly.
+  slices_.clear();
+  length_ = 0;
+  if (old_impl_) {
+    buffer_.reset(evbuffer_new());
+  }
+}
+
 } // namespace Buffer
 } // namespace Envoy
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/buffer/slice_pool.h"
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
@@ -46,19 +53,248 @@ private:
   const std::function<void(const void*, size_t, const BufferFragmentImpl*)> releasor_;
 };
 
+/**
+ * A Slice manages a contiguous block of bytes.
+ * The block is arranged like this:
+ *                   |<- dataSize() ->|<- reservableSize() ->|
+ * +-----------------+----------------+----------------------+
+ * | Drained         | Data           | Reservable           |
+ * | Unused space    | Usable content | New content can be   |
+ * | that formerly   |                | added here with      |
+ * | was in the Data |                | reserve()/commit()   |
+ * | section         |                |                      |
+ * +-----------------+----------------+----------------------+
+ *                   ^                ^                      ^
+ *                   |                |                      |
+ *                   base_ + data_    base_ + reservable_    base_ + size_
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const void* data() const { return base_ + data_; }
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  void* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first `size` bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than dataSize(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+    if (data_ == reservable_) {
+      // There is no more content in the slice, so set the data pointer to the start of the slice
+      // so that as much space as possible is available for new reservations.
+      data_ = reservable_ = 0;
+    }
+  }
+
+  /**
+   * @return the total size in bytes of the memory the slice manages, including the drained and
+   *         reservable sections.
+   */
+  uint64_t size() const { return size_; }
+
+  /**
+   * @return the number of bytes available to be reserve()d.
+   */
+  uint64_t reservableSize() const { return size_ - reservable_; }
+
+  /**
+   * Reserve `size` bytes that the caller can populate with content. The caller SHOULD then
+   * call commit() to add the newly populated content from the Reserved section to the Data
+   * section. Any change to the slice (append(), drain() or another commit()) invalidates the
+   * reservation.
+   * @param size the number of bytes to reserve. The Slice implementation MAY reserve
+   *        fewer bytes than requested (for example, if it doesn't have enough room in the
+   *        Reservable section to fulfill the whole request).
+   * @return a RawSlice describing the reserved memory, with mem_ set to nullptr if no
+   *         memory could be reserved.
+   */
+  RawSlice reserve(uint64_t size) {
+    const uint64_t reservation_size = std::min(size, reservableSize());
+    if (reservation_size == 0) {
+      return {nullptr, 0};
+    }
+    return {base_ + reservable_, static_cast<size_t>(reservation_size)};
+  }
+
+  /**
+   * Commit a reservation that was previously obtained from a call to reserve().
+   * The reservation's size is added to the Data section.
+   * @param reservation a reservation obtained from a previous call to reserve().
+   *        If the reservation is not from this Slice, commit() will return false.
+   *        If the caller is committing fewer bytes than provided by reserve(), it
+   *        should change the len_ field of the reservation before calling commit().
+   *        For example, if a caller reserve()s 4KB to do a nonblocking socket read,
+   *        and the read only returns two bytes, the caller should set
+   *        reservation.len_ = 2 and then call commit(reservation).
+   * @return whether the reservation was successfully committed to the Slice.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (reservation.mem_ == nullptr ||
+        static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > size_) {
+      // The reservation is not from this Slice.
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the end of the slice.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size != 0) {
+      memcpy(base_ + reservable_, data, copy_size);
+      reservable_ += copy_size;
+    }
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t size)
+      : data_(data), reservable_(reservable), size_(size) {}
+
+  /** Start of the slice. Subclasses must set base_ to a valid address. */
+  uint8_t* base_{nullptr};
+
+  /** Offset in bytes from the start of the slice to the start of the Data section. */
+  uint64_t data_;
+
+  /** Offset in bytes from the start of the slice to the start of the Reservable section. */
+  uint64_t reservable_;
+
+  /** Total number of bytes in the slice. */
+  uint64_t size_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+typedef std::shared_ptr<Slice> SliceSharedPtr;
+
+/**
+ * A Slice whose storage is allocated inline, immediately following the object header, so that
+ * the header and the bytes it manages share a single allocation. The allocation comes from the
+ * calling thread's SlicePool when there is one.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have. The actual capacity is
+   *        rounded up so that the total allocation is a multiple of the page size.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied data.
+   * @param data the content to copy into the slice.
+   * @param size length of the content.
+   * @return an OwnedSlice containing a copy of the content, which may (dependent on
+   *         the internal implementation) have a nonzero amount of reservable space at the end.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  // Custom delete operator to keep C++14 from using the global operator delete(void*, size_t),
+  // which would result in the compiler error:
+  // "exception cleanup for this placement new selects non-placement operator delete"
+  static void operator delete(void* address) { SlicePool::deallocate(address); }
+
+private:
+  static void* operator new(size_t object_size, size_t data_size) {
+    return SlicePool::allocate(object_size + data_size);
+  }
+
+  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+
+  /**
+   * Compute a slice size big enough to hold a specified amount of data.
+   * @param data_size the minimum amount of data the slice must be able to store, in bytes.
+   * @return a recommended slice size, in bytes. The slice, its storage and the SlicePool
+   *         bookkeeping together fill a whole number of pages.
+   */
+  static uint64_t sliceSize(uint64_t data_size) {
+    constexpr uint64_t PageSize = SlicePool::PageSize;
+    constexpr uint64_t Overhead = SlicePool::HeaderSize + sizeof(OwnedSlice);
+    const uint64_t num_pages = (Overhead + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - Overhead;
+  }
+
+  uint8_t storage_[];
+};
+
+/**
+ * A Slice that refers to externally owned data supplied through a BufferFragment. The fragment's
+ * done() method is called when the slice is destroyed.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
+/**
+ * A Slice that exposes the remaining content of another slice whose memory must outlive the
+ * buffer, for example because the kernel still references the part that has been sent with
+ * MSG_ZEROCOPY. The view has no reservable space, so nothing is ever written into the shared
+ * memory. A view that is drained to empty is popped from its buffer like any other slice.
+ */
+class SharedSliceView : public Slice {
+public:
+  SharedSliceView(SliceSharedPtr parent)
+      : Slice(0, parent->dataSize(), parent->dataSize()), parent_(std::move(parent)) {
+    base_ = static_cast<uint8_t*>(parent_->data());
+  }
+
+private:
+  SliceSharedPtr parent_;
+};
+
 class LibEventInstance : public Instance {
 public:
-  // Allows access into the underlying buffer for move() optimizations.
-  virtual Event::Libevent::BufferPtr& buffer() PURE;
   // Called after accessing the memory in buffer() directly to allow any post-processing.
   virtual void postProcess() PURE;
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * Buffer implementation built from a deque of Slices. Content is appended to the reservable tail
+ * of the last slice when possible, move() hands slices over without copying, and reserve()/commit()
+ * hand out the slices' own memory for direct reads.
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * The original evbuffer-backed implementation is retained behind useOldImpl() for comparison and
+ * as a fallback; it is selected per buffer at construction time.
  */
 class OwnedImpl : public LibEventInstance {
 public:
@@ -67,6 +303,13 @@ public:
   OwnedImpl(const Instance& data);
   OwnedImpl(const void* data, uint64_t size);
 
+  /**
+   * Moving takes over the content and the implementation of other. other is left as an empty
+   * buffer that still uses its own implementation.
+   */
+  OwnedImpl(OwnedImpl&& other);
+  OwnedImpl& operator=(OwnedImpl&& other);
+
   // LibEventInstance
   void add(const void* data, uint64_t size) override;
   void addBufferFragment(BufferFragment& fragment) override;
@@ -86,9 +329,90 @@ public:
   int write(int fd) override;
   void postProcess() override {}
 
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
+  /**
+   * Select whether newly constructed buffers use the libevent evbuffer implementation. Buffers
+   * that already exist are not affected. This must be called before any worker threads are
+   * started.
+   * @param use_old_impl true to use the evbuffer implementation, false for the slice deque.
+   */
+  static void useOldImpl(bool use_old_impl);
+
+  /**
+   * @return whether newly constructed buffers use the libevent evbuffer implementation.
+   */
+  static bool newBuffersUseOldImpl() { return use_old_impl_; }
+
+  /**
+   * @return whether this buffer uses the libevent evbuffer implementation.
+   */
+  bool usesOldImpl() const { return old_impl_; }
+
+  /**
+   * Remove the first size bytes from the buffer without releasing the memory that holds them.
+   * The slices backing those bytes are appended to retained; a slice that is only partly drained
+   * is shared between retained and a SharedSliceView that stays at the front of the buffer. Calls
+   * postProcess() like the other draining operations. Only valid when usesOldImpl() is false.
+   * @param size supplies the number of bytes to drain.
+   * @param retained supplies the vector that receives the drained slices.
+   */
+  void drainRetained(uint64_t size, std::vector<SliceSharedPtr>& retained);
+
+  /**
+   * Append the content of slices retained by drainRetained() without copying it. Each slice is
+   * added as a SharedSliceView, so the same slices can be added to any number of buffers. Only
+   * valid when usesOldImpl() is false.
+   * @param slices supplies the slices to append.
+   */
+  void addSharedSlices(const std::vector<SliceSharedPtr>& slices);
+
+  /**
+   * Tell whether the memory behind one of the slices returned by getRawSlices() belongs to this
+   * buffer alone, so that it may be modified in place. Only valid when usesOldImpl() is false.
+   * @param index supplies the index of the slice in the output of getRawSlices().
+   * @return the size of the slice's memory if it is an OwnedSlice, or 0 if the memory is borrowed
+   *         or shared, as it is for an UnownedSlice or a SharedSliceView.
+   */
+  uint64_t ownedSliceSize(uint64_t index) const;
+
+  // Only valid when usesOldImpl() is true. Allows access into the underlying buffer for move()
+  // optimizations.
+  Event::Libevent::BufferPtr& buffer() { return buffer_; }
 
 private:
+  /**
+   * @param rhs another buffer.
+   * @return whether the rhs buffer is also an instance of OwnedImpl (or a subclass) that uses
+   *         the same internal implementation as this buffer.
+   */
+  bool isSameBufferImpl(const Instance& rhs) const;
+
+  /**
+   * Copy up to length bytes from an arbitrary buffer into this one and drain them from the source.
+   * Used when the two buffers use different internal implementations.
+   */
+  void moveByCopy(Instance& rhs, uint64_t length);
+
+  /**
+   * Empty this buffer after its content has been moved to another OwnedImpl.
+   */
+  void resetAfterMove();
+
+  /** Whether to use the old evbuffer implementation when constructing new OwnedImpl objects. */
+  static bool use_old_impl_;
+
+  /**
+   * Whether this buffer uses the old evbuffer implementation. Not const, so that buffers can be
+   * move assigned.
+   */
+  bool old_impl_;
+
+  /** Ring buffer of slices. */
+  std::deque<SlicePtr> slices_;
+
+  /** Sum of the dataSize of all slices. */
+  uint64_t length_{0};
+
+  /** Used instead of slices_ and length_ if old_impl_ is true. */
   Event::Libevent::BufferPtr buffer_;
 };
 
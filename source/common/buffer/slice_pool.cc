@@ -0,0 +1,189 @@
+#include "common/buffer/slice_pool.h"
+
+#include <cstddef>
+#include <new>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Bookkeeping placed in front of every allocation.
+ */
+struct SlicePool::BlockHeader {
+  BlockHeader(SlicePoolSharedPtr&& pool, uint64_t pages) : pool_(std::move(pool)), pages_(pages) {}
+
+  // The pool the block returns to, or nullptr for heap allocations and for blocks that are
+  // sitting in a free list.
+  SlicePoolSharedPtr pool_;
+  // Next block in a free list.
+  BlockHeader* next_{};
+  // Size of the whole allocation in pages, or 0 if the block was not sized in pages.
+  uint64_t pages_;
+};
+
+namespace {
+
+thread_local SlicePool* current_pool = nullptr;
+
+void* blockData(void* header) { return static_cast<uint8_t*>(header) + SlicePool::HeaderSize; }
+
+} // namespace
+
+constexpr uint64_t SlicePool::PageSize;
+constexpr uint64_t SlicePool::MaxPooledPages;
+constexpr uint64_t SlicePool::DefaultMaxResidentBytes;
+constexpr uint64_t SlicePool::HeaderSize;
+
+SlicePoolSharedPtr SlicePool::create(uint64_t max_resident_bytes) {
+  static_assert(sizeof(BlockHeader) <= HeaderSize, "BlockHeader does not fit in HeaderSize");
+  static_assert(HeaderSize % alignof(std::max_align_t) == 0,
+                "HeaderSize breaks the alignment of allocations");
+  return SlicePoolSharedPtr{new SlicePool(max_resident_bytes)};
+}
+
+SlicePool::SlicePool(uint64_t max_resident_bytes) : max_resident_bytes_(max_resident_bytes) {}
+
+SlicePool::~SlicePool() {
+  // Every outstanding block holds a reference to the pool, so only free list entries are left.
+  drainRemote();
+  for (BlockHeader*& list : free_) {
+    while (list != nullptr) {
+      BlockHeader* block = list;
+      list = block->next_;
+      freeBlock(block);
+    }
+  }
+  // A pool that outlived its owner had its stats detached already.
+  detachStats();
+}
+
+void SlicePool::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  stats_.reset(new SlicePoolStats{
+      ALL_SLICE_POOL_STATS(POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix))});
+}
+
+void SlicePool::detachStats() {
+  if (stats_) {
+    stats_->resident_bytes_.sub(resident_bytes_);
+    stats_.reset();
+  }
+}
+
+SlicePool* SlicePool::current() { return current_pool; }
+
+SlicePool::ScopedCurrent::ScopedCurrent(SlicePool& pool) : previous_(current_pool) {
+  current_pool = &pool;
+}
+
+SlicePool::ScopedCurrent::~ScopedCurrent() { current_pool = previous_; }
+
+void* SlicePool::allocate(uint64_t size) {
+  const uint64_t total_size = size + HeaderSize;
+  const uint64_t pages = total_size / PageSize;
+  if (current_pool != nullptr && total_size % PageSize == 0 && pages <= MaxPooledPages) {
+    return current_pool->allocateBlock(pages);
+  }
+
+  void* memory = ::operator new(total_size);
+  new (memory) BlockHeader(nullptr, 0);
+  return blockData(memory);
+}
+
+void SlicePool::deallocate(void* address) {
+  BlockHeader* block =
+      reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(address) - HeaderSize);
+  if (block->pool_ == nullptr) {
+    freeBlock(block);
+  } else if (block->pool_.get() == current_pool) {
+    current_pool->releaseLocal(block);
+  } else {
+    block->pool_->releaseRemote(block);
+  }
+}
+
+void* SlicePool::allocateBlock(uint64_t pages) {
+  ASSERT(pages > 0 && pages <= MaxPooledPages);
+  if (free_[pages] == nullptr) {
+    drainRemote();
+  }
+
+  BlockHeader* block = free_[pages];
+  if (block != nullptr) {
+    free_[pages] = block->next_;
+    block->next_ = nullptr;
+    block->pool_ = shared_from_this();
+    resident_bytes_ -= pages * PageSize;
+    if (stats_) {
+      stats_->hits_.inc();
+      stats_->resident_bytes_.sub(pages * PageSize);
+    }
+    return blockData(block);
+  }
+
+  if (stats_) {
+    stats_->misses_.inc();
+  }
+  void* memory = ::operator new(pages * PageSize);
+  new (memory) BlockHeader(shared_from_this(), pages);
+  return blockData(memory);
+}
+
+void SlicePool::releaseLocal(BlockHeader* block) {
+  // Take the block's reference to the pool. Blocks sitting in a free list do not keep the pool
+  // alive, otherwise it could never be destroyed. Dropping the reference may destroy the pool, so
+  // hold it until we are done.
+  SlicePoolSharedPtr self = std::move(block->pool_);
+  const uint64_t block_bytes = block->pages_ * PageSize;
+  if (resident_bytes_ + block_bytes > max_resident_bytes_) {
+    freeBlock(block);
+    return;
+  }
+
+  block->next_ = free_[block->pages_];
+  free_[block->pages_] = block;
+  resident_bytes_ += block_bytes;
+  if (stats_) {
+    stats_->resident_bytes_.add(block_bytes);
+  }
+}
+
+void SlicePool::releaseRemote(BlockHeader* block) {
+  // As in releaseLocal(), the pool must stay alive until the block has been handed over. If this
+  // drops the last reference, the destructor frees the block along with the rest of the list.
+  SlicePoolSharedPtr self = std::move(block->pool_);
+  BlockHeader* head = remote_free_.load(std::memory_order_relaxed);
+  do {
+    block->next_ = head;
+  } while (!remote_free_.compare_exchange_weak(head, block, std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void SlicePool::drainRemote() {
+  // The owner always takes the whole list, so there is no ABA problem with concurrent pushes.
+  BlockHeader* block = remote_free_.exchange(nullptr, std::memory_order_acquire);
+  while (block != nullptr) {
+    BlockHeader* next = block->next_;
+    const uint64_t block_bytes = block->pages_ * PageSize;
+    if (resident_bytes_ + block_bytes > max_resident_bytes_) {
+      freeBlock(block);
+    } else {
+      block->next_ = free_[block->pages_];
+      free_[block->pages_] = block;
+      resident_bytes_ += block_bytes;
+      if (stats_) {
+        stats_->resident_bytes_.add(block_bytes);
+      }
+    }
+    block = next;
+  }
+}
+
+void SlicePool::freeBlock(BlockHeader* block) {
+  block->~BlockHeader();
+  ::operator delete(block);
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "envoy/stats/stats.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * All slice pool stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_SLICE_POOL_STATS(COUNTER, GAUGE)                                                       \
+  COUNTER(hits)                                                                                    \
+  COUNTER(misses)                                                                                  \
+  GAUGE  (resident_bytes)
+// clang-format on
+
+/**
+ * Struct definition for all slice pool stats. @see stats_macros.h
+ */
+struct SlicePoolStats {
+  ALL_SLICE_POOL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class SlicePool;
+typedef std::shared_ptr<SlicePool> SlicePoolSharedPtr;
+
+/**
+ * A per-thread free-list allocator for buffer slice memory. Allocations are made in whole pages
+ * and blocks of up to MaxPooledPages pages are recycled through per-size free lists instead of
+ * going back to the global heap.
+ *
+ * A pool is owned by a single thread (in practice the thread running the owning dispatcher's
+ * event loop), which installs it with ScopedCurrent. Allocations made on that thread come from
+ * the pool. A block always returns to the pool that allocated it: if it is released on the owning
+ * thread it goes straight onto the free list, otherwise it is pushed onto a lock-free list of
+ * remotely released blocks that the owner drains the next time it runs out of free blocks. Every
+ * outstanding block holds a reference to its pool, so a pool outlives all of its blocks even if
+ * its owner has gone away.
+ */
+class SlicePool : NonCopyable, public std::enable_shared_from_this<SlicePool> {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t MaxPooledPages = 8;
+  static constexpr uint64_t DefaultMaxResidentBytes = 8 * 1024 * 1024;
+
+  /**
+   * Number of bytes at the start of each allocation used for bookkeeping. Callers that want
+   * page-sized allocations should account for this when choosing a size.
+   */
+  static constexpr uint64_t HeaderSize = 32;
+
+  /**
+   * @param max_resident_bytes supplies the maximum number of bytes that may be held in free lists.
+   *        Blocks released beyond this limit go back to the heap.
+   */
+  static SlicePoolSharedPtr create(uint64_t max_resident_bytes = DefaultMaxResidentBytes);
+
+  ~SlicePool();
+
+  /**
+   * Initialize stats for this pool. This must be done before the owning thread starts using the
+   * pool.
+   * @param scope supplies the scope to create stats in.
+   * @param prefix supplies the stat prefix, including the trailing '.'.
+   */
+  void initializeStats(Stats::Scope& scope, const std::string& prefix);
+
+  /**
+   * Stop updating the stats set up by initializeStats(), and take the bytes held in free lists out
+   * of the resident bytes gauge. Outstanding blocks can keep the pool alive after its owner and the
+   * stats scope are gone, so the owner must call this before either goes away. Must be called on
+   * the owning thread, or once it has stopped using the pool.
+   */
+  void detachStats();
+
+  /**
+   * @return the number of bytes currently held in free lists on the owning thread.
+   */
+  uint64_t residentBytes() const { return resident_bytes_; }
+
+  /**
+   * Allocate memory for a slice. If the calling thread has a current pool and the size is
+   * poolable, the memory comes from that pool, otherwise from the heap.
+   * @param size supplies the number of usable bytes needed.
+   * @return a pointer to at least size bytes, aligned like operator new.
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * Release memory obtained from allocate(). This may be called from any thread.
+   * @param address supplies the pointer returned by allocate().
+   */
+  static void deallocate(void* address);
+
+  /**
+   * @return the pool installed on the calling thread, or nullptr.
+   */
+  static SlicePool* current();
+
+  /**
+   * Installs a pool as the calling thread's current pool for the lifetime of the object, then
+   * restores the previous one.
+   */
+  class ScopedCurrent : NonCopyable {
+  public:
+    ScopedCurrent(SlicePool& pool);
+    ~ScopedCurrent();
+
+  private:
+    SlicePool* previous_;
+  };
+
+private:
+  struct BlockHeader;
+
+  SlicePool(uint64_t max_resident_bytes);
+
+  void* allocateBlock(uint64_t pages);
+  void releaseLocal(BlockHeader* block);
+  void releaseRemote(BlockHeader* block);
+  void drainRemote();
+  static void freeBlock(BlockHeader* block);
+
+  const uint64_t max_resident_bytes_;
+  uint64_t resident_bytes_{0};
+  // Free lists indexed by block size in pages. Only accessed on the owning thread.
+  BlockHeader* free_[MaxPooledPages + 1]{};
+  // Blocks released by other threads. Pushed to by any thread, drained by the owning thread.
+  std::atomic<BlockHeader*> remote_free_{nullptr};
+  std::unique_ptr<SlicePoolStats> stats_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
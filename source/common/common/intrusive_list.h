@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+template <class T> class IntrusiveList;
+
+/**
+ * Mixin class holding the links of an object in an IntrusiveList<T>. The object can be in one such
+ * list at a time.
+ */
+template <class T> class IntrusiveListNode {
+public:
+  IntrusiveListNode(const IntrusiveListNode&) = delete;
+  IntrusiveListNode& operator=(const IntrusiveListNode&) = delete;
+
+  /**
+   * @return whether the object is currently in a list.
+   */
+  bool linked() const { return next_ != nullptr; }
+
+protected:
+  IntrusiveListNode() {}
+  ~IntrusiveListNode() { ASSERT(!linked()); }
+
+private:
+  friend class IntrusiveList<T>;
+
+  IntrusiveListNode* prev_{};
+  IntrusiveListNode* next_{};
+};
+
+/**
+ * Doubly linked list of objects that hold their own links by deriving from IntrusiveListNode<T>.
+ * Adding, removing and moving objects between lists never allocates, and removal only needs the
+ * object. The list does not own the objects in it.
+ */
+template <class T> class IntrusiveList {
+public:
+  class Iterator {
+  public:
+    T& operator*() const { return static_cast<T&>(*node_); }
+    T* operator->() const { return &static_cast<T&>(*node_); }
+    Iterator& operator++() {
+      node_ = node_->next_;
+      return *this;
+    }
+    bool operator!=(const Iterator& rhs) const { return node_ != rhs.node_; }
+
+  private:
+    friend class IntrusiveList;
+
+    explicit Iterator(IntrusiveListNode<T>* node) : node_(node) {}
+
+    IntrusiveListNode<T>* node_;
+  };
+
+  IntrusiveList() { head_.prev_ = head_.next_ = &head_; }
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+  ~IntrusiveList() {
+    ASSERT(empty());
+    head_.prev_ = head_.next_ = nullptr;
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  T& front() {
+    ASSERT(!empty());
+    return static_cast<T&>(*head_.next_);
+  }
+
+  T& back() {
+    ASSERT(!empty());
+    return static_cast<T&>(*head_.prev_);
+  }
+
+  /**
+   * Iteration is in order from the front. The object an iterator is at must not be removed.
+   */
+  Iterator begin() { return Iterator(head_.next_); }
+  Iterator end() { return Iterator(&head_); }
+
+  void pushFront(T& item) { insertAfter(head_, item); }
+  void pushBack(T& item) { insertAfter(*head_.prev_, item); }
+
+  /**
+   * Remove an object from the list.
+   * @param item supplies the object, which must be in this list.
+   */
+  void remove(T& item) {
+    IntrusiveListNode<T>& node = item;
+    ASSERT(node.linked() && size_ > 0);
+    node.prev_->next_ = node.next_;
+    node.next_->prev_ = node.prev_;
+    node.prev_ = node.next_ = nullptr;
+    size_--;
+  }
+
+  /**
+   * Move an object from the list it is in to the front of this one.
+   * @param item supplies the object.
+   * @param from supplies the list the object is in.
+   */
+  void moveToFront(T& item, IntrusiveList& from) {
+    from.remove(item);
+    pushFront(item);
+  }
+
+  /**
+   * Exchange the contents of two lists.
+   */
+  void swap(IntrusiveList& other) {
+    IntrusiveList tmp;
+    tmp.take(*this);
+    take(other);
+    other.take(tmp);
+  }
+
+private:
+  void insertAfter(IntrusiveListNode<T>& position, T& item) {
+    IntrusiveListNode<T>& node = item;
+    ASSERT(!node.linked());
+    node.prev_ = &position;
+    node.next_ = position.next_;
+    position.next_->prev_ = &node;
+    position.next_ = &node;
+    size_++;
+  }
+
+  // Move all the objects of other into this list, which must be empty.
+  void take(IntrusiveList& other) {
+    ASSERT(empty());
+    if (other.empty()) {
+      return;
+    }
+    head_.next_ = other.head_.next_;
+    head_.prev_ = other.head_.prev_;
+    head_.next_->prev_ = &head_;
+    head_.prev_->next_ = &head_;
+    size_ = other.size_;
+    other.head_.prev_ = other.head_.next_ = &other.head_;
+    other.size_ = 0;
+  }
+
+  IntrusiveListNode<T> head_;
+  size_t size_{};
+};
+
+} // namespace Envoy
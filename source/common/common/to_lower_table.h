@@ -5,8 +5,8 @@
 
 namespace Envoy {
 /**
- * Convenience class for converting ASCII strings to lower case using a lookup table for maximum
- * speed.
+ * Convenience class for converting ASCII strings to lower case for maximum speed, eight bytes at a
+ * time and with a lookup table for the rest.
  */
 class ToLowerTable {
 public:
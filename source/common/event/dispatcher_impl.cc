@@ -10,7 +10,6 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/signal_impl.h"
 #include "common/event/timer_impl.h"
@@ -18,12 +17,17 @@
 #include "common/network/connection_impl.h"
 #include "common/network/dns_impl.h"
 #include "common/network/listener_impl.h"
+#include "common/network/udp_listener_impl.h"
+#include "common/network/zero_copy_sender.h"
 
 #include "event2/event.h"
 
 namespace Envoy {
 namespace Event {
 
+bool DispatcherImpl::use_io_uring_ = false;
+bool DispatcherImpl::use_timer_wheel_ = false;
+
 DispatcherImpl::DispatcherImpl()
     : DispatcherImpl(Buffer::WatermarkFactoryPtr{new Buffer::WatermarkBufferFactory}) {
   // The dispatcher won't work as expected if libevent hasn't been configured to use threads.
@@ -31,14 +35,31 @@ DispatcherImpl::DispatcherImpl()
 }
 
 DispatcherImpl::DispatcherImpl(Buffer::WatermarkFactoryPtr&& factory)
-    : buffer_factory_(std::move(factory)), base_(event_base_new()),
+    : slice_pool_(Buffer::SlicePool::create()), buffer_factory_(std::move(factory)),
+      base_(event_base_new()),
+      timer_wheel_(use_timer_wheel_ ? new WheelTimerScheduler(*this) : nullptr),
       deferred_delete_timer_(createTimer([this]() -> void { clearDeferredDeleteList(); })),
-      post_timer_(createTimer([this]() -> void { runPostCallbacks(); })),
+      post_timer_(new TimerImpl(*this, [this]() -> void { runPostCallbacks(); })),
       current_to_delete_(&to_delete_1_) {
   RELEASE_ASSERT(Libevent::Global::initialized());
+  if (use_io_uring_) {
+    io_uring_poller_ = IoUringPoller::create(*base_);
+    if (io_uring_poller_ == nullptr) {
+      ENVOY_LOG(warn, "io_uring is not available, polling file events with libevent");
+    }
+  }
 }
 
-DispatcherImpl::~DispatcherImpl() {}
+DispatcherImpl::~DispatcherImpl() {
+  Network::ZeroCopySender::onDispatcherDestroyed(*this);
+  // Buffers still holding slices keep the pool alive, possibly after the stats scope is gone.
+  slice_pool_->detachStats();
+}
+
+void DispatcherImpl::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  slice_pool_->initializeStats(scope, prefix + "buffer_pool.");
+  loop_stats_.reset(new LoopStats(scope, prefix + "loop."));
+}
 
 void DispatcherImpl::clearDeferredDeleteList() {
   ASSERT(isThreadSafe());
@@ -50,6 +71,7 @@ void DispatcherImpl::clearDeferredDeleteList() {
   }
 
   ENVOY_LOG(trace, "clearing deferred deletion list (size={})", num_to_delete);
+  LoopStats::ScopedCallback callback_stats(LoopStats::Category::DeferredDelete);
 
   // Swap the current deletion vector so that if we do deferred delete while we are deleting, we
   // use the other vector. We will get another callback to delete that vector.
@@ -99,6 +121,10 @@ Network::DnsResolverSharedPtr DispatcherImpl::createDnsResolver(
 FileEventPtr DispatcherImpl::createFileEvent(int fd, FileReadyCb cb, FileTriggerType trigger,
                                              uint32_t events) {
   ASSERT(isThreadSafe());
+  if (io_uring_poller_ != nullptr) {
+    return FileEventPtr{
+        new IoUringFileEventImpl(*io_uring_poller_, *base_, fd, cb, trigger, events)};
+  }
   return FileEventPtr{new FileEventImpl(*this, fd, cb, trigger, events)};
 }
 
@@ -115,8 +141,17 @@ DispatcherImpl::createListener(Network::Socket& socket, Network::ListenerCallbac
                                                         hand_off_restored_destination_connections)};
 }
 
+Network::UdpListenerPtr DispatcherImpl::createUdpListener(Network::Socket& socket,
+                                                          Network::UdpListenerCallbacks& cb) {
+  ASSERT(isThreadSafe());
+  return Network::UdpListenerPtr{new Network::UdpListenerImpl(*this, socket, cb)};
+}
+
 TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   ASSERT(isThreadSafe());
+  if (timer_wheel_ != nullptr) {
+    return TimerPtr{new WheelTimerImpl(*timer_wheel_, *this, cb)};
+  }
   return TimerPtr{new TimerImpl(*this, cb)};
 }
 
@@ -137,14 +172,9 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
+  // Only the first post after the loop starts draining wakes it up. libevent's cross-thread
+  // notification behind the zero timeout uses an eventfd where available.
+  if (post_queue_.push(std::move(callback))) {
     post_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 }
@@ -152,26 +182,47 @@ void DispatcherImpl::post(std::function<void()> callback) {
 void DispatcherImpl::run(RunType type) {
   run_tid_ = Thread::Thread::currentThreadId();
 
+  // Buffer slices allocated while the loop runs come from this dispatcher's pool.
+  Buffer::SlicePool::ScopedCurrent current_slice_pool(*slice_pool_);
+
   // Flush all post callbacks before we run the event loop. We do this because there are post
   // callbacks that have to get run before the initial event loop starts running. libevent does
   // not gaurantee that events are run in any particular order. So even if we post() and call
   // event_base_once() before some other event, the other event might get called first.
   runPostCallbacks();
 
-  event_base_loop(base_.get(), type == RunType::NonBlock ? EVLOOP_NONBLOCK : 0);
+  // Hand over poll requests queued outside the loop, so that readiness that is already pending is
+  // picked up by this pass.
+  if (io_uring_poller_ != nullptr) {
+    io_uring_poller_->flush();
+  }
+
+  if (loop_stats_ == nullptr) {
+    event_base_loop(base_.get(), type == RunType::NonBlock ? EVLOOP_NONBLOCK : 0);
+    return;
+  }
+
+  // Run the loop one pass at a time so that each pass can be measured. A pass waits for events
+  // and then runs callbacks until none are active.
+  LoopStats::ScopedCurrent current_loop_stats(*loop_stats_);
+  if (type == RunType::NonBlock) {
+    event_base_loop(base_.get(), EVLOOP_NONBLOCK);
+    loop_stats_->endIteration();
+    return;
+  }
+  while (event_base_loop(base_.get(), EVLOOP_ONCE) == 0) {
+    loop_stats_->endIteration();
+    if (event_base_got_exit(base_.get()) || event_base_got_break(base_.get())) {
+      break;
+    }
+  }
 }
 
 void DispatcherImpl::runPostCallbacks() {
-  std::function<void()> callback;
-  while (true) {
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
-    }
+  LoopStats::ScopedCallback callback_stats(LoopStats::Category::Post);
+  post_queue_.beginDrain();
+  PostCb callback;
+  while (post_queue_.pop(callback)) {
     callback();
   }
 }
@@ -2,20 +2,26 @@
 
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <memory>
 #include <vector>
 
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection_handler.h"
 
+#include "common/buffer/slice_pool.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
+#include "common/event/io_uring_file_event_impl.h"
 #include "common/event/libevent.h"
+#include "common/event/loop_stats.h"
+#include "common/event/post_queue.h"
 
 namespace Envoy {
 namespace Event {
 
+class WheelTimerScheduler;
+
 /**
  * libevent implementation of Event::Dispatcher.
  */
@@ -30,7 +36,40 @@ public:
    */
   event_base& base() { return *base_; }
 
+  /**
+   * @return the pool that buffer slices allocated on this dispatcher's thread come from.
+   */
+  Buffer::SlicePool& slicePool() { return *slice_pool_; }
+
+  /**
+   * @return bool whether file events on this dispatcher are polled through io_uring.
+   */
+  bool ioUringEnabled() const { return io_uring_poller_ != nullptr; }
+
+  /**
+   * Select the polling backend for file events on dispatchers created afterwards. When io_uring
+   * is requested but not available, dispatchers fall back to libevent.
+   * @param use_io_uring supplies whether to poll file events through io_uring.
+   */
+  static void useIoUring(bool use_io_uring) { use_io_uring_ = use_io_uring; }
+
+  /**
+   * @return bool whether timers created by this dispatcher run on a timer wheel.
+   */
+  bool timerWheelEnabled() const { return timer_wheel_ != nullptr; }
+
+  /**
+   * Select whether dispatchers created afterwards run their timers on a hierarchical timer wheel
+   * with millisecond ticks instead of libevent's timer heap.
+   * @param use_timer_wheel supplies whether to use a timer wheel.
+   */
+  static void useTimerWheel(bool use_timer_wheel) { use_timer_wheel_ = use_timer_wheel; }
+
   // Event::Dispatcher
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override;
+  uint32_t loopUtilization() const override {
+    return loop_stats_ != nullptr ? loop_stats_->utilization() : 0;
+  }
   void clearDeferredDeleteList() override;
   Network::ConnectionPtr
   createServerConnection(Network::ConnectionSocketPtr&& socket,
@@ -48,6 +87,8 @@ public:
   Network::ListenerPtr createListener(Network::Socket& socket, Network::ListenerCallbacks& cb,
                                       bool bind_to_port,
                                       bool hand_off_restored_destination_connections) override;
+  Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                            Network::UdpListenerCallbacks& cb) override;
   TimerPtr createTimer(TimerCb cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
   void exit() override;
@@ -67,16 +108,23 @@ private:
   }
 
   Thread::ThreadId run_tid_{};
+  Buffer::SlicePoolSharedPtr slice_pool_;
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
+  IoUringPollerPtr io_uring_poller_;
+  std::unique_ptr<WheelTimerScheduler> timer_wheel_;
   TimerPtr deferred_delete_timer_;
+  // Always a libevent timer, since it is enabled from other threads.
   TimerPtr post_timer_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
   std::vector<DeferredDeletablePtr> to_delete_2_;
   std::vector<DeferredDeletablePtr>* current_to_delete_;
-  Thread::MutexBasicLockable post_lock_;
-  std::list<std::function<void()>> post_callbacks_ GUARDED_BY(post_lock_);
+  PostQueue post_queue_;
+  std::unique_ptr<LoopStats> loop_stats_;
   bool deferred_deleting_{};
+
+  static bool use_io_uring_;
+  static bool use_timer_wheel_;
 };
 
 } // namespace Event
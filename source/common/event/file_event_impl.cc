@@ -4,6 +4,7 @@
 
 #include "common/common/assert.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/event/loop_stats.h"
 
 #include "event2/event.h"
 
@@ -35,6 +36,8 @@ void FileEventImpl::activate(uint32_t events) {
   event_active(&raw_event_, libevent_events, 0);
 }
 
+int FileEventImpl::receive(Buffer::Instance&, uint64_t) { NOT_REACHED; }
+
 void FileEventImpl::assignEvents(uint32_t events) {
   event_assign(&raw_event_, base_, fd_,
                EV_PERSIST | (trigger_ == FileTriggerType::Level ? 0 : EV_ET) |
@@ -57,6 +60,7 @@ void FileEventImpl::assignEvents(uint32_t events) {
                  }
 
                  ASSERT(events);
+                 LoopStats::ScopedCallback callback_stats(LoopStats::Category::FileEvent);
                  event->cb_(events);
                },
                this);
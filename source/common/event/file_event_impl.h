@@ -22,6 +22,8 @@ public:
   // Event::FileEvent
   void activate(uint32_t events) override;
   void setEnabled(uint32_t events) override;
+  bool enableReceive() override { return false; }
+  int receive(Buffer::Instance& buffer, uint64_t max_length) override;
 
 private:
   void assignEvents(uint32_t events);
@@ -0,0 +1,381 @@
+#include "common/event/io_uring.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ENVOY_IO_URING_SUPPORTED 1
+#endif
+#endif
+
+#ifdef ENVOY_IO_URING_SUPPORTED
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// The system call numbers are shared by all architectures, but older C library headers predate
+// them.
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE (1U << 1)
+#endif
+#ifndef IORING_RECV_MULTISHOT
+#define IORING_RECV_MULTISHOT (1U << 1)
+#endif
+#endif
+
+namespace Envoy {
+namespace Event {
+
+#ifdef ENVOY_IO_URING_SUPPORTED
+
+namespace {
+
+// user_data of the requests issued to check for multishot poll and receive support.
+const uint64_t ProbeUserData = ~0ULL;
+
+// The only group of provided buffers, which receive requests select from.
+const uint16_t ReceiveBufferGroup = 0;
+
+// IORING_REGISTER_PBUF_RING and the structures it uses, which older headers lack.
+const uint32_t RegisterBufferRing = 22;
+
+struct BufferRingEntry {
+  uint64_t addr_;
+  uint32_t len_;
+  uint16_t bid_;
+  // The ring's tail, in the first entry only.
+  uint16_t tail_;
+};
+
+struct BufferRingRegistration {
+  uint64_t ring_addr_;
+  uint32_t ring_entries_;
+  uint16_t bgid_;
+  uint16_t flags_;
+  uint64_t reserved_[3];
+};
+
+template <class T> T* offset(void* base, uint32_t bytes) {
+  return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + bytes);
+}
+
+} // namespace
+
+IoUringPtr IoUring::create(uint32_t entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = entries * 4;
+  const int fd = ::syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  IoUringPtr ring(new IoUring(fd));
+  // Overflowed completions must be kept rather than dropped, and the single mapping keeps setup
+  // simple. Both are older than multishot poll, which is checked below.
+  if ((params.features & IORING_FEAT_NODROP) == 0 ||
+      (params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+    return nullptr;
+  }
+
+  const size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  const size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->ring_size_ = std::max(sq_size, cq_size);
+  ring->ring_ = ::mmap(nullptr, ring->ring_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ring->ring_ == MAP_FAILED) {
+    ring->ring_ = nullptr;
+    return nullptr;
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes_ = ::mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (ring->sqes_ == MAP_FAILED) {
+    ring->sqes_ = nullptr;
+    return nullptr;
+  }
+
+  void* base = ring->ring_;
+  ring->sq_head_ = offset<uint32_t>(base, params.sq_off.head);
+  ring->sq_tail_ = offset<uint32_t>(base, params.sq_off.tail);
+  ring->sq_flags_ = offset<uint32_t>(base, params.sq_off.flags);
+  ring->sq_mask_ = *offset<uint32_t>(base, params.sq_off.ring_mask);
+  ring->sq_entries_ = params.sq_entries;
+  ring->cq_head_ = offset<uint32_t>(base, params.cq_off.head);
+  ring->cq_tail_ = offset<uint32_t>(base, params.cq_off.tail);
+  ring->cq_mask_ = *offset<uint32_t>(base, params.cq_off.ring_mask);
+  ring->cqes_ = offset<void>(base, params.cq_off.cqes);
+
+  // Submission slot i always refers to entry i, so the indirection array is filled in once.
+  uint32_t* array = offset<uint32_t>(base, params.sq_off.array);
+  for (uint32_t i = 0; i < params.sq_entries; i++) {
+    array[i] = i;
+  }
+
+  // Kernels before 5.13 reject the multishot flag, and a poll on a pipe with room to write
+  // completes immediately, so one round trip tells whether multishot poll works.
+  int pipe_fds[2];
+  if (::pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return nullptr;
+  }
+  ring->pollAdd(pipe_fds[1], POLLOUT, true, ProbeUserData);
+  ring->submit();
+  ring->enter(0, 1, IORING_ENTER_GETEVENTS);
+  std::vector<Completion> completions;
+  ring->reap(completions);
+  ring->pollRemove(ProbeUserData);
+  ring->submit();
+  ring->enter(0, 1, IORING_ENTER_GETEVENTS);
+  ring->reap(completions);
+  ::close(pipe_fds[0]);
+  ::close(pipe_fds[1]);
+  if (completions.empty() || completions[0].user_data_ != ProbeUserData ||
+      completions[0].result_ < 0 || !completions[0].more_) {
+    return nullptr;
+  }
+
+  return ring;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    ::munmap(sqes_, sqes_size_);
+  }
+  if (ring_ != nullptr) {
+    ::munmap(ring_, ring_size_);
+  }
+  // Closing the ring releases the kernel's hold on the receive buffers.
+  ::close(fd_);
+  if (buffer_ring_ != nullptr) {
+    ::munmap(buffer_ring_, buffer_ring_size_);
+  }
+  if (receive_buffers_ != nullptr) {
+    ::munmap(receive_buffers_, receive_buffers_size_);
+  }
+}
+
+bool IoUring::registerReceiveBuffers(uint32_t count, uint32_t size) {
+  ASSERT(count > 0 && count <= 32768 && (count & (count - 1)) == 0);
+  ASSERT(buffer_ring_ == nullptr);
+  buffer_ring_size_ = count * sizeof(BufferRingEntry);
+  void* buffer_ring = ::mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer_ring == MAP_FAILED) {
+    return false;
+  }
+  buffer_ring_ = buffer_ring;
+  receive_buffers_size_ = static_cast<size_t>(count) * size;
+  void* receive_buffers = ::mmap(nullptr, receive_buffers_size_, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (receive_buffers == MAP_FAILED) {
+    return false;
+  }
+  receive_buffers_ = static_cast<uint8_t*>(receive_buffers);
+  receive_buffer_size_ = size;
+  buffer_ring_mask_ = count - 1;
+
+  BufferRingRegistration registration;
+  memset(&registration, 0, sizeof(registration));
+  registration.ring_addr_ = reinterpret_cast<uint64_t>(buffer_ring_);
+  registration.ring_entries_ = count;
+  registration.bgid_ = ReceiveBufferGroup;
+  if (::syscall(__NR_io_uring_register, fd_, RegisterBufferRing, &registration, 1) != 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    recycleReceiveBuffer(i);
+  }
+
+  // Kernels before 6.0 reject multishot receives, so one byte sent over a socket pair tells whether
+  // they work. The request is then cancelled, and waited for so that none of its completions are
+  // left for the caller.
+  int socket_fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, socket_fds) != 0) {
+    return false;
+  }
+  recvAdd(socket_fds[0], ProbeUserData);
+  submit();
+  const char probe = 0;
+  bool supported = ::write(socket_fds[1], &probe, 1) == 1;
+  bool cancelled = false;
+  if (!supported) {
+    cancel(ProbeUserData);
+    submit();
+    cancelled = true;
+  }
+  bool armed = true;
+  std::vector<Completion> completions;
+  while (armed) {
+    enter(0, 1, IORING_ENTER_GETEVENTS);
+    reap(completions);
+    for (const Completion& completion : completions) {
+      if (completion.user_data_ != ProbeUserData) {
+        continue;
+      }
+      if (completion.buffer_ >= 0) {
+        recycleReceiveBuffer(completion.buffer_);
+      } else if (completion.result_ != -ECANCELED) {
+        supported = false;
+      }
+      if (!completion.more_) {
+        armed = false;
+      } else if (!cancelled) {
+        cancel(ProbeUserData);
+        submit();
+        cancelled = true;
+      }
+    }
+    completions.clear();
+  }
+  ::close(socket_fds[0]);
+  ::close(socket_fds[1]);
+  return supported && cancelled;
+}
+
+void IoUring::pollAdd(int fd, uint32_t poll_mask, bool multishot, uint64_t user_data) {
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(nextSubmission());
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = poll_mask;
+  sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+  sqe->user_data = user_data;
+}
+
+void IoUring::pollRemove(uint64_t target_user_data) {
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(nextSubmission());
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = target_user_data;
+  sqe->user_data = 0;
+}
+
+void IoUring::recvAdd(int fd, uint64_t user_data) {
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(nextSubmission());
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = ReceiveBufferGroup;
+  sqe->user_data = user_data;
+}
+
+void IoUring::cancel(uint64_t target_user_data) {
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(nextSubmission());
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = target_user_data;
+  sqe->user_data = 0;
+}
+
+void IoUring::recycleReceiveBuffer(int32_t buffer) {
+  BufferRingEntry* entries = static_cast<BufferRingEntry*>(buffer_ring_);
+  BufferRingEntry& entry = entries[buffer_ring_tail_ & buffer_ring_mask_];
+  entry.addr_ = reinterpret_cast<uint64_t>(receiveBuffer(buffer));
+  entry.len_ = receive_buffer_size_;
+  entry.bid_ = buffer;
+  buffer_ring_tail_++;
+  // The kernel reads the tail without entering, so the entry must be visible before it.
+  __atomic_store_n(&entries[0].tail_, buffer_ring_tail_, __ATOMIC_RELEASE);
+}
+
+void* IoUring::nextSubmission() {
+  uint32_t tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+    submit();
+    // The kernel consumes every submission it is given unless it is out of memory.
+    RELEASE_ASSERT(tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) < sq_entries_);
+  }
+
+  struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + (tail & sq_mask_);
+  memset(sqe, 0, sizeof(*sqe));
+  // Without SQPOLL the kernel only reads entries inside io_uring_enter(), so the caller can fill
+  // the entry in after the tail has moved past it.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  unsubmitted_++;
+  return sqe;
+}
+
+void IoUring::submit() {
+  while (unsubmitted_ > 0) {
+    const int rc = enter(unsubmitted_, 0, 0);
+    if (rc <= 0) {
+      // EBUSY or EAGAIN: the kernel is short of resources or has completions to flush first. The
+      // remaining requests are handed over by the next submit().
+      return;
+    }
+    unsubmitted_ -= std::min<uint32_t>(rc, unsubmitted_);
+  }
+}
+
+void IoUring::reap(std::vector<Completion>& completions) {
+  if (__atomic_load_n(sq_flags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+    // Completions that did not fit in the ring are moved into it when the kernel is entered.
+    enter(0, 0, IORING_ENTER_GETEVENTS);
+  }
+
+  uint32_t head = *cq_head_;
+  const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  const struct io_uring_cqe* cqes = static_cast<const struct io_uring_cqe*>(cqes_);
+  for (; head != tail; head++) {
+    const struct io_uring_cqe& cqe = cqes[head & cq_mask_];
+    completions.push_back({cqe.user_data, cqe.res, (cqe.flags & IORING_CQE_F_MORE) != 0,
+                           (cqe.flags & IORING_CQE_F_BUFFER) != 0
+                               ? static_cast<int32_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT)
+                               : -1});
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+int IoUring::enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return ::syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0);
+}
+
+#else
+
+IoUringPtr IoUring::create(uint32_t) { return nullptr; }
+
+IoUring::~IoUring() {}
+
+void IoUring::pollAdd(int, uint32_t, bool, uint64_t) { NOT_IMPLEMENTED; }
+
+void IoUring::pollRemove(uint64_t) { NOT_IMPLEMENTED; }
+
+bool IoUring::registerReceiveBuffers(uint32_t, uint32_t) { return false; }
+
+void IoUring::recvAdd(int, uint64_t) { NOT_IMPLEMENTED; }
+
+void IoUring::cancel(uint64_t) { NOT_IMPLEMENTED; }
+
+void IoUring::recycleReceiveBuffer(int32_t) { NOT_IMPLEMENTED; }
+
+void IoUring::submit() { NOT_IMPLEMENTED; }
+
+void IoUring::reap(std::vector<Completion>&) { NOT_IMPLEMENTED; }
+
+#endif
+
+} // namespace Event
+} // namespace Envoy
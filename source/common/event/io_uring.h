@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+class IoUring;
+typedef std::unique_ptr<IoUring> IoUringPtr;
+
+/**
+ * A minimal io_uring instance driven through the raw system calls. Requests are written into the
+ * submission ring shared with the kernel and handed over in a single io_uring_enter() by submit().
+ * Completions are read back from the shared completion ring by reap() without entering the kernel.
+ * Only the poll and receive operations needed by IoUringPoller are exposed.
+ */
+class IoUring : NonCopyable {
+public:
+  struct Completion {
+    uint64_t user_data_;
+    int32_t result_;
+    // Whether the request is still armed and will post further completions.
+    bool more_;
+    // The receive buffer that holds the data of a receive completion, or -1.
+    int32_t buffer_;
+  };
+
+  /**
+   * @param entries supplies the number of submission queue entries. The completion queue is made
+   *        larger because multishot polls post completions without new submissions.
+   * @return IoUringPtr the new instance, or nullptr if io_uring with multishot poll (Linux 5.13)
+   *         is not available on this platform, or is disabled.
+   */
+  static IoUringPtr create(uint32_t entries);
+
+  ~IoUring();
+
+  /**
+   * @return int the ring's descriptor. It polls readable while completions are waiting.
+   */
+  int fd() const { return fd_; }
+
+  /**
+   * Queue a poll request.
+   * @param fd supplies the descriptor to poll.
+   * @param poll_mask supplies the POLL* events to wait for.
+   * @param multishot supplies whether the request stays armed after posting a completion, which
+   *        then happens on every wakeup of the descriptor, like an edge triggered epoll event.
+   * @param user_data supplies the value returned in the request's completions.
+   */
+  void pollAdd(int fd, uint32_t poll_mask, bool multishot, uint64_t user_data);
+
+  /**
+   * Queue the cancellation of a poll request. The cancellation's own completion carries
+   * user_data 0, so 0 must not be used for other requests.
+   * @param target_user_data supplies the user_data of the poll request to cancel.
+   */
+  void pollRemove(uint64_t target_user_data);
+
+  /**
+   * Set up the receive buffers that recvAdd() requests fill. They are handed to the kernel through
+   * a provided buffer ring, which it picks a buffer from whenever data arrives.
+   * @param count supplies the number of buffers, a power of two of at most 32768.
+   * @param size supplies the size of each buffer.
+   * @return bool whether receiving is available. It needs provided buffer rings (Linux 5.19) and
+   *         multishot receive (Linux 6.0).
+   */
+  bool registerReceiveBuffers(uint32_t count, uint32_t size);
+
+  /**
+   * Queue a multishot receive request. It posts a completion for every chunk of data received on
+   * the descriptor, in a buffer set up by registerReceiveBuffers(), until the end of the stream, an
+   * error or its cancellation. A completion without buffers left to fill carries -ENOBUFS and ends
+   * the request.
+   * @param fd supplies the descriptor to receive from.
+   * @param user_data supplies the value returned in the request's completions.
+   */
+  void recvAdd(int fd, uint64_t user_data);
+
+  /**
+   * Queue the cancellation of a request of any kind. Like pollRemove(), the cancellation's own
+   * completion carries user_data 0.
+   * @param target_user_data supplies the user_data of the request to cancel.
+   */
+  void cancel(uint64_t target_user_data);
+
+  /**
+   * @param buffer supplies the buffer of a receive completion.
+   * @return const uint8_t* the buffer's memory.
+   */
+  const uint8_t* receiveBuffer(int32_t buffer) const {
+    return receive_buffers_ + static_cast<uint64_t>(buffer) * receive_buffer_size_;
+  }
+
+  /**
+   * Hand the buffer of a receive completion back to the kernel, once its data has been consumed.
+   * @param buffer supplies the buffer.
+   */
+  void recycleReceiveBuffer(int32_t buffer);
+
+  /**
+   * @return bool whether there are queued requests that have not been handed to the kernel.
+   */
+  bool hasPendingSubmissions() const { return unsubmitted_ > 0; }
+
+  /**
+   * Hand all queued requests to the kernel.
+   */
+  void submit();
+
+  /**
+   * Move all available completions into completions.
+   */
+  void reap(std::vector<Completion>& completions);
+
+private:
+  IoUring(int fd) : fd_(fd) {}
+
+  void* nextSubmission();
+  int enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+
+  const int fd_;
+  void* ring_{};
+  size_t ring_size_{};
+  void* sqes_{};
+  size_t sqes_size_{};
+  uint32_t* sq_head_{};
+  uint32_t* sq_tail_{};
+  uint32_t* sq_flags_{};
+  uint32_t sq_mask_{};
+  uint32_t sq_entries_{};
+  uint32_t* cq_head_{};
+  uint32_t* cq_tail_{};
+  uint32_t cq_mask_{};
+  void* cqes_{};
+  uint32_t unsubmitted_{};
+  void* buffer_ring_{};
+  size_t buffer_ring_size_{};
+  uint16_t buffer_ring_tail_{};
+  uint32_t buffer_ring_mask_{};
+  uint8_t* receive_buffers_{};
+  size_t receive_buffers_size_{};
+  uint32_t receive_buffer_size_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,309 @@
+#include "common/event/io_uring_file_event_impl.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+
+#include "common/common/assert.h"
+#include "common/event/loop_stats.h"
+
+#include "event2/event.h"
+
+namespace Envoy {
+namespace Event {
+
+namespace {
+
+uint32_t toPollMask(uint32_t events) {
+  return (events & FileReadyType::Read ? POLLIN : 0) |
+         (events & FileReadyType::Write ? POLLOUT : 0) |
+         (events & FileReadyType::Closed ? POLLRDHUP : 0);
+}
+
+uint32_t fromPollMask(uint32_t poll_mask) {
+  // Errors and hangups are reported as both readable and writable, as libevent does for epoll.
+  if (poll_mask & (POLLERR | POLLHUP)) {
+    return FileReadyType::Read | FileReadyType::Write |
+           (poll_mask & POLLRDHUP ? FileReadyType::Closed : 0);
+  }
+  return (poll_mask & POLLIN ? FileReadyType::Read : 0) |
+         (poll_mask & POLLOUT ? FileReadyType::Write : 0) |
+         (poll_mask & POLLRDHUP ? FileReadyType::Closed : 0);
+}
+
+} // namespace
+
+IoUringPollerPtr IoUringPoller::create(event_base& base) {
+  IoUringPtr ring = IoUring::create(RingEntries);
+  if (ring == nullptr) {
+    return nullptr;
+  }
+  return IoUringPollerPtr{new IoUringPoller(base, std::move(ring))};
+}
+
+IoUringPoller::IoUringPoller(event_base& base, IoUringPtr&& ring)
+    : ring_(std::move(ring)),
+      receive_supported_(ring_->registerReceiveBuffers(ReceiveBufferCount, ReceiveBufferSize)) {
+  event_assign(&ring_event_, &base, ring_->fd(), EV_READ | EV_PERSIST,
+               [](evutil_socket_t, short, void* arg) -> void {
+                 static_cast<IoUringPoller*>(arg)->onRingReady();
+               },
+               this);
+  event_add(&ring_event_, nullptr);
+  evtimer_assign(&flush_event_, &base,
+                 [](evutil_socket_t, short, void* arg) -> void {
+                   static_cast<IoUringPoller*>(arg)->flush();
+                 },
+                 this);
+}
+
+IoUringPoller::~IoUringPoller() {
+  // Requests still armed in the kernel are cancelled when the ring is closed.
+  event_del(&flush_event_);
+  event_del(&ring_event_);
+}
+
+uint64_t IoUringPoller::arm(IoUringFileEventImpl& event, int fd, uint32_t events, bool multishot) {
+  const uint64_t token = next_token_++;
+  armed_.emplace(token, Request{&event, false});
+  ring_->pollAdd(fd, toPollMask(events), multishot, token);
+  scheduleFlush();
+  return token;
+}
+
+uint64_t IoUringPoller::armReceive(IoUringFileEventImpl& event, int fd) {
+  ASSERT(receive_supported_);
+  const uint64_t token = next_token_++;
+  armed_.emplace(token, Request{&event, true});
+  ring_->recvAdd(fd, token);
+  scheduleFlush();
+  return token;
+}
+
+void IoUringPoller::cancel(uint64_t token) {
+  ring_->cancel(token);
+  scheduleFlush();
+}
+
+void IoUringPoller::disarm(uint64_t token) {
+  auto it = armed_.find(token);
+  if (it == armed_.end()) {
+    // The request has already posted its last completion.
+    return;
+  }
+  if (it->second.receive_) {
+    ring_->cancel(token);
+  } else {
+    ring_->pollRemove(token);
+  }
+  armed_.erase(it);
+  scheduleFlush();
+}
+
+void IoUringPoller::flush() {
+  flush_scheduled_ = false;
+  ring_->submit();
+}
+
+void IoUringPoller::scheduleFlush() {
+  // The flush runs after the callbacks already active in this pass of the loop, so it picks up
+  // every change they make.
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    event_active(&flush_event_, EV_TIMEOUT, 0);
+  }
+}
+
+void IoUringPoller::onRingReady() {
+  ring_->reap(completions_);
+
+  // Callbacks may arm, disarm or destroy any event, including ones with completions later in this
+  // batch, so each completion is looked up by its token when it is dispatched.
+  for (const IoUring::Completion& completion : completions_) {
+    auto it = armed_.find(completion.user_data_);
+    if (it != armed_.end()) {
+      const Request request = it->second;
+      if (!completion.more_) {
+        armed_.erase(it);
+      }
+      if (request.receive_) {
+        request.event_->onReceiveResult(
+            completion.user_data_, completion.result_,
+            completion.buffer_ >= 0 ? ring_->receiveBuffer(completion.buffer_) : nullptr,
+            completion.more_);
+      } else {
+        request.event_->onPollResult(completion.result_, completion.more_);
+      }
+    }
+
+    // The event has copied the data out by now, or is gone.
+    if (completion.buffer_ >= 0) {
+      ring_->recycleReceiveBuffer(completion.buffer_);
+    }
+  }
+  completions_.clear();
+}
+
+IoUringFileEventImpl::IoUringFileEventImpl(IoUringPoller& poller, event_base& base, int fd,
+                                           FileReadyCb cb, FileTriggerType trigger,
+                                           uint32_t events)
+    : poller_(poller), fd_(fd), cb_(cb), trigger_(trigger) {
+  // The libevent event is only used to run injected events from the loop.
+  event_assign(&raw_event_, &base, -1, 0,
+               [](evutil_socket_t, short, void* arg) -> void {
+                 IoUringFileEventImpl* event = static_cast<IoUringFileEventImpl*>(arg);
+                 const uint32_t injected_events = event->injected_events_;
+                 event->injected_events_ = 0;
+                 LoopStats::ScopedCallback callback_stats(LoopStats::Category::FileEvent);
+                 event->cb_(injected_events);
+               },
+               this);
+  setEnabled(events);
+}
+
+IoUringFileEventImpl::~IoUringFileEventImpl() {
+  if (token_ != 0) {
+    poller_.disarm(token_);
+  }
+  for (uint64_t token : receive_tokens_) {
+    poller_.disarm(token);
+  }
+}
+
+void IoUringFileEventImpl::activate(uint32_t events) {
+  ASSERT(events);
+  injected_events_ |= events;
+  event_active(&raw_event_, EV_TIMEOUT, 0);
+}
+
+void IoUringFileEventImpl::setEnabled(uint32_t events) {
+  if (token_ != 0) {
+    poller_.disarm(token_);
+    token_ = 0;
+  }
+
+  enabled_ = events;
+  if (receiving_) {
+    updateReceive();
+  }
+  armPoll();
+}
+
+bool IoUringFileEventImpl::enableReceive() {
+  if (trigger_ != FileTriggerType::Edge || !poller_.receiveSupported()) {
+    return false;
+  }
+  if (!receiving_) {
+    receiving_ = true;
+    // Reads are now reported by the receive request rather than the poll.
+    setEnabled(enabled_);
+  }
+  return true;
+}
+
+int IoUringFileEventImpl::receive(Buffer::Instance& buffer, uint64_t max_length) {
+  ASSERT(receiving_);
+  if (received_.length() > 0) {
+    const uint64_t length = std::min<uint64_t>(max_length, received_.length());
+    buffer.move(received_, length);
+    return length;
+  }
+  if (received_end_) {
+    return 0;
+  }
+  errno = received_error_ != 0 ? received_error_ : EAGAIN;
+  return -1;
+}
+
+void IoUringFileEventImpl::onPollResult(int32_t result, bool more) {
+  uint32_t events;
+  if (result < 0) {
+    // The descriptor can no longer be polled. Report it as ready so that the owner's next read or
+    // write surfaces the error, and leave it unarmed.
+    ENVOY_LOG_MISC(debug, "io_uring poll on fd {} failed: {}", fd_, -result);
+    token_ = 0;
+    events = FileReadyType::Read | FileReadyType::Write;
+  } else {
+    events = fromPollMask(result);
+    if (!more) {
+      // A one shot poll has fired, or the kernel ended a multishot poll, for example because the
+      // completion ring overflowed. Re-arming reports any readiness that is still pending.
+      armPoll();
+    }
+  }
+
+  // The callback may destroy this event, so it must come last.
+  events &= enabled_;
+  if (events != 0) {
+    LoopStats::ScopedCallback callback_stats(LoopStats::Category::FileEvent);
+    cb_(events);
+  }
+}
+
+void IoUringFileEventImpl::onReceiveResult(uint64_t token, int32_t result, const uint8_t* data,
+                                           bool more) {
+  if (!more) {
+    receive_tokens_.erase(std::find(receive_tokens_.begin(), receive_tokens_.end(), token));
+    if (token == receive_token_) {
+      receive_token_ = 0;
+    }
+  }
+
+  if (result > 0) {
+    received_.add(data, result);
+  } else if (result == 0) {
+    received_end_ = true;
+  } else if (result != -ENOBUFS && result != -ECANCELED) {
+    ENVOY_LOG_MISC(debug, "io_uring receive on fd {} failed: {}", fd_, -result);
+    received_error_ = -result;
+  }
+
+  if (!(enabled_ & FileReadyType::Read)) {
+    // The data of a cancelled request is kept until reads are enabled again.
+    return;
+  }
+  // The kernel may have ended the request, for example because all receive buffers were in use.
+  // They have all been handed back by the time a new request is submitted.
+  armReceive();
+  if (result == -ENOBUFS || result == -ECANCELED) {
+    return;
+  }
+
+  // The callback may destroy this event, so it must come last.
+  LoopStats::ScopedCallback callback_stats(LoopStats::Category::FileEvent);
+  cb_(FileReadyType::Read);
+}
+
+void IoUringFileEventImpl::armPoll() {
+  // While receiving, reads are reported by the receive request.
+  const uint32_t events = receiving_ ? enabled_ & ~FileReadyType::Read : enabled_;
+  token_ = events != 0 ? poller_.arm(*this, fd_, events, trigger_ == FileTriggerType::Edge) : 0;
+}
+
+void IoUringFileEventImpl::armReceive() {
+  if (receive_token_ == 0 && !receiveEnded()) {
+    receive_token_ = poller_.armReceive(*this, fd_);
+    receive_tokens_.push_back(receive_token_);
+  }
+}
+
+void IoUringFileEventImpl::updateReceive() {
+  if (!(enabled_ & FileReadyType::Read)) {
+    if (receive_token_ != 0) {
+      poller_.cancel(receive_token_);
+      receive_token_ = 0;
+    }
+    return;
+  }
+
+  armReceive();
+  if (received_.length() > 0 || receiveEnded()) {
+    // As when epoll starts watching a descriptor with data waiting, it is reported straight away.
+    activate(FileReadyType::Read);
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
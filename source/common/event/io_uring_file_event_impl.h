@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/event/file_event.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+#include "common/event/event_impl_base.h"
+#include "common/event/io_uring.h"
+#include "common/event/libevent.h"
+
+namespace Envoy {
+namespace Event {
+
+class IoUringFileEventImpl;
+class IoUringPoller;
+typedef std::unique_ptr<IoUringPoller> IoUringPollerPtr;
+
+/**
+ * Watches file descriptors with io_uring poll requests on behalf of a dispatcher.
+ *
+ * Arming, re-arming and cancelling polls only queues requests in the submission ring. The queue
+ * is handed to the kernel once per pass of the event loop, so any number of setEnabled() calls
+ * and closed connections cost a single io_uring_enter() instead of an epoll_ctl() each.
+ * Readiness comes back through the completion ring, which is read directly from shared memory
+ * whenever the ring descriptor, itself registered with the libevent base, polls readable.
+ * Timers, signals and injected events stay on libevent.
+ *
+ * Events can also receive on their owner's behalf. A multishot receive request stays armed in the
+ * kernel and fills buffers from a ring shared with it as data arrives, so that data comes back
+ * through the completion ring too, without a read() per socket per pass of the event loop.
+ */
+class IoUringPoller : NonCopyable, Logger::Loggable<Logger::Id::main> {
+public:
+  /**
+   * @param base supplies the libevent base of the owning dispatcher.
+   * @return IoUringPollerPtr the new poller, or nullptr if io_uring is not available.
+   */
+  static IoUringPollerPtr create(event_base& base);
+
+  ~IoUringPoller();
+
+  /**
+   * Queue a poll request for an event.
+   * @param event supplies the event that receives the completions.
+   * @param fd supplies the descriptor to poll.
+   * @param events supplies the FileReadyType events to poll for.
+   * @param multishot supplies whether the request stays armed across completions.
+   * @return uint64_t the token identifying the request in disarm().
+   */
+  uint64_t arm(IoUringFileEventImpl& event, int fd, uint32_t events, bool multishot);
+
+  /**
+   * Queue a multishot receive request for an event.
+   * @param event supplies the event that receives the data.
+   * @param fd supplies the descriptor to receive from.
+   * @return uint64_t the token identifying the request in cancel() and disarm().
+   */
+  uint64_t armReceive(IoUringFileEventImpl& event, int fd);
+
+  /**
+   * @return bool whether events can receive on their owner's behalf.
+   */
+  bool receiveSupported() const { return receive_supported_; }
+
+  /**
+   * Cancel a receive request. Data it received before the cancellation took effect is still
+   * passed to its event, up to the request's last completion.
+   * @param token supplies the token returned by armReceive().
+   */
+  void cancel(uint64_t token);
+
+  /**
+   * Cancel a request, discarding completions already posted for it.
+   * @param token supplies the token returned by arm() or armReceive().
+   */
+  void disarm(uint64_t token);
+
+  /**
+   * Hand all queued requests to the kernel.
+   */
+  void flush();
+
+private:
+  IoUringPoller(event_base& base, IoUringPtr&& ring);
+
+  void scheduleFlush();
+  void onRingReady();
+
+  struct Request {
+    IoUringFileEventImpl* event_;
+    bool receive_;
+  };
+
+  // Number of submission queue entries. Multishot polls stay armed without occupying entries, so
+  // this only bounds the number of changes made in one pass of the event loop before an early
+  // submit.
+  static const uint32_t RingEntries = 1024;
+  // Receive buffers are copied out and handed back as their completions are processed, so they
+  // only need to cover the data that arrives on all sockets between two passes of the event loop.
+  // A receive that finds none left ends, and is re-armed after the pass has handed them all back.
+  static const uint32_t ReceiveBufferCount = 128;
+  static const uint32_t ReceiveBufferSize = 16384;
+
+  IoUringPtr ring_;
+  const bool receive_supported_;
+  event ring_event_;
+  event flush_event_;
+  bool flush_scheduled_{};
+  // Token 0 is used for the completions of cancellations.
+  uint64_t next_token_{1};
+  std::unordered_map<uint64_t, Request> armed_;
+  std::vector<IoUring::Completion> completions_;
+};
+
+/**
+ * Implementation of FileEvent on top of IoUringPoller. Edge triggered events use a multishot
+ * poll, which reports every wakeup of the descriptor as epoll does in edge triggered mode. Level
+ * triggered events use a one shot poll that is re-armed after each completion, so readiness that
+ * has not been consumed is reported again in the next pass of the event loop.
+ *
+ * Once an edge triggered event receives on its owner's behalf, a multishot receive request takes
+ * the place of polling for reads while they are enabled. Received data is queued in the event and
+ * reported as a read event, and receive() hands it over. Disabling reads cancels the request, so
+ * that further data stays in the kernel where it applies back pressure.
+ */
+class IoUringFileEventImpl : public FileEvent, ImplBase {
+public:
+  IoUringFileEventImpl(IoUringPoller& poller, event_base& base, int fd, FileReadyCb cb,
+                       FileTriggerType trigger, uint32_t events);
+  ~IoUringFileEventImpl();
+
+  // Event::FileEvent
+  void activate(uint32_t events) override;
+  void setEnabled(uint32_t events) override;
+  bool enableReceive() override;
+  int receive(Buffer::Instance& buffer, uint64_t max_length) override;
+
+  /**
+   * Called by the poller with the result of the event's poll request.
+   * @param result supplies the POLL* events reported, or a negative errno.
+   * @param more supplies whether the request is still armed.
+   */
+  void onPollResult(int32_t result, bool more);
+
+  /**
+   * Called by the poller with the result of one of the event's receive requests.
+   * @param token supplies the token of the request.
+   * @param result supplies the number of bytes received, 0 at the end of the stream, or a negative
+   *        errno.
+   * @param data supplies the received bytes, which are only valid during the call.
+   * @param more supplies whether the request is still armed.
+   */
+  void onReceiveResult(uint64_t token, int32_t result, const uint8_t* data, bool more);
+
+private:
+  void armPoll();
+  void armReceive();
+  void updateReceive();
+  bool receiveEnded() const { return received_end_ || received_error_ != 0; }
+
+  IoUringPoller& poller_;
+  const int fd_;
+  FileReadyCb cb_;
+  const FileTriggerType trigger_;
+  uint32_t enabled_{};
+  uint64_t token_{};
+  uint32_t injected_events_{};
+  bool receiving_{};
+  // The armed receive request, and every receive request that may still post completions,
+  // including cancelled ones.
+  uint64_t receive_token_{};
+  std::vector<uint64_t> receive_tokens_;
+  Buffer::OwnedImpl received_;
+  bool received_end_{};
+  int received_error_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,105 @@
+#include "common/event/loop_stats.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Envoy {
+namespace Event {
+
+namespace {
+
+thread_local LoopStats* current_loop_stats = nullptr;
+
+uint64_t toMicroseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+LoopStats::LoopStats(Stats::Scope& scope, const std::string& prefix)
+    : stats_{ALL_LOOP_STATS(POOL_HISTOGRAM_PREFIX(scope, prefix))},
+      last_end_(std::chrono::steady_clock::now()) {}
+
+void LoopStats::endIteration() {
+  if (!busy_) {
+    return;
+  }
+
+  const MonotonicTime now = std::chrono::steady_clock::now();
+  const std::chrono::nanoseconds busy = now - first_start_;
+  stats_.duration_us_.recordValue(toMicroseconds(busy));
+  stats_.events_.recordValue(events_);
+  Stats::Histogram* category_stats[Categories] = {&stats_.file_event_us_, &stats_.timer_us_,
+                                                  &stats_.post_us_, &stats_.deferred_delete_us_};
+  for (uint32_t i = 0; i < Categories; i++) {
+    if (category_time_[i].count() > 0) {
+      category_stats[i]->recordValue(toMicroseconds(category_time_[i]));
+      category_time_[i] = std::chrono::nanoseconds(0);
+    }
+  }
+
+  // The utilization of the time since the previous busy pass, idle passes included, is blended in
+  // with a weight that grows with the length of that time, so a single long pass counts as much as
+  // many short ones covering the same time.
+  const std::chrono::duration<double> elapsed = now - last_end_;
+  const double sample = elapsed.count() > 0 ? std::min(1.0, busy / elapsed) : 1.0;
+  const double weight = std::min(1.0, elapsed / std::chrono::duration<double>(UtilizationWindow));
+  smoothed_utilization_ += weight * (sample - smoothed_utilization_);
+  utilization_.store(static_cast<uint32_t>(smoothed_utilization_ * 100 + 0.5),
+                     std::memory_order_relaxed);
+  last_end_ = now;
+
+  busy_ = false;
+  events_ = 0;
+}
+
+constexpr std::chrono::seconds LoopStats::UtilizationWindow;
+
+LoopStats* LoopStats::current() { return current_loop_stats; }
+
+LoopStats::ScopedCurrent::ScopedCurrent(LoopStats& stats) : previous_(current_loop_stats) {
+  current_loop_stats = &stats;
+}
+
+LoopStats::ScopedCurrent::~ScopedCurrent() { current_loop_stats = previous_; }
+
+void LoopStats::addTime(Category category, MonotonicTime start, MonotonicTime end) {
+  category_time_[static_cast<uint32_t>(category)] += end - start;
+}
+
+LoopStats::ScopedCallback::ScopedCallback(Category category)
+    : stats_(current_loop_stats), category_(category) {
+  if (stats_ == nullptr) {
+    return;
+  }
+
+  start_ = std::chrono::steady_clock::now();
+  parent_ = stats_->active_;
+  if (parent_ != nullptr) {
+    // The parent's time stops here and resumes once this callback is done.
+    stats_->addTime(parent_->category_, parent_->start_, start_);
+  } else {
+    if (!stats_->busy_) {
+      stats_->busy_ = true;
+      stats_->first_start_ = start_;
+    }
+    stats_->events_++;
+  }
+  stats_->active_ = this;
+}
+
+LoopStats::ScopedCallback::~ScopedCallback() {
+  if (stats_ == nullptr) {
+    return;
+  }
+
+  const MonotonicTime end = std::chrono::steady_clock::now();
+  stats_->addTime(category_, start_, end);
+  stats_->active_ = parent_;
+  if (parent_ != nullptr) {
+    parent_->start_ = end;
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
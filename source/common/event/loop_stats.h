@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * All event loop stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOOP_STATS(HISTOGRAM)                                                                  \
+  HISTOGRAM(duration_us)                                                                           \
+  HISTOGRAM(events)                                                                                \
+  HISTOGRAM(file_event_us)                                                                         \
+  HISTOGRAM(timer_us)                                                                              \
+  HISTOGRAM(post_us)                                                                               \
+  HISTOGRAM(deferred_delete_us)
+// clang-format on
+
+/**
+ * Struct definition for all event loop stats. @see stats_macros.h
+ */
+struct LoopStatsHistograms {
+  ALL_LOOP_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Measures the passes of a dispatcher's event loop. Callbacks run by the loop are wrapped in
+ * ScopedCallback, which attributes the time spent in them to a category. Once a pass is over, the
+ * owner calls endIteration(), which records how long the pass was busy, from the start of its
+ * first callback until then, how many callbacks ran and how long each category took. Passes that
+ * ran no callbacks are not recorded, so idle time waiting for events doesn't show up.
+ *
+ * The share of time the loop spends in busy passes is also kept as a utilization, smoothed over
+ * about a second, which other threads can read to compare the load of workers.
+ *
+ * Like Buffer::SlicePool, an instance is installed for the thread running the loop with
+ * ScopedCurrent, so that the callback wrappers don't need a reference to their dispatcher. When no
+ * instance is installed, the wrappers do nothing.
+ */
+class LoopStats : NonCopyable {
+public:
+  enum class Category { FileEvent, Timer, Post, DeferredDelete };
+
+  /**
+   * @param scope supplies the scope to create stats in.
+   * @param prefix supplies the stat prefix, including the trailing '.'.
+   */
+  LoopStats(Stats::Scope& scope, const std::string& prefix);
+
+  /**
+   * Record the pass of the loop that just ended, if it ran any callbacks, and start a new one.
+   */
+  void endIteration();
+
+  /**
+   * @return uint32_t the recent utilization of the loop in percent. May be called from any thread.
+   */
+  uint32_t utilization() const { return utilization_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the instance installed on the calling thread, or nullptr.
+   */
+  static LoopStats* current();
+
+  /**
+   * Installs an instance as the calling thread's current one for the lifetime of the object, then
+   * restores the previous one.
+   */
+  class ScopedCurrent : NonCopyable {
+  public:
+    ScopedCurrent(LoopStats& stats);
+    ~ScopedCurrent();
+
+  private:
+    LoopStats* previous_;
+  };
+
+  /**
+   * Attributes the time until it is destroyed to a category. Time spent in a nested ScopedCallback
+   * goes to the nested one's category instead, and only the outermost one counts as an event.
+   */
+  class ScopedCallback : NonCopyable {
+  public:
+    ScopedCallback(Category category);
+    ~ScopedCallback();
+
+  private:
+    LoopStats* const stats_;
+    const Category category_;
+    ScopedCallback* parent_{};
+    MonotonicTime start_;
+  };
+
+private:
+  static constexpr uint32_t Categories = 4;
+  // The time constant of the utilization's exponential smoothing.
+  static constexpr std::chrono::seconds UtilizationWindow{1};
+
+  void addTime(Category category, MonotonicTime start, MonotonicTime end);
+
+  LoopStatsHistograms stats_;
+  ScopedCallback* active_{};
+  bool busy_{};
+  MonotonicTime first_start_;
+  uint64_t events_{};
+  std::chrono::nanoseconds category_time_[Categories]{};
+  MonotonicTime last_end_;
+  double smoothed_utilization_{};
+  std::atomic<uint32_t> utilization_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,142 @@
+#include "common/event/post_queue.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Free nodes owned by the current thread, linked through their next_ pointers. Nodes move freely
+ * between queues, so one cache serves every queue the thread posts to.
+ */
+class PostQueue::NodeCache {
+public:
+  ~NodeCache() {
+    while (head_ != nullptr) {
+      Node* node = head_;
+      head_ = node->next_.load(std::memory_order_relaxed);
+      delete node;
+    }
+  }
+
+  Node* head_{};
+};
+
+thread_local PostQueue::NodeCache PostQueue::node_cache_;
+
+PostQueue::PostQueue() : head_(&stub_), tail_(&stub_) {}
+
+PostQueue::~PostQueue() {
+  // Callbacks that never ran are destroyed along with their nodes.
+  PostCb callback;
+  while (pop(callback)) {
+  }
+
+  Node* node = free_nodes_.exchange(nullptr, std::memory_order_acquire);
+  while (node != nullptr) {
+    Node* next = node->next_.load(std::memory_order_relaxed);
+    delete node;
+    node = next;
+  }
+}
+
+bool PostQueue::push(PostCb&& callback) {
+  Node* node = allocateNode();
+  node->callback_ = std::move(callback);
+  enqueue(node);
+
+  // The exchange orders the enqueue before the flag, so a consumer that re-arms wakeups after
+  // this point sees the node.
+  return !wakeup_pending_.exchange(true, std::memory_order_acq_rel);
+}
+
+void PostQueue::beginDrain() { wakeup_pending_.exchange(false, std::memory_order_acq_rel); }
+
+bool PostQueue::pop(PostCb& callback) {
+  Node* node = dequeue();
+  if (node == nullptr) {
+    releaseNodes();
+    return false;
+  }
+
+  callback = std::move(node->callback_);
+  node->callback_ = nullptr;
+  if (released_head_ == nullptr) {
+    released_tail_ = node;
+  }
+  node->next_.store(released_head_, std::memory_order_relaxed);
+  released_head_ = node;
+  return true;
+}
+
+PostQueue::Node* PostQueue::allocateNode() {
+  NodeCache& cache = node_cache_;
+  if (cache.head_ == nullptr) {
+    // Take over every node the consumer has released. Taking the whole list with one exchange
+    // avoids the ABA problem of popping single nodes from a shared stack.
+    cache.head_ = free_nodes_.exchange(nullptr, std::memory_order_acquire);
+    if (cache.head_ == nullptr) {
+      return new Node();
+    }
+  }
+
+  Node* node = cache.head_;
+  cache.head_ = node->next_.load(std::memory_order_relaxed);
+  node->next_.store(nullptr, std::memory_order_relaxed);
+  return node;
+}
+
+void PostQueue::enqueue(Node* node) {
+  node->next_.store(nullptr, std::memory_order_relaxed);
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  // Until this store, the consumer sees the queue end at prev.
+  prev->next_.store(node, std::memory_order_release);
+}
+
+PostQueue::Node* PostQueue::dequeue() {
+  Node* tail = tail_;
+  Node* next = tail->next_.load(std::memory_order_acquire);
+  if (tail == &stub_) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    tail_ = next;
+    tail = next;
+    next = next->next_.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+
+  // tail is the last linked node. It can only be handed out once another node follows it, so
+  // push the stub behind it unless a producer is midway through enqueueing.
+  if (tail != head_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  enqueue(&stub_);
+  next = tail->next_.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+void PostQueue::releaseNodes() {
+  if (released_head_ == nullptr) {
+    return;
+  }
+
+  Node* free_head = free_nodes_.load(std::memory_order_relaxed);
+  do {
+    released_tail_->next_.store(free_head, std::memory_order_relaxed);
+  } while (!free_nodes_.compare_exchange_weak(free_head, released_head_, std::memory_order_release,
+                                              std::memory_order_relaxed));
+  released_head_ = nullptr;
+  released_tail_ = nullptr;
+}
+
+} // namespace Event
+} // namespace Envoy
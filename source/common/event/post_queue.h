@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Lock-free multi-producer/single-consumer queue of posted callbacks. Any thread may push(); only
+ * the thread that owns the queue may beginDrain() and pop().
+ *
+ * Producers enqueue with a single atomic exchange (an intrusive Vyukov queue), and callbacks
+ * travel in pooled nodes rather than a freshly allocated list node per post. Nodes the consumer is
+ * done with go back to a per-queue free list, which producers take over whole into a per-thread
+ * cache once theirs runs dry, so a steady stream of posts does not allocate.
+ *
+ * push() also coalesces wakeups: it reports that the consumer needs to be woken only for the first
+ * callback pushed after the consumer last called beginDrain().
+ */
+class PostQueue : NonCopyable {
+public:
+  PostQueue();
+  ~PostQueue();
+
+  /**
+   * Enqueue a callback. Thread safe.
+   * @param callback supplies the callback to move into the queue.
+   * @return bool true if the consumer must be woken up to drain the queue, false if a wakeup is
+   *         already pending.
+   */
+  bool push(PostCb&& callback);
+
+  /**
+   * Re-arm wakeups before draining the queue with pop(). Callbacks pushed from here on either show
+   * up in the following pop() calls or make push() request a new wakeup.
+   */
+  void beginDrain();
+
+  /**
+   * Dequeue the oldest callback. Callbacks pushed by one thread come out in the order they were
+   * pushed.
+   * @param callback supplies where to move the callback to.
+   * @return bool false if the queue is empty. A push() that is still in progress may not be
+   *         visible yet, in which case that push() requests a wakeup if needed.
+   */
+  bool pop(PostCb& callback);
+
+private:
+  struct Node {
+    std::atomic<Node*> next_{};
+    PostCb callback_;
+  };
+  class NodeCache;
+
+  Node* allocateNode();
+  void enqueue(Node* node);
+  Node* dequeue();
+  void releaseNodes();
+
+  // Most recently pushed node. Producers exchange themselves in here.
+  std::atomic<Node*> head_;
+  // Oldest node, owned by the consumer.
+  Node* tail_;
+  // Placeholder that keeps the queue non-empty so that producers never touch tail_.
+  Node stub_;
+  std::atomic<bool> wakeup_pending_{};
+
+  // Nodes popped during the current drain, handed to free_nodes_ in one go once the queue is empty.
+  Node* released_head_{};
+  Node* released_tail_{};
+  std::atomic<Node*> free_nodes_{};
+
+  static thread_local NodeCache node_cache_;
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -1,9 +1,11 @@
 #include "common/event/timer_impl.h"
 
 #include <chrono>
+#include <cstdint>
 
 #include "common/common/assert.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/event/loop_stats.h"
 
 #include "event2/event.h"
 
@@ -14,7 +16,11 @@ TimerImpl::TimerImpl(DispatcherImpl& dispatcher, TimerCb cb) : cb_(cb) {
   ASSERT(cb_);
   evtimer_assign(
       &raw_event_, &dispatcher.base(),
-      [](evutil_socket_t, short, void* arg) -> void { static_cast<TimerImpl*>(arg)->cb_(); }, this);
+      [](evutil_socket_t, short, void* arg) -> void {
+        LoopStats::ScopedCallback callback_stats(LoopStats::Category::Timer);
+        static_cast<TimerImpl*>(arg)->cb_();
+      },
+      this);
 }
 
 void TimerImpl::disableTimer() { event_del(&raw_event_); }
@@ -31,5 +37,95 @@ void TimerImpl::enableTimer(const std::chrono::milliseconds& d) {
   }
 }
 
+WheelTimerScheduler::WheelTimerScheduler(DispatcherImpl& dispatcher)
+    : start_(std::chrono::steady_clock::now()), wheel_(0) {
+  evtimer_assign(
+      &raw_event_, &dispatcher.base(),
+      [](evutil_socket_t, short, void* arg) -> void {
+        static_cast<WheelTimerScheduler*>(arg)->onTimer();
+      },
+      this);
+}
+
+void WheelTimerScheduler::schedule(TimerWheel::Entry& entry, const std::chrono::milliseconds& d) {
+  const uint64_t now_us = elapsedUs();
+  const uint64_t expiry = (now_us + d.count() * 1000 + 999) / 1000;
+  wheel_.schedule(entry, expiry);
+  if (!armed_.has_value() || expiry < armed_.value()) {
+    arm(expiry, now_us);
+  }
+}
+
+uint64_t WheelTimerScheduler::elapsedUs() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                               start_)
+      .count();
+}
+
+void WheelTimerScheduler::arm(uint64_t wakeup, uint64_t now_us) {
+  const uint64_t wakeup_us = wakeup * 1000;
+  const uint64_t delay_us = wakeup_us > now_us ? wakeup_us - now_us : 0;
+  timeval tv;
+  tv.tv_sec = delay_us / 1000000;
+  tv.tv_usec = delay_us % 1000000;
+  event_add(&raw_event_, &tv);
+  armed_ = wakeup;
+}
+
+void WheelTimerScheduler::onTimer() {
+  armed_.reset();
+  wheel_.advance(elapsedUs() / 1000);
+
+  // Expiry callbacks may have armed the timer already for a timer they enabled.
+  const absl::optional<uint64_t> next = wheel_.nextWakeup();
+  if (next.has_value() && (!armed_.has_value() || next.value() < armed_.value())) {
+    arm(next.value(), elapsedUs());
+  }
+}
+
+WheelTimerImpl::WheelTimerImpl(WheelTimerScheduler& scheduler, DispatcherImpl& dispatcher,
+                               TimerCb cb)
+    : scheduler_(scheduler), cb_(cb) {
+  ASSERT(cb_);
+  evtimer_assign(
+      &raw_event_, &dispatcher.base(),
+      [](evutil_socket_t, short, void* arg) -> void {
+        WheelTimerImpl* timer = static_cast<WheelTimerImpl*>(arg);
+        timer->activated_ = false;
+        LoopStats::ScopedCallback callback_stats(LoopStats::Category::Timer);
+        timer->cb_();
+      },
+      this);
+}
+
+void WheelTimerImpl::onExpiry() {
+  LoopStats::ScopedCallback callback_stats(LoopStats::Category::Timer);
+  cb_();
+}
+
+void WheelTimerImpl::disableTimer() {
+  scheduler_.cancel(*this);
+  if (activated_) {
+    event_del(&raw_event_);
+    activated_ = false;
+  }
+}
+
+void WheelTimerImpl::enableTimer(const std::chrono::milliseconds& d) {
+  if (d.count() == 0) {
+    scheduler_.cancel(*this);
+    if (!activated_) {
+      event_active(&raw_event_, EV_TIMEOUT, 0);
+      activated_ = true;
+    }
+  } else {
+    if (activated_) {
+      event_del(&raw_event_);
+      activated_ = false;
+    }
+    scheduler_.schedule(*this, d);
+  }
+}
+
 } // namespace Event
 } // namespace Envoy
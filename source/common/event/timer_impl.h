@@ -1,11 +1,16 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
+#include "envoy/common/time.h"
 #include "envoy/event/timer.h"
 
 #include "common/event/dispatcher_impl.h"
 #include "common/event/event_impl_base.h"
+#include "common/event/timer_wheel.h"
+
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Event {
@@ -25,5 +30,58 @@ private:
   TimerCb cb_;
 };
 
+/**
+ * Runs a dispatcher's wheel timers. All pending timeouts live on a TimerWheel with millisecond
+ * ticks, and a single libevent timer is kept armed for the wheel's next wakeup, so libevent's timer
+ * heap stays at one entry however many timers are pending.
+ */
+class WheelTimerScheduler : ImplBase {
+public:
+  WheelTimerScheduler(DispatcherImpl& dispatcher);
+
+  /**
+   * Schedule an entry to expire once the given duration has elapsed. Timeouts are rounded up to
+   * the next millisecond tick, so an entry never expires early.
+   */
+  void schedule(TimerWheel::Entry& entry, const std::chrono::milliseconds& d);
+
+  /**
+   * Cancel a pending entry.
+   */
+  void cancel(TimerWheel::Entry& entry) { wheel_.cancel(entry); }
+
+private:
+  uint64_t elapsedUs() const;
+  void arm(uint64_t wakeup, uint64_t now_us);
+  void onTimer();
+
+  const MonotonicTime start_;
+  TimerWheel wheel_;
+  // Tick the libevent timer is armed for, if it is pending.
+  absl::optional<uint64_t> armed_;
+};
+
+/**
+ * Implementation of Event::Timer on a WheelTimerScheduler. Zero timeouts bypass the wheel and
+ * activate the timer's own libevent event, like TimerImpl, so that they run on the next loop
+ * iteration rather than the next tick.
+ */
+class WheelTimerImpl : public Timer, TimerWheel::Entry, ImplBase {
+public:
+  WheelTimerImpl(WheelTimerScheduler& scheduler, DispatcherImpl& dispatcher, TimerCb cb);
+
+  // Event::Timer
+  void disableTimer() override;
+  void enableTimer(const std::chrono::milliseconds& d) override;
+
+private:
+  // TimerWheel::Entry
+  void onExpiry() override;
+
+  WheelTimerScheduler& scheduler_;
+  TimerCb cb_;
+  bool activated_{};
+};
+
 } // namespace Event
 } // namespace Envoy
@@ -0,0 +1,206 @@
+#include "common/event/timer_wheel.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+TimerWheel::Entry::~Entry() {
+  if (wheel_ != nullptr) {
+    wheel_->cancel(*this);
+  }
+}
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {
+  for (uint32_t level = 0; level < Levels; level++) {
+    for (uint32_t slot = 0; slot < Slots; slot++) {
+      initList(slots_[level][slot]);
+    }
+  }
+  initList(overflow_);
+}
+
+TimerWheel::~TimerWheel() {
+  // Entries may outlive the wheel. Detach them so that they don't reach back into it.
+  auto detach = [](Link& list) {
+    for (Link* link = list.next_; link != &list; link = link->next_) {
+      static_cast<Entry*>(link)->wheel_ = nullptr;
+      static_cast<Entry*>(link)->list_ = nullptr;
+    }
+  };
+  for (uint32_t level = 0; level < Levels; level++) {
+    for (uint32_t slot = 0; slot < Slots; slot++) {
+      detach(slots_[level][slot]);
+    }
+  }
+  detach(overflow_);
+}
+
+void TimerWheel::schedule(Entry& entry, uint64_t expiry) {
+  ASSERT(entry.wheel_ == nullptr || entry.wheel_ == this);
+  if (entry.wheel_ != nullptr) {
+    remove(entry);
+  } else {
+    entry.wheel_ = this;
+    size_++;
+  }
+
+  entry.expiry_ = expiry;
+  place(entry);
+}
+
+void TimerWheel::cancel(Entry& entry) {
+  if (entry.wheel_ == nullptr) {
+    return;
+  }
+
+  ASSERT(entry.wheel_ == this);
+  remove(entry);
+  entry.wheel_ = nullptr;
+  size_--;
+}
+
+void TimerWheel::advance(uint64_t now) {
+  while (true) {
+    const absl::optional<Wakeup> wakeup = findWakeup();
+    if (!wakeup.has_value() || wakeup.value().time_ > now) {
+      break;
+    }
+
+    now_ = std::max(now_, wakeup.value().time_);
+    if (wakeup.value().level_ == Levels) {
+      cascadeList(overflow_);
+    } else if (wakeup.value().level_ == 0) {
+      expireList(slots_[0][wakeup.value().slot_]);
+    } else {
+      cascadeList(slots_[wakeup.value().level_][wakeup.value().slot_]);
+    }
+  }
+
+  now_ = std::max(now_, now);
+}
+
+absl::optional<uint64_t> TimerWheel::nextWakeup() const {
+  const absl::optional<Wakeup> wakeup = findWakeup();
+  if (!wakeup.has_value()) {
+    return absl::nullopt;
+  }
+  return wakeup.value().time_;
+}
+
+absl::optional<TimerWheel::Wakeup> TimerWheel::findWakeup() const {
+  // Occupied slots at a level all lie within the current slot of the level above, so the first
+  // occupied slot at the lowest non-empty level is the earliest wakeup.
+  for (uint32_t level = 0; level < Levels; level++) {
+    const uint32_t shift = level * SlotBits;
+    const uint32_t index = (now_ >> shift) & (Slots - 1);
+    const uint64_t pending = occupied_[level] & (~0ULL << index);
+    if (pending != 0) {
+      const uint32_t slot = __builtin_ctzll(pending);
+      const uint64_t base = (now_ >> (shift + SlotBits)) << (shift + SlotBits);
+      return Wakeup{base | (static_cast<uint64_t>(slot) << shift), level, slot};
+    }
+  }
+
+  if (!listEmpty(overflow_)) {
+    return Wakeup{((now_ >> WheelBits) + 1) << WheelBits, Levels, 0};
+  }
+  return absl::nullopt;
+}
+
+void TimerWheel::place(Entry& entry) {
+  // An entry goes to the level of the highest bit in which its expiry differs from now. Within
+  // that level, its slot is always after the slot now is in.
+  const uint64_t expiry = std::max(entry.expiry_, now_);
+  const uint64_t diff = expiry ^ now_;
+  uint32_t level = 0;
+  while (level < Levels && (diff >> ((level + 1) * SlotBits)) != 0) {
+    level++;
+  }
+
+  Link* list;
+  if (level == Levels) {
+    list = &overflow_;
+  } else {
+    const uint32_t slot = (expiry >> (level * SlotBits)) & (Slots - 1);
+    list = &slots_[level][slot];
+    occupied_[level] |= 1ULL << slot;
+  }
+
+  entry.prev_ = list->prev_;
+  entry.next_ = list;
+  list->prev_->next_ = &entry;
+  list->prev_ = &entry;
+  entry.list_ = list;
+}
+
+void TimerWheel::remove(Entry& entry) {
+  entry.prev_->next_ = entry.next_;
+  entry.next_->prev_ = entry.prev_;
+  entry.prev_ = entry.next_ = nullptr;
+
+  Link* list = entry.list_;
+  entry.list_ = nullptr;
+  if (list != nullptr && list != &overflow_ && listEmpty(*list)) {
+    const size_t index = list - &slots_[0][0];
+    occupied_[index / Slots] &= ~(1ULL << (index % Slots));
+  }
+}
+
+void TimerWheel::spliceList(Link& from, Link& to) {
+  ASSERT(listEmpty(to));
+  if (listEmpty(from)) {
+    return;
+  }
+
+  to.next_ = from.next_;
+  to.prev_ = from.prev_;
+  to.next_->prev_ = &to;
+  to.prev_->next_ = &to;
+  initList(from);
+}
+
+void TimerWheel::expireList(Link& list) {
+  Link expiring;
+  initList(expiring);
+  spliceList(list, expiring);
+  const size_t index = &list - &slots_[0][0];
+  occupied_[index / Slots] &= ~(1ULL << (index % Slots));
+
+  // Expiry callbacks may cancel or reschedule entries that are still waiting on this list.
+  // Clearing list_ keeps remove() from treating the local list as a wheel slot.
+  for (Link* link = expiring.next_; link != &expiring; link = link->next_) {
+    static_cast<Entry*>(link)->list_ = nullptr;
+  }
+
+  while (!listEmpty(expiring)) {
+    Entry& entry = *static_cast<Entry*>(expiring.next_);
+    remove(entry);
+    entry.wheel_ = nullptr;
+    size_--;
+    entry.onExpiry();
+  }
+}
+
+void TimerWheel::cascadeList(Link& list) {
+  Link cascading;
+  initList(cascading);
+  spliceList(list, cascading);
+  if (&list != &overflow_) {
+    const size_t index = &list - &slots_[0][0];
+    occupied_[index / Slots] &= ~(1ULL << (index % Slots));
+  }
+
+  while (!listEmpty(cascading)) {
+    Entry& entry = *static_cast<Entry*>(cascading.next_);
+    entry.prev_->next_ = entry.next_;
+    entry.next_->prev_ = entry.prev_;
+    place(entry);
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
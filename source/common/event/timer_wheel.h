@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "envoy/common/pure.h"
+
+#include "common/common/non_copyable.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Hierarchical timing wheel. Scheduling and cancelling an entry is O(1) regardless of how many
+ * entries are pending, at the cost of tick (millisecond) resolution. Times are plain tick counts
+ * supplied by the owner; the wheel never reads a clock itself.
+ *
+ * Level L of the wheel has 64 slots of 64^L ticks each. An entry lives at the lowest level whose
+ * slot range still covers its expiry given the current time, and moves down one or more levels
+ * when time reaches the start of its slot ("cascading"). Each entry therefore moves at most once
+ * per level over its lifetime. Expiries more than 64^6 ticks (~2.2 years of milliseconds) away are
+ * parked on an overflow list.
+ */
+class TimerWheel : NonCopyable {
+  struct Link {
+    Link* prev_{};
+    Link* next_{};
+  };
+
+public:
+  /**
+   * An item that can be scheduled on the wheel. Entries are intrusively linked, so the wheel
+   * never allocates.
+   */
+  class Entry : Link {
+  public:
+    virtual ~Entry();
+
+    /**
+     * @return bool whether the entry is scheduled on a wheel.
+     */
+    bool scheduled() const { return wheel_ != nullptr; }
+
+    /**
+     * @return uint64_t the tick the entry expires at. Only meaningful while scheduled.
+     */
+    uint64_t expiry() const { return expiry_; }
+
+  protected:
+    /**
+     * Called from TimerWheel::advance() when the entry expires. The entry is no longer scheduled
+     * at that point and may be rescheduled or destroyed from within the call.
+     */
+    virtual void onExpiry() PURE;
+
+  private:
+    friend class TimerWheel;
+
+    TimerWheel* wheel_{};
+    // Slot list the entry is linked into, or nullptr while it is on the list being expired.
+    Link* list_{};
+    uint64_t expiry_{};
+  };
+
+  /**
+   * @param now supplies the current tick.
+   */
+  explicit TimerWheel(uint64_t now);
+  ~TimerWheel();
+
+  /**
+   * Schedule an entry, replacing any pending expiry it has. Entries scheduled at or before now()
+   * expire during the next advance().
+   * @param entry supplies the entry. It must not be scheduled on another wheel.
+   * @param expiry supplies the tick to expire the entry at.
+   */
+  void schedule(Entry& entry, uint64_t expiry);
+
+  /**
+   * Remove an entry from the wheel. Does nothing if the entry is not scheduled.
+   */
+  void cancel(Entry& entry);
+
+  /**
+   * Move the wheel forward, expiring every entry whose expiry is at or before the given tick in
+   * expiry order. Entries expiring on the same tick expire in the order they were scheduled.
+   * @param now supplies the current tick. Moving backwards is a no-op.
+   */
+  void advance(uint64_t now);
+
+  /**
+   * @return absl::optional<uint64_t> the earliest tick at which advance() has work to do, either
+   *         expiring an entry or cascading entries to a lower level, or absl::nullopt if the wheel
+   *         is empty. Owners that sleep until this tick never oversleep an expiry.
+   */
+  absl::optional<uint64_t> nextWakeup() const;
+
+  /**
+   * @return uint64_t the tick the wheel was last advanced to.
+   */
+  uint64_t now() const { return now_; }
+
+  /**
+   * @return size_t the number of scheduled entries.
+   */
+  size_t size() const { return size_; }
+
+private:
+  static constexpr uint32_t SlotBits = 6;
+  static constexpr uint32_t Slots = 1 << SlotBits;
+  static constexpr uint32_t Levels = 6;
+  static constexpr uint32_t WheelBits = SlotBits * Levels;
+
+  struct Wakeup {
+    uint64_t time_;
+    // Level of the slot to process, or Levels for the overflow list.
+    uint32_t level_;
+    uint32_t slot_;
+  };
+
+  static void initList(Link& head) { head.prev_ = head.next_ = &head; }
+  static bool listEmpty(const Link& head) { return head.next_ == &head; }
+  static void spliceList(Link& from, Link& to);
+
+  absl::optional<Wakeup> findWakeup() const;
+  void place(Entry& entry);
+  void remove(Entry& entry);
+  void expireList(Link& list);
+  void cascadeList(Link& list);
+
+  uint64_t now_;
+  size_t size_{};
+  Link slots_[Levels][Slots];
+  // Bit N of occupied_[L] is set while slots_[L][N] is not empty.
+  uint64_t occupied_[Levels]{};
+  Link overflow_;
+};
+
+} // namespace Event
+} // namespace Envoy
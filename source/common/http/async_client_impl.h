@@ -120,6 +120,8 @@ private:
     }
     uint32_t numRetries() const override { return 0; }
     uint32_t retryOn() const override { return 0; }
+    std::chrono::milliseconds hedgeDelay() const override { return std::chrono::milliseconds(0); }
+    double hedgeLatencyPercentile() const override { return 0; }
   };
 
   struct NullShadowPolicy : public Router::ShadowPolicy {
@@ -184,6 +186,9 @@ private:
     const Router::RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
     const Router::RetryPolicy& retryPolicy() const override { return retry_policy_; }
     const Router::ShadowPolicy& shadowPolicy() const override { return shadow_policy_; }
+    const Router::RequestCoalescingPolicy* requestCoalescingPolicy() const override {
+      return nullptr;
+    }
     std::chrono::milliseconds timeout() const override {
       if (timeout_) {
         return timeout_.value();
@@ -106,6 +106,12 @@ public:
 
   bool remoteClosed() const { return remote_closed_; }
 
+  /**
+   * Stop closing the connection once it has had no active requests for the cluster's idle timeout,
+   * for owners that close idle connections themselves.
+   */
+  void disableIdleTimeout() { idle_timer_.reset(); }
+
 protected:
   /**
    * Create a codec client and connect to a remote host/port.
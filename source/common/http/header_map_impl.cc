@@ -1,11 +1,14 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <list>
 #include <string>
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/singleton/const_singleton.h"
 
@@ -14,6 +17,16 @@
 namespace Envoy {
 namespace Http {
 
+namespace {
+
+template <class T> T load(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+} // namespace
+
 HeaderString::HeaderString() : type_(Type::Inline) {
   buffer_.dynamic_ = inline_buffer_;
   clear();
@@ -67,13 +80,16 @@ void HeaderString::freeDynamic() {
 void HeaderString::append(const char* data, uint32_t size) {
   switch (type_) {
   case Type::Reference: {
-    // Switch back to inline and fall through. We do not actually append to the static string
-    // currently which would require a copy.
+    // Copy the referenced string into inline or dynamic storage and append to the copy. The
+    // referenced data is never written to.
+    const char* ref_value = buffer_.ref_;
+    const uint32_t ref_size = string_length_;
     type_ = Type::Inline;
     buffer_.dynamic_ = inline_buffer_;
     string_length_ = 0;
-
-    FALLTHRU;
+    append(ref_value, ref_size);
+    append(data, size);
+    return;
   }
 
   case Type::Inline: {
@@ -186,10 +202,15 @@ void HeaderString::setInteger(uint64_t value) {
 }
 
 void HeaderString::setReference(const std::string& ref_value) {
+  setReference(ref_value.c_str(), ref_value.size());
+}
+
+void HeaderString::setReference(const char* ref_value, uint32_t size) {
+  ASSERT(ref_value[size] == 0);
   freeDynamic();
   type_ = Type::Reference;
-  buffer_.ref_ = ref_value.c_str();
-  string_length_ = ref_value.size();
+  buffer_.ref_ = ref_value;
+  string_length_ = size;
 }
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
@@ -215,7 +236,7 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
 }
 
 #define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {            \
+  add(Headers::get().name.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {                    \
     return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
   });
 
@@ -223,38 +244,69 @@ HeaderMapImpl::StaticLookupTable::StaticLookupTable() {
   ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
 
   // Special case where we map a legacy host header to :authority.
-  add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
+  add(Headers::get().HostLegacy.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {
     return {&h.inline_headers_.Host_, &Headers::get().Host};
   });
+
+  // Slots hold entry indexes in a byte, and the table is kept at most a sixth full so that a seed
+  // is found within a few hundred attempts.
+  RELEASE_ASSERT(entries_.size() * 6 <= slots_.size());
+  uint64_t seed = 0x9e3779b97f4a7c15;
+  for (uint32_t attempt = 0; !trySeed(seed); attempt++) {
+    RELEASE_ASSERT(attempt < 100000);
+    // Step through odd multipliers.
+    seed += 0x9e3779b97f4a7c16;
+  }
 }
 
-void HeaderMapImpl::StaticLookupTable::add(const char* key, StaticLookupEntry::EntryCb cb) {
-  StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    if (!current->entries_[c]) {
-      current->entries_[c].reset(new StaticLookupEntry());
+void HeaderMapImpl::StaticLookupTable::add(const std::string& key, StaticLookupEntry::EntryCb cb) {
+  entries_.push_back({key, cb});
+}
+
+bool HeaderMapImpl::StaticLookupTable::trySeed(uint64_t seed) {
+  slots_.fill(0);
+  for (size_t i = 0; i < entries_.size(); i++) {
+    uint8_t& index = slots_[slot(entries_[i].key_, seed)];
+    if (index != 0) {
+      return false;
     }
+    index = i + 1;
+  }
 
-    current = current->entries_[c].get();
-    key++;
+  seed_ = seed;
+  return true;
+}
+
+size_t HeaderMapImpl::StaticLookupTable::slot(absl::string_view key, uint64_t seed) {
+  // The key is read with fixed size loads, the last of which may overlap the ones before it.
+  const char* data = key.data();
+  const size_t size = key.size();
+  uint64_t hash = size;
+  if (size >= sizeof(uint64_t)) {
+    for (size_t i = 0; i + sizeof(uint64_t) < size; i += sizeof(uint64_t)) {
+      hash = (hash ^ load<uint64_t>(data + i)) * seed;
+    }
+    hash ^= load<uint64_t>(data + size - sizeof(uint64_t));
+  } else if (size >= sizeof(uint32_t)) {
+    hash ^= load<uint32_t>(data) ^
+            static_cast<uint64_t>(load<uint32_t>(data + size - sizeof(uint32_t))) << 32;
+  } else if (size > 0) {
+    hash ^= static_cast<uint8_t>(data[0]) ^ static_cast<uint8_t>(data[size / 2]) << 8 ^
+            static_cast<uint8_t>(data[size - 1]) << 16;
   }
 
-  current->cb_ = cb;
+  hash *= seed;
+  return (hash ^ (hash >> 32)) * seed >> (64 - SlotBits);
 }
 
 HeaderMapImpl::StaticLookupEntry::EntryCb
-HeaderMapImpl::StaticLookupTable::find(const char* key) const {
-  const StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    current = current->entries_[c].get();
-    if (current) {
-      key++;
-    } else {
-      return nullptr;
-    }
+HeaderMapImpl::StaticLookupTable::find(absl::string_view key) const {
+  const uint8_t index = slots_[slot(key, seed_)];
+  if (index == 0 || entries_[index - 1].key_ != key) {
+    return nullptr;
   }
 
-  return current->cb_;
+  return entries_[index - 1].cb_;
 }
 
 HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
@@ -302,7 +354,8 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  StaticLookupEntry::EntryCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.getStringView());
   if (cb) {
     // TODO(mattklein123): Currently, for all of the inline headers, we don't support appending. The
     // only inline header where we should be converting multiple headers into a comma delimited
@@ -313,9 +366,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_, std::move(value));
   } else {
-    std::list<HeaderEntryImpl>::iterator i =
-        headers_.emplace(headers_.end(), std::move(key), std::move(value));
-    i->entry_ = i;
+    appendEntry(headers_.emplace(headers_.end(), std::move(key), std::move(value)));
   }
 }
 
@@ -323,6 +374,19 @@ void HeaderMapImpl::addViaMove(HeaderString&& key, HeaderString&& value) {
   insertByKey(std::move(key), std::move(value));
 }
 
+void HeaderMapImpl::moveReferences(const char* begin, const char* end, const char* to) {
+  const auto move_if_in_range = [begin, end, to](HeaderString& string) {
+    if (string.type() == HeaderString::Type::Reference && string.c_str() >= begin &&
+        string.c_str() < end) {
+      string.setReference(to + (string.c_str() - begin), string.size());
+    }
+  };
+  for (HeaderEntryImpl& header : headers_) {
+    move_if_in_range(header.key_);
+    move_if_in_range(header.value_);
+  }
+}
+
 void HeaderMapImpl::addReference(const LowerCaseString& key, const std::string& value) {
   HeaderString ref_key(key);
   HeaderString ref_value(value);
@@ -391,20 +455,20 @@ uint64_t HeaderMapImpl::byteSize() const {
   return byte_size;
 }
 
-const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
-    }
-  }
+const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const { return find(key); }
 
-  return nullptr;
-}
+HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) { return find(key); }
 
-HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
-  for (HeaderEntryImpl& header : headers_) {
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::find(const LowerCaseString& key) const {
+  if (maybeBuildIndex()) {
+    return index_.find(key.get(), HeaderIndex::hash(key.get()));
+  }
+
+  for (const HeaderEntryImpl& header : headers_) {
     if (header.key() == key.get().c_str()) {
-      return &header;
+      // The list holds the entries by value, so this only sheds the constness that the iterator
+      // added.
+      return const_cast<HeaderEntryImpl*>(&header);
     }
   }
 
@@ -429,7 +493,7 @@ void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
 
 HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
                                         const HeaderEntry** entry) const {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     // The accessor callbacks for predefined inline headers take a HeaderMapImpl& as an argument;
     // even though we don't make any modifications, we need to cast_cast in order to use the
@@ -451,11 +515,19 @@ HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
+    if (maybeBuildIndex()) {
+      const uint64_t hash = HeaderIndex::hash(key.get());
+      if (index_.find(key.get(), hash) == nullptr) {
+        // Nothing to remove, so there is no need to scan the list.
+        return;
+      }
+      index_.erase(key.get(), hash);
+    }
     for (auto i = headers_.begin(); i != headers_.end();) {
       if (i->key() == key.get().c_str()) {
         i = headers_.erase(i);
@@ -470,10 +542,14 @@ void HeaderMapImpl::removePrefix(const LowerCaseString& prefix) {
   headers_.remove_if([&](const HeaderEntryImpl& entry) {
     bool to_remove = absl::StartsWith(entry.key().getStringView(), prefix.get());
     if (to_remove) {
+      // Every entry with this key has the prefix as well, so none of them is left to index.
+      if (indexed_) {
+        index_.erase(entry.key().getStringView(), HeaderIndex::hash(entry.key().getStringView()));
+      }
       // If this header should be removed, make sure any references in the
       // static lookup table are cleared as well.
       StaticLookupEntry::EntryCb cb =
-          ConstSingleton<StaticLookupTable>::get().find(entry.key().c_str());
+          ConstSingleton<StaticLookupTable>::get().find(entry.key().getStringView());
       if (cb) {
         StaticLookupResponse ref_lookup_response = cb(*this);
         if (ref_lookup_response.entry_) {
@@ -491,9 +567,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &appendEntry(headers_.emplace(headers_.end(), key));
   return **entry;
 }
 
@@ -505,9 +579,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &appendEntry(headers_.emplace(headers_.end(), key, std::move(value)));
   return **entry;
 }
 
@@ -518,8 +590,109 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
+  // Inline headers are never added twice, so this was the only entry with its key.
+  if (indexed_) {
+    index_.erase(entry->key().getStringView(), HeaderIndex::hash(entry->key().getStringView()));
+  }
   headers_.erase(entry->entry_);
 }
 
+HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::appendEntry(std::list<HeaderEntryImpl>::iterator i) {
+  i->entry_ = i;
+  if (indexed_) {
+    index_.insert(*i, HeaderIndex::hash(i->key().getStringView()));
+  }
+  return *i;
+}
+
+bool HeaderMapImpl::maybeBuildIndex() const {
+  if (!indexed_ && headers_.size() >= MinIndexedHeaders) {
+    for (const HeaderEntryImpl& header : headers_) {
+      index_.insert(const_cast<HeaderEntryImpl&>(header),
+                    HeaderIndex::hash(header.key().getStringView()));
+    }
+    indexed_ = true;
+  }
+
+  return indexed_;
+}
+
+uint64_t HeaderMapImpl::HeaderIndex::hash(absl::string_view key) { return HashUtil::xxHash64(key); }
+
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::HeaderIndex::find(absl::string_view key,
+                                                                 uint64_t hash) const {
+  if (slots_.empty()) {
+    return nullptr;
+  }
+
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask; slots_[i].entry_ != nullptr; i = (i + 1) & mask) {
+    if (slots_[i].hash_ == hash && slots_[i].entry_->key().getStringView() == key) {
+      return slots_[i].entry_;
+    }
+  }
+
+  return nullptr;
+}
+
+void HeaderMapImpl::HeaderIndex::insert(HeaderEntryImpl& entry, uint64_t hash) {
+  if ((size_ + 1) * 4 > slots_.size() * 3) {
+    grow();
+  }
+
+  const size_t mask = slots_.size() - 1;
+  size_t i = hash & mask;
+  for (; slots_[i].entry_ != nullptr; i = (i + 1) & mask) {
+    if (slots_[i].hash_ == hash &&
+        slots_[i].entry_->key().getStringView() == entry.key().getStringView()) {
+      return;
+    }
+  }
+
+  slots_[i] = {&entry, hash};
+  size_++;
+}
+
+void HeaderMapImpl::HeaderIndex::erase(absl::string_view key, uint64_t hash) {
+  if (slots_.empty()) {
+    return;
+  }
+
+  const size_t mask = slots_.size() - 1;
+  size_t i = hash & mask;
+  for (;; i = (i + 1) & mask) {
+    if (slots_[i].entry_ == nullptr) {
+      return;
+    }
+    if (slots_[i].hash_ == hash && slots_[i].entry_->key().getStringView() == key) {
+      break;
+    }
+  }
+
+  // Shift back the slots that follow in the same probe run, so that lookups need no tombstones.
+  size_--;
+  for (size_t j = (i + 1) & mask; slots_[j].entry_ != nullptr; j = (j + 1) & mask) {
+    // A slot can fill the hole at i unless its home slot lies cyclically in (i, j].
+    const size_t home = slots_[j].hash_ & mask;
+    const bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (!stays) {
+      slots_[i] = slots_[j];
+      i = j;
+    }
+  }
+  slots_[i].entry_ = nullptr;
+}
+
+void HeaderMapImpl::HeaderIndex::grow() {
+  std::vector<Slot> old_slots(std::max<size_t>(16, slots_.size() * 2), Slot{nullptr, 0});
+  old_slots.swap(slots_);
+  size_ = 0;
+  for (const Slot& slot : old_slots) {
+    if (slot.entry_ != nullptr) {
+      insert(*slot.entry_, slot.hash_);
+    }
+  }
+}
+
 } // namespace Http
 } // namespace Envoy
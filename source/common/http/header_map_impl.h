@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
@@ -33,7 +34,8 @@ public:
  * headers are added to the map, we do a hash lookup to see if it's one of the O(1) headers.
  * If it is, we store a reference to it that can be accessed later directly. Most high performance
  * paths use O(1) direct access. In general, we try to copy as little as possible and allocate as
- * little as possible in any of the paths.
+ * little as possible in any of the paths. Once a map holds MinIndexedHeaders headers, the next
+ * lookup by key builds a hash index over all of them so that custom headers are found in O(1) too.
  */
 class HeaderMapImpl : public HeaderMap {
 public:
@@ -47,6 +49,24 @@ public:
    */
   void addViaMove(HeaderString&& key, HeaderString&& value);
 
+  /**
+   * Keep storage alive for as long as the map, so that its headers can reference memory the
+   * storage owns via HeaderString::setReference(). Codecs use this to keep headers in their read
+   * buffers rather than copy them.
+   */
+  void retain(std::shared_ptr<const void> storage) { retained_.emplace_back(std::move(storage)); }
+
+  /**
+   * Point the header names and values that reference memory in [begin, end) at the same offsets
+   * from to instead. The caller copies the memory, and retains the storage of the copy.
+   */
+  void moveReferences(const char* begin, const char* end, const char* to);
+
+  /**
+   * Release all storage passed to retain(). No header may reference it any more.
+   */
+  void releaseRetained() { retained_.clear(); }
+
   /**
    * For testing. Equality is based on equality of the backing list. This is an exact match
    * comparison (order matters).
@@ -71,6 +91,9 @@ public:
   void removePrefix(const LowerCaseString& key) override;
   size_t size() const override { return headers_.size(); }
 
+  // Smallest map for which get() and remove() build a hash index rather than scan the headers.
+  static const size_t MinIndexedHeaders = 16;
+
 protected:
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
     HeaderEntryImpl(const LowerCaseString& key);
@@ -99,34 +122,85 @@ protected:
   struct StaticLookupEntry {
     typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
 
-    EntryCb cb_{};
-    std::array<std::unique_ptr<StaticLookupEntry>, 256> entries_;
+    absl::string_view key_;
+    EntryCb cb_;
   };
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. It is a perfect hash table: the hash seed is picked when the table is built so that
+   * no two of the header names share a slot. A lookup is a single probe and one comparison.
    */
   struct StaticLookupTable {
     StaticLookupTable();
-    void add(const char* key, StaticLookupEntry::EntryCb cb);
-    StaticLookupEntry::EntryCb find(const char* key) const;
-
-    StaticLookupEntry root_;
+    void add(const std::string& key, StaticLookupEntry::EntryCb cb);
+    StaticLookupEntry::EntryCb find(absl::string_view key) const;
+
+    /**
+     * Hashes the key eight bytes at a time, with the seed as the multiplier.
+     */
+    static size_t slot(absl::string_view key, uint64_t seed);
+    bool trySeed(uint64_t seed);
+
+    static const size_t SlotBits = 9;
+    std::vector<StaticLookupEntry> entries_;
+    // Index of each slot's entry plus one, or zero for an empty slot.
+    std::array<uint8_t, 1 << SlotBits> slots_;
+    uint64_t seed_{};
   };
 
   struct AllInlineHeaders {
     ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
   };
 
+  /**
+   * Open addressed hash table, with linear probing, from a header key to the first entry in
+   * headers_ with that key. Entries are always appended to headers_, so an entry that is indexed
+   * stays the first one with its key until all entries with that key are removed.
+   */
+  class HeaderIndex {
+  public:
+    static uint64_t hash(absl::string_view key);
+
+    HeaderEntryImpl* find(absl::string_view key, uint64_t hash) const;
+    /**
+     * Index an entry that was just appended to headers_, unless an earlier one has the same key.
+     */
+    void insert(HeaderEntryImpl& entry, uint64_t hash);
+    /**
+     * Remove a key once no entry with it is left in headers_.
+     */
+    void erase(absl::string_view key, uint64_t hash);
+
+  private:
+    struct Slot {
+      HeaderEntryImpl* entry_;
+      uint64_t hash_;
+    };
+
+    void grow();
+
+    // Power of two sized, and at most 3/4 full.
+    std::vector<Slot> slots_;
+    size_t size_{};
+  };
+
   void insertByKey(HeaderString&& key, HeaderString&& value);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key,
                                      HeaderString&& value);
   void removeInline(HeaderEntryImpl** entry);
+  HeaderEntryImpl& appendEntry(std::list<HeaderEntryImpl>::iterator i);
+  HeaderEntryImpl* find(const LowerCaseString& key) const;
+  bool maybeBuildIndex() const;
 
+  // Declared before the headers so that it outlives any that reference it.
+  std::vector<std::shared_ptr<const void>> retained_;
   AllInlineHeaders inline_headers_;
   std::list<HeaderEntryImpl> headers_;
+  // Built lazily by maybeBuildIndex(), and kept up to date from then on.
+  mutable HeaderIndex index_;
+  mutable bool indexed_{};
 
   ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
 };
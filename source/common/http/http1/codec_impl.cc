@@ -1,6 +1,8 @@
 #include "common/http/http1/codec_impl.h"
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
@@ -12,6 +14,8 @@
 #include "common/common/utility.h"
 #include "common/http/exception.h"
 #include "common/http/headers.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/scanning_parser_impl.h"
 #include "common/http/utility.h"
 
 namespace Envoy {
@@ -241,59 +245,40 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
   StreamEncoderImpl::encodeHeaders(headers, end_stream);
 }
 
-http_parser_settings ConnectionImpl::settings_{
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageBeginBase();
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onUrl(at, length);
-      return 0;
-    },
-    nullptr, // on_status
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderField(at, length);
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderValue(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      return static_cast<ConnectionImpl*>(parser->data)->onHeadersCompleteBase();
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onBody(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageComplete();
-      return 0;
-    },
-    nullptr, // on_chunk_header
-    nullptr  // on_chunk_complete
-};
-
 const ToLowerTable& ConnectionImpl::toLowerTable() {
   static ToLowerTable* table = new ToLowerTable();
   return *table;
 }
 
-ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type)
+ConnectionImpl::ConnectionImpl(Network::Connection& connection, MessageType type,
+                               bool scanning_parser)
     : connection_(connection), output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
                                               [&]() -> void { this->onAboveHighWatermark(); }) {
   output_buffer_.setWatermarks(connection.bufferLimit());
-  http_parser_init(&parser_, type);
-  parser_.data = this;
+  if (scanning_parser) {
+    parser_.reset(new ScanningParserImpl(type, *this));
+  } else {
+    parser_.reset(new LegacyParserImpl(type, *this));
+  }
 }
 
 void ConnectionImpl::completeLastHeader() {
   ENVOY_CONN_LOG(trace, "completed header: key={} value={}", connection_,
                  current_header_field_.c_str(), current_header_value_.c_str());
   if (!current_header_field_.empty()) {
-    toLowerTable().toLowerCase(current_header_field_.buffer(), current_header_field_.size());
+    if (current_header_field_.type() != HeaderString::Type::Reference) {
+      // A referenced field was lower cased in place.
+      toLowerTable().toLowerCase(current_header_field_.buffer(), current_header_field_.size());
+    }
     current_header_map_->addViaMove(std::move(current_header_field_),
                                     std::move(current_header_value_));
+    // A moved or cleared reference still points at the read buffer.
+    if (current_header_field_.type() == HeaderString::Type::Reference) {
+      current_header_field_.setCopy("", 0);
+    }
+    if (current_header_value_.type() == HeaderString::Type::Reference) {
+      current_header_value_.setCopy("", 0);
+    }
   }
 
   header_parsing_state_ = HeaderParsingState::Field;
@@ -305,30 +290,94 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "parsing {} bytes", connection_, data.length());
 
   // Always unpause before dispatch.
-  http_parser_pause(&parser_, 0);
+  parser_->resume();
 
+  Buffer::OwnedImpl* referenceable_buffer = referenceableBuffer(data);
   ssize_t total_parsed = 0;
-  if (data.length() > 0) {
-    uint64_t num_slices = data.getRawSlices(nullptr, 0);
-    Buffer::RawSlice slices[num_slices];
-    data.getRawSlices(slices, num_slices);
-    for (Buffer::RawSlice& slice : slices) {
-      total_parsed += dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+  try {
+    if (data.length() > 0) {
+      uint64_t num_slices = data.getRawSlices(nullptr, 0);
+      Buffer::RawSlice slices[num_slices];
+      data.getRawSlices(slices, num_slices);
+      for (uint64_t i = 0; i < num_slices; i++) {
+        Buffer::RawSlice& slice = slices[i];
+        // Headers are written to in place, so only memory that the buffer owns alone qualifies.
+        slice_size_ = referenceable_buffer != nullptr ? referenceable_buffer->ownedSliceSize(i) : 0;
+        if (slice_size_ > 0) {
+          slice_begin_ = static_cast<char*>(slice.mem_);
+          slice_end_ = slice_begin_ + slice.len_;
+          slice_offset_ = total_parsed;
+        } else {
+          slice_begin_ = slice_end_ = nullptr;
+        }
+        total_parsed += dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+      }
+    } else {
+      dispatchSlice(nullptr, 0);
     }
-  } else {
-    dispatchSlice(nullptr, 0);
+  } catch (...) {
+    // Streams that already have their headers may outlive the read buffer.
+    pinReferencedSlices(referenceable_buffer);
+    throw;
   }
 
   ENVOY_CONN_LOG(trace, "parsed {} bytes", connection_, total_parsed);
-  data.drain(total_parsed);
+  data.drain(total_parsed - pinReferencedSlices(referenceable_buffer));
+}
+
+uint64_t ConnectionImpl::pinReferencedSlices(Buffer::OwnedImpl* buffer) {
+  slice_begin_ = slice_end_ = nullptr;
+  const uint64_t pinned_length = pinned_length_;
+  if (pinned_length > 0) {
+    // The slices that hold referenced headers move to the header maps rather than being released.
+    buffer->drainRetained(pinned_length, *pinned_slices_);
+    pinned_length_ = 0;
+  }
+  // A head that is still incomplete gets a new vector for the slices of the next dispatch.
+  pinned_slices_.reset();
+  message_pinned_length_ = 0;
+  return pinned_length;
+}
+
+Buffer::OwnedImpl* ConnectionImpl::referenceableBuffer(Buffer::Instance& data) {
+  if (!parser_->terminatesInPlace()) {
+    return nullptr;
+  }
+  Buffer::OwnedImpl* owned_buffer = dynamic_cast<Buffer::OwnedImpl*>(&data);
+  // Only the slice based buffer can retain its slices.
+  return owned_buffer != nullptr && !owned_buffer->usesOldImpl() ? owned_buffer : nullptr;
+}
+
+bool ConnectionImpl::referenceable(const char* data, size_t length) const {
+  // The byte after the field or value must be in the slice too, as it becomes the terminator.
+  return length > 0 && slice_begin_ != nullptr && data >= slice_begin_ &&
+         data + length < slice_end_;
+}
+
+void ConnectionImpl::setReference(HeaderString& string, const char* data, size_t length) {
+  char* reference = slice_begin_ + (data - slice_begin_);
+  reference[length] = 0;
+  string.setReference(reference, length);
+  referenced_bytes_ += length;
+  if (referenced_ranges_.empty() || referenced_ranges_.back().first < slice_begin_ ||
+      referenced_ranges_.back().first >= slice_end_) {
+    referenced_ranges_.emplace_back(reference, reference);
+    referenced_slice_bytes_ += slice_size_;
+  }
+  referenced_ranges_.back().second = reference + length + 1;
+  if (!pinned_slices_) {
+    pinned_slices_ = std::make_shared<std::vector<Buffer::SliceSharedPtr>>();
+    current_header_map_->retain(pinned_slices_);
+  }
+  pinned_length_ = slice_offset_ + (reference + length + 1 - slice_begin_);
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
-  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
+  ssize_t rc = parser_->execute(slice, len);
+  if (parser_->status() == ParserStatus::Error) {
     sendProtocolError();
     throw CodecProtocolException("http/1.1 protocol error: " +
-                                 std::string(http_errno_name(HTTP_PARSER_ERRNO(&parser_))));
+                                 std::string(parser_->errorName()));
   }
 
   return rc;
@@ -344,7 +393,12 @@ void ConnectionImpl::onHeaderField(const char* data, size_t length) {
     completeLastHeader();
   }
 
-  current_header_field_.append(data, length);
+  if (current_header_field_.empty() && referenceable(data, length)) {
+    toLowerTable().toLowerCase(slice_begin_ + (data - slice_begin_), length);
+    setReference(current_header_field_, data, length);
+  } else {
+    current_header_field_.append(data, length);
+  }
 }
 
 void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
@@ -354,29 +408,67 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
   }
 
   header_parsing_state_ = HeaderParsingState::Value;
-  current_header_value_.append(data, length);
+  if (current_header_value_.empty() && referenceable(data, length)) {
+    setReference(current_header_value_, data, length);
+  } else {
+    // The continuation of a folded value copies what has been referenced so far.
+    current_header_value_.append(data, length);
+  }
+}
+
+void ConnectionImpl::maybeCompactReferences() {
+  if (referenced_bytes_ > 0 &&
+      referenced_slice_bytes_ > referenced_bytes_ * MaxPinnedBytesPerReferencedByte) {
+    // Pinning the slices would keep much more memory alive than the headers use, possibly for as
+    // long as a long lived request. Copy the referenced part of the head, terminators included,
+    // into one allocation of its size instead, and point the headers at the copy.
+    uint64_t head_length = 0;
+    for (const auto& range : referenced_ranges_) {
+      head_length += range.second - range.first;
+    }
+    std::shared_ptr<char> head(new char[head_length], std::default_delete<char[]>());
+    char* to = head.get();
+    for (const auto& range : referenced_ranges_) {
+      memcpy(to, range.first, range.second - range.first);
+      current_header_map_->moveReferences(range.first, range.second, to);
+      to += range.second - range.first;
+    }
+    current_header_map_->releaseRetained();
+    current_header_map_->retain(std::move(head));
+    // Earlier messages of this dispatch may still need the slices up to where they began.
+    pinned_length_ = message_pinned_length_;
+  }
+  referenced_ranges_.clear();
+  referenced_bytes_ = 0;
+  referenced_slice_bytes_ = 0;
 }
 
-int ConnectionImpl::onHeadersCompleteBase() {
+int ConnectionImpl::onHeadersComplete() {
   ENVOY_CONN_LOG(trace, "headers complete", connection_);
   completeLastHeader();
-  if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
+  maybeCompactReferences();
+  if (!(parser_->httpMajor() == 1 && parser_->httpMinor() == 1)) {
     // This is not necessarily true, but it's good enough since higher layers only care if this is
     // HTTP/1.1 or not.
     protocol_ = Protocol::Http10;
   }
 
-  int rc = onHeadersComplete(std::move(current_header_map_));
+  int rc = onHeadersCompleteImpl(std::move(current_header_map_));
   current_header_map_.reset();
   header_parsing_state_ = HeaderParsingState::Done;
   return rc;
 }
 
-void ConnectionImpl::onMessageBeginBase() {
+void ConnectionImpl::onMessageBegin() {
   ASSERT(!current_header_map_);
   current_header_map_.reset(new HeaderMapImpl());
+  message_pinned_length_ = pinned_length_;
+  if (pinned_slices_) {
+    // A pipelined message may reference the slices that the one before it did.
+    current_header_map_->retain(pinned_slices_);
+  }
   header_parsing_state_ = HeaderParsingState::Field;
-  onMessageBegin();
+  onMessageBeginImpl();
 }
 
 void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
@@ -388,7 +480,8 @@ void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            ServerConnectionCallbacks& callbacks,
                                            Http1Settings settings)
-    : ConnectionImpl(connection, HTTP_REQUEST), callbacks_(callbacks), codec_settings_(settings) {}
+    : ConnectionImpl(connection, MessageType::Request, settings.scanning_parser_),
+      callbacks_(callbacks), codec_settings_(settings) {}
 
 void ServerConnectionImpl::onEncodeComplete() {
   ASSERT(active_request_);
@@ -477,16 +570,16 @@ void ServerConnectionImpl::handlePath(HeaderMapImpl& headers, unsigned int metho
   }
 }
 
-int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
+int ServerConnectionImpl::onHeadersCompleteImpl(HeaderMapImplPtr&& headers) {
   // Handle the case where response happens prior to request complete. It's up to upper layer code
   // to disconnect the connection but we shouldn't fire any more events since it doesn't make
   // sense.
   if (active_request_) {
-    const char* method_string = http_method_str(static_cast<http_method>(parser_.method));
+    const char* method_string = http_method_str(parser_->method());
 
     // Currently, CONNECT is not supported, however; http_parser_parse_url needs to know about
     // CONNECT
-    handlePath(*headers, parser_.method);
+    handlePath(*headers, parser_->method());
     ASSERT(active_request_->request_url_.empty());
 
     headers->insertMethod().value(method_string, strlen(method_string));
@@ -497,14 +590,13 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     // with message complete. This allows upper layers to behave like HTTP/2 and prevents a proxy
     // scenario where the higher layers stream through and implicitly switch to chunked transfer
     // encoding because end stream with zero body length has not yet been indicated.
-    if (parser_.flags & F_CHUNKED ||
-        (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX)) {
+    if (parser_->hasBody()) {
       active_request_->request_decoder_->decodeHeaders(std::move(headers), false);
 
       // If the connection has been closed (or is closing) after decoding headers, pause the parser
       // so we return control to the caller.
       if (connection_.state() != Network::Connection::State::Open) {
-        http_parser_pause(&parser_, 1);
+        parser_->pause();
       }
 
     } else {
@@ -515,7 +607,7 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   return 0;
 }
 
-void ServerConnectionImpl::onMessageBegin() {
+void ServerConnectionImpl::onMessageBeginImpl() {
   if (!resetStreamCalled()) {
     ASSERT(!active_request_);
     active_request_.reset(new ActiveRequest(*this));
@@ -556,7 +648,7 @@ void ServerConnectionImpl::onMessageComplete() {
   // Always pause the parser so that the calling code can process 1 request at a time and apply
   // back pressure. However this means that the calling code needs to detect if there is more data
   // in the buffer and dispatch it again.
-  http_parser_pause(&parser_, 1);
+  parser_->pause();
 }
 
 void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
@@ -590,12 +682,13 @@ void ServerConnectionImpl::onBelowLowWatermark() {
   }
 }
 
-ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&)
-    : ConnectionImpl(connection, HTTP_RESPONSE) {}
+ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&,
+                                           const Http1Settings& settings)
+    : ConnectionImpl(connection, MessageType::Response, settings.scanning_parser_) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
   if ((!pending_responses_.empty() && pending_responses_.front().head_request_) ||
-      parser_.status_code == 204 || parser_.status_code == 304) {
+      parser_->statusCode() == 204 || parser_->statusCode() == 304) {
     return true;
   } else {
     return false;
@@ -623,8 +716,8 @@ void ClientConnectionImpl::onEncodeComplete() {
   pending_responses_.back().head_request_ = request_encoder_->headRequest();
 }
 
-int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
-  headers->insertStatus().value(parser_.status_code);
+int ClientConnectionImpl::onHeadersCompleteImpl(HeaderMapImplPtr&& headers) {
+  headers->insertStatus().value(parser_->statusCode());
 
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
@@ -632,7 +725,7 @@ int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   if (pending_responses_.empty() && !resetStreamCalled()) {
     throw PrematureResponseException(std::move(headers));
   } else if (!pending_responses_.empty()) {
-    if (parser_.status_code == 100) {
+    if (parser_->statusCode() == 100) {
       // http-parser treats 100 continue headers as their own complete response.
       // Swallow the spurious onMessageComplete and continue processing.
       ignore_message_complete_for_100_continue_ = true;
@@ -1,22 +1,23 @@
 #pragma once
 
-#include <http_parser.h>
-
 #include <array>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/http/codec.h"
 #include "envoy/network/connection.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/assert.h"
 #include "common/common/to_lower_table.h"
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/parser.h"
 
 namespace Envoy {
 namespace Http {
@@ -108,7 +109,9 @@ private:
 /**
  * Base class for HTTP/1.1 client and server connections.
  */
-class ConnectionImpl : public virtual Connection, protected Logger::Loggable<Logger::Id::http> {
+class ConnectionImpl : public virtual Connection,
+                       private ParserCallbacks,
+                       protected Logger::Loggable<Logger::Id::http> {
 public:
   /**
    * @return Network::Connection& the backing network connection.
@@ -153,12 +156,18 @@ public:
   virtual bool supports_http_10() { return false; }
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type);
+  /**
+   * @param connection supplies the backing network connection.
+   * @param type supplies whether requests or responses are read.
+   * @param scanning_parser supplies whether to read them with ScanningParserImpl rather than
+   *        http_parser.
+   */
+  ConnectionImpl(Network::Connection& connection, MessageType type, bool scanning_parser);
 
   bool resetStreamCalled() { return reset_stream_called_; }
 
   Network::Connection& connection_;
-  http_parser parser_;
+  ParserPtr parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
 
@@ -178,52 +187,53 @@ private:
   size_t dispatchSlice(const char* slice, size_t len);
 
   /**
-   * Called when a request/response is beginning. A base routine happens first then a virtual
-   * dispatch is invoked.
+   * @return Buffer::OwnedImpl* data if headers can be referenced in it rather than copied, or
+   *         nullptr.
    */
-  void onMessageBeginBase();
-  virtual void onMessageBegin() PURE;
+  Buffer::OwnedImpl* referenceableBuffer(Buffer::Instance& data);
 
   /**
-   * Called when URL data is received.
-   * @param data supplies the start address.
-   * @param lenth supplies the length.
+   * Drain the front of buffer that headers referenced during this dispatch need, retaining its
+   * slices for the header maps.
+   * @return uint64_t the number of bytes drained.
    */
-  virtual void onUrl(const char* data, size_t length) PURE;
+  uint64_t pinReferencedSlices(Buffer::OwnedImpl* buffer);
 
   /**
-   * Called when header field data is received.
-   * @param data supplies the start address.
-   * @param length supplies the length.
+   * @return whether a header field or value can be referenced where it is, in the slice being
+   *         dispatched.
    */
-  void onHeaderField(const char* data, size_t length);
+  bool referenceable(const char* data, size_t length) const;
 
   /**
-   * Called when header value data is received.
-   * @param data supplies the start address.
-   * @param length supplies the length.
+   * Point a header string at a field or value in the slice being dispatched, null terminating it
+   * there, and arrange for the slice to outlive the header map.
    */
-  void onHeaderValue(const char* data, size_t length);
+  void setReference(HeaderString& string, const char* data, size_t length);
 
   /**
-   * Called when headers are complete. A base routine happens first then a virtual disaptch is
-   * invoked.
-   * @return 0 if no error, 1 if there should be no body.
+   * Move the part of the current message's head that its headers reference out of the read buffer
+   * into memory of its own, if the slices it is in are too large to pin for it. Called before the
+   * map is handed out.
    */
-  int onHeadersCompleteBase();
-  virtual int onHeadersComplete(HeaderMapImplPtr&& headers) PURE;
+  void maybeCompactReferences();
+
+  // Http1::ParserCallbacks
+  void onMessageBegin() override;
+  void onHeaderField(const char* data, size_t length) override;
+  void onHeaderValue(const char* data, size_t length) override;
+  int onHeadersComplete() override;
 
   /**
-   * Called when body data is received.
-   * @param data supplies the start address.
-   * @param length supplies the length.
+   * Called when a request/response is beginning, after the base routine.
    */
-  virtual void onBody(const char* data, size_t length) PURE;
+  virtual void onMessageBeginImpl() PURE;
 
   /**
-   * Called when the request/response is complete.
+   * Called when headers are complete, after the base routine.
+   * @return 0 if no error, 1 if there should be no body.
    */
-  virtual void onMessageComplete() PURE;
+  virtual int onHeadersCompleteImpl(HeaderMapImplPtr&& headers) PURE;
 
   /**
    * @see onResetStreamBase().
@@ -247,13 +257,37 @@ private:
    */
   virtual void onBelowLowWatermark() PURE;
 
-  static http_parser_settings settings_;
   static const ToLowerTable& toLowerTable();
 
+  // Headers stay referenced in the read buffer only if the slices that pinning them keeps alive
+  // are at most this many times as large as the referenced names and values. A typical request
+  // head read into a 16KB slice is instead compacted into an exact size copy with one memcpy, and
+  // its headers reference that; heads of a few KB, e.g. with large cookies, are left in place.
+  static const uint64_t MaxPinnedBytesPerReferencedByte = 8;
+
   HeaderMapImplPtr current_header_map_;
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   HeaderString current_header_field_;
   HeaderString current_header_value_;
+  // The slice being dispatched and its offset in the read buffer, when the parser and the buffer
+  // allow headers to be referenced in place rather than copied.
+  char* slice_begin_{};
+  char* slice_end_{};
+  uint64_t slice_offset_{};
+  uint64_t slice_size_{};
+  // For each slice that the current message's headers reference, the span from the first
+  // referenced byte to the last terminator. Then the number of bytes referenced, and the total
+  // size of those slices.
+  std::vector<std::pair<const char*, const char*>> referenced_ranges_;
+  uint64_t referenced_bytes_{};
+  uint64_t referenced_slice_bytes_{};
+  // Read buffer slices that hold headers referenced during the current dispatch, and how much of
+  // the read buffer they must cover. The slices are drained into the vector rather than released,
+  // and every header map that references them retains the vector.
+  std::shared_ptr<std::vector<Buffer::SliceSharedPtr>> pinned_slices_;
+  uint64_t pinned_length_{};
+  // pinned_length_ when the current message began, if it began during this dispatch.
+  uint64_t message_pinned_length_{};
   bool reset_stream_called_{};
   Buffer::WatermarkBuffer output_buffer_;
   Buffer::RawSlice reserved_iovec_;
@@ -296,16 +330,18 @@ private:
 
   // ConnectionImpl
   void onEncodeComplete() override;
-  void onMessageBegin() override;
-  void onUrl(const char* data, size_t length) override;
-  int onHeadersComplete(HeaderMapImplPtr&& headers) override;
-  void onBody(const char* data, size_t length) override;
-  void onMessageComplete() override;
+  void onMessageBeginImpl() override;
+  int onHeadersCompleteImpl(HeaderMapImplPtr&& headers) override;
   void onResetStream(StreamResetReason reason) override;
   void sendProtocolError() override;
   void onAboveHighWatermark() override;
   void onBelowLowWatermark() override;
 
+  // Http1::ParserCallbacks
+  void onUrl(const char* data, size_t length) override;
+  void onBody(const char* data, size_t length) override;
+  void onMessageComplete() override;
+
   ServerConnectionCallbacks& callbacks_;
   std::unique_ptr<ActiveRequest> active_request_;
   Http1Settings codec_settings_;
@@ -316,7 +352,8 @@ private:
  */
 class ClientConnectionImpl : public ClientConnection, public ConnectionImpl {
 public:
-  ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks& callbacks);
+  ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks& callbacks,
+                       const Http1Settings& settings = Http1Settings());
 
   // Http::ClientConnection
   StreamEncoder& newStream(StreamDecoder& response_decoder) override;
@@ -333,16 +370,18 @@ private:
 
   // ConnectionImpl
   void onEncodeComplete() override;
-  void onMessageBegin() override {}
-  void onUrl(const char*, size_t) override { NOT_IMPLEMENTED; }
-  int onHeadersComplete(HeaderMapImplPtr&& headers) override;
-  void onBody(const char* data, size_t length) override;
-  void onMessageComplete() override;
+  void onMessageBeginImpl() override {}
+  int onHeadersCompleteImpl(HeaderMapImplPtr&& headers) override;
   void onResetStream(StreamResetReason reason) override;
   void sendProtocolError() override {}
   void onAboveHighWatermark() override;
   void onBelowLowWatermark() override;
 
+  // Http1::ParserCallbacks
+  void onUrl(const char*, size_t) override { NOT_IMPLEMENTED; }
+  void onBody(const char* data, size_t length) override;
+  void onMessageComplete() override;
+
   std::unique_ptr<RequestStreamEncoderImpl> request_encoder_;
   std::list<PendingResponse> pending_responses_;
   // Set true between receiving 100-Continue headers and receiving the spurious onMessageComplete.
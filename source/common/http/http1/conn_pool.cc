@@ -1,5 +1,7 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <list>
 
@@ -22,32 +24,57 @@ namespace Http1 {
 
 ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                            Upstream::ResourcePriority priority,
-                           const Network::ConnectionSocket::OptionsSharedPtr& options)
+                           const Network::ConnectionSocket::OptionsSharedPtr& options,
+                           MonotonicTimeSource& time_source)
     : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options),
-      upstream_ready_timer_(dispatcher_.createTimer([this]() { onUpstreamReady(); })) {}
+      upstream_ready_timer_(dispatcher_.createTimer([this]() { onUpstreamReady(); })),
+      time_source_(time_source), idle_timeout_(host_->cluster().idleTimeout()) {
+  if (idle_timeout_) {
+    idle_timer_ = dispatcher_.createTimer([this]() { onIdleTimeout(); });
+  }
+}
 
 ConnPoolImpl::~ConnPoolImpl() {
   while (!ready_clients_.empty()) {
-    ready_clients_.front()->codec_client_->close();
+    ready_clients_.front().codec_client_->close();
   }
 
   while (!busy_clients_.empty()) {
-    busy_clients_.front()->codec_client_->close();
+    busy_clients_.front().codec_client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
   dispatcher_.clearDeferredDeleteList();
+
+  while (!pending_requests_.empty()) {
+    removePendingRequest(pending_requests_.front());
+  }
 }
 
 void ConnPoolImpl::drainConnections() {
   while (!ready_clients_.empty()) {
-    ready_clients_.front()->codec_client_->close();
+    ready_clients_.front().codec_client_->close();
   }
 
   // We drain busy clients by manually setting remaining requests to 1. Thus, when the next
   // response completes the client will be destroyed.
-  for (const auto& client : busy_clients_) {
-    client->remaining_requests_ = 1;
+  for (ActiveClient& client : busy_clients_) {
+    client.remaining_requests_ = 1;
+  }
+}
+
+void ConnPoolImpl::prefetch(uint32_t connections) {
+  // A pool that is being drained opens no more connections.
+  if (!drained_callbacks_.empty()) {
+    return;
+  }
+
+  while (ready_clients_.size() + busy_clients_.size() < connections &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a connection");
+    createNewConnection();
+    busy_clients_.front().prefetched_ = true;
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
   }
 }
 
@@ -59,6 +86,10 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
   ASSERT(!client.stream_wrapper_);
+  if (client.prefetched_) {
+    client.prefetched_ = false;
+    host_->cluster().stats().upstream_cx_prefetch_used_.inc();
+  }
   client.stream_wrapper_.reset(new StreamWrapper(response_decoder, client));
   callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
 }
@@ -66,7 +97,7 @@ void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& re
 void ConnPoolImpl::checkForDrained() {
   if (!drained_callbacks_.empty() && pending_requests_.empty() && busy_clients_.empty()) {
     while (!ready_clients_.empty()) {
-      ready_clients_.front()->codec_client_->close();
+      ready_clients_.front().codec_client_->close();
     }
 
     for (const DrainedCb& cb : drained_callbacks_) {
@@ -77,35 +108,42 @@ void ConnPoolImpl::checkForDrained() {
 
 void ConnPoolImpl::createNewConnection() {
   ENVOY_LOG(debug, "creating a new connection");
-  ActiveClientPtr client(new ActiveClient(*this));
-  client->moveIntoList(std::move(client), busy_clients_);
+  busy_clients_.pushFront(*new ActiveClient(*this));
+  connecting_clients_++;
 }
 
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   if (!ready_clients_.empty()) {
-    ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
-    ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
-    attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    ActiveClient& client = ready_clients_.front();
+    busy_clients_.moveToFront(client, ready_clients_);
+    ENVOY_CONN_LOG(debug, "using existing connection", *client.codec_client_);
+    attachRequestToClient(client, response_decoder, callbacks);
+    prefetchForDemand();
     return nullptr;
   }
 
   if (host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
-    bool can_create_connection =
-        host_->cluster().resourceManager(priority_).connections().canCreate();
-    if (!can_create_connection) {
-      host_->cluster().stats().upstream_cx_overflow_.inc();
-    }
+    // If a connection is still connecting with no request waiting for it, such as one that was
+    // prefetched, the request waits for that one.
+    if (connecting_clients_ <= pending_requests_.size()) {
+      bool can_create_connection =
+          host_->cluster().resourceManager(priority_).connections().canCreate();
+      if (!can_create_connection) {
+        host_->cluster().stats().upstream_cx_overflow_.inc();
+      }
 
-    // If we have no connections at all, make one no matter what so we don't starve.
-    if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) || can_create_connection) {
-      createNewConnection();
+      // If we have no connections at all, make one no matter what so we don't starve.
+      if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) || can_create_connection) {
+        createNewConnection();
+      }
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
-    PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
-    pending_request->moveIntoList(std::move(pending_request), pending_requests_);
-    return pending_requests_.front().get();
+    PendingRequest* pending_request = new PendingRequest(*this, response_decoder, callbacks);
+    pending_requests_.pushFront(*pending_request);
+    prefetchForDemand();
+    return pending_request;
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
@@ -119,7 +157,6 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       event == Network::ConnectionEvent::LocalClose) {
     // The client died.
     ENVOY_CONN_LOG(debug, "client disconnected", *client.codec_client_);
-    ActiveClientPtr removed;
     bool check_for_drained = true;
     if (client.stream_wrapper_) {
       if (!client.stream_wrapper_->decode_complete_) {
@@ -135,17 +172,18 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       // There is an active request attached to this client. The underlying codec client will
       // already have "reset" the stream to fire the reset callback. All we do here is just
       // destroy the client.
-      removed = client.removeFromList(busy_clients_);
+      busy_clients_.remove(client);
     } else if (!client.connect_timer_) {
       // The connect timer is destroyed on connect. The lack of a connect timer means that this
       // client is idle and in the ready pool.
-      removed = client.removeFromList(ready_clients_);
+      ready_clients_.remove(client);
       check_for_drained = false;
     } else {
       // The only time this happens is if we actually saw a connect failure.
       host_->cluster().stats().upstream_cx_connect_fail_.inc();
       host_->stats().cx_connect_fail_.inc();
-      removed = client.removeFromList(busy_clients_);
+      busy_clients_.remove(client);
+      connecting_clients_--;
 
       // Raw connect failures should never happen under normal circumstances. If we have an upstream
       // that is behaving badly, requests can get stuck here in the pending state. If we see a
@@ -153,17 +191,18 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       // do with the request.
       // NOTE: We move the existing pending requests to a temporary list. This is done so that
       //       if retry logic submits a new request to the pool, we don't fail it inline.
-      std::list<PendingRequestPtr> pending_requests_to_purge(std::move(pending_requests_));
+      IntrusiveList<PendingRequest> pending_requests_to_purge;
+      pending_requests_to_purge.swap(pending_requests_);
       while (!pending_requests_to_purge.empty()) {
-        PendingRequestPtr request =
-            pending_requests_to_purge.front()->removeFromList(pending_requests_to_purge);
+        PendingRequestPtr request(&pending_requests_to_purge.front());
+        pending_requests_to_purge.remove(*request);
         host_->cluster().stats().upstream_rq_pending_failure_eject_.inc();
         request->callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure,
                                           client.real_host_description_);
       }
     }
 
-    dispatcher_.deferredDelete(std::move(removed));
+    dispatcher_.deferredDelete(ActiveClientPtr{&client});
 
     // If we have pending requests and we just lost a connection we should make a new one.
     if (pending_requests_.size() > (ready_clients_.size() + busy_clients_.size())) {
@@ -185,6 +224,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   // drain/destruction event, we key off of the existence of the connect timer above to determine
   // whether the client is in the ready list (connected) or the busy list (failed to connect).
   if (event == Network::ConnectionEvent::Connected) {
+    connecting_clients_--;
     conn_connect_ms_->complete();
     processIdleClient(client, false);
   }
@@ -195,9 +235,31 @@ void ConnPoolImpl::onDownstreamReset(ActiveClient& client) {
   client.codec_client_->close();
 }
 
+void ConnPoolImpl::onIdleTimeout() {
+  idle_timer_enabled_ = false;
+  const MonotonicTime now = time_source_.currentTime();
+
+  // Ready clients are in order of use, so the ones that have been idle longest are at the back.
+  // Closing a client removes it from the list.
+  while (!ready_clients_.empty()) {
+    ActiveClient& client = ready_clients_.back();
+    const std::chrono::milliseconds idle =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - client.idle_since_);
+    if (idle < idle_timeout_.value()) {
+      idle_timer_enabled_ = true;
+      idle_timer_->enableTimer(idle_timeout_.value() - idle);
+      break;
+    }
+
+    ENVOY_CONN_LOG(debug, "idle timeout", *client.codec_client_);
+    host_->cluster().stats().upstream_cx_idle_timeout_.inc();
+    client.codec_client_->close();
+  }
+}
+
 void ConnPoolImpl::onPendingRequestCancel(PendingRequest& request) {
   ENVOY_LOG(debug, "cancelling pending request");
-  request.removeFromList(pending_requests_);
+  removePendingRequest(request);
   host_->cluster().stats().upstream_rq_cancelled_.inc();
   checkForDrained();
 }
@@ -225,14 +287,35 @@ void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
 void ConnPoolImpl::onUpstreamReady() {
   upstream_ready_enabled_ = false;
   while (!pending_requests_.empty() && !ready_clients_.empty()) {
-    ActiveClient& client = *ready_clients_.front();
+    ActiveClient& client = ready_clients_.front();
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
     // There is work to do so bind a request to the client and move it to the busy list. Pending
     // requests are pushed onto the front, so pull from the back.
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
-    client.moveBetweenLists(ready_clients_, busy_clients_);
+    PendingRequest& request = pending_requests_.back();
+    attachRequestToClient(client, request.decoder_, request.callbacks_);
+    removePendingRequest(request);
+    busy_clients_.moveToFront(client, ready_clients_);
+  }
+}
+
+void ConnPoolImpl::moveClientToReady(ActiveClient& client) {
+  ready_clients_.moveToFront(client, busy_clients_);
+  if (idle_timeout_) {
+    client.idle_since_ = time_source_.currentTime();
+    if (!idle_timer_enabled_) {
+      idle_timer_enabled_ = true;
+      idle_timer_->enableTimer(idle_timeout_.value());
+    }
+  }
+}
+
+void ConnPoolImpl::prefetchForDemand() {
+  // Every connection has a capacity of one request, so the pool needs the ratio times its active
+  // and pending requests in connections. The connecting clients are busy but have no request.
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio > 1) {
+    const uint64_t demand = busy_clients_.size() - connecting_clients_ + pending_requests_.size();
+    prefetch(static_cast<uint32_t>(std::ceil(ratio * demand)));
   }
 }
 
@@ -242,14 +325,14 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
     // There is nothing to service or delayed processing is requested, so just move the connection
     // into the ready list.
     ENVOY_CONN_LOG(debug, "moving to ready", *client.codec_client_);
-    client.moveBetweenLists(busy_clients_, ready_clients_);
+    moveClientToReady(client);
   } else {
     // There is work to do immediately so bind a request to the client and move it to the busy list.
     // Pending requests are pushed onto the front, so pull from the back.
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    PendingRequest& request = pending_requests_.back();
+    attachRequestToClient(client, request.decoder_, request.callbacks_);
+    removePendingRequest(request);
   }
 
   if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
@@ -260,6 +343,11 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
   checkForDrained();
 }
 
+void ConnPoolImpl::removePendingRequest(PendingRequest& request) {
+  pending_requests_.remove(request);
+  delete &request;
+}
+
 ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, ActiveClient& parent)
     : StreamEncoderWrapper(parent.codec_client_->newStream(*this)),
       StreamDecoderWrapper(response_decoder), parent_(parent) {
@@ -319,6 +407,8 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   real_host_description_ = data.host_description_;
   codec_client_ = parent_.createCodecClient(data);
   codec_client_->addConnectionCallbacks(*this);
+  // The pool closes idle connections itself.
+  codec_client_->disableIdleTimeout();
 
   parent_.host_->cluster().stats().upstream_cx_total_.inc();
   parent_.host_->cluster().stats().upstream_cx_active_.inc();
@@ -338,6 +428,9 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
+  if (prefetched_) {
+    parent_.host_->cluster().stats().upstream_cx_prefetch_wasted_.inc();
+  }
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   parent_.host_->stats().cx_active_.dec();
   conn_length_->complete();
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <memory>
 
+#include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/timer.h"
 #include "envoy/http/conn_pool.h"
@@ -11,7 +13,8 @@
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
-#include "common/common/linked_object.h"
+#include "common/common/intrusive_list.h"
+#include "common/common/utility.h"
 #include "common/http/codec_client.h"
 #include "common/http/codec_wrappers.h"
 
@@ -26,12 +29,19 @@ namespace Http1 {
  * NOTE: The connection pool does NOT do DNS resolution. It assumes it is being given a numeric IP
  *       address. Higher layer code should handle resolving DNS on error and creating a new pool
  *       bound to a different IP address.
+ *
+ * Ready connections are reused last in, first out, so that requests go to the connections that
+ * were used most recently and have warm congestion windows, while the connections at the cold end
+ * of the ready list go idle. If the cluster has an idle timeout, a single timer per pool closes the
+ * cold connections once they have been idle that long, rather than a timer per connection that is
+ * rearmed by every request.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
   ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                Upstream::ResourcePriority priority,
-               const Network::ConnectionSocket::OptionsSharedPtr& options);
+               const Network::ConnectionSocket::OptionsSharedPtr& options,
+               MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
 
   ~ConnPoolImpl();
 
@@ -39,6 +49,7 @@ public:
   Http::Protocol protocol() const override { return Http::Protocol::Http11; }
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
+  void prefetch(uint32_t connections) override;
   ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
 
@@ -72,7 +83,7 @@ protected:
 
   typedef std::unique_ptr<StreamWrapper> StreamWrapperPtr;
 
-  struct ActiveClient : LinkedObject<ActiveClient>,
+  struct ActiveClient : IntrusiveListNode<ActiveClient>,
                         public Network::ConnectionCallbacks,
                         public Event::DeferredDeletable {
     ActiveClient(ConnPoolImpl& parent);
@@ -94,11 +105,15 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // When the client last moved to the ready list.
+    MonotonicTime idle_since_;
+    // Set while a connection opened by prefetch() has not yet had a request.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
 
-  struct PendingRequest : LinkedObject<PendingRequest>, public ConnectionPool::Cancellable {
+  struct PendingRequest : IntrusiveListNode<PendingRequest>, public ConnectionPool::Cancellable {
     PendingRequest(ConnPoolImpl& parent, StreamDecoder& decoder,
                    ConnectionPool::Callbacks& callbacks);
     ~PendingRequest();
@@ -120,22 +135,35 @@ protected:
   void createNewConnection();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
+  void onIdleTimeout();
   void onPendingRequestCancel(PendingRequest& request);
   void onResponseComplete(ActiveClient& client);
   void onUpstreamReady();
+  void moveClientToReady(ActiveClient& client);
+  void prefetchForDemand();
   void processIdleClient(ActiveClient& client, bool delay);
+  void removePendingRequest(PendingRequest& request);
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  std::list<ActiveClientPtr> ready_clients_;
-  std::list<ActiveClientPtr> busy_clients_;
-  std::list<PendingRequestPtr> pending_requests_;
+  // The pool owns the clients and pending requests in these lists. Ready clients are ordered from
+  // the most to the least recently used. Pending requests are added at the front and served from
+  // the back.
+  IntrusiveList<ActiveClient> ready_clients_;
+  // Clients with a request, and clients that are still connecting.
+  IntrusiveList<ActiveClient> busy_clients_;
+  uint32_t connecting_clients_{};
+  IntrusiveList<PendingRequest> pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  MonotonicTimeSource& time_source_;
+  const absl::optional<std::chrono::milliseconds> idle_timeout_;
+  Event::TimerPtr idle_timer_;
+  bool idle_timer_enabled_{};
 };
 
 /**
@@ -0,0 +1,69 @@
+#include "common/http/http1/legacy_parser_impl.h"
+
+#include <climits>
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+http_parser_settings LegacyParserImpl::settings_{
+    [](http_parser* parser) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onMessageBegin();
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onUrl(at, length);
+      return 0;
+    },
+    nullptr, // on_status
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onHeaderField(at, length);
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onHeaderValue(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      return static_cast<ParserCallbacks*>(parser->data)->onHeadersComplete();
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onBody(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onMessageComplete();
+      return 0;
+    },
+    nullptr, // on_chunk_header
+    nullptr  // on_chunk_complete
+};
+
+LegacyParserImpl::LegacyParserImpl(MessageType type, ParserCallbacks& callbacks) {
+  http_parser_init(&parser_, type == MessageType::Request ? HTTP_REQUEST : HTTP_RESPONSE);
+  parser_.data = &callbacks;
+}
+
+size_t LegacyParserImpl::execute(const char* data, size_t length) {
+  return http_parser_execute(&parser_, &settings_, data, length);
+}
+
+ParserStatus LegacyParserImpl::status() const {
+  switch (HTTP_PARSER_ERRNO(&parser_)) {
+  case HPE_OK:
+    return ParserStatus::Ok;
+  case HPE_PAUSED:
+    return ParserStatus::Paused;
+  default:
+    return ParserStatus::Error;
+  }
+}
+
+bool LegacyParserImpl::hasBody() const {
+  return parser_.flags & F_CHUNKED ||
+         (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX);
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
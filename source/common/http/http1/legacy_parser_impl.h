@@ -0,0 +1,39 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser backed by http_parser, which reads the stream one byte at a time.
+ */
+class LegacyParserImpl : public Parser {
+public:
+  LegacyParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { http_parser_pause(&parser_, 1); }
+  void resume() override { http_parser_pause(&parser_, 0); }
+  ParserStatus status() const override;
+  const char* errorName() const override { return http_errno_name(HTTP_PARSER_ERRNO(&parser_)); }
+  http_method method() const override { return static_cast<http_method>(parser_.method); }
+  uint16_t statusCode() const override { return parser_.status_code; }
+  uint16_t httpMajor() const override { return parser_.http_major; }
+  uint16_t httpMinor() const override { return parser_.http_minor; }
+  bool hasBody() const override;
+  bool terminatesInPlace() const override { return false; }
+
+private:
+  static http_parser_settings settings_;
+
+  http_parser parser_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Which side of an HTTP/1.1 exchange a parser reads.
+ */
+enum class MessageType { Request, Response };
+
+/**
+ * Where a parser stands after execute().
+ */
+enum class ParserStatus {
+  // Ready for more data.
+  Ok,
+  // Stopped by pause() until resume() is called.
+  Paused,
+  // Stopped by a protocol error. The parser does not recover.
+  Error
+};
+
+/**
+ * Callbacks raised by a Parser as it reads messages. They follow http_parser's callbacks: data
+ * callbacks may be raised several times for one element when it spans calls to execute(), and the
+ * data only lives until the callback returns.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() {}
+
+  /**
+   * Called when the first byte of a request or response is read.
+   */
+  virtual void onMessageBegin() PURE;
+
+  /**
+   * Called when URL data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header field data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header value data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called when headers are complete.
+   * @return 0 to read the body as the headers describe it, 1 if the message has no body.
+   */
+  virtual int onHeadersComplete() PURE;
+
+  /**
+   * Called when body data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the request/response is complete.
+   */
+  virtual void onMessageComplete() PURE;
+};
+
+/**
+ * An HTTP/1.1 parser for one direction of a connection. Implementations accept and reject the same
+ * input as http_parser, and report errors with http_parser's error names.
+ */
+class Parser {
+public:
+  virtual ~Parser() {}
+
+  /**
+   * Parse the next span of the stream.
+   * @param data supplies the start address.
+   * @param length supplies the length. Zero tells the parser that the stream has ended.
+   * @return size_t the number of bytes consumed. This is less than length if the parser was paused
+   *         or failed, or if an upgraded connection stopped being HTTP.
+   */
+  virtual size_t execute(const char* data, size_t length) PURE;
+
+  /**
+   * Stop parsing. Called from a callback, execute() returns once the callback does.
+   */
+  virtual void pause() PURE;
+
+  /**
+   * Undo pause().
+   */
+  virtual void resume() PURE;
+
+  /**
+   * @return ParserStatus whether the parser can go on.
+   */
+  virtual ParserStatus status() const PURE;
+
+  /**
+   * @return const char* the http_parser name of the error, e.g. "HPE_INVALID_METHOD".
+   */
+  virtual const char* errorName() const PURE;
+
+  /**
+   * @return the method of the request being parsed. Valid from onHeadersComplete().
+   */
+  virtual http_method method() const PURE;
+
+  /**
+   * @return the status code of the response being parsed. Valid from onHeadersComplete().
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return the HTTP version of the message being parsed. Valid from onHeadersComplete().
+   */
+  virtual uint16_t httpMajor() const PURE;
+  virtual uint16_t httpMinor() const PURE;
+
+  /**
+   * @return bool whether the message being parsed is chunked or has a non zero content-length.
+   *         Valid from onHeadersComplete().
+   */
+  virtual bool hasBody() const PURE;
+
+  /**
+   * @return bool whether each non empty header field or value that the parser passes to the
+   *         callbacks from the data given to execute() is followed there by the byte that ended
+   *         it. The parser reads neither again once the callback returns, so the callback may
+   *         modify them in place, e.g. to lower case a field and null terminate it.
+   */
+  virtual bool terminatesInPlace() const PURE;
+};
+
+typedef std::unique_ptr<Parser> ParserPtr;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,1178 @@
+#include "common/http/http1/scanning_parser_impl.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+bool isAlpha(uint8_t c) { return (c | 0x20) >= 'a' && (c | 0x20) <= 'z'; }
+bool isNum(uint8_t c) { return c >= '0' && c <= '9'; }
+
+int8_t unhex(uint8_t c) {
+  if (isNum(c)) {
+    return c - '0';
+  }
+  c |= 0x20;
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// http_parser's character classes, as it is built in strict mode.
+struct CharTables {
+  CharTables() {
+    for (uint32_t c = 0; c < 256; c++) {
+      const bool alpha_num = isAlpha(c) || isNum(c);
+      token_[c] = alpha_num || (c != 0 && strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+      url_[c] = c > 0x20 && c < 0x7f && c != '#' && c != '?';
+      userinfo_[c] = alpha_num || (c != 0 && strchr("-_.!~*'()%;:&=+$,", c) != nullptr);
+      unhex_[c] = unhex(c);
+    }
+  }
+
+  std::array<bool, 256> token_;
+  std::array<bool, 256> url_;
+  std::array<bool, 256> userinfo_;
+  std::array<int8_t, 256> unhex_;
+};
+
+const CharTables& charTables() {
+  static const CharTables* tables = new CharTables();
+  return *tables;
+}
+
+struct MethodName {
+  absl::string_view name_;
+  http_method method_;
+};
+
+#define METHOD_NAME(num, name, string) {#string, HTTP_##name},
+const MethodName MethodNames[] = {HTTP_METHOD_MAP(METHOD_NAME)};
+#undef METHOD_NAME
+
+bool isMethodPrefix(absl::string_view prefix) {
+  for (const MethodName& method : MethodNames) {
+    if (method.name_.substr(0, prefix.size()) == prefix) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The delimiters searched for, tested one byte at a time or 16 or 32 bytes at a time. Each vector
+// test sets every byte of its result that matches to 0xff.
+struct LineEnd {
+  static bool match(uint8_t c) { return c == '\r' || c == '\n'; }
+#if defined(__SSE2__)
+  static __m128i match(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+  }
+#endif
+#if defined(__AVX2__)
+  static __m256i match(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+  }
+#endif
+};
+
+// The end of a header value: CR, LF, or any other control character but HTAB, which is invalid.
+struct ValueEnd {
+  static bool match(uint8_t c) { return (c < 0x20 && c != '\t') || c == 0x7f; }
+#if defined(__SSE2__)
+  static __m128i match(__m128i v) {
+    // There is no unsigned compare before AVX-512, but v <= 0x1f exactly when min(v, 0x1f) == v.
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+    return _mm_or_si128(_mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), control),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+  }
+#endif
+#if defined(__AVX2__)
+  static __m256i match(__m256i v) {
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+    return _mm256_or_si256(
+        _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')), control),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)));
+  }
+#endif
+};
+
+// Anything in a URL path, query string or fragment that is not an ordinary URL character.
+struct UrlEnd {
+  static bool match(uint8_t c) { return c <= 0x20 || c >= 0x7f || c == '#' || c == '?'; }
+#if defined(__SSE2__)
+  static __m128i match(__m128i v) {
+    // As signed bytes, 0x80 and up are negative, so one compare finds them and 0x20 and below.
+    const __m128i outside = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x21)),
+                                         _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)));
+    return _mm_or_si128(outside, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('#')),
+                                              _mm_cmpeq_epi8(v, _mm_set1_epi8('?'))));
+  }
+#endif
+#if defined(__AVX2__)
+  static __m256i match(__m256i v) {
+    const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x21), v),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)));
+    return _mm256_or_si256(outside,
+                           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('#')),
+                                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('?'))));
+  }
+#endif
+};
+
+/**
+ * @return the first byte of [p, end) that matches Delimiters, or end.
+ */
+template <class Delimiters> const char* find(const char* p, const char* end) {
+#if defined(__AVX2__)
+  for (; end - p >= 32; p += 32) {
+    const uint32_t mask = _mm256_movemask_epi8(
+        Delimiters::match(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  for (; end - p >= 16; p += 16) {
+    const uint32_t mask = _mm_movemask_epi8(
+        Delimiters::match(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; p != end; p++) {
+    if (Delimiters::match(static_cast<uint8_t>(*p))) {
+      return p;
+    }
+  }
+  return end;
+}
+
+// http_parser's URL states, in the same order, so that those that may end a URL come last.
+enum class UrlState {
+  Dead,
+  Schema,
+  SchemaSlash,
+  SchemaSlashSlash,
+  ServerStart,
+  Server,
+  ServerWithAt,
+  Path,
+  QueryStringStart,
+  QueryString,
+  FragmentStart,
+  Fragment
+};
+
+// http_parser's parse_url_char(), for any character but a space, CR or LF.
+UrlState parseUrlChar(UrlState state, uint8_t c) {
+  const CharTables& tables = charTables();
+  switch (state) {
+  case UrlState::Schema:
+    if (isAlpha(c)) {
+      return state;
+    }
+    return c == ':' ? UrlState::SchemaSlash : UrlState::Dead;
+  case UrlState::SchemaSlash:
+    return c == '/' ? UrlState::SchemaSlashSlash : UrlState::Dead;
+  case UrlState::SchemaSlashSlash:
+    return c == '/' ? UrlState::ServerStart : UrlState::Dead;
+  case UrlState::ServerWithAt:
+    if (c == '@') {
+      return UrlState::Dead;
+    }
+    FALLTHRU;
+  case UrlState::ServerStart:
+  case UrlState::Server:
+    if (c == '/') {
+      return UrlState::Path;
+    }
+    if (c == '?') {
+      return UrlState::QueryStringStart;
+    }
+    if (c == '@') {
+      return UrlState::ServerWithAt;
+    }
+    return tables.userinfo_[c] || c == '[' || c == ']' ? UrlState::Server : UrlState::Dead;
+  case UrlState::Path:
+    if (tables.url_[c]) {
+      return state;
+    }
+    return c == '?' ? UrlState::QueryStringStart
+                    : c == '#' ? UrlState::FragmentStart : UrlState::Dead;
+  case UrlState::QueryStringStart:
+  case UrlState::QueryString:
+    if (tables.url_[c] || c == '?') {
+      return UrlState::QueryString;
+    }
+    return c == '#' ? UrlState::FragmentStart : UrlState::Dead;
+  case UrlState::FragmentStart:
+    if (tables.url_[c] || c == '?') {
+      return UrlState::Fragment;
+    }
+    return c == '#' ? state : UrlState::Dead;
+  case UrlState::Fragment:
+    return tables.url_[c] || c == '?' || c == '#' ? state : UrlState::Dead;
+  default:
+    return UrlState::Dead;
+  }
+}
+
+// The first character of a URL, which http_parser reads in its s_req_spaces_before_url state.
+UrlState parseUrlStart(http_method method, uint8_t c) {
+  if (method == HTTP_CONNECT) {
+    return parseUrlChar(UrlState::ServerStart, c);
+  }
+  if (c == '/' || c == '*') {
+    return UrlState::Path;
+  }
+  return isAlpha(c) ? UrlState::Schema : UrlState::Dead;
+}
+
+bool equalsLowerCase(const char* begin, const char* end, absl::string_view lower) {
+  if (static_cast<size_t>(end - begin) != lower.size()) {
+    return false;
+  }
+  for (char c : lower) {
+    // Header fields only hold token characters, so setting 0x20 lower cases letters and leaves
+    // every other character that can match alone.
+    if ((*begin++ | 0x20) != c) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Match "HTTP/" at p, which holds the 'H'. http_parser reports anything else after the 'H' as a
+ * strict mode error.
+ * @return const char* the byte after the slash, end if more data is needed, or nullptr if the
+ *         bytes do not match.
+ */
+const char* parseProtocol(const char* p, const char* end) {
+  for (char c : absl::string_view("TTP/")) {
+    if (++p == end) {
+      return end;
+    }
+    if (*p != c) {
+      return nullptr;
+    }
+  }
+  return p + 1;
+}
+
+/**
+ * Read a decimal number of at most three digits, as http_parser does for versions and status
+ * codes.
+ * @return const char* the first byte after the digits, end if more are needed, or nullptr if the
+ *         number is too large.
+ */
+const char* parseNumber(const char* p, const char* end, uint16_t& value) {
+  for (; p != end && isNum(*p); p++) {
+    value = value * 10 + (*p - '0');
+    if (value > 999) {
+      return nullptr;
+    }
+  }
+  return p;
+}
+
+/**
+ * Read a content-length value, or as much of one as has arrived.
+ * @return bool false if the value is invalid.
+ */
+bool parseContentLength(const char* p, const char* end, uint64_t& length) {
+  length = *p++ - '0';
+  for (; p != end && isNum(*p); p++) {
+    length = length * 10 + (*p - '0');
+    if ((ULLONG_MAX - 10) / 10 < length) {
+      return false;
+    }
+  }
+  // Trailing spaces are allowed, but nothing else.
+  return std::all_of(p, end, [](char c) { return c == ' '; });
+}
+
+} // namespace
+
+ScanningParserImpl::ScanningParserImpl(MessageType type, ParserCallbacks& callbacks)
+    : type_(type), callbacks_(callbacks), content_length_(ULLONG_MAX) {}
+
+ParserStatus ScanningParserImpl::status() const {
+  if (error_ != HPE_OK) {
+    return ParserStatus::Error;
+  }
+  return paused_ ? ParserStatus::Paused : ParserStatus::Ok;
+}
+
+bool ScanningParserImpl::hasBody() const {
+  return (flags_ & F_CHUNKED) || (content_length_ > 0 && content_length_ != ULLONG_MAX);
+}
+
+size_t ScanningParserImpl::execute(const char* data, size_t length) {
+  if (status() != ParserStatus::Ok) {
+    return 0;
+  }
+  if (length == 0) {
+    return onEof();
+  }
+
+  const CharTables& tables = charTables();
+  const char* const end = data + length;
+  const char* p = data;
+  stop_ = false;
+  while (p != end && error_ == HPE_OK && !paused_ && !stop_) {
+    switch (state_) {
+    case State::Dead:
+      // After a message that does not keep the connection alive, http_parser only takes line
+      // breaks.
+      if (*p != '\r' && *p != '\n') {
+        fail(HPE_CLOSED_CONNECTION);
+        break;
+      }
+      p++;
+      if (++head_size_ > HTTP_MAX_HEADER_SIZE) {
+        fail(HPE_HEADER_OVERFLOW);
+      }
+      break;
+
+    case State::MessageStart:
+      p = startMessage(p, end);
+      break;
+
+    case State::StartLine:
+    case State::Header:
+      p = parseHead(p, end);
+      break;
+
+    case State::HeadersDone:
+      finishHead();
+      break;
+
+    case State::BodyIdentity: {
+      const size_t length = std::min<uint64_t>(remaining_, end - p);
+      remaining_ -= length;
+      callbacks_.onBody(p, length);
+      p += length;
+      if (remaining_ == 0) {
+        messageComplete();
+      }
+      break;
+    }
+
+    case State::BodyIdentityEof:
+      callbacks_.onBody(p, end - p);
+      p = end;
+      break;
+
+    case State::ChunkSizeStart:
+      if (tables.unhex_[static_cast<uint8_t>(*p)] == -1) {
+        fail(HPE_INVALID_CHUNK_SIZE);
+        break;
+      }
+      remaining_ = tables.unhex_[static_cast<uint8_t>(*p++)];
+      state_ = State::ChunkSize;
+      break;
+
+    case State::ChunkSize:
+      for (; p != end; p++) {
+        const int8_t digit = tables.unhex_[static_cast<uint8_t>(*p)];
+        if (digit == -1) {
+          if (*p == '\r') {
+            state_ = State::ChunkSizeAlmostDone;
+          } else if (*p == ';' || *p == ' ') {
+            state_ = State::ChunkParameters;
+          } else {
+            fail(HPE_INVALID_CHUNK_SIZE);
+            break;
+          }
+          p++;
+          break;
+        }
+        remaining_ = remaining_ * 16 + digit;
+        if ((ULLONG_MAX - 16) / 16 < remaining_) {
+          fail(HPE_INVALID_CONTENT_LENGTH);
+          break;
+        }
+      }
+      break;
+
+    case State::ChunkParameters: {
+      // Chunk extensions are ignored up to the CR.
+      const char* cr = static_cast<const char*>(memchr(p, '\r', end - p));
+      if (cr == nullptr) {
+        p = end;
+      } else {
+        p = cr + 1;
+        state_ = State::ChunkSizeAlmostDone;
+      }
+      break;
+    }
+
+    case State::ChunkSizeAlmostDone:
+      if (*p++ != '\n') {
+        fail(HPE_STRICT);
+        break;
+      }
+      if (remaining_ == 0) {
+        flags_ |= F_TRAILING;
+        value_open_ = false;
+        head_size_ = 0;
+        state_ = State::Header;
+      } else {
+        state_ = State::ChunkData;
+      }
+      break;
+
+    case State::ChunkData: {
+      const size_t length = std::min<uint64_t>(remaining_, end - p);
+      remaining_ -= length;
+      callbacks_.onBody(p, length);
+      p += length;
+      if (remaining_ == 0) {
+        state_ = State::ChunkDataAlmostDone;
+      }
+      break;
+    }
+
+    case State::ChunkDataAlmostDone:
+      if (*p++ != '\r') {
+        fail(HPE_STRICT);
+        break;
+      }
+      state_ = State::ChunkDataDone;
+      break;
+
+    case State::ChunkDataDone:
+      if (*p++ != '\n') {
+        fail(HPE_STRICT);
+        break;
+      }
+      state_ = State::ChunkSizeStart;
+      break;
+    }
+  }
+
+  return p - data;
+}
+
+size_t ScanningParserImpl::onEof() {
+  switch (state_) {
+  case State::MessageStart:
+  case State::Dead:
+    return 0;
+  case State::BodyIdentityEof:
+    callbacks_.onMessageComplete();
+    return 0;
+  default:
+    fail(HPE_INVALID_EOF_STATE);
+    return 1;
+  }
+}
+
+size_t ScanningParserImpl::fail(http_errno error) {
+  error_ = error;
+  return 0;
+}
+
+const char* ScanningParserImpl::startMessage(const char* p, const char* end) {
+  // Line breaks before a message are skipped, but count towards the size of its head.
+  const char* start = p;
+  while (p != end && (*p == '\r' || *p == '\n')) {
+    p++;
+  }
+  head_size_ += p - start;
+  if (head_size_ > HTTP_MAX_HEADER_SIZE) {
+    fail(HPE_HEADER_OVERFLOW);
+    return p;
+  }
+  if (p == end) {
+    return p;
+  }
+
+  if (type_ == MessageType::Request) {
+    if (!isMethodPrefix(absl::string_view(p, 1))) {
+      fail(HPE_INVALID_METHOD);
+      return p;
+    }
+  } else if (*p != 'H') {
+    fail(HPE_INVALID_CONSTANT);
+    return p;
+  }
+
+  flags_ = 0;
+  pending_flags_ = 0;
+  value_open_ = false;
+  content_length_ = ULLONG_MAX;
+  state_ = State::StartLine;
+  callbacks_.onMessageBegin();
+  return p;
+}
+
+const char* ScanningParserImpl::parseHead(const char* p, const char* end) {
+  if (partial_.empty()) {
+    p += parseLines(p, end);
+    if (incomplete_) {
+      partial_.assign(p, end);
+      partial_awaiting_ = awaiting_;
+      if (head_size_ + partial_.size() > HTTP_MAX_HEADER_SIZE) {
+        fail(HPE_HEADER_OVERFLOW);
+      }
+      return end;
+    }
+    return p;
+  }
+
+  // Only parse the line again once the data can move it along. Until then the data cannot make it
+  // invalid either, so nothing is lost by waiting.
+  if (!awaited(p, end)) {
+    partial_.append(p, end);
+    if (head_size_ + partial_.size() > HTTP_MAX_HEADER_SIZE) {
+      fail(HPE_HEADER_OVERFLOW);
+    }
+    return end;
+  }
+
+  const size_t buffered = partial_.size();
+  partial_.append(p, end);
+  const size_t parsed = parseLines(partial_.data(), partial_.data() + partial_.size());
+  if (parsed < buffered) {
+    // The line is still incomplete, or invalid.
+    partial_.erase(0, parsed);
+    partial_awaiting_ = awaiting_;
+    if (head_size_ + partial_.size() > HTTP_MAX_HEADER_SIZE) {
+      fail(HPE_HEADER_OVERFLOW);
+    }
+    return end;
+  }
+
+  // The rest is parsed from the caller's buffer, even if the next line is incomplete too.
+  partial_.clear();
+  return p + (parsed - buffered);
+}
+
+bool ScanningParserImpl::awaited(const char* p, const char* end) const {
+  switch (partial_awaiting_) {
+  case Awaiting::AnyByte:
+    return true;
+  case Awaiting::LineEnd:
+    return find<LineEnd>(p, end) != end;
+  case Awaiting::UrlEnd:
+    return find<UrlEnd>(p, end) != end;
+  case Awaiting::ValueEnd:
+    return find<ValueEnd>(p, end) != end;
+  case Awaiting::FieldEnd: {
+    const CharTables& tables = charTables();
+    return std::find_if(p, end, [&tables](char c) {
+             return !tables.token_[static_cast<uint8_t>(c)];
+           }) != end;
+  }
+  }
+
+  NOT_REACHED;
+}
+
+size_t ScanningParserImpl::parseLines(const char* begin, const char* end) {
+  incomplete_ = false;
+  const char* p = begin;
+  while (p != end) {
+    const size_t length = state_ == State::StartLine
+                              ? (type_ == MessageType::Request ? parseRequestLine(p, end)
+                                                               : parseStatusLine(p, end))
+                              : parseHeaderLine(p, end);
+    if (length == 0) {
+      incomplete_ = error_ == HPE_OK;
+      break;
+    }
+
+    p += length;
+    head_size_ += length;
+    if (head_size_ > HTTP_MAX_HEADER_SIZE) {
+      fail(HPE_HEADER_OVERFLOW);
+      break;
+    }
+    if (head_done_) {
+      head_done_ = false;
+      head_size_ = 0;
+      endHead();
+      break;
+    }
+  }
+  return p - begin;
+}
+
+size_t ScanningParserImpl::parseRequestLine(const char* begin, const char* end) {
+  awaiting_ = Awaiting::AnyByte;
+
+  // The method, which must be followed by a single space.
+  const char* p = begin;
+  while (p != end && (isAlpha(*p) || *p == '-')) {
+    p++;
+  }
+  const absl::string_view name(begin, p - begin);
+  if (p == end) {
+    return isMethodPrefix(name) ? 0 : fail(HPE_INVALID_METHOD);
+  }
+  const MethodName* method = nullptr;
+  if (*p == ' ') {
+    for (const MethodName& candidate : MethodNames) {
+      if (candidate.name_ == name) {
+        method = &candidate;
+        break;
+      }
+    }
+  }
+  if (method == nullptr) {
+    return fail(HPE_INVALID_METHOD);
+  }
+  method_ = method->method_;
+
+  // The URL, after any number of spaces.
+  while (++p != end && *p == ' ') {
+  }
+  if (p == end) {
+    return 0;
+  }
+  const char* url = p;
+  UrlState url_state = parseUrlStart(method_, *p);
+  if (url_state == UrlState::Dead) {
+    return fail(HPE_INVALID_URL);
+  }
+  for (p++;; p++) {
+    if (url_state >= UrlState::Path) {
+      p = find<UrlEnd>(p, end);
+      awaiting_ = Awaiting::UrlEnd;
+    }
+    if (p == end) {
+      return 0;
+    }
+    awaiting_ = Awaiting::AnyByte;
+    if (*p == ' ' || *p == '\r' || *p == '\n') {
+      if (url_state < UrlState::Server) {
+        return fail(HPE_INVALID_URL);
+      }
+      break;
+    }
+    url_state = parseUrlChar(url_state, *p);
+    if (url_state == UrlState::Dead) {
+      return fail(HPE_INVALID_URL);
+    }
+  }
+  const char* url_end = p;
+
+  if (*p == ' ') {
+    // The version, after any number of spaces.
+    while (++p != end && *p == ' ') {
+    }
+    if (p == end) {
+      return 0;
+    }
+    if (*p != 'H') {
+      return fail(HPE_INVALID_CONSTANT);
+    }
+    p = parseProtocol(p, end);
+    if (p == nullptr) {
+      return fail(HPE_STRICT);
+    }
+    if (p == end) {
+      return 0;
+    }
+    if (*p < '1' || *p > '9') {
+      return fail(HPE_INVALID_VERSION);
+    }
+    http_major_ = 0;
+    p = parseNumber(p, end, http_major_);
+    if (p == nullptr) {
+      return fail(HPE_INVALID_VERSION);
+    }
+    if (p == end) {
+      return 0;
+    }
+    if (*p != '.') {
+      return fail(HPE_INVALID_VERSION);
+    }
+    if (++p == end) {
+      return 0;
+    }
+    if (!isNum(*p)) {
+      return fail(HPE_INVALID_VERSION);
+    }
+    http_minor_ = 0;
+    p = parseNumber(p, end, http_minor_);
+    if (p == nullptr) {
+      return fail(HPE_INVALID_VERSION);
+    }
+    if (p == end) {
+      return 0;
+    }
+    if (*p != '\r' && *p != '\n') {
+      return fail(HPE_INVALID_VERSION);
+    }
+  } else {
+    // An HTTP/0.9 request line has no version.
+    http_major_ = 0;
+    http_minor_ = 9;
+  }
+
+  if (*p == '\r') {
+    if (++p == end) {
+      return 0;
+    }
+    if (*p != '\n') {
+      return fail(HPE_LF_EXPECTED);
+    }
+  }
+  p++;
+
+  callbacks_.onUrl(url, url_end - url);
+  state_ = State::Header;
+  return p - begin;
+}
+
+size_t ScanningParserImpl::parseStatusLine(const char* begin, const char* end) {
+  awaiting_ = Awaiting::AnyByte;
+
+  // The version. startMessage() checked the 'H'.
+  const char* p = parseProtocol(begin, end);
+  if (p == nullptr) {
+    return fail(HPE_STRICT);
+  }
+  if (p == end) {
+    return 0;
+  }
+  if (!isNum(*p)) {
+    return fail(HPE_INVALID_VERSION);
+  }
+  http_major_ = 0;
+  p = parseNumber(p, end, http_major_);
+  if (p == nullptr) {
+    return fail(HPE_INVALID_VERSION);
+  }
+  if (p == end) {
+    return 0;
+  }
+  if (*p != '.') {
+    return fail(HPE_INVALID_VERSION);
+  }
+  if (++p == end) {
+    return 0;
+  }
+  if (!isNum(*p)) {
+    return fail(HPE_INVALID_VERSION);
+  }
+  http_minor_ = 0;
+  p = parseNumber(p, end, http_minor_);
+  if (p == nullptr) {
+    return fail(HPE_INVALID_VERSION);
+  }
+  if (p == end) {
+    return 0;
+  }
+  if (*p != ' ') {
+    return fail(HPE_INVALID_VERSION);
+  }
+
+  // The status code, after any number of spaces.
+  while (++p != end && *p == ' ') {
+  }
+  if (p == end) {
+    return 0;
+  }
+  if (!isNum(*p)) {
+    return fail(HPE_INVALID_STATUS);
+  }
+  status_code_ = 0;
+  p = parseNumber(p, end, status_code_);
+  if (p == nullptr) {
+    return fail(HPE_INVALID_STATUS);
+  }
+  if (p == end) {
+    return 0;
+  }
+  if (*p != ' ' && *p != '\r' && *p != '\n') {
+    return fail(HPE_INVALID_STATUS);
+  }
+
+  // The reason phrase, which is not checked.
+  p = find<LineEnd>(p, end);
+  if (p == end) {
+    awaiting_ = Awaiting::LineEnd;
+    return 0;
+  }
+  if (*p == '\r') {
+    if (++p == end) {
+      return 0;
+    }
+    if (*p != '\n') {
+      return fail(HPE_STRICT);
+    }
+  }
+  p++;
+
+  state_ = State::Header;
+  return p - begin;
+}
+
+size_t ScanningParserImpl::parseHeaderLine(const char* begin, const char* end) {
+  awaiting_ = Awaiting::AnyByte;
+  const char* p = begin;
+
+  if (value_open_ && (*p == ' ' || *p == '\t')) {
+    // An obsolete line folding continues the last value, from the whitespace on. Whatever the
+    // value said about the message is forgotten, as http_parser goes back to a general header.
+    if (open_content_length_) {
+      return fail(HPE_INVALID_CONTENT_LENGTH);
+    }
+    pending_flags_ = 0;
+    const char* value_end = find<ValueEnd>(p, end);
+    if (value_end == end) {
+      awaiting_ = Awaiting::ValueEnd;
+      return 0;
+    }
+    const size_t length = parseValueEnd(value_end, end);
+    if (length == 0) {
+      return 0;
+    }
+    callbacks_.onHeaderValue(p, value_end - p);
+    return value_end + length - begin;
+  }
+
+  if (value_open_) {
+    value_open_ = false;
+    flags_ |= pending_flags_;
+    pending_flags_ = 0;
+  }
+
+  if (*p == '\r' || *p == '\n') {
+    // The end of the head.
+    if (*p == '\r') {
+      if (++p == end) {
+        return 0;
+      }
+      if (*p != '\n') {
+        return fail(HPE_STRICT);
+      }
+    }
+    head_done_ = true;
+    return p + 1 - begin;
+  }
+
+  // The field, which ends at the colon.
+  const CharTables& tables = charTables();
+  while (p != end && tables.token_[static_cast<uint8_t>(*p)]) {
+    p++;
+  }
+  if (p == end) {
+    awaiting_ = Awaiting::FieldEnd;
+    return 0;
+  }
+  if (*p != ':' || p == begin) {
+    return fail(HPE_INVALID_HEADER_TOKEN);
+  }
+  const char* field_end = p++;
+
+  HeaderKind kind = HeaderKind::General;
+  if (equalsLowerCase(begin, field_end, "connection") ||
+      equalsLowerCase(begin, field_end, "proxy-connection")) {
+    kind = HeaderKind::Connection;
+  } else if (equalsLowerCase(begin, field_end, "content-length")) {
+    kind = HeaderKind::ContentLength;
+  } else if (equalsLowerCase(begin, field_end, "transfer-encoding")) {
+    kind = HeaderKind::TransferEncoding;
+  } else if (equalsLowerCase(begin, field_end, "upgrade")) {
+    kind = HeaderKind::Upgrade;
+  }
+
+  // Whitespace before the value is dropped, including line breaks followed by more whitespace.
+  for (;;) {
+    if (p == end) {
+      return 0;
+    }
+    if (*p == ' ' || *p == '\t') {
+      p++;
+      continue;
+    }
+    if (*p != '\r' && *p != '\n') {
+      break;
+    }
+    if (*p == '\r') {
+      if (++p == end) {
+        return 0;
+      }
+      if (*p != '\n') {
+        return fail(HPE_STRICT);
+      }
+    }
+    if (++p == end) {
+      return 0;
+    }
+    if (*p != ' ' && *p != '\t') {
+      // The value is empty, which content-length may not be.
+      if (kind == HeaderKind::ContentLength) {
+        return fail(HPE_INVALID_CONTENT_LENGTH);
+      }
+      callbacks_.onHeaderField(begin, field_end - begin);
+      callbacks_.onHeaderValue(p, 0);
+      return p - begin;
+    }
+    p++;
+  }
+
+  const char* value = p;
+  const char* value_end = find<ValueEnd>(p, end);
+  const size_t length = value_end == end ? 0 : parseValueEnd(value_end, end);
+  if (length == 0) {
+    if (error_ == HPE_OK && kind == HeaderKind::ContentLength) {
+      // http_parser checks content-length a digit at a time, so it fails on a bad one without
+      // waiting for the rest of the line.
+      processValue(kind, value, value_end, false);
+    } else if (value_end == end) {
+      awaiting_ = Awaiting::ValueEnd;
+    }
+    return 0;
+  }
+  callbacks_.onHeaderField(begin, field_end - begin);
+  if (!processValue(kind, value, value_end, true)) {
+    return 0;
+  }
+  callbacks_.onHeaderValue(value, value_end - value);
+  value_open_ = true;
+  // http_parser takes trailing spaces as the end of a content-length, but not its last digit.
+  open_content_length_ = kind == HeaderKind::ContentLength && value_end[-1] != ' ';
+  return value_end + length - begin;
+}
+
+size_t ScanningParserImpl::parseValueEnd(const char* p, const char* end) {
+  if (*p == '\n') {
+    return 1;
+  }
+  if (*p != '\r') {
+    return fail(HPE_INVALID_HEADER_TOKEN);
+  }
+  if (p + 1 == end) {
+    return 0;
+  }
+  return p[1] == '\n' ? 2 : fail(HPE_LF_EXPECTED);
+}
+
+bool ScanningParserImpl::processValue(HeaderKind kind, const char* value, const char* end,
+                                      bool complete) {
+  switch (kind) {
+  case HeaderKind::General:
+    return true;
+
+  case HeaderKind::Upgrade:
+    flags_ |= F_UPGRADE;
+    return true;
+
+  case HeaderKind::ContentLength: {
+    if (!isNum(*value)) {
+      fail(HPE_INVALID_CONTENT_LENGTH);
+      return false;
+    }
+    if (flags_ & F_CONTENTLENGTH) {
+      fail(HPE_UNEXPECTED_CONTENT_LENGTH);
+      return false;
+    }
+    uint64_t length;
+    if (!parseContentLength(value, end, length)) {
+      fail(HPE_INVALID_CONTENT_LENGTH);
+      return false;
+    }
+    if (complete) {
+      flags_ |= F_CONTENTLENGTH;
+      content_length_ = length;
+    }
+    return true;
+  }
+
+  case HeaderKind::TransferEncoding: {
+    // Only a value of exactly "chunked", in any case and with trailing spaces, counts.
+    static const absl::string_view chunked = "chunked";
+    const char* p = value;
+    size_t i = 0;
+    for (; p != end && i < chunked.size() && (*p | 0x20) == chunked[i]; p++, i++) {
+    }
+    if (i == chunked.size() && std::all_of(p, end, [](char c) { return c == ' '; })) {
+      pending_flags_ |= F_CHUNKED;
+    }
+    return true;
+  }
+
+  case HeaderKind::Connection:
+    processConnectionValue(value, end);
+    return true;
+  }
+
+  NOT_REACHED;
+}
+
+void ScanningParserImpl::processConnectionValue(const char* value, const char* end) {
+  // http_parser looks for "keep-alive", "close" and "upgrade" among comma separated tokens, but
+  // gives up on the rest of the value at the first token that does not start with a token
+  // character.
+  enum class TokenState { Start, Matching, Matched, Other };
+  struct Candidate {
+    absl::string_view name_;
+    uint8_t flag_;
+  };
+  static const Candidate candidates[] = {{"keep-alive", F_CONNECTION_KEEP_ALIVE},
+                                         {"close", F_CONNECTION_CLOSE},
+                                         {"upgrade", F_CONNECTION_UPGRADE}};
+
+  const CharTables& tables = charTables();
+  TokenState state = TokenState::Start;
+  const Candidate* candidate = nullptr;
+  size_t index = 0;
+  for (const char* p = value; p != end; p++) {
+    const uint8_t c = *p | 0x20;
+    switch (state) {
+    case TokenState::Start: {
+      const TokenState previous = state;
+      // The first character of the value starts a token whatever it is. Later tokens may be
+      // preceded by whitespace.
+      state = p == value ? TokenState::Other : TokenState::Start;
+      for (const Candidate& name : candidates) {
+        if (c == static_cast<uint8_t>(name.name_[0])) {
+          candidate = &name;
+          index = 0;
+          state = TokenState::Matching;
+        }
+      }
+      if (state == previous && p != value && *p != ' ' && *p != '\t') {
+        if (c == ' ' || !tables.token_[c]) {
+          return;
+        }
+        state = TokenState::Other;
+      }
+      break;
+    }
+
+    case TokenState::Matching:
+      index++;
+      if (index >= candidate->name_.size() || c != static_cast<uint8_t>(candidate->name_[index])) {
+        state = TokenState::Other;
+      } else if (index == candidate->name_.size() - 1) {
+        state = TokenState::Matched;
+      }
+      break;
+
+    case TokenState::Matched:
+      if (*p == ',') {
+        flags_ |= candidate->flag_;
+        state = TokenState::Start;
+      } else if (*p != ' ') {
+        state = TokenState::Other;
+      }
+      break;
+
+    case TokenState::Other:
+      if (*p == ',') {
+        state = TokenState::Start;
+      }
+      break;
+    }
+  }
+
+  if (state == TokenState::Matched) {
+    pending_flags_ |= candidate->flag_;
+  }
+}
+
+void ScanningParserImpl::endHead() {
+  if (flags_ & F_TRAILING) {
+    messageComplete();
+    return;
+  }
+  if ((flags_ & F_CHUNKED) && (flags_ & F_CONTENTLENGTH)) {
+    fail(HPE_UNEXPECTED_CONTENT_LENGTH);
+    return;
+  }
+
+  if ((flags_ & F_UPGRADE) && (flags_ & F_CONNECTION_UPGRADE)) {
+    // A response only upgrades the connection with a 101.
+    upgrade_ = type_ == MessageType::Request || status_code_ == 101;
+  } else {
+    upgrade_ = type_ == MessageType::Request && method_ == HTTP_CONNECT;
+  }
+
+  state_ = State::HeadersDone;
+  if (callbacks_.onHeadersComplete() == 1) {
+    flags_ |= F_SKIPBODY;
+  }
+  // If the callback paused the parser, the body is dealt with once it resumes.
+  if (!paused_ && error_ == HPE_OK) {
+    finishHead();
+  }
+}
+
+void ScanningParserImpl::finishHead() {
+  if (upgrade_ && (method_ == HTTP_CONNECT || (flags_ & F_SKIPBODY) || !hasBody())) {
+    // The rest of the data belongs to another protocol.
+    messageComplete();
+  } else if (flags_ & F_SKIPBODY) {
+    messageComplete();
+  } else if (flags_ & F_CHUNKED) {
+    state_ = State::ChunkSizeStart;
+  } else if (content_length_ == 0) {
+    messageComplete();
+  } else if (content_length_ != ULLONG_MAX) {
+    remaining_ = content_length_;
+    state_ = State::BodyIdentity;
+  } else if (!needsEof()) {
+    messageComplete();
+  } else {
+    state_ = State::BodyIdentityEof;
+  }
+}
+
+void ScanningParserImpl::messageComplete() {
+  state_ = shouldKeepAlive() ? State::MessageStart : State::Dead;
+  stop_ = upgrade_;
+  callbacks_.onMessageComplete();
+}
+
+bool ScanningParserImpl::needsEof() const {
+  if (type_ == MessageType::Request) {
+    return false;
+  }
+  // RFC 2616 section 4.4.
+  if (status_code_ / 100 == 1 || status_code_ == 204 || status_code_ == 304 ||
+      (flags_ & F_SKIPBODY)) {
+    return false;
+  }
+  return !(flags_ & F_CHUNKED) && content_length_ == ULLONG_MAX;
+}
+
+bool ScanningParserImpl::shouldKeepAlive() const {
+  if (http_major_ > 0 && http_minor_ > 0) {
+    if (flags_ & F_CONNECTION_CLOSE) {
+      return false;
+    }
+  } else if (!(flags_ & F_CONNECTION_KEEP_ALIVE)) {
+    return false;
+  }
+  return !needsEof();
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
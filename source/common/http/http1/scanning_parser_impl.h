@@ -0,0 +1,145 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser that reads the head of a message a line at a time, finding the end of URLs and header
+ * values 16 or 32 bytes at a time with SSE2 or AVX2 where the build targets them, and a byte at a
+ * time otherwise. Header fields and values are handed to the callbacks whole, straight from the
+ * caller's buffer. A line that is split across calls to execute() is copied aside until the rest
+ * of it arrives.
+ *
+ * The parser follows http_parser as Envoy builds it, in strict mode and quirks included, so that
+ * switching parsers does not change which messages are accepted. The one exception is that
+ * control characters in header values are always rejected, where http_parser only notices some of
+ * them.
+ */
+class ScanningParserImpl : public Parser {
+public:
+  ScanningParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { paused_ = true; }
+  void resume() override { paused_ = false; }
+  ParserStatus status() const override;
+  const char* errorName() const override { return http_errno_name(error_); }
+  http_method method() const override { return method_; }
+  uint16_t statusCode() const override { return status_code_; }
+  uint16_t httpMajor() const override { return http_major_; }
+  uint16_t httpMinor() const override { return http_minor_; }
+  bool hasBody() const override;
+  bool terminatesInPlace() const override { return true; }
+
+private:
+  enum class State {
+    Dead,
+    MessageStart,
+    StartLine,
+    Header,
+    HeadersDone,
+    BodyIdentity,
+    BodyIdentityEof,
+    ChunkSizeStart,
+    ChunkSize,
+    ChunkParameters,
+    ChunkSizeAlmostDone,
+    ChunkData,
+    ChunkDataAlmostDone,
+    ChunkDataDone
+  };
+
+  // What the line in partial_ waits for before it is worth parsing again. Until a byte of the
+  // kind arrives, more data can neither complete the line nor make it invalid.
+  enum class Awaiting { AnyByte, LineEnd, UrlEnd, ValueEnd, FieldEnd };
+
+  // The headers whose values http_parser looks into.
+  enum class HeaderKind { General, Connection, ContentLength, TransferEncoding, Upgrade };
+
+  const char* startMessage(const char* p, const char* end);
+  const char* parseHead(const char* p, const char* end);
+  /**
+   * @return bool whether [p, end) holds what the line in partial_ is waiting for.
+   */
+  bool awaited(const char* p, const char* end) const;
+  /**
+   * Parse as many whole lines of the head as [begin, end) holds.
+   * @return size_t the number of bytes parsed. If the last line is incomplete, incomplete_ is set.
+   */
+  size_t parseLines(const char* begin, const char* end);
+  /**
+   * Each of these parses one line starting at begin.
+   * @return size_t the length of the line, or 0 if it is incomplete or invalid.
+   */
+  size_t parseRequestLine(const char* begin, const char* end);
+  size_t parseStatusLine(const char* begin, const char* end);
+  size_t parseHeaderLine(const char* begin, const char* end);
+  /**
+   * Parse the line break that ends a header value at p.
+   * @return size_t the length of the line break, or 0 if it is incomplete or invalid.
+   */
+  size_t parseValueEnd(const char* p, const char* end);
+  /**
+   * Apply what a header value says about the message, as http_parser does while it reads it.
+   * @param complete supplies whether [value, end) is the whole value. If not, it is only checked.
+   * @return bool false if the value is invalid.
+   */
+  bool processValue(HeaderKind kind, const char* value, const char* end, bool complete);
+  void processConnectionValue(const char* value, const char* end);
+  void endHead();
+  void finishHead();
+  void messageComplete();
+  bool needsEof() const;
+  bool shouldKeepAlive() const;
+  size_t fail(http_errno error);
+  size_t onEof();
+
+  const MessageType type_;
+  ParserCallbacks& callbacks_;
+  State state_{State::MessageStart};
+  http_errno error_{HPE_OK};
+  bool paused_{};
+  // Set when an upgraded message completes. http_parser stops there, leaving the rest of the data
+  // to whatever protocol follows.
+  bool stop_{};
+
+  // The unparsed start of a line that the last call to execute() ended in the middle of.
+  std::string partial_;
+  Awaiting partial_awaiting_{Awaiting::AnyByte};
+  // Set by parseLines() and the line parsers when they run out of data.
+  bool incomplete_{};
+  Awaiting awaiting_{Awaiting::AnyByte};
+  // Bytes of head read so far, which http_parser caps at HTTP_MAX_HEADER_SIZE.
+  uint32_t head_size_{};
+  bool head_done_{};
+
+  // Set after a header line with a value, which a line starting with whitespace continues.
+  bool value_open_{};
+  // Set after a content-length value that a continuation line would make invalid.
+  bool open_content_length_{};
+  // The http_parser flags that the last header value sets once no continuation line follows it.
+  uint8_t pending_flags_{};
+
+  http_method method_{};
+  uint16_t status_code_{};
+  uint16_t http_major_{};
+  uint16_t http_minor_{};
+  uint64_t content_length_;
+  uint64_t remaining_{};
+  // http_parser's flags for the message, from enum flags.
+  uint8_t flags_{};
+  bool upgrade_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,138 @@
+#include "common/http/http2/arena.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+const size_t Arena::CHUNK_SIZE;
+
+Arena::Arena() {
+  mem_.mem_user_data = this;
+  mem_.malloc = [](size_t size, void* arena) -> void* {
+    return static_cast<Arena*>(arena)->allocate(size);
+  };
+  mem_.free = [](void* ptr, void* arena) -> void { static_cast<Arena*>(arena)->release(ptr); };
+  mem_.calloc = [](size_t count, size_t size, void* arena) -> void* {
+    return static_cast<Arena*>(arena)->allocateZeroed(count, size);
+  };
+  mem_.realloc = [](void* ptr, size_t size, void* arena) -> void* {
+    return static_cast<Arena*>(arena)->reallocate(ptr, size);
+  };
+}
+
+Arena::~Arena() {
+  for (char* chunk : chunks_) {
+    ::free(chunk);
+  }
+}
+
+uint32_t Arena::sizeClass(size_t size) {
+  const size_t block_size = size + sizeof(BlockHeader);
+  uint32_t size_class = 0;
+  while (size_class < SIZE_CLASSES && blockSize(size_class) < block_size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+Arena::BlockHeader* Arena::carve(uint32_t size_class) {
+  BlockHeader* block = free_blocks_[size_class];
+  if (block != nullptr) {
+    free_blocks_[size_class] = block->next_free_;
+    return block;
+  }
+
+  const size_t block_size = blockSize(size_class);
+  if (static_cast<size_t>(chunk_end_ - chunk_free_) < block_size) {
+    // The rest of the current chunk, less than a block, is left unused.
+    char* chunk = static_cast<char*>(::malloc(CHUNK_SIZE));
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    chunks_.push_back(chunk);
+    chunk_free_ = chunk;
+    chunk_end_ = chunk + CHUNK_SIZE;
+  }
+
+  block = reinterpret_cast<BlockHeader*>(chunk_free_);
+  chunk_free_ += block_size;
+  return block;
+}
+
+void* Arena::allocate(size_t size) {
+  const uint32_t size_class = sizeClass(size);
+  BlockHeader* block;
+  if (size_class == LARGE_BLOCK) {
+    block = static_cast<BlockHeader*>(::malloc(size + sizeof(BlockHeader)));
+  } else {
+    block = carve(size_class);
+  }
+  if (block == nullptr) {
+    return nullptr;
+  }
+
+  block->size_class_ = size_class;
+  return block + 1;
+}
+
+void* Arena::allocateZeroed(size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    return nullptr;
+  }
+  void* ptr = allocate(count * size);
+  if (ptr != nullptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void* Arena::reallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return allocate(size);
+  }
+
+  BlockHeader* block = header(ptr);
+  if (block->size_class_ == LARGE_BLOCK) {
+    // Stay with malloc, even if the block shrinks enough to fit a size class.
+    block = static_cast<BlockHeader*>(::realloc(block, size + sizeof(BlockHeader)));
+    return block != nullptr ? block + 1 : nullptr;
+  }
+
+  const size_t usable_size = blockSize(block->size_class_) - sizeof(BlockHeader);
+  if (size <= usable_size) {
+    return ptr;
+  }
+  void* new_ptr = allocate(size);
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  memcpy(new_ptr, ptr, usable_size);
+  release(ptr);
+  return new_ptr;
+}
+
+void Arena::release(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  BlockHeader* block = header(ptr);
+  const uint32_t size_class = block->size_class_;
+  if (size_class == LARGE_BLOCK) {
+    ::free(block);
+    return;
+  }
+
+  ASSERT(size_class < SIZE_CLASSES);
+  block->next_free_ = free_blocks_[size_class];
+  free_blocks_[size_class] = block;
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
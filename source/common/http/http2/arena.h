@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nghttp2/nghttp2.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Memory for one nghttp2 session, handed to nghttp2 as an nghttp2_mem. Blocks of up to 4KiB are
+ * carved out of CHUNK_SIZE chunks and recycled through per size class free lists, so that the
+ * HPACK strings, frames and stream state that nghttp2 allocates and frees on every request stay
+ * within the connection's chunks rather than going through malloc. Larger blocks use malloc
+ * directly.
+ *
+ * The arena is shared by the connection and by the header maps that still reference its HPACK
+ * strings, and releases its chunks when the last of them goes away. It is not thread safe, which
+ * is fine as both live on the connection's worker.
+ */
+class Arena {
+public:
+  Arena();
+  ~Arena();
+
+  /**
+   * @return nghttp2_mem* allocator callbacks for nghttp2_session_client_new3() or
+   *         nghttp2_session_server_new3().
+   */
+  nghttp2_mem* mem() { return &mem_; }
+
+  void* allocate(size_t size);
+  void* allocateZeroed(size_t count, size_t size);
+  void* reallocate(void* ptr, size_t size);
+  void release(void* ptr);
+
+  /**
+   * @return uint64_t the bytes held in chunks, whether in use or free.
+   */
+  uint64_t chunkBytes() const { return chunks_.size() * CHUNK_SIZE; }
+
+  static const size_t CHUNK_SIZE = 64 * 1024;
+
+private:
+  // Every block starts with a header holding its size class while in use, or the next free block
+  // of its class while free. It is padded so that the memory after it has the alignment that
+  // malloc() guarantees.
+  union alignas(alignof(std::max_align_t)) BlockHeader {
+    uint32_t size_class_;
+    BlockHeader* next_free_;
+  };
+
+  // Block sizes, including the header, are 64 << size class.
+  static const uint32_t SIZE_CLASSES = 7;
+  static const uint32_t LARGE_BLOCK = SIZE_CLASSES;
+
+  static uint32_t sizeClass(size_t size);
+  static size_t blockSize(uint32_t size_class) { return static_cast<size_t>(64) << size_class; }
+  static BlockHeader* header(void* ptr) { return static_cast<BlockHeader*>(ptr) - 1; }
+
+  BlockHeader* carve(uint32_t size_class);
+
+  nghttp2_mem mem_;
+  std::array<BlockHeader*, SIZE_CLASSES> free_blocks_{};
+  std::vector<char*> chunks_;
+  char* chunk_free_{};
+  char* chunk_end_{};
+};
+
+typedef std::shared_ptr<Arena> ArenaSharedPtr;
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,64 @@
+#include "common/http/http2/bdp_estimator.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+const uint32_t BdpEstimator::SHRINK_SAMPLES;
+
+BdpEstimator::BdpEstimator(uint32_t min_window, uint32_t max_window,
+                           MonotonicTimeSource& time_source)
+    : min_window_(min_window), max_window_(std::max(min_window, max_window)),
+      time_source_(time_source), window_(min_window) {}
+
+bool BdpEstimator::onData(uint64_t bytes) {
+  if (ping_outstanding_) {
+    sample_bytes_ += bytes;
+    return false;
+  }
+
+  ping_outstanding_ = true;
+  sample_start_ = time_source_.currentTime();
+  sample_bytes_ = bytes;
+  return true;
+}
+
+bool BdpEstimator::onPingAck() {
+  if (!ping_outstanding_) {
+    return false;
+  }
+  ping_outstanding_ = false;
+
+  // Round trips are counted as at least a microsecond so that every sample has a bandwidth.
+  const int64_t rtt = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(
+                                               time_source_.currentTime() - sample_start_)
+                                               .count());
+  const double bandwidth = static_cast<double>(sample_bytes_) / rtt;
+
+  uint32_t window = window_;
+  if (3 * sample_bytes_ >= 2 * static_cast<uint64_t>(window_) && bandwidth > max_bandwidth_) {
+    max_bandwidth_ = bandwidth;
+    low_samples_ = 0;
+    window = static_cast<uint32_t>(std::min<uint64_t>(max_window_, 2 * sample_bytes_));
+  } else if (4 * sample_bytes_ < window_) {
+    if (++low_samples_ == SHRINK_SAMPLES) {
+      low_samples_ = 0;
+      window = std::max(min_window_, window_ / 2);
+      // The bandwidth seen with the larger window must not stop this one from growing again.
+      max_bandwidth_ = 0;
+    }
+  } else {
+    low_samples_ = 0;
+  }
+
+  const bool changed = window != window_;
+  window_ = window;
+  return changed;
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+#include "envoy/common/time.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Estimates the bandwidth-delay product of a connection from the data received during the round
+ * trip of a PING, and picks the flow-control window to advertise from it. A sample starts with the
+ * first data received while no PING is outstanding, which sends one, and ends when the PING is
+ * acknowledged. When a sample fills two thirds of the window at a higher bandwidth than any before
+ * it, the window was the bottleneck and grows to twice the sample. When SHRINK_SAMPLES samples in
+ * a row use less than a quarter of the window, it halves. The window stays between the minimum and
+ * maximum it is constructed with.
+ */
+class BdpEstimator {
+public:
+  BdpEstimator(uint32_t min_window, uint32_t max_window, MonotonicTimeSource& time_source);
+
+  /**
+   * @return uint32_t the window to advertise for the connection and for each stream.
+   */
+  uint32_t window() const { return window_; }
+
+  /**
+   * Account for received data.
+   * @param bytes supplies the number of bytes received.
+   * @return bool whether to send a PING to start a sample.
+   */
+  bool onData(uint64_t bytes);
+
+  /**
+   * End the current sample on the acknowledgement of its PING.
+   * @return bool whether window() changed.
+   */
+  bool onPingAck();
+
+  static const uint32_t SHRINK_SAMPLES = 4;
+
+private:
+  const uint32_t min_window_;
+  const uint32_t max_window_;
+  MonotonicTimeSource& time_source_;
+  uint32_t window_;
+  MonotonicTime sample_start_;
+  uint64_t sample_bytes_{};
+  // In bytes per microsecond.
+  double max_bandwidth_{};
+  uint32_t low_samples_{};
+  bool ping_outstanding_{};
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
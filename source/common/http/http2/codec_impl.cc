@@ -1,6 +1,7 @@
 #include "common/http/http2/codec_impl.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -22,6 +23,10 @@ namespace Envoy {
 namespace Http {
 namespace Http2 {
 
+// The opaque data of the PINGs that sample the bandwidth-delay product, which tells their
+// acknowledgements apart from those of any other PING.
+const uint8_t BDP_PING_DATA[8] = {'e', 'n', 'v', 'o', 'y', 'b', 'd', 'p'};
+
 bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderString& value,
                                           HeaderString& cookies) {
   if (key != Headers::get().Cookie.get().c_str()) {
@@ -179,12 +184,45 @@ void ConnectionImpl::StreamImpl::pendingSendBufferLowWatermark() {
   runLowWatermarkCallbacks();
 }
 
-void ConnectionImpl::StreamImpl::saveHeader(HeaderString&& name, HeaderString&& value) {
-  if (!Utility::reconstituteCrumbledCookies(name, value, cookies_)) {
-    headers_->addViaMove(std::move(name), std::move(value));
+void ConnectionImpl::StreamImpl::saveHeader(nghttp2_rcbuf* name, nghttp2_rcbuf* value) {
+  // nghttp2 null terminates the strings it decodes, so they can be referenced where they are.
+  const nghttp2_vec name_buffer = nghttp2_rcbuf_get_buf(name);
+  const nghttp2_vec value_buffer = nghttp2_rcbuf_get_buf(value);
+  HeaderString name_string;
+  name_string.setReference(reinterpret_cast<const char*>(name_buffer.base), name_buffer.len);
+  HeaderString value_string;
+  value_string.setReference(reinterpret_cast<const char*>(value_buffer.base), value_buffer.len);
+  if (!Utility::reconstituteCrumbledCookies(name_string, value_string, cookies_)) {
+    retainHeaderBuffer(name);
+    retainHeaderBuffer(value);
+    headers_->addViaMove(std::move(name_string), std::move(value_string));
+  }
+}
+
+void ConnectionImpl::StreamImpl::retainHeaderBuffer(nghttp2_rcbuf* buffer) {
+  if (nghttp2_rcbuf_is_static(buffer)) {
+    // Names from the HPACK static table are never freed.
+    return;
+  }
+
+  if (!header_buffers_) {
+    header_buffers_ = std::make_shared<HeaderBuffers>(parent_.arena_);
+    headers_->retain(header_buffers_);
+  }
+  header_buffers_->add(buffer);
+}
+
+ConnectionImpl::HeaderBuffers::~HeaderBuffers() {
+  for (nghttp2_rcbuf* buffer : buffers_) {
+    nghttp2_rcbuf_decref(buffer);
   }
 }
 
+void ConnectionImpl::HeaderBuffers::add(nghttp2_rcbuf* buffer) {
+  nghttp2_rcbuf_incref(buffer);
+  buffers_.push_back(buffer);
+}
+
 void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
   std::vector<nghttp2_nv> final_headers;
   buildHeaders(final_headers, trailers);
@@ -220,9 +258,8 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
   // https://nghttp2.org/documentation/types.html#c.nghttp2_send_data_callback
   static const uint64_t FRAME_HEADER_SIZE = 9;
 
-  Buffer::OwnedImpl output(framehd, FRAME_HEADER_SIZE);
-  output.move(pending_send_data_, length);
-  parent_.connection_.write(output, false);
+  parent_.write_buffer_.add(framehd, FRAME_HEADER_SIZE);
+  parent_.write_buffer_.move(pending_send_data_, length);
   return 0;
 }
 
@@ -306,8 +343,9 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
   data.drain(data.length());
 
-  // Decoding incoming frames can generate outbound frames so flush pending.
-  sendPendingFrames();
+  // Decoding incoming frames can generate outbound frames so flush pending. This is not deferred
+  // even when coalescing writes, as a GOAWAY for a protocol error must fail the dispatch.
+  flushPendingFrames();
 }
 
 ConnectionImpl::StreamImpl* ConnectionImpl::getStream(int32_t stream_id) {
@@ -326,6 +364,12 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   } else {
     stream->unconsumed_bytes_ += len;
   }
+
+  if (bdp_estimator_ && bdp_estimator_->onData(len)) {
+    // Start a sample. The PING is sent with the frames that dispatch() flushes.
+    int rc = nghttp2_submit_ping(session_, NGHTTP2_FLAG_NONE, BDP_PING_DATA);
+    ASSERT(rc == 0);
+  }
   return 0;
 }
 
@@ -335,14 +379,24 @@ void ConnectionImpl::goAway() {
                                  NGHTTP2_NO_ERROR, nullptr, 0);
   ASSERT(rc == 0);
 
-  sendPendingFrames();
+  // The caller may close the connection next, so this is never deferred.
+  flushPendingFrames();
 }
 
 void ConnectionImpl::shutdownNotice() {
   int rc = nghttp2_submit_shutdown_notice(session_);
   ASSERT(rc == 0);
 
-  sendPendingFrames();
+  flushPendingFrames();
+}
+
+bool ConnectionImpl::wantsToWrite() {
+  // Frames that are only waiting for the end of the event loop iteration are written now, so that
+  // this reflects what nghttp2 cannot send yet, such as data waiting for window.
+  if (flush_scheduled_) {
+    flushPendingFrames();
+  }
+  return nghttp2_session_want_write(session_);
 }
 
 int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
@@ -357,6 +411,12 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
     return 0;
   }
 
+  if (frame->hd.type == NGHTTP2_PING && (frame->hd.flags & NGHTTP2_FLAG_ACK) && bdp_estimator_ &&
+      memcmp(frame->ping.opaque_data, BDP_PING_DATA, sizeof(BDP_PING_DATA)) == 0) {
+    onBdpPingAck();
+    return 0;
+  }
+
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     return 0;
@@ -428,6 +488,7 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
     }
 
     stream->headers_.reset();
+    stream->header_buffers_.reset();
     break;
   }
   case NGHTTP2_DATA: {
@@ -458,6 +519,7 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   // In all cases however it will attempt to send a GOAWAY frame with an error status. If we see
   // an outgoing frame of this type, we will return an error code so that we can abort execution.
   ENVOY_CONN_LOG(trace, "sent frame type={}", connection_, static_cast<uint64_t>(frame->hd.type));
+  write_buffer_frames_++;
   switch (frame->hd.type) {
   case NGHTTP2_GOAWAY: {
     if (frame->goaway.error_code != NGHTTP2_NO_ERROR) {
@@ -504,8 +566,8 @@ int ConnectionImpl::onInvalidFrame(int32_t stream_id, int error_code) {
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer(data, length);
-  connection_.write(buffer, false);
+  // Frames are collected and written to the connection together once nghttp2 has sent them all.
+  write_buffer_.add(data, length);
   return length;
 }
 
@@ -544,8 +606,8 @@ int ConnectionImpl::onStreamClose(int32_t stream_id, uint32_t error_code) {
   return 0;
 }
 
-int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
-                               HeaderString&& value) {
+int ConnectionImpl::saveHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name,
+                               nghttp2_rcbuf* value) {
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     // We have seen 1 or 2 crashes where we get a headers callback but there is no associated
@@ -558,7 +620,7 @@ int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
     return 0;
   }
 
-  stream->saveHeader(std::move(name), std::move(value));
+  stream->saveHeader(name, value);
   if (stream->headers_->byteSize() > StreamImpl::MAX_HEADER_SIZE) {
     // This will cause the library to reset/close the stream.
     stats_.header_overflow_.inc();
@@ -573,7 +635,41 @@ void ConnectionImpl::sendPendingFrames() {
     return;
   }
 
+  if (flush_timer_) {
+    // Frames from every stream that encodes during this event loop iteration go out together.
+    if (!flush_scheduled_) {
+      flush_timer_->enableTimer(std::chrono::milliseconds(0));
+      flush_scheduled_ = true;
+    }
+    return;
+  }
+
+  flushPendingFrames();
+}
+
+void ConnectionImpl::onFlushTimer() {
+  flush_scheduled_ = false;
+  try {
+    flushPendingFrames();
+  } catch (const CodecProtocolException& e) {
+    ENVOY_CONN_LOG(debug, "deferred flush error: {}", connection_, e.what());
+    connection_.close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void ConnectionImpl::flushPendingFrames() {
+  if (dispatching_ || connection_.state() == Network::Connection::State::Closed) {
+    return;
+  }
+
+  if (flush_scheduled_) {
+    flush_timer_->disableTimer();
+    flush_scheduled_ = false;
+  }
+
   int rc = nghttp2_session_send(session_);
+  // Write whatever was sent before any error, so that frames are not reordered or lost.
+  writeFrames();
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
     throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
@@ -598,10 +694,49 @@ void ConnectionImpl::sendPendingFrames() {
         stream->resetStreamWorker(stream->deferred_reset_.value());
       }
     }
-    sendPendingFrames();
+    flushPendingFrames();
   }
 }
 
+void ConnectionImpl::writeFrames() {
+  if (write_buffer_.length() == 0) {
+    return;
+  }
+
+  stats_.frames_per_write_.recordValue(write_buffer_frames_);
+  write_buffer_frames_ = 0;
+  // The write can reenter the codec, which must find the buffer empty.
+  Buffer::OwnedImpl output;
+  output.move(write_buffer_);
+  connection_.write(output, false);
+}
+
+void ConnectionImpl::onBdpPingAck() {
+  const uint32_t previous_window = bdp_estimator_->window();
+  if (!bdp_estimator_->onPingAck()) {
+    return;
+  }
+
+  const uint32_t window = bdp_estimator_->window();
+  ENVOY_CONN_LOG(debug, "adjusting window size from {} to {}", connection_, previous_window,
+                 window);
+  if (window > previous_window) {
+    stats_.window_increase_.inc();
+  } else {
+    stats_.window_decrease_.inc();
+  }
+  stats_.window_size_.recordValue(window);
+
+  // A new initial window size applies to the streams that are already open as well. The connection
+  // window has no such setting, so its local size is changed, which nghttp2 reflects in the
+  // WINDOW_UPDATE frames it sends.
+  nghttp2_settings_entry iv = {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, window};
+  int rc = nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, &iv, 1);
+  ASSERT(rc == 0);
+  rc = nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0, window);
+  ASSERT(rc == 0);
+}
+
 void ConnectionImpl::sendSettings(const Http2Settings& http2_settings, bool disable_push) {
   ASSERT(http2_settings.hpack_table_size_ <= Http2Settings::MAX_HPACK_TABLE_SIZE);
   ASSERT(Http2Settings::MIN_MAX_CONCURRENT_STREAMS <= http2_settings.max_concurrent_streams_ &&
@@ -614,6 +749,15 @@ void ConnectionImpl::sendSettings(const Http2Settings& http2_settings, bool disa
          http2_settings.initial_connection_window_size_ <=
              Http2Settings::MAX_INITIAL_CONNECTION_WINDOW_SIZE);
 
+  // Adaptive windows start at their smallest size, whatever the initial sizes are.
+  const uint32_t stream_window_size =
+      bdp_estimator_ ? bdp_estimator_->window() : http2_settings.initial_stream_window_size_;
+  const uint32_t connection_window_size =
+      bdp_estimator_ ? bdp_estimator_->window() : http2_settings.initial_connection_window_size_;
+  if (bdp_estimator_) {
+    stats_.window_size_.recordValue(bdp_estimator_->window());
+  }
+
   std::vector<nghttp2_settings_entry> iv;
 
   if (http2_settings.hpack_table_size_ != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
@@ -628,11 +772,10 @@ void ConnectionImpl::sendSettings(const Http2Settings& http2_settings, bool disa
                    http2_settings.max_concurrent_streams_);
   }
 
-  if (http2_settings.initial_stream_window_size_ != NGHTTP2_INITIAL_WINDOW_SIZE) {
-    iv.push_back(
-        {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, http2_settings.initial_stream_window_size_});
+  if (stream_window_size != NGHTTP2_INITIAL_WINDOW_SIZE) {
+    iv.push_back({NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, stream_window_size});
     ENVOY_CONN_LOG(debug, "setting stream-level initial window size to {}", connection_,
-                   http2_settings.initial_stream_window_size_);
+                   stream_window_size);
   }
 
   if (disable_push) {
@@ -652,11 +795,11 @@ void ConnectionImpl::sendSettings(const Http2Settings& http2_settings, bool disa
   }
 
   // Increase connection window size up to our default size.
-  if (http2_settings.initial_connection_window_size_ != NGHTTP2_INITIAL_CONNECTION_WINDOW_SIZE) {
+  if (connection_window_size != NGHTTP2_INITIAL_CONNECTION_WINDOW_SIZE) {
     ENVOY_CONN_LOG(debug, "updating connection-level initial window size to {}", connection_,
-                   http2_settings.initial_connection_window_size_);
+                   connection_window_size);
     int rc = nghttp2_submit_window_update(session_, NGHTTP2_FLAG_NONE, 0,
-                                          http2_settings.initial_connection_window_size_ -
+                                          connection_window_size -
                                               NGHTTP2_INITIAL_CONNECTION_WINDOW_SIZE);
     ASSERT(rc == 0);
   }
@@ -683,18 +826,10 @@ ConnectionImpl::Http2Callbacks::Http2Callbacks() {
         return static_cast<ConnectionImpl*>(user_data)->onBeginHeaders(frame);
       });
 
-  nghttp2_session_callbacks_set_on_header_callback(
-      callbacks_,
-      [](nghttp2_session*, const nghttp2_frame* frame, const uint8_t* raw_name, size_t name_length,
-         const uint8_t* raw_value, size_t value_length, uint8_t, void* user_data) -> int {
-
-        // TODO PERF: Can reference count here to avoid copies.
-        HeaderString name;
-        name.setCopy(reinterpret_cast<const char*>(raw_name), name_length);
-        HeaderString value;
-        value.setCopy(reinterpret_cast<const char*>(raw_value), value_length);
-        return static_cast<ConnectionImpl*>(user_data)->onHeader(frame, std::move(name),
-                                                                 std::move(value));
+  nghttp2_session_callbacks_set_on_header_callback2(
+      callbacks_, [](nghttp2_session*, const nghttp2_frame* frame, nghttp2_rcbuf* name,
+                     nghttp2_rcbuf* value, uint8_t, void* user_data) -> int {
+        return static_cast<ConnectionImpl*>(user_data)->onHeader(frame, name, value);
       });
 
   nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
@@ -753,8 +888,8 @@ ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection,
                                            Http::ConnectionCallbacks& callbacks,
                                            Stats::Scope& stats, const Http2Settings& http2_settings)
     : ConnectionImpl(connection, stats, http2_settings), callbacks_(callbacks) {
-  nghttp2_session_client_new2(&session_, http2_callbacks_.callbacks(), base(),
-                              http2_options_.options());
+  nghttp2_session_client_new3(&session_, http2_callbacks_.callbacks(), base(),
+                              http2_options_.options(), arena_->mem());
   sendSettings(http2_settings, true);
 }
 
@@ -785,20 +920,20 @@ int ClientConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   return 0;
 }
 
-int ClientConnectionImpl::onHeader(const nghttp2_frame* frame, HeaderString&& name,
-                                   HeaderString&& value) {
+int ClientConnectionImpl::onHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name,
+                                   nghttp2_rcbuf* value) {
   // The client code explicitly does not currently suport push promise.
   ASSERT(frame->hd.type == NGHTTP2_HEADERS);
   ASSERT(frame->headers.cat == NGHTTP2_HCAT_RESPONSE || frame->headers.cat == NGHTTP2_HCAT_HEADERS);
-  return saveHeader(frame, std::move(name), std::move(value));
+  return saveHeader(frame, name, value);
 }
 
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            Http::ServerConnectionCallbacks& callbacks,
                                            Stats::Scope& scope, const Http2Settings& http2_settings)
     : ConnectionImpl(connection, scope, http2_settings), callbacks_(callbacks) {
-  nghttp2_session_server_new2(&session_, http2_callbacks_.callbacks(), base(),
-                              http2_options_.options());
+  nghttp2_session_server_new3(&session_, http2_callbacks_.callbacks(), base(),
+                              http2_options_.options(), arena_->mem());
   sendSettings(http2_settings, false);
 }
 
@@ -827,12 +962,12 @@ int ServerConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   return 0;
 }
 
-int ServerConnectionImpl::onHeader(const nghttp2_frame* frame, HeaderString&& name,
-                                   HeaderString&& value) {
+int ServerConnectionImpl::onHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name,
+                                   nghttp2_rcbuf* value) {
   // For a server connection, we should never get push promise frames.
   ASSERT(frame->hd.type == NGHTTP2_HEADERS);
   ASSERT(frame->headers.cat == NGHTTP2_HCAT_REQUEST || frame->headers.cat == NGHTTP2_HCAT_HEADERS);
-  return saveHeader(frame, std::move(name), std::move(value));
+  return saveHeader(frame, name, value);
 }
 
 } // namespace Http2
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
 #include "envoy/http/codec.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/stats.h"
@@ -16,8 +17,11 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/linked_object.h"
 #include "common/common/logger.h"
+#include "common/common/utility.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http2/arena.h"
+#include "common/http/http2/bdp_estimator.h"
 
 #include "absl/types/optional.h"
 #include "nghttp2/nghttp2.h"
@@ -36,21 +40,25 @@ const std::string CLIENT_MAGIC_PREFIX = "PRI * HTTP/2";
  * All stats for the HTTP/2 codec. @see stats_macros.h
  */
 // clang-format off
-#define ALL_HTTP2_CODEC_STATS(COUNTER)                                                             \
+#define ALL_HTTP2_CODEC_STATS(COUNTER, HISTOGRAM)                                                  \
   COUNTER(header_overflow)                                                                         \
   COUNTER(headers_cb_no_stream)                                                                    \
   COUNTER(rx_messaging_error)                                                                      \
   COUNTER(rx_reset)                                                                                \
   COUNTER(too_many_header_frames)                                                                  \
   COUNTER(trailers)                                                                                \
-  COUNTER(tx_reset)
+  COUNTER(tx_reset)                                                                                \
+  COUNTER(window_decrease)                                                                         \
+  COUNTER(window_increase)                                                                         \
+  HISTOGRAM(frames_per_write)                                                                      \
+  HISTOGRAM(window_size)
 // clang-format on
 
 /**
  * Wrapper struct for the HTTP/2 codec stats. @see stats_macros.h
  */
 struct CodecStats {
-  ALL_HTTP2_CODEC_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_HTTP2_CODEC_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class Utility {
@@ -73,10 +81,22 @@ class ConnectionImpl : public virtual Connection, protected Logger::Loggable<Log
 public:
   ConnectionImpl(Network::Connection& connection, Stats::Scope& stats,
                  const Http2Settings& http2_settings)
-      : stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."))},
+      : arena_(std::make_shared<Arena>()),
+        stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."),
+                                     POOL_HISTOGRAM_PREFIX(stats, "http2."))},
         connection_(connection),
-        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_), dispatching_(false),
-        raised_goaway_(false), pending_deferred_reset_(false) {}
+        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_),
+        flush_timer_(http2_settings.coalesce_writes_
+                         ? connection.dispatcher().createTimer([this]() -> void { onFlushTimer(); })
+                         : nullptr),
+        bdp_estimator_(http2_settings.adaptive_window_
+                           ? std::make_unique<BdpEstimator>(
+                                 http2_settings.adaptive_window_min_size_,
+                                 http2_settings.adaptive_window_max_size_,
+                                 ProdMonotonicTimeSource::instance_)
+                           : nullptr),
+        dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false),
+        flush_scheduled_(false) {}
 
   ~ConnectionImpl();
 
@@ -85,7 +105,7 @@ public:
   void goAway() override;
   Protocol protocol() override { return Protocol::Http2; }
   void shutdownNotice() override;
-  bool wantsToWrite() override { return nghttp2_session_want_write(session_); }
+  bool wantsToWrite() override;
   // Propogate network connection watermark events to each stream on the connection.
   void onUnderlyingConnectionAboveWriteBufferHighWatermark() override {
     for (auto& stream : active_streams_) {
@@ -127,6 +147,26 @@ protected:
     nghttp2_option* options_;
   };
 
+  /**
+   * HPACK-decoded strings that a header map references rather than copies. nghttp2 reference
+   * counts them, so a string in the HPACK dynamic table is shared by every header map on the
+   * connection that references it.
+   */
+  class HeaderBuffers {
+  public:
+    HeaderBuffers(ArenaSharedPtr arena) : arena_(std::move(arena)) {}
+    ~HeaderBuffers();
+
+    void add(nghttp2_rcbuf* buffer);
+
+  private:
+    // The buffers are freed into the arena, which must outlive them.
+    ArenaSharedPtr arena_;
+    std::vector<nghttp2_rcbuf*> buffers_;
+  };
+
+  typedef std::shared_ptr<HeaderBuffers> HeaderBuffersSharedPtr;
+
   /**
    * Base class for client and server side streams.
    */
@@ -143,7 +183,8 @@ protected:
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
     static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
-    void saveHeader(HeaderString&& name, HeaderString&& value);
+    void saveHeader(nghttp2_rcbuf* name, nghttp2_rcbuf* value);
+    void retainHeaderBuffer(nghttp2_rcbuf* buffer);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
                                nghttp2_data_provider* provider) PURE;
     void submitTrailers(const HeaderMap& trailers);
@@ -185,6 +226,8 @@ protected:
 
     ConnectionImpl& parent_;
     HeaderMapImplPtr headers_;
+    // The HPACK strings that headers_ references, if any.
+    HeaderBuffersSharedPtr header_buffers_;
     StreamDecoder* decoder_{};
     int32_t stream_id_{-1};
     uint32_t unconsumed_bytes_{0};
@@ -233,18 +276,35 @@ protected:
 
   ConnectionImpl* base() { return this; }
   StreamImpl* getStream(int32_t stream_id);
-  int saveHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value);
+  int saveHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name, nghttp2_rcbuf* value);
+
+  /**
+   * Send the frames nghttp2 has queued, at the end of the event loop iteration if writes are
+   * coalesced and otherwise now. Nothing is sent while dispatching, as dispatch() flushes when it
+   * is done.
+   */
   void sendPendingFrames();
+
+  /**
+   * Send the frames nghttp2 has queued now, unless dispatching.
+   */
+  void flushPendingFrames();
   void sendSettings(const Http2Settings& http2_settings, bool disable_push);
 
   static Http2Callbacks http2_callbacks_;
   static Http2Options http2_options_;
 
+  // Shared with the header buffers, which may outlive the connection.
+  ArenaSharedPtr arena_;
   std::list<StreamImplPtr> active_streams_;
   nghttp2_session* session_{};
   CodecStats stats_;
   Network::Connection& connection_;
   uint32_t per_stream_buffer_limit_;
+  // Frames that nghttp2 has sent during one flush, and how many, which are written to the
+  // connection together once it is done.
+  Buffer::OwnedImpl write_buffer_;
+  uint64_t write_buffer_frames_{};
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
@@ -252,14 +312,22 @@ private:
   int onData(int32_t stream_id, const uint8_t* data, size_t len);
   int onFrameReceived(const nghttp2_frame* frame);
   int onFrameSend(const nghttp2_frame* frame);
-  virtual int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) PURE;
+  virtual int onHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name, nghttp2_rcbuf* value) PURE;
   int onInvalidFrame(int32_t stream_id, int error_code);
   ssize_t onSend(const uint8_t* data, size_t length);
   int onStreamClose(int32_t stream_id, uint32_t error_code);
-
+  void onFlushTimer();
+  void writeFrames();
+  void onBdpPingAck();
+
+  // Set if writes are coalesced, to flush at the end of the event loop iteration.
+  Event::TimerPtr flush_timer_;
+  // Set if the windows are tuned to the bandwidth-delay product.
+  std::unique_ptr<BdpEstimator> bdp_estimator_;
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
+  bool flush_scheduled_ : 1;
 };
 
 /**
@@ -277,7 +345,7 @@ private:
   // ConnectionImpl
   ConnectionCallbacks& callbacks() override { return callbacks_; }
   int onBeginHeaders(const nghttp2_frame* frame) override;
-  int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) override;
+  int onHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name, nghttp2_rcbuf* value) override;
 
   Http::ConnectionCallbacks& callbacks_;
 };
@@ -294,7 +362,7 @@ private:
   // ConnectionImpl
   ConnectionCallbacks& callbacks() override { return callbacks_; }
   int onBeginHeaders(const nghttp2_frame* frame) override;
-  int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) override;
+  int onHeader(const nghttp2_frame* frame, nghttp2_rcbuf* name, nghttp2_rcbuf* value) override;
 
   ServerConnectionCallbacks& callbacks_;
 };
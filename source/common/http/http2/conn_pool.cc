@@ -1,5 +1,7 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 #include "envoy/event/dispatcher.h"
@@ -20,12 +22,13 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
     : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  // Closing a client removes it from its list.
+  while (!ready_clients_.empty()) {
+    ready_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -33,8 +36,37 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  while (!ready_clients_.empty()) {
+    moveClientToDraining(*ready_clients_.front());
+  }
+}
+
+void ConnPoolImpl::prefetch(uint32_t connections) {
+  // A pool that is being drained opens no more connections.
+  if (!drained_callbacks_.empty()) {
+    return;
+  }
+
+  connections = std::min(connections, host_->cluster().http2MaxConnectionsPerHost());
+  while (ready_clients_.size() < connections) {
+    ENVOY_LOG(debug, "prefetching a connection");
+    ActiveClientPtr client(new ActiveClient(*this));
+    client->prefetched_ = true;
+    client->moveIntoList(std::move(client), ready_clients_);
+    host_->cluster().stats().upstream_cx_prefetch_total_.inc();
+  }
+}
+
+void ConnPoolImpl::prefetchForDemand() {
+  // Every connection has a capacity of the streams at which it becomes busy.
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio > 1) {
+    uint64_t demand = 0;
+    for (const ActiveClientPtr& client : ready_clients_) {
+      demand += client->client_->numActiveRequests();
+    }
+    prefetch(static_cast<uint32_t>(
+        std::ceil(ratio * demand / host_->cluster().http2BusyStreamThreshold())));
   }
 }
 
@@ -49,18 +81,21 @@ void ConnPoolImpl::checkForDrained() {
   }
 
   bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
+  for (auto it = ready_clients_.begin(); it != ready_clients_.end();) {
+    // Closing the client removes it from the list.
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     } else {
       drained = false;
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
+  for (const ActiveClientPtr& client : draining_clients_) {
+    ASSERT(client->client_->numActiveRequests() > 0);
+    if (client->client_->numActiveRequests() > 0) {
+      drained = false;
+    }
   }
 
   if (drained) {
@@ -81,33 +116,64 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  for (auto it = ready_clients_.begin(); it != ready_clients_.end();) {
+    // Draining the client removes it from the list.
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      moveClientToDraining(client);
+    }
   }
 
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
-  }
+  ActiveClient& client = leastActiveClient();
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    if (client.prefetched_) {
+      client.prefetched_ = false;
+      host_->cluster().stats().upstream_cx_prefetch_used_.inc();
+    }
+    client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client.client_->newStream(response_decoder),
+                          client.real_host_description_);
+    prefetchForDemand();
   }
 
   return nullptr;
 }
 
+ConnPoolImpl::ActiveClient& ConnPoolImpl::leastActiveClient() {
+  ActiveClient* least_active = nullptr;
+  for (const ActiveClientPtr& client : ready_clients_) {
+    if (least_active == nullptr ||
+        client->client_->numActiveRequests() < least_active->client_->numActiveRequests()) {
+      least_active = client.get();
+    }
+  }
+
+  if (least_active == nullptr ||
+      (least_active->busy() &&
+       ready_clients_.size() < host_->cluster().http2MaxConnectionsPerHost())) {
+    if (least_active != nullptr) {
+      ENVOY_CONN_LOG(debug, "all {} connections busy, creating another", *least_active->client_,
+                     ready_clients_.size());
+    }
+    ActiveClientPtr client(new ActiveClient(*this));
+    client->moveIntoList(std::move(client), ready_clients_);
+    least_active = ready_clients_.front().get();
+  }
+
+  return *least_active;
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -121,12 +187,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
-    } else {
+    if (client.draining_) {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
+    } else {
+      ENVOY_CONN_LOG(debug, "destroying ready client", *client.client_);
+      dispatcher_.deferredDelete(client.removeFromList(ready_clients_));
     }
 
     if (client.connect_timer_) {
@@ -149,25 +215,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving client to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the client does not have any active requests just close it now.
+    client.client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    client.draining_ = true;
+    client.moveBetweenLists(ready_clients_, draining_clients_);
   }
-
-  ASSERT(!primary_client_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -179,8 +236,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -190,7 +247,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -244,7 +301,15 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
                                &parent_.host_->cluster().stats().bind_errors_});
 }
 
+bool ConnPoolImpl::ActiveClient::busy() const {
+  return above_write_high_watermark_ ||
+         client_->numActiveRequests() >= parent_.host_->cluster().http2BusyStreamThreshold();
+}
+
 ConnPoolImpl::ActiveClient::~ActiveClient() {
+  if (prefetched_) {
+    parent_.host_->cluster().stats().upstream_cx_prefetch_wasted_.inc();
+  }
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   conn_length_->complete();
@@ -10,6 +10,7 @@
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -18,8 +19,10 @@ namespace Http2 {
 
 /**
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * shifting to a new connection if we reach max streams on a connection. Streams go to the ready
+ * connection with the fewest active streams, and another connection is opened when that one is
+ * busy, up to the cluster's limit of connections per host. This is a base class used for both the
+ * prod implementation as well as the testing one.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -32,25 +35,28 @@ public:
   Http::Protocol protocol() const override { return Http::Protocol::Http2; }
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
+  void prefetch(uint32_t connections) override;
   ConnectionPool::Cancellable* newStream(Http::StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
   struct ActiveClient : public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
+                        public LinkedObject<ActiveClient>,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
     ActiveClient(ConnPoolImpl& parent);
     ~ActiveClient();
 
     void onConnectTimeout() { parent_.onConnectTimeout(*this); }
+    bool busy() const;
 
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override {
       parent_.onConnectionEvent(*this, event);
     }
-    void onAboveWriteBufferHighWatermark() override {}
-    void onBelowWriteBufferLowWatermark() override {}
+    void onAboveWriteBufferHighWatermark() override { above_write_high_watermark_ = true; }
+    void onBelowWriteBufferLowWatermark() override { above_write_high_watermark_ = false; }
 
     // CodecClientCallbacks
     void onStreamDestroy() override { parent_.onStreamDestroy(*this); }
@@ -68,6 +74,10 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool draining_{};
+    bool above_write_high_watermark_{};
+    // Set while a connection opened by prefetch() has not yet had a stream.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -75,18 +85,21 @@ protected:
   void checkForDrained();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  ActiveClient& leastActiveClient();
+  void moveClientToDraining(ActiveClient& client);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
+  void prefetchForDemand();
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Connections that take new streams, and connections that finish their streams before closing.
+  std::list<ActiveClientPtr> ready_clients_;
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
@@ -210,6 +210,14 @@ Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& co
   ret.initial_connection_window_size_ =
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, initial_connection_window_size,
                                       Http::Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
+  ret.coalesce_writes_ = config.coalesce_writes();
+  ret.adaptive_window_ = config.adaptive_window();
+  ret.adaptive_window_min_size_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, adaptive_window_min_size,
+                                      Http::Http2Settings::MIN_INITIAL_STREAM_WINDOW_SIZE);
+  ret.adaptive_window_max_size_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, adaptive_window_max_size,
+                                      Http::Http2Settings::DEFAULT_ADAPTIVE_WINDOW_MAX_SIZE);
   return ret;
 }
 
@@ -219,6 +227,7 @@ Utility::parseHttp1Settings(const envoy::api::v2::core::Http1ProtocolOptions& co
   ret.allow_absolute_url_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, allow_absolute_url, false);
   ret.accept_http_10_ = config.accept_http_10();
   ret.default_host_for_http_10_ = config.default_host_for_http_10();
+  ret.scanning_parser_ = config.scanning_parser();
   return ret;
 }
 
@@ -0,0 +1,83 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+constexpr uint32_t ConnectionBalancerImpl::UtilizationMargin;
+constexpr uint64_t ConnectionBalancerImpl::ConnectionMargin;
+constexpr uint64_t ConnectionBalancerImpl::ConnectionMarginPercent;
+
+ConnectionBalancerImpl::ConnectionBalancerImpl(uint32_t workers, LoadMetric metric)
+    : num_workers_(workers), metric_(metric), workers_(new Worker[workers]) {}
+
+void ConnectionBalancerImpl::registerHandler(uint32_t worker_index,
+                                             BalancedConnectionHandler& handler) {
+  ASSERT(worker_index < num_workers_);
+  workers_[worker_index].connections_ = 0;
+  workers_[worker_index].handler_.store(&handler, std::memory_order_release);
+}
+
+void ConnectionBalancerImpl::unregisterHandler(uint32_t worker_index) {
+  ASSERT(worker_index < num_workers_);
+  workers_[worker_index].handler_.store(nullptr, std::memory_order_release);
+}
+
+void ConnectionBalancerImpl::onConnectionCount(uint32_t worker_index, uint64_t connections) {
+  ASSERT(worker_index < num_workers_);
+  workers_[worker_index].connections_.store(connections, std::memory_order_relaxed);
+}
+
+BalancedConnectionHandler& ConnectionBalancerImpl::pickTargetHandler(uint32_t worker_index) {
+  ASSERT(worker_index < num_workers_);
+  Worker& current = workers_[worker_index];
+  BalancedConnectionHandler* current_handler = current.handler_.load(std::memory_order_acquire);
+  ASSERT(current_handler != nullptr);
+
+  const bool by_utilization = metric_ == LoadMetric::LoopUtilization;
+  const uint32_t current_utilization = by_utilization ? current_handler->loopUtilization() : 0;
+  Worker* target = &current;
+  BalancedConnectionHandler* target_handler = current_handler;
+  const uint64_t current_connections = current.connections_.load(std::memory_order_relaxed);
+  const uint64_t connection_margin =
+      std::max(ConnectionMargin, current_connections * ConnectionMarginPercent / 100);
+  uint64_t target_connections = current_connections;
+  uint32_t target_utilization = current_utilization;
+
+  for (uint32_t i = 0; i < num_workers_; i++) {
+    BalancedConnectionHandler* handler = workers_[i].handler_.load(std::memory_order_acquire);
+    if (i == worker_index || handler == nullptr) {
+      continue;
+    }
+
+    const uint64_t connections = workers_[i].connections_.load(std::memory_order_relaxed);
+    bool better;
+    if (by_utilization) {
+      const uint32_t utilization = handler->loopUtilization();
+      better = utilization + UtilizationMargin <= current_utilization &&
+               (target == &current || utilization < target_utilization ||
+                (utilization == target_utilization && connections < target_connections));
+      if (better) {
+        target_utilization = utilization;
+      }
+    } else {
+      better = connections + connection_margin <= current_connections &&
+               connections < target_connections;
+    }
+
+    if (better) {
+      target = &workers_[i];
+      target_handler = handler;
+      target_connections = connections;
+    }
+  }
+
+  target->connections_.fetch_add(1, std::memory_order_relaxed);
+  return *target_handler;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Hands each accepted socket to the least loaded worker running the listener. Workers are kept in
+ * a fixed array indexed by worker, and registration, load reports and picks only touch atomics, so
+ * a pick never waits for another worker. The hand-off itself goes through the target's
+ * BalancedConnectionHandler::post().
+ *
+ * A pick adds the socket to the target's connection count straight away, so that a burst of
+ * accepts is spread out rather than sent to the same worker until it reports its new count.
+ */
+class ConnectionBalancerImpl : public ConnectionBalancer, NonCopyable {
+public:
+  enum class LoadMetric {
+    // The number of connections each worker holds on the listener.
+    ActiveConnections,
+    // The recent utilization of each worker's event loop. Ties are broken by connections.
+    LoopUtilization
+  };
+
+  /**
+   * A worker's loop utilization must be at least this many percentage points below the accepting
+   * worker's for a socket to be moved to it, so that sockets don't chase noise in the measurement.
+   */
+  static constexpr uint32_t UtilizationMargin = 10;
+
+  /**
+   * A worker must hold at least ConnectionMargin connections, and at least ConnectionMarginPercent
+   * percent of the accepting worker's connections, fewer than the accepting worker for a socket to
+   * be moved to it. Under near-equal load sockets then stay on the worker that accepted them
+   * instead of paying for a cross-thread hand-off that doesn't improve the balance.
+   */
+  static constexpr uint64_t ConnectionMargin = 4;
+  static constexpr uint64_t ConnectionMarginPercent = 5;
+
+  /**
+   * @param workers supplies the number of workers.
+   * @param metric supplies how the load of a worker is measured.
+   */
+  ConnectionBalancerImpl(uint32_t workers, LoadMetric metric);
+
+  // Network::ConnectionBalancer
+  void registerHandler(uint32_t worker_index, BalancedConnectionHandler& handler) override;
+  void unregisterHandler(uint32_t worker_index) override;
+  void onConnectionCount(uint32_t worker_index, uint64_t connections) override;
+  BalancedConnectionHandler& pickTargetHandler(uint32_t worker_index) override;
+
+private:
+  struct Worker {
+    std::atomic<BalancedConnectionHandler*> handler_{};
+    std::atomic<uint64_t> connections_{};
+  };
+
+  const uint32_t num_workers_;
+  const LoadMetric metric_;
+  std::unique_ptr<Worker[]> workers_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -110,6 +110,19 @@ public:
   // fair sharing of CPU resources, the underlying event loop does not make any fairness guarantees.
   // Reconsider how to make fairness happen.
   void setReadBufferReady() override { file_event_->activate(Event::FileReadyType::Read); }
+  bool enableReceive() override {
+    receiving_ = file_event_->enableReceive();
+    return receiving_;
+  }
+  int receive(Buffer::Instance& buffer, uint64_t max_length) override {
+    return file_event_->receive(buffer, max_length);
+  }
+
+  /**
+   * @return bool whether the file event receives on the transport socket's behalf. Data it has
+   *         received may not have reached the read buffer yet.
+   */
+  bool receiving() const { return receiving_; }
 
   // Obtain global next connection ID. This should only be used in tests.
   static uint64_t nextGlobalIdForTest() { return next_global_id_; }
@@ -159,6 +172,7 @@ private:
   bool enable_half_close_{false};
   bool read_end_stream_raised_{false};
   bool read_end_stream_{false};
+  bool receiving_{false};
   bool write_end_stream_{false};
   bool current_write_end_stream_{false};
   Buffer::Instance* current_write_buffer_{};
@@ -66,6 +66,19 @@ void FilterManagerImpl::onRead() {
   onContinueReading(nullptr);
 }
 
+bool FilterManagerImpl::hasOtherFilters(const ActiveReadFilter& filter) const {
+  if (upstream_filters_.size() > 1) {
+    return true;
+  }
+  for (const WriteFilterSharedPtr& write_filter : downstream_filters_) {
+    // A filter added with addFilter() is both a read and a write filter.
+    if (dynamic_cast<ReadFilter*>(write_filter.get()) != filter.filter_.get()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 FilterStatus FilterManagerImpl::onWrite() {
   for (const WriteFilterSharedPtr& filter : downstream_filters_) {
     BufferSource::StreamBuffer write_buffer = buffer_source_.getWriteBuffer();
@@ -61,6 +61,7 @@ private:
     void upstreamHost(Upstream::HostDescriptionConstSharedPtr host) override {
       parent_.host_description_ = host;
     }
+    bool hasOtherFilters() override { return parent_.hasOtherFilters(*this); }
 
     FilterManagerImpl& parent_;
     ReadFilterSharedPtr filter_;
@@ -70,6 +71,7 @@ private:
   typedef std::unique_ptr<ActiveReadFilter> ActiveReadFilterPtr;
 
   void onContinueReading(ActiveReadFilter* filter);
+  bool hasOtherFilters(const ActiveReadFilter& filter) const;
 
   Connection& connection_;
   BufferSource& buffer_source_;
@@ -73,6 +73,17 @@ public:
 
 typedef std::unique_ptr<TcpListenSocket> TcpListenSocketPtr;
 
+/**
+ * Wraps a bound datagram socket.
+ */
+class UdpListenSocket : public ListenSocketImpl {
+public:
+  UdpListenSocket(const Address::InstanceConstSharedPtr& address,
+                  const Network::Socket::OptionsSharedPtr& options);
+  UdpListenSocket(int fd, const Address::InstanceConstSharedPtr& address,
+                  const Network::Socket::OptionsSharedPtr& options);
+};
+
 class UdsListenSocket : public ListenSocketImpl {
 public:
   UdsListenSocket(const Address::InstanceConstSharedPtr& address);
@@ -1,18 +1,21 @@
 #include "common/network/listener_impl.h"
 
+#include <fcntl.h>
 #include <sys/un.h>
 
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
 #include "envoy/common/exception.h"
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
+#include "common/common/utility.h"
 #include "common/event/dispatcher_impl.h"
-#include "common/event/file_event_impl.h"
 #include "common/network/address_impl.h"
 
-#include "event2/listener.h"
-
 namespace Envoy {
 namespace Network {
 
@@ -20,13 +23,56 @@ Address::InstanceConstSharedPtr ListenerImpl::getLocalAddress(int fd) {
   return Address::addressFromFd(fd);
 }
 
-void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
-                                  int remote_addr_len, void* arg) {
-  ListenerImpl* listener = static_cast<ListenerImpl*>(arg);
+void ListenerImpl::onSocketReady() {
+  const MonotonicTime batch_start = ProdMonotonicTimeSource::instance_.currentTime();
+  uint32_t accepted = 0;
+  // Stop at the batch size so that a flood of new connections cannot starve the other events of
+  // this worker. The file event is level triggered, so any remaining connections are picked up on
+  // the next pass of the event loop. A callback may also disable the listener part way through.
+  while (enabled_ && (accept_batch_size_ == 0 || accepted < accept_batch_size_)) {
+    sockaddr_storage remote_addr;
+    socklen_t remote_addr_len = sizeof(remote_addr);
+#ifdef SOCK_NONBLOCK
+    const int fd = ::accept4(fd_, reinterpret_cast<sockaddr*>(&remote_addr), &remote_addr_len,
+                             SOCK_NONBLOCK);
+#else
+    const int fd = ::accept(fd_, reinterpret_cast<sockaddr*>(&remote_addr), &remote_addr_len);
+    if (fd >= 0) {
+      RELEASE_ASSERT(fcntl(fd, F_SETFL, O_NONBLOCK) != -1);
+    }
+#endif
+    if (fd < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      // This can happen if we run out of FDs or memory. In those cases just crash.
+      PANIC(fmt::format("listener accept failure: {}", strerror(errno)));
+    }
+
+    accepted++;
+    onAccept(fd, remote_addr, remote_addr_len);
+    if (accept_stats_ != nullptr) {
+      accept_stats_->accept_latency_us_.recordValue(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              ProdMonotonicTimeSource::instance_.currentTime() - batch_start)
+              .count());
+    }
+  }
+
+  if (accept_stats_ != nullptr && accepted > 0) {
+    accept_stats_->accept_batch_size_.recordValue(accepted);
+  }
+}
+
+void ListenerImpl::onAccept(int fd, const sockaddr_storage& remote_addr,
+                            socklen_t remote_addr_len) {
   // Get the local address from the new socket if the listener is listening on IP ANY
   // (e.g., 0.0.0.0 for IPv4) (local_address_ is nullptr in this case).
   const Address::InstanceConstSharedPtr& local_address =
-      listener->local_address_ ? listener->local_address_ : listener->getLocalAddress(fd);
+      local_address_ ? local_address_ : getLocalAddress(fd);
   // The accept() call that filled in remote_addr doesn't fill in more than the sa_family field
   // for Unix domain sockets; apparently there isn't a mechanism in the kernel to get the
   // sockaddr_un associated with the client socket when starting from the server socket.
@@ -35,20 +81,19 @@ void ListenerImpl::listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr*
   // if the socket is a v4 socket, but for v6 sockets this will create an IPv4 remote address if an
   // IPv4 local_address was created from an IPv6 mapped IPv4 address.
   const Address::InstanceConstSharedPtr& remote_address =
-      (remote_addr->sa_family == AF_UNIX)
+      (remote_addr.ss_family == AF_UNIX)
           ? Address::peerAddressFromFd(fd)
-          : Address::addressFromSockAddr(*reinterpret_cast<const sockaddr_storage*>(remote_addr),
-                                         remote_addr_len,
+          : Address::addressFromSockAddr(remote_addr, remote_addr_len,
                                          local_address->ip()->version() == Address::IpVersion::v6);
-  listener->cb_.onAccept(std::make_unique<AcceptedSocketImpl>(fd, local_address, remote_address),
-                         listener->hand_off_restored_destination_connections_);
+  cb_.onAccept(std::make_unique<AcceptedSocketImpl>(fd, local_address, remote_address),
+               hand_off_restored_destination_connections_);
 }
 
 ListenerImpl::ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, ListenerCallbacks& cb,
                            bool bind_to_port, bool hand_off_restored_destination_connections)
     : local_address_(nullptr), cb_(cb),
       hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
-      listener_(nullptr) {
+      fd_(socket.fd()) {
   const auto ip = socket.localAddress()->ip();
 
   // Only use the listen socket's local address for new connections if it is not the all hosts
@@ -58,10 +103,7 @@ ListenerImpl::ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, Li
   }
 
   if (bind_to_port) {
-    listener_.reset(
-        evconnlistener_new(&dispatcher.base(), listenCallback, this, 0, -1, socket.fd()));
-
-    if (!listener_) {
+    if (::listen(fd_, ListenBacklog) != 0 || fcntl(fd_, F_SETFL, O_NONBLOCK) == -1) {
       throw CreateListenerException(
           fmt::format("cannot listen on socket: {}", socket.localAddress()->asString()));
     }
@@ -71,14 +113,28 @@ ListenerImpl::ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, Li
           "cannot set post-listen socket option on socket: {}", socket.localAddress()->asString()));
     }
 
-    evconnlistener_set_error_cb(listener_.get(), errorCallback);
+    file_event_ = dispatcher.createFileEvent(fd_, [this](uint32_t) -> void { onSocketReady(); },
+                                             Event::FileTriggerType::Level,
+                                             Event::FileReadyType::Read);
+  }
+}
+
+void ListenerImpl::disable() {
+  enabled_ = false;
+  if (file_event_ != nullptr) {
+    file_event_->setEnabled(0);
+  }
+}
+
+void ListenerImpl::enable() {
+  enabled_ = true;
+  if (file_event_ != nullptr) {
+    file_event_->setEnabled(Event::FileReadyType::Read);
   }
 }
 
-void ListenerImpl::errorCallback(evconnlistener*, void*) {
-  // We should never get an error callback. This can happen if we run out of FDs or memory. In those
-  // cases just crash.
-  PANIC(fmt::format("listener accept failure: {}", strerror(errno)));
+void ListenerImpl::setAcceptStats(const AcceptStats& stats) {
+  accept_stats_ = std::make_unique<AcceptStats>(stats);
 }
 
 } // namespace Network
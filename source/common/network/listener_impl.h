@@ -1,24 +1,40 @@
 #pragma once
 
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/event/file_event.h"
 #include "envoy/network/listener.h"
 
 #include "common/event/dispatcher_impl.h"
-#include "common/event/libevent.h"
 #include "common/network/listen_socket_impl.h"
 
-#include "event2/event.h"
-
 namespace Envoy {
 namespace Network {
 
 /**
- * libevent implementation of Network::Listener.
+ * Implementation of Network::Listener that accepts connections in batches from a level triggered
+ * file event on the listen socket.
  */
 class ListenerImpl : public Listener {
 public:
   ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, ListenerCallbacks& cb,
                bool bind_to_port, bool hand_off_restored_destination_connections);
 
+  // Network::Listener
+  void disable() override;
+  void enable() override;
+  void setAcceptBatchSize(uint32_t batch_size) override { accept_batch_size_ = batch_size; }
+  void setAcceptStats(const AcceptStats& stats) override;
+
+  // Size of the kernel's queue of connections waiting to be accepted. This matches what libevent's
+  // evconnlistener used.
+  static const int ListenBacklog = 128;
+  // Connections accepted per readiness event unless the listener is configured otherwise.
+  static const uint32_t DefaultAcceptBatchSize = 64;
+
 protected:
   virtual Address::InstanceConstSharedPtr getLocalAddress(int fd);
 
@@ -27,11 +43,14 @@ protected:
   const bool hand_off_restored_destination_connections_;
 
 private:
-  static void errorCallback(evconnlistener* listener, void* context);
-  static void listenCallback(evconnlistener*, evutil_socket_t fd, sockaddr* remote_addr,
-                             int remote_addr_len, void* arg);
-
-  Event::Libevent::ListenerPtr listener_;
+  void onSocketReady();
+  void onAccept(int fd, const sockaddr_storage& remote_addr, socklen_t remote_addr_len);
+
+  const int fd_;
+  Event::FileEventPtr file_event_;
+  uint32_t accept_batch_size_{DefaultAcceptBatchSize};
+  bool enabled_{true};
+  std::unique_ptr<AcceptStats> accept_stats_;
 };
 
 } // namespace Network
@@ -2,6 +2,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/utility.h"
 #include "common/http/headers.h"
 
 namespace Envoy {
@@ -17,7 +18,7 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   bool end_stream = false;
   do {
     // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
-    int rc = buffer.read(callbacks_->fd(), 16384);
+    int rc = receiving_ ? callbacks_->receive(buffer, 16384) : buffer.read(callbacks_->fd(), 16384);
     ENVOY_CONN_LOG(trace, "read returns: {}", callbacks_->connection(), rc);
 
     if (rc == 0) {
@@ -29,6 +30,11 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
       ENVOY_CONN_LOG(trace, "read error: {}", callbacks_->connection(), errno);
       if (errno != EAGAIN) {
         action = PostIoAction::Close;
+      } else if (!receiving_ && !receive_unavailable_) {
+        // The socket has been drained, so the file event can take over from here. It only starts
+        // once the socket is known to be connected and readable.
+        receiving_ = callbacks_->enableReceive();
+        receive_unavailable_ = !receiving_;
       }
 
       break;
@@ -48,6 +54,10 @@ IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
   PostIoAction action;
   uint64_t bytes_written = 0;
   ASSERT(!shutdown_ || buffer.length() == 0);
+  if (zero_copy_sender_ != nullptr) {
+    // Zero copy completions are signalled with EPOLLERR, which arrives as a write event.
+    zero_copy_config_->stats_.zerocopy_copied_total_.add(zero_copy_sender_->reap());
+  }
   do {
     if (buffer.length() == 0) {
       if (end_stream && !shutdown_) {
@@ -59,7 +69,20 @@ IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
       action = PostIoAction::KeepOpen;
       break;
     }
-    int rc = buffer.write(callbacks_->fd());
+    Buffer::OwnedImpl* zero_copy_buffer = zeroCopyBuffer(buffer);
+    int rc;
+    if (zero_copy_buffer != nullptr) {
+      rc = zero_copy_sender_->send(*zero_copy_buffer);
+      if (rc > 0) {
+        zero_copy_config_->stats_.zerocopy_send_total_.inc();
+      } else if (rc == -1 && errno == ENOBUFS) {
+        // The kernel could not pin any more memory for this socket, so copy this write instead.
+        zero_copy_config_->stats_.zerocopy_fallback_total_.inc();
+        rc = buffer.write(callbacks_->fd());
+      }
+    } else {
+      rc = buffer.write(callbacks_->fd());
+    }
     ENVOY_CONN_LOG(trace, "write returns: {}", callbacks_->connection(), rc);
     if (rc == -1) {
       ENVOY_CONN_LOG(trace, "write error: {} ({})", callbacks_->connection(), errno,
@@ -79,12 +102,44 @@ IoResult RawBufferSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
   return {action, bytes_written, false};
 }
 
+Buffer::OwnedImpl* RawBufferSocket::zeroCopyBuffer(Buffer::Instance& buffer) {
+  if (zero_copy_config_ == nullptr || buffer.length() < zero_copy_config_->threshold_) {
+    return nullptr;
+  }
+
+  // Sent slices must be retained until the kernel is done with them, which needs the slice based
+  // buffer implementation.
+  Buffer::OwnedImpl* owned_buffer = dynamic_cast<Buffer::OwnedImpl*>(&buffer);
+  if (owned_buffer == nullptr || owned_buffer->usesOldImpl() || zero_copy_unavailable_) {
+    zero_copy_config_->stats_.zerocopy_fallback_total_.inc();
+    return nullptr;
+  }
+
+  if (zero_copy_sender_ == nullptr) {
+    zero_copy_sender_ = ZeroCopySender::create(callbacks_->fd());
+    if (zero_copy_sender_ == nullptr) {
+      zero_copy_unavailable_ = true;
+      zero_copy_config_->stats_.zerocopy_fallback_total_.inc();
+      return nullptr;
+    }
+  }
+  return owned_buffer;
+}
+
+void RawBufferSocket::closeSocket(Network::ConnectionEvent) {
+  if (zero_copy_sender_ != nullptr) {
+    zero_copy_config_->stats_.zerocopy_copied_total_.add(zero_copy_sender_->reap());
+    ZeroCopySender::release(std::move(zero_copy_sender_), callbacks_->connection().dispatcher(),
+                            ProdMonotonicTimeSource::instance_);
+  }
+}
+
 std::string RawBufferSocket::protocol() const { return EMPTY_STRING; }
 
 void RawBufferSocket::onConnected() { callbacks_->raiseEvent(ConnectionEvent::Connected); }
 
 TransportSocketPtr RawBufferSocketFactory::createTransportSocket() const {
-  return std::make_unique<RawBufferSocket>();
+  return std::make_unique<RawBufferSocket>(zero_copy_config_);
 }
 
 bool RawBufferSocketFactory::implementsSecureTransport() const { return false; }
@@ -3,19 +3,58 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/stats/stats_macros.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
+#include "common/network/zero_copy_sender.h"
 
 namespace Envoy {
 namespace Network {
 
+/**
+ * All raw buffer socket stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RAW_BUFFER_SOCKET_STATS(COUNTER)                                                       \
+  COUNTER(zerocopy_send_total)                                                                     \
+  COUNTER(zerocopy_copied_total)                                                                   \
+  COUNTER(zerocopy_fallback_total)
+// clang-format on
+
+/**
+ * Struct definition for all raw buffer socket stats. @see stats_macros.h
+ */
+struct RawBufferSocketStats {
+  ALL_RAW_BUFFER_SOCKET_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Zero copy transmit settings shared by the sockets of one RawBufferSocketFactory.
+ */
+struct ZeroCopyConfig {
+  ZeroCopyConfig(uint64_t threshold, Stats::Scope& scope)
+      : threshold_(threshold), stats_{ALL_RAW_BUFFER_SOCKET_STATS(
+                                   POOL_COUNTER_PREFIX(scope, "raw_buffer."))} {}
+
+  // Writes of at least this many buffered bytes are sent with MSG_ZEROCOPY.
+  const uint64_t threshold_;
+  RawBufferSocketStats stats_;
+};
+
+typedef std::shared_ptr<const ZeroCopyConfig> ZeroCopyConfigConstSharedPtr;
+
 class RawBufferSocket : public TransportSocket, protected Logger::Loggable<Logger::Id::connection> {
 public:
+  RawBufferSocket() {}
+  RawBufferSocket(ZeroCopyConfigConstSharedPtr zero_copy_config)
+      : zero_copy_config_(std::move(zero_copy_config)) {}
+
   // Network::TransportSocket
   void setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
   bool canFlushClose() override { return true; }
-  void closeSocket(Network::ConnectionEvent) override {}
+  void closeSocket(Network::ConnectionEvent) override;
   void onConnected() override;
   IoResult doRead(Buffer::Instance& buffer) override;
   IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
@@ -23,15 +62,34 @@ public:
   const Ssl::Connection* ssl() const override { return nullptr; }
 
 private:
+  Buffer::OwnedImpl* zeroCopyBuffer(Buffer::Instance& buffer);
+
   TransportSocketCallbacks* callbacks_{};
   bool shutdown_{};
+  const ZeroCopyConfigConstSharedPtr zero_copy_config_;
+  ZeroCopySenderPtr zero_copy_sender_;
+  bool zero_copy_unavailable_{};
+  // Whether reads are handed over by the connection's file event rather than made from the socket.
+  bool receiving_{};
+  bool receive_unavailable_{};
 };
 
 class RawBufferSocketFactory : public TransportSocketFactory {
 public:
+  RawBufferSocketFactory() {}
+  /**
+   * @param zero_copy_config supplies the zero copy transmit settings for the sockets created by
+   *        this factory. When nullptr every write is copied into the kernel.
+   */
+  RawBufferSocketFactory(ZeroCopyConfigConstSharedPtr zero_copy_config)
+      : zero_copy_config_(std::move(zero_copy_config)) {}
+
   // Network::TransportSocketFactory
   TransportSocketPtr createTransportSocket() const override;
   bool implementsSecureTransport() const override;
+
+private:
+  const ZeroCopyConfigConstSharedPtr zero_copy_config_;
 };
 
 } // namespace Network
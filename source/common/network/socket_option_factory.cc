@@ -57,5 +57,12 @@ SocketOptionFactory::buildTcpFastOpenOptions(uint32_t queue_length) {
   return options;
 }
 
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildReusePortOptions() {
+  std::unique_ptr<Socket::Options> options = absl::make_unique<Socket::Options>();
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      Network::Socket::SocketState::PreBind, ENVOY_SOCKET_SO_REUSEPORT, 1));
+  return options;
+}
+
 } // namespace Network
 } // namespace Envoy
\ No newline at end of file
@@ -45,6 +45,13 @@ typedef absl::optional<std::pair<int, int>> SocketOptionName;
 #define ENVOY_SOCKET_IPV6_FREEBIND Network::SocketOptionName()
 #endif
 
+#ifdef SO_REUSEPORT
+#define ENVOY_SOCKET_SO_REUSEPORT                                                                  \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_REUSEPORT))
+#else
+#define ENVOY_SOCKET_SO_REUSEPORT Network::SocketOptionName()
+#endif
+
 #ifdef SO_KEEPALIVE
 #define ENVOY_SOCKET_SO_KEEPALIVE                                                                  \
   Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_KEEPALIVE))
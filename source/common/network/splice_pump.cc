@@ -0,0 +1,201 @@
+#include "common/network/splice_pump.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/network/connection_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+// Capacity assumed when the kernel cannot report the pipe size.
+const uint64_t DefaultPipeCapacity = 65536;
+
+ssize_t spliceNonBlocking(int fd_in, int fd_out, uint64_t len) {
+#if defined(__linux__)
+  return ::splice(fd_in, nullptr, fd_out, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+#else
+  UNREFERENCED_PARAMETER(fd_in);
+  UNREFERENCED_PARAMETER(fd_out);
+  UNREFERENCED_PARAMETER(len);
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+} // namespace
+
+SplicePumpPtr SplicePump::create(Connection& source, Connection& destination, uint32_t pipe_size,
+                                 BytesMovedCb bytes_moved_cb) {
+#if defined(__linux__)
+  if (source.fd() == -1 || destination.fd() == -1) {
+    return nullptr;
+  }
+  // Data that the source's file event has received, or is still receiving, would be overtaken by
+  // spliced data.
+  const ConnectionImpl* source_impl = dynamic_cast<const ConnectionImpl*>(&source);
+  if (source_impl != nullptr && source_impl->receiving()) {
+    ENVOY_LOG(debug, "not splicing, the source connection receives through its file event");
+    return nullptr;
+  }
+
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    ENVOY_LOG(debug, "unable to create splice pipe: {}", errno);
+    return nullptr;
+  }
+
+  if (pipe_size > 0) {
+    // A size above /proc/sys/fs/pipe-max-size fails for unprivileged processes; the pipe then keeps
+    // its default capacity, which is still bounded.
+    ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(pipe_size));
+  }
+  const int capacity = ::fcntl(fds[1], F_GETPIPE_SZ);
+
+  return SplicePumpPtr{new SplicePump(
+      source, destination, fds[0], fds[1],
+      capacity > 0 ? static_cast<uint64_t>(capacity) : DefaultPipeCapacity, bytes_moved_cb)};
+#else
+  UNREFERENCED_PARAMETER(source);
+  UNREFERENCED_PARAMETER(destination);
+  UNREFERENCED_PARAMETER(pipe_size);
+  UNREFERENCED_PARAMETER(bytes_moved_cb);
+  return nullptr;
+#endif
+}
+
+SplicePump::SplicePump(Connection& source, Connection& destination, int pipe_read_fd,
+                       int pipe_write_fd, uint64_t pipe_capacity, BytesMovedCb bytes_moved_cb)
+    : source_(source), destination_(destination), pipe_read_fd_(pipe_read_fd),
+      pipe_write_fd_(pipe_write_fd), pipe_capacity_(pipe_capacity),
+      bytes_moved_cb_(bytes_moved_cb) {
+  ENVOY_CONN_LOG(debug, "splicing to connection {} with a {} byte pipe", source_,
+                 destination_.id(), pipe_capacity_);
+  source_.readDisable(true);
+
+  // Edge triggered registration reports the current readiness, so bytes that arrived before the
+  // pump was created are picked up by the first event.
+  Event::Dispatcher& dispatcher = source_.dispatcher();
+  source_event_ = dispatcher.createFileEvent(source_.fd(), [this](uint32_t) { onFileEvent(); },
+                                             Event::FileTriggerType::Edge,
+                                             Event::FileReadyType::Read);
+  destination_event_ = dispatcher.createFileEvent(
+      destination_.fd(), [this](uint32_t) { onFileEvent(); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Write);
+}
+
+SplicePump::~SplicePump() {
+  if (!complete_) {
+    source_event_.reset();
+    destination_event_.reset();
+    closePipe();
+    if (source_.state() == Connection::State::Open) {
+      source_.readDisable(false);
+    }
+  }
+}
+
+void SplicePump::readDisable(bool disable) {
+  if (disable) {
+    ++read_disable_count_;
+    return;
+  }
+
+  ASSERT(read_disable_count_ > 0);
+  if (--read_disable_count_ == 0 && !complete_) {
+    // The read edge may have been consumed while paused.
+    source_event_->activate(Event::FileReadyType::Read);
+  }
+}
+
+void SplicePump::onFileEvent() {
+  ASSERT(!complete_);
+
+  for (uint32_t fills = 0;; ++fills) {
+    // Always empty the pipe before reading more so that bytes reach the destination in order and
+    // the next read has the whole pipe available.
+    if (!flushPipe()) {
+      return;
+    }
+
+    if (source_done_) {
+      onComplete();
+      return;
+    }
+
+    if (read_disable_count_ > 0) {
+      return;
+    }
+
+    if (fills == MaxFillsPerEvent) {
+      // Yield to other connections and continue on the next loop iteration.
+      source_event_->activate(Event::FileReadyType::Read);
+      return;
+    }
+
+    const ssize_t rc = spliceNonBlocking(source_.fd(), pipe_write_fd_, pipe_capacity_);
+    if (rc > 0) {
+      pipe_bytes_ += rc;
+    } else if (rc < 0 && errno == EAGAIN) {
+      return;
+    } else {
+      // End of stream or a socket error. The source connection reports either once it reads again.
+      ENVOY_CONN_LOG(trace, "splice source done: rc={} errno={}", source_, rc, rc < 0 ? errno : 0);
+      source_done_ = true;
+    }
+  }
+}
+
+bool SplicePump::flushPipe() {
+  while (pipe_bytes_ > 0) {
+    const ssize_t rc = spliceNonBlocking(pipe_read_fd_, destination_.fd(), pipe_bytes_);
+    if (rc < 0 && errno == EAGAIN) {
+      // Wait for the destination write event.
+      return false;
+    }
+
+    if (rc <= 0) {
+      // The pipe contents can no longer be delivered. Hand the source back so both connections are
+      // torn down through their normal paths.
+      ENVOY_CONN_LOG(debug, "splice to connection {} failed: {}", source_, destination_.id(),
+                     rc < 0 ? errno : 0);
+      pipe_bytes_ = 0;
+      onComplete();
+      return false;
+    }
+
+    pipe_bytes_ -= rc;
+    bytes_moved_cb_(rc);
+  }
+
+  return true;
+}
+
+void SplicePump::onComplete() {
+  complete_ = true;
+  source_event_.reset();
+  destination_event_.reset();
+  closePipe();
+
+  if (source_.state() == Connection::State::Open) {
+    source_.readDisable(false);
+  }
+}
+
+void SplicePump::closePipe() {
+  if (pipe_read_fd_ != -1) {
+    ::close(pipe_read_fd_);
+    ::close(pipe_write_fd_);
+    pipe_read_fd_ = -1;
+    pipe_write_fd_ = -1;
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
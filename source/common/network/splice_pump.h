@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/network/connection.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePump;
+typedef std::unique_ptr<SplicePump> SplicePumpPtr;
+
+/**
+ * Moves bytes from the socket of one plaintext connection to the socket of another through a
+ * kernel pipe with splice(2), so the payload is never copied into user space.
+ *
+ * While active the pump holds a readDisable() reference on the source connection and services
+ * both descriptors with its own edge triggered file events. The pipe is the only buffer between
+ * the two sockets: once it is full the pump stops reading from the source until the destination
+ * drains it, which pushes back on the peer through the kernel exactly like a full write buffer
+ * does through the connection watermarks.
+ *
+ * When the source reaches end of stream or fails, the pump flushes what is left in the pipe and
+ * releases its readDisable() reference. The source connection's own read path then observes the
+ * same end of stream or error and raises the usual events, so half close and teardown behave as
+ * they do without the pump.
+ *
+ * The caller must ensure the destination has no buffered writes when the pump is created and must
+ * not write to the destination until the pump has completed or been destroyed.
+ */
+class SplicePump : Logger::Loggable<Logger::Id::connection> {
+public:
+  typedef std::function<void(uint64_t bytes)> BytesMovedCb;
+
+  /**
+   * @param source supplies the connection to read from.
+   * @param destination supplies the connection to write to.
+   * @param pipe_size supplies the requested pipe capacity, which bounds the number of bytes in
+   *        flight between the two sockets. 0 keeps the kernel default.
+   * @param bytes_moved_cb supplies the callback invoked with the number of bytes written to the
+   *        destination.
+   * @return SplicePumpPtr the new pump, or nullptr if splice() is not available on this platform,
+   *         the pipe could not be created, or the source's file event receives on its behalf.
+   */
+  static SplicePumpPtr create(Connection& source, Connection& destination, uint32_t pipe_size,
+                              BytesMovedCb bytes_moved_cb);
+
+  ~SplicePump();
+
+  /**
+   * Pause or resume reading from the source. Calls are counted in the same way as
+   * Connection::readDisable(); bytes already in the pipe are still flushed to the destination.
+   */
+  void readDisable(bool disable);
+
+  /**
+   * @return bool whether the source has been handed back to its connection.
+   */
+  bool complete() const { return complete_; }
+
+  /**
+   * @return uint64_t the number of bytes currently held in the pipe.
+   */
+  uint64_t pipeBytes() const { return pipe_bytes_; }
+
+private:
+  SplicePump(Connection& source, Connection& destination, int pipe_read_fd, int pipe_write_fd,
+             uint64_t pipe_capacity, BytesMovedCb bytes_moved_cb);
+
+  void onFileEvent();
+  bool flushPipe();
+  void onComplete();
+  void closePipe();
+
+  // Upper bound on the number of pipe fills moved in one event before yielding to the loop.
+  static const uint32_t MaxFillsPerEvent = 16;
+
+  Connection& source_;
+  Connection& destination_;
+  int pipe_read_fd_;
+  int pipe_write_fd_;
+  const uint64_t pipe_capacity_;
+  BytesMovedCb bytes_moved_cb_;
+  Event::FileEventPtr source_event_;
+  Event::FileEventPtr destination_event_;
+  uint64_t pipe_bytes_{};
+  uint32_t read_disable_count_{};
+  bool source_done_{};
+  bool complete_{};
+};
+
+} // namespace Network
+} // namespace Envoy
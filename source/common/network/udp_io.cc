@@ -0,0 +1,223 @@
+#include "common/network/udp_io.h"
+
+#include <netinet/in.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/network/address_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+socklen_t toSockAddr(const Address::Instance& address, sockaddr_storage& ss) {
+  memset(&ss, 0, sizeof(ss));
+  const Address::Ip* ip = address.ip();
+  ASSERT(ip != nullptr);
+  if (ip->version() == Address::IpVersion::v4) {
+    sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&ss);
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(ip->port());
+    sin->sin_addr.s_addr = ip->ipv4()->address();
+    return sizeof(sockaddr_in);
+  }
+
+  sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&ss);
+  sin6->sin6_family = AF_INET6;
+  sin6->sin6_port = htons(ip->port());
+  const absl::uint128 address_bits = ip->ipv6()->address();
+  static_assert(sizeof(address_bits) == sizeof(sin6->sin6_addr), "unexpected in6_addr size");
+  memcpy(static_cast<void*>(&sin6->sin6_addr), static_cast<const void*>(&address_bits),
+         sizeof(address_bits));
+  return sizeof(sockaddr_in6);
+}
+
+} // namespace
+
+void UdpReader::reserve(uint32_t index) {
+  if (buffers_[index] == nullptr) {
+    buffers_[index] = std::make_unique<Buffer::OwnedImpl>();
+    const uint64_t num_slices = buffers_[index]->reserve(MaxDatagramSize, &slices_[index], 1);
+    UNREFERENCED_PARAMETER(num_slices);
+    ASSERT(num_slices == 1 && slices_[index].len_ >= MaxDatagramSize);
+  }
+}
+
+UdpReader::Result UdpReader::read(int fd, bool peer_addresses, const ReadCb& cb) {
+  // Everything is allocated on the stack except for the payload buffers, which are kept across
+  // calls until they are filled.
+  iovec iovecs[BatchSize];
+  sockaddr_storage addresses[BatchSize];
+  uint32_t received = 0;
+  Result result;
+
+#if defined(__linux__)
+  mmsghdr messages[BatchSize];
+  memset(messages, 0, sizeof(messages));
+  for (uint32_t i = 0; i < BatchSize; i++) {
+    reserve(i);
+    iovecs[i].iov_base = slices_[i].mem_;
+    iovecs[i].iov_len = MaxDatagramSize;
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+    if (peer_addresses) {
+      messages[i].msg_hdr.msg_name = &addresses[i];
+      messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+    }
+  }
+
+  int rc;
+  do {
+    rc = ::recvmmsg(fd, messages, BatchSize, MSG_DONTWAIT, nullptr);
+  } while (rc == -1 && errno == EINTR);
+  if (rc == -1) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      result.error_ = errno;
+    }
+    return result;
+  }
+  received = rc;
+  auto datagram_length = [&messages](uint32_t i) -> uint64_t { return messages[i].msg_len; };
+  auto datagram_flags = [&messages](uint32_t i) -> int { return messages[i].msg_hdr.msg_flags; };
+  auto address_length = [&messages](uint32_t i) -> socklen_t {
+    return messages[i].msg_hdr.msg_namelen;
+  };
+#else
+  // Without recvmmsg() each datagram takes its own system call, but the batch is still handed to
+  // the caller in one go.
+  msghdr messages[BatchSize];
+  ssize_t lengths[BatchSize];
+  memset(messages, 0, sizeof(messages));
+  for (; received < BatchSize; received++) {
+    const uint32_t i = received;
+    reserve(i);
+    iovecs[i].iov_base = slices_[i].mem_;
+    iovecs[i].iov_len = MaxDatagramSize;
+    messages[i].msg_iov = &iovecs[i];
+    messages[i].msg_iovlen = 1;
+    if (peer_addresses) {
+      messages[i].msg_name = &addresses[i];
+      messages[i].msg_namelen = sizeof(addresses[i]);
+    }
+    do {
+      lengths[i] = ::recvmsg(fd, &messages[i], MSG_DONTWAIT);
+    } while (lengths[i] == -1 && errno == EINTR);
+    if (lengths[i] == -1) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        result.error_ = errno;
+      }
+      break;
+    }
+  }
+  auto datagram_length = [&lengths](uint32_t i) -> uint64_t { return lengths[i]; };
+  auto datagram_flags = [&messages](uint32_t i) -> int { return messages[i].msg_flags; };
+  auto address_length = [&messages](uint32_t i) -> socklen_t { return messages[i].msg_namelen; };
+#endif
+
+  for (uint32_t i = 0; i < received; i++) {
+    if (datagram_flags(i) & MSG_TRUNC) {
+      // The buffer can be used again as nothing was committed to it.
+      result.truncated_++;
+      continue;
+    }
+
+    slices_[i].len_ = datagram_length(i);
+    buffers_[i]->commit(&slices_[i], 1);
+    Buffer::InstancePtr buffer = std::move(buffers_[i]);
+    buffers_[i] = nullptr;
+    result.datagrams_++;
+    cb(peer_addresses ? Address::addressFromSockAddr(addresses[i], address_length(i), true)
+                      : nullptr,
+       std::move(buffer));
+  }
+  return result;
+}
+
+void UdpSendQueue::add(const Address::InstanceConstSharedPtr& peer_address,
+                       Buffer::Instance& data) {
+  datagrams_.emplace_back();
+  Datagram& datagram = datagrams_.back();
+  datagram.peer_address_len_ =
+      peer_address != nullptr ? toSockAddr(*peer_address, datagram.peer_address_) : 0;
+  datagram.buffer_.move(data);
+}
+
+UdpSendQueue::Result UdpSendQueue::flush(int fd) {
+  Result result;
+  iovec iovecs[BatchSize][MaxSlicesPerDatagram];
+  Buffer::RawSlice slices[MaxSlicesPerDatagram];
+
+  auto prepare = [&](Datagram& datagram, msghdr& message, iovec* datagram_iovecs) {
+    Buffer::Instance& buffer = datagram.buffer_;
+    if (buffer.getRawSlices(nullptr, 0) > MaxSlicesPerDatagram) {
+      buffer.linearize(buffer.length());
+    }
+    const uint64_t num_slices = std::min<uint64_t>(
+        buffer.getRawSlices(slices, MaxSlicesPerDatagram), MaxSlicesPerDatagram);
+    uint64_t num_iovecs = 0;
+    for (uint64_t i = 0; i < num_slices; i++) {
+      if (slices[i].len_ != 0) {
+        datagram_iovecs[num_iovecs].iov_base = slices[i].mem_;
+        datagram_iovecs[num_iovecs].iov_len = slices[i].len_;
+        num_iovecs++;
+      }
+    }
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = datagram_iovecs;
+    message.msg_iovlen = num_iovecs;
+    if (datagram.peer_address_len_ != 0) {
+      message.msg_name = &datagram.peer_address_;
+      message.msg_namelen = datagram.peer_address_len_;
+    }
+  };
+
+  size_t next = 0;
+  while (next < datagrams_.size()) {
+    const uint32_t batch =
+        std::min<size_t>(datagrams_.size() - next, static_cast<size_t>(BatchSize));
+#if defined(__linux__)
+    mmsghdr messages[BatchSize];
+    for (uint32_t i = 0; i < batch; i++) {
+      prepare(datagrams_[next + i], messages[i].msg_hdr, iovecs[i]);
+      messages[i].msg_len = 0;
+    }
+    const int rc = ::sendmmsg(fd, messages, batch, MSG_DONTWAIT);
+#else
+    msghdr message;
+    prepare(datagrams_[next], message, iovecs[0]);
+    const int rc = ::sendmsg(fd, &message, MSG_DONTWAIT) == -1 ? -1 : 1;
+#endif
+    if (rc == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        result.dropped_ += datagrams_.size() - next;
+        break;
+      }
+      // Skip the datagram that failed, for example with ECONNREFUSED after an ICMP port
+      // unreachable on a connected socket, and carry on with the rest.
+      result.dropped_++;
+      next++;
+      continue;
+    }
+
+    for (int i = 0; i < rc; i++) {
+      result.datagrams_++;
+      result.bytes_ += datagrams_[next + i].buffer_.length();
+    }
+    next += rc;
+  }
+
+  datagrams_.clear();
+  return result;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/network/address.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Reads datagrams from non-blocking sockets in batches, with a single recvmmsg() call per batch
+ * where it is available. Each datagram is read straight into its own buffer, whose memory comes
+ * from the calling thread's slice pool. Buffers that a batch doesn't fill are kept for the next
+ * one, so a single reader can serve all the sockets that are read on a thread.
+ */
+class UdpReader : NonCopyable {
+public:
+  // Datagrams read per system call.
+  static const uint32_t BatchSize = 16;
+  // Largest datagram that is read without truncation. This covers jumbo frames.
+  static const uint64_t MaxDatagramSize = 9000;
+
+  struct Result {
+    // Datagrams handed to the callback.
+    uint32_t datagrams_{};
+    // Datagrams dropped because they were larger than MaxDatagramSize.
+    uint32_t truncated_{};
+    // The error that ended the batch, or 0 if the batch was full or the socket had no more
+    // datagrams.
+    int error_{};
+  };
+
+  /**
+   * Called for each datagram that is read.
+   * @param peer_address supplies the sender, or nullptr if peer addresses were not requested.
+   * @param buffer supplies the payload.
+   */
+  typedef std::function<void(const Address::InstanceConstSharedPtr& peer_address,
+                             Buffer::InstancePtr&& buffer)>
+      ReadCb;
+
+  /**
+   * Read one batch of up to BatchSize datagrams.
+   * @param fd supplies the socket.
+   * @param peer_addresses supplies whether the sender of each datagram is needed. Connected sockets
+   *        can skip the address conversion.
+   * @param cb supplies the callback to invoke for each datagram.
+   * @return Result what the batch read.
+   */
+  Result read(int fd, bool peer_addresses, const ReadCb& cb);
+
+private:
+  void reserve(uint32_t index);
+
+  Buffer::InstancePtr buffers_[BatchSize];
+  Buffer::RawSlice slices_[BatchSize];
+};
+
+/**
+ * Datagrams waiting to be written to a socket. flush() writes them with as few sendmmsg() calls as
+ * possible.
+ */
+class UdpSendQueue : NonCopyable {
+public:
+  // Datagrams written per system call.
+  static const uint32_t BatchSize = 16;
+
+  struct Result {
+    // Datagrams written.
+    uint64_t datagrams_{};
+    // Payload bytes written.
+    uint64_t bytes_{};
+    // Datagrams that could not be written.
+    uint64_t dropped_{};
+  };
+
+  /**
+   * Queue a datagram.
+   * @param peer_address supplies the destination, or nullptr if the socket is connected.
+   * @param data supplies the payload, which is moved into the queue.
+   */
+  void add(const Address::InstanceConstSharedPtr& peer_address, Buffer::Instance& data);
+
+  /**
+   * Write and empty the queue. A datagram the kernel refuses is dropped. Once the socket's send
+   * buffer is full the rest of the queue is dropped as well, as there is no backpressure to wait
+   * for with UDP.
+   * @param fd supplies the socket.
+   * @return Result what was written.
+   */
+  Result flush(int fd);
+
+  bool empty() const { return datagrams_.empty(); }
+  uint64_t size() const { return datagrams_.size(); }
+
+private:
+  // Datagrams made of more slices than this are linearized before they are written.
+  static const uint32_t MaxSlicesPerDatagram = 8;
+
+  struct Datagram {
+    sockaddr_storage peer_address_;
+    socklen_t peer_address_len_;
+    Buffer::OwnedImpl buffer_;
+  };
+
+  std::deque<Datagram> datagrams_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,87 @@
+#include "common/network/udp_listener_impl.h"
+
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/event/dispatcher_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+UdpListenerImpl::UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket,
+                                 UdpListenerCallbacks& cb)
+    : fd_(socket.fd()), local_address_(socket.localAddress()), cb_(cb) {
+  file_event_ = dispatcher.createFileEvent(fd_, [this](uint32_t) -> void { onSocketReady(); },
+                                           Event::FileTriggerType::Level,
+                                           Event::FileReadyType::Read);
+}
+
+void UdpListenerImpl::onSocketReady() {
+  uint32_t read = 0;
+  // Stop after a batch comes back short, or once enough datagrams have been read that the other
+  // events of this worker are due. The file event is level triggered, so the remaining datagrams
+  // are picked up on the next pass of the event loop.
+  while (enabled_ && read < MaxDatagramsPerEvent) {
+    const UdpReader::Result result = reader_.read(
+        fd_, true,
+        [this](const Address::InstanceConstSharedPtr& peer_address, Buffer::InstancePtr&& buffer) {
+          UdpRecvData data{local_address_, peer_address, std::move(buffer)};
+          cb_.onData(data);
+        });
+    const uint32_t batch = result.datagrams_ + result.truncated_;
+    read += batch;
+    if (stats_ != nullptr) {
+      stats_->rx_datagrams_.add(result.datagrams_);
+      stats_->rx_datagrams_truncated_.add(result.truncated_);
+    }
+    if (result.error_ != 0) {
+      ENVOY_LOG_MISC(debug, "udp listener {} read error: {}", local_address_->asString(),
+                     strerror(result.error_));
+    }
+    if (batch < UdpReader::BatchSize) {
+      break;
+    }
+  }
+
+  if (read > 0) {
+    if (stats_ != nullptr) {
+      stats_->rx_batch_size_.recordValue(read);
+    }
+    cb_.onReadComplete();
+  }
+  flush();
+}
+
+void UdpListenerImpl::send(const Address::InstanceConstSharedPtr& peer_address,
+                           Buffer::Instance& data) {
+  send_queue_.add(peer_address, data);
+}
+
+void UdpListenerImpl::flush() {
+  if (send_queue_.empty()) {
+    return;
+  }
+  const UdpSendQueue::Result result = send_queue_.flush(fd_);
+  if (stats_ != nullptr) {
+    stats_->tx_datagrams_.add(result.datagrams_);
+    stats_->tx_datagrams_dropped_.add(result.dropped_);
+  }
+}
+
+void UdpListenerImpl::disable() {
+  enabled_ = false;
+  file_event_->setEnabled(0);
+}
+
+void UdpListenerImpl::enable() {
+  enabled_ = true;
+  file_event_->setEnabled(Event::FileReadyType::Read);
+}
+
+void UdpListenerImpl::setStats(const UdpStats& stats) {
+  stats_ = std::make_unique<UdpStats>(stats);
+}
+
+} // namespace Network
+} // namespace Envoy
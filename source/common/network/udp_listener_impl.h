@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/event/file_event.h"
+#include "envoy/network/listener.h"
+
+#include "common/event/dispatcher_impl.h"
+#include "common/network/udp_io.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Implementation of Network::UdpListener that reads batches of datagrams with recvmmsg() from a
+ * level triggered file event on the socket, and writes the datagrams queued with send() with
+ * sendmmsg().
+ */
+class UdpListenerImpl : public UdpListener {
+public:
+  UdpListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, UdpListenerCallbacks& cb);
+
+  // Network::UdpListener
+  void disable() override;
+  void enable() override;
+  const Address::InstanceConstSharedPtr& localAddress() const override { return local_address_; }
+  void send(const Address::InstanceConstSharedPtr& peer_address, Buffer::Instance& data) override;
+  void flush() override;
+  void setStats(const UdpStats& stats) override;
+
+  // Datagrams read per readiness event before yielding to the other events of the worker. This
+  // matches the default accept batch size of stream listeners.
+  static const uint32_t MaxDatagramsPerEvent = 64;
+
+private:
+  void onSocketReady();
+
+  const int fd_;
+  const Address::InstanceConstSharedPtr local_address_;
+  UdpListenerCallbacks& cb_;
+  Event::FileEventPtr file_event_;
+  UdpReader reader_;
+  UdpSendQueue send_queue_;
+  bool enabled_{true};
+  std::unique_ptr<UdpStats> stats_;
+};
+
+} // namespace Network
+} // namespace Envoy
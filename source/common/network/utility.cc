@@ -4,6 +4,7 @@
 #include <ifaddrs.h>
 
 #if defined(__linux__)
+#include <linux/filter.h>
 #include <linux/netfilter_ipv4.h>
 #endif
 
@@ -31,11 +32,14 @@ namespace Envoy {
 namespace Network {
 
 const std::string Utility::TCP_SCHEME = "tcp://";
+const std::string Utility::UDP_SCHEME = "udp://";
 const std::string Utility::UNIX_SCHEME = "unix://";
 
 Address::InstanceConstSharedPtr Utility::resolveUrl(const std::string& url) {
   if (urlIsTcpScheme(url)) {
     return parseInternetAddressAndPort(url.substr(TCP_SCHEME.size()));
+  } else if (urlIsUdpScheme(url)) {
+    return parseInternetAddressAndPort(url.substr(UDP_SCHEME.size()));
   } else if (urlIsUnixScheme(url)) {
     return Address::InstanceConstSharedPtr{
         new Address::PipeInstance(url.substr(UNIX_SCHEME.size()))};
@@ -46,6 +50,8 @@ Address::InstanceConstSharedPtr Utility::resolveUrl(const std::string& url) {
 
 bool Utility::urlIsTcpScheme(const std::string& url) { return url.find(TCP_SCHEME) == 0; }
 
+bool Utility::urlIsUdpScheme(const std::string& url) { return url.find(UDP_SCHEME) == 0; }
+
 bool Utility::urlIsUnixScheme(const std::string& url) { return url.find(UNIX_SCHEME) == 0; }
 
 std::string Utility::hostFromTcpUrl(const std::string& url) {
@@ -310,6 +316,27 @@ Address::InstanceConstSharedPtr Utility::getOriginalDst(int fd) {
 #endif
 }
 
+bool Utility::attachReusePortCpuSteering(int fd, uint32_t num_sockets) {
+  ASSERT(num_sockets > 0);
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  // A = raw_smp_processor_id() % num_sockets; return A. The kernel falls back to hashing when the
+  // returned index is past the end of the group.
+  sock_filter code[] = {
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, num_sockets},
+      {BPF_RET | BPF_A, 0, 0, 0},
+  };
+  sock_fprog program;
+  program.len = sizeof(code) / sizeof(code[0]);
+  program.filter = code;
+  return setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0;
+#else
+  UNREFERENCED_PARAMETER(fd);
+  UNREFERENCED_PARAMETER(num_sockets);
+  return false;
+#endif
+}
+
 void Utility::parsePortRangeList(absl::string_view string, std::list<PortRange>& list) {
   const auto ranges = StringUtil::splitToken(string, ",");
   for (auto s : ranges) {
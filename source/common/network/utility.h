@@ -35,6 +35,7 @@ typedef std::list<PortRange> PortRangeList;
 class Utility {
 public:
   static const std::string TCP_SCHEME;
+  static const std::string UDP_SCHEME;
   static const std::string UNIX_SCHEME;
 
   /**
@@ -51,6 +52,13 @@ public:
    */
   static bool urlIsTcpScheme(const std::string& url);
 
+  /**
+   * Match a URL to the UDP scheme
+   * @param url supplies the URL to match.
+   * @return bool true if the URL matches the UDP scheme, false otherwise.
+   */
+  static bool urlIsUdpScheme(const std::string& url);
+
   /**
    * Match a URL to the Unix scheme
    * @param url supplies the Unix to match.
@@ -169,6 +177,17 @@ public:
    */
   static Address::InstanceConstSharedPtr getOriginalDst(int fd);
 
+  /**
+   * Attach a classic BPF program to the SO_REUSEPORT group of a listen socket that picks the
+   * member socket whose index equals the CPU that received the connection, modulo the number of
+   * sockets. Members are numbered in the order they started listening.
+   * @param fd supplies any listen socket of the group.
+   * @param num_sockets supplies the number of sockets in the group.
+   * @return bool true if the program was attached, false if the platform doesn't support it or
+   *         the kernel rejected it.
+   */
+  static bool attachReusePortCpuSteering(int fd, uint32_t num_sockets);
+
   /**
    * Parses a string containing a comma-separated list of port numbers and/or
    * port ranges and appends the values to a caller-provided list of PortRange structures.
@@ -0,0 +1,240 @@
+#include "common/network/zero_copy_sender.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <list>
+
+#include "envoy/event/timer.h"
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/common/utility.h"
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+
+// Older C library headers predate the zero copy API.
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+// How long a released sender waits for outstanding sends before resetting its socket.
+const std::chrono::seconds LingerTimeout{10};
+
+// Maximum number of slices passed to one sendmsg() call, as in Buffer::OwnedImpl::write().
+const uint64_t MaxSlices = 16;
+
+// How often lingering senders are swept while there are any.
+const std::chrono::seconds SweepInterval{1};
+
+// Released senders that still have sends outstanding. Connections are closed on the thread that
+// owns them, so every list is only touched by its own thread. The list is swept whenever a sender
+// is created or released on the thread, and by a timer on the dispatcher that released a sender
+// last, so that senders are freed on a thread that stops opening and closing connections too.
+struct LingeringSenders {
+  std::list<ZeroCopySenderPtr> senders_;
+  MonotonicTimeSource* time_source_{&ProdMonotonicTimeSource::instance_};
+  Event::Dispatcher* dispatcher_{};
+  Event::TimerPtr sweep_timer_;
+};
+
+thread_local LingeringSenders lingering;
+
+} // namespace
+
+ZeroCopySenderPtr ZeroCopySender::create(int fd) {
+#if defined(__linux__)
+  sweepLingering();
+
+  const int enable = 1;
+  if (::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) != 0) {
+    ENVOY_LOG(debug, "SO_ZEROCOPY is not available on fd {}: {}", fd, errno);
+    return nullptr;
+  }
+  return ZeroCopySenderPtr{new ZeroCopySender(fd)};
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return nullptr;
+#endif
+}
+
+void ZeroCopySender::release(ZeroCopySenderPtr&& sender, Event::Dispatcher& dispatcher,
+                             MonotonicTimeSource& time_source) {
+  ZeroCopySenderPtr released = std::move(sender);
+  lingering.time_source_ = &time_source;
+  released->reap();
+  sweepLingering();
+  if (released->pending_.empty()) {
+    return;
+  }
+
+  const int fd = ::dup(released->fd_);
+  if (fd == -1) {
+    // There is no way to wait for the completions, so make the owner's close() reset the
+    // connection, which drops the queued data along with its references to the slices.
+    const struct linger reset = {1, 0};
+    ::setsockopt(released->fd_, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    return;
+  }
+
+  // The duplicate keeps the socket open after the owner closes its descriptor, so shut it down
+  // here to give the peer the same end of stream that close() would have.
+  ::shutdown(fd, SHUT_RDWR);
+  ENVOY_LOG(debug, "lingering on fd {} for {} zero copy sends", fd, released->pending_.size());
+  released->fd_ = fd;
+  released->owns_fd_ = true;
+  released->linger_deadline_ = time_source.currentTime() + LingerTimeout;
+  lingering.senders_.emplace_back(std::move(released));
+  scheduleSweep(dispatcher);
+}
+
+void ZeroCopySender::onDispatcherDestroyed(Event::Dispatcher& dispatcher) {
+  if (lingering.dispatcher_ == &dispatcher) {
+    lingering.sweep_timer_.reset();
+    lingering.dispatcher_ = nullptr;
+  }
+}
+
+ZeroCopySender::~ZeroCopySender() {
+  if (!owns_fd_) {
+    return;
+  }
+
+  if (!pending_.empty()) {
+    // Reset the connection so the kernel drops the data that still references the slices.
+    const struct linger reset = {1, 0};
+    ::setsockopt(fd_, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+  }
+  ::close(fd_);
+}
+
+int ZeroCopySender::send(Buffer::OwnedImpl& buffer) {
+#if defined(__linux__)
+  ASSERT(!buffer.usesOldImpl());
+  Buffer::RawSlice slices[MaxSlices];
+  const uint64_t num_slices = std::min(buffer.getRawSlices(slices, MaxSlices), MaxSlices);
+  if (num_slices == 0) {
+    return 0;
+  }
+
+  struct iovec iov[MaxSlices];
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+
+  struct msghdr message {};
+  message.msg_iov = iov;
+  message.msg_iovlen = num_slices;
+  const ssize_t rc = ::sendmsg(fd_, &message, MSG_ZEROCOPY);
+  if (rc > 0) {
+    // Every successful zero copy send gets the next sequence number on the socket, whether or not
+    // it sent everything that was offered.
+    pending_.emplace_back();
+    buffer.drainRetained(rc, pending_.back());
+  }
+  return static_cast<int>(rc);
+#else
+  UNREFERENCED_PARAMETER(buffer);
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+uint64_t ZeroCopySender::reap() {
+  uint64_t copied = 0;
+#if defined(__linux__)
+  while (!pending_.empty()) {
+    uint8_t control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+    struct msghdr message {};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (::recvmsg(fd_, &message, MSG_ERRQUEUE) == -1) {
+      // EAGAIN once the queue is empty.
+      break;
+    }
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      const auto* error = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cmsg));
+      if (error->ee_origin != SO_EE_ORIGIN_ZEROCOPY || error->ee_errno != 0) {
+        continue;
+      }
+
+      // The notification covers sends ee_info through ee_data. TCP completes sends in order, so
+      // everything up to ee_data is done even if an earlier notification was merged into this one.
+      const uint32_t last = error->ee_data;
+      while (!pending_.empty() && static_cast<int32_t>(last - next_completion_) >= 0) {
+        pending_.pop_front();
+        next_completion_++;
+        if (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+          copied++;
+        }
+      }
+    }
+  }
+#endif
+  return copied;
+}
+
+uint64_t ZeroCopySender::lingeringSenders() { return lingering.senders_.size(); }
+
+void ZeroCopySender::scheduleSweep(Event::Dispatcher& dispatcher) {
+  if (lingering.dispatcher_ != &dispatcher) {
+    lingering.sweep_timer_ = dispatcher.createTimer([]() -> void {
+      sweepLingering();
+      if (!lingering.senders_.empty()) {
+        lingering.sweep_timer_->enableTimer(SweepInterval);
+      }
+    });
+    lingering.dispatcher_ = &dispatcher;
+  }
+  lingering.sweep_timer_->enableTimer(SweepInterval);
+}
+
+void ZeroCopySender::sweepLingering() {
+  if (lingering.senders_.empty()) {
+    return;
+  }
+
+  const MonotonicTime now = lingering.time_source_->currentTime();
+  for (auto it = lingering.senders_.begin(); it != lingering.senders_.end();) {
+    ZeroCopySender& sender = **it;
+    sender.reap();
+    if (sender.pending_.empty() || now >= sender.linger_deadline_) {
+      it = lingering.senders_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (lingering.senders_.empty() && lingering.sweep_timer_ != nullptr) {
+    lingering.sweep_timer_->disableTimer();
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
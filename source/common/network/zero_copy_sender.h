@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+class ZeroCopySender;
+typedef std::unique_ptr<ZeroCopySender> ZeroCopySenderPtr;
+
+/**
+ * Sends buffer content on a TCP socket with MSG_ZEROCOPY (Linux 4.14 and later), so the kernel
+ * transmits straight from the buffer's slices instead of copying them into socket memory.
+ *
+ * The kernel keeps referencing the slices after sendmsg() returns. Bytes that were sent are
+ * drained from the buffer with OwnedImpl::drainRetained() and the slices are held here until
+ * the kernel reports through the socket error queue that the send has completed. Completion
+ * notifications raise EPOLLERR, which libevent reports as a write event on the connection.
+ *
+ * The kernel falls back to copying internally when it cannot transmit from user memory, for
+ * example on loopback. It still posts a completion, flagged as copied, which reap() counts so
+ * that operators can tell whether zero copy is effective.
+ */
+class ZeroCopySender : Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * Enable zero copy sends on a socket.
+   * @param fd supplies the socket. It must stay open until release() is called.
+   * @return ZeroCopySenderPtr a sender for the socket, or nullptr if the platform or the socket
+   *         does not support SO_ZEROCOPY.
+   */
+  static ZeroCopySenderPtr create(int fd);
+
+  /**
+   * Hand over a sender whose socket is about to be closed by its owner. Sends that are still
+   * outstanding keep referencing their slices after close(), so the sender shuts the socket
+   * down, keeps a duplicate of the descriptor along with the slices on a per-thread list, and
+   * frees both once the kernel reports the sends complete or a fixed timeout passes, whichever
+   * comes first. After the timeout the socket is reset, which discards whatever is left unsent.
+   * The list is swept by a timer on the dispatcher while it is not empty.
+   * @param sender supplies the sender to release.
+   * @param dispatcher supplies the dispatcher of the calling thread, which runs the sweep timer.
+   * @param time_source supplies the time source the timeout is measured with.
+   */
+  static void release(ZeroCopySenderPtr&& sender, Event::Dispatcher& dispatcher,
+                      MonotonicTimeSource& time_source);
+
+  /**
+   * Stop sweeping released senders on a dispatcher that is being destroyed. Senders that are still
+   * lingering on the calling thread are swept when the next sender is created or released, and
+   * freed when the thread exits.
+   * @param dispatcher supplies the dispatcher being destroyed.
+   */
+  static void onDispatcherDestroyed(Event::Dispatcher& dispatcher);
+
+  ~ZeroCopySender();
+
+  /**
+   * Send as much of a buffer as the socket accepts. The bytes sent are drained from the buffer,
+   * but their memory is retained until the kernel no longer references it.
+   * @param buffer supplies the buffer to send from. It must not use the evbuffer implementation.
+   * @return int the number of bytes sent, or -1 with errno set, as for Buffer::Instance::write().
+   *         ENOBUFS means the kernel could not pin more memory for the socket; the caller
+   *         should copy the data instead.
+   */
+  int send(Buffer::OwnedImpl& buffer);
+
+  /**
+   * Read completion notifications from the socket error queue and release the slices of every
+   * completed send.
+   * @return uint64_t the number of completed sends that the kernel satisfied by copying.
+   */
+  uint64_t reap();
+
+  /**
+   * @return uint64_t the number of sends whose slices are still referenced by the kernel.
+   */
+  uint64_t pendingSends() const { return pending_.size(); }
+
+  /**
+   * @return uint64_t the number of released senders on this thread still waiting for completions.
+   */
+  static uint64_t lingeringSenders();
+
+private:
+  ZeroCopySender(int fd) : fd_(fd) {}
+
+  static void scheduleSweep(Event::Dispatcher& dispatcher);
+  static void sweepLingering();
+
+  int fd_;
+  // True once the sender has been released and fd_ is its own duplicate.
+  bool owns_fd_{};
+  MonotonicTime linger_deadline_;
+  // Slices of every send the kernel has not completed yet, oldest first. The front entry
+  // belongs to send number next_completion_, counting from zero as the kernel does.
+  std::deque<std::vector<Buffer::SliceSharedPtr>> pending_;
+  uint32_t next_completion_{};
+};
+
+} // namespace Network
+} // namespace Envoy
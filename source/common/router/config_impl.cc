@@ -48,6 +48,13 @@ RetryPolicyImpl::RetryPolicyImpl(const envoy::api::v2::route::RouteAction& confi
   num_retries_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.retry_policy(), num_retries, 1);
   retry_on_ = RetryStateImpl::parseRetryOn(config.retry_policy().retry_on());
   retry_on_ |= RetryStateImpl::parseRetryGrpcOn(config.retry_policy().retry_on());
+
+  if (config.retry_policy().has_hedge_policy()) {
+    const auto& hedge_policy = config.retry_policy().hedge_policy();
+    hedge_delay_ = std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(hedge_policy, delay));
+    hedge_latency_percentile_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(hedge_policy, latency_percentile, 0);
+  }
 }
 
 CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config) {
@@ -73,6 +80,11 @@ ShadowPolicyImpl::ShadowPolicyImpl(const envoy::api::v2::route::RouteAction& con
   runtime_key_ = config.request_mirror_policy().runtime_key();
 }
 
+RequestCoalescingPolicyImpl::RequestCoalescingPolicyImpl(
+    const envoy::api::v2::route::RouteAction::RequestCoalescing& config)
+    : max_waiters_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_waiters, 1000)),
+      max_wait_(PROTOBUF_GET_MS_OR_DEFAULT(config, max_wait, 5000)) {}
+
 class HeaderHashMethod : public HashPolicyImpl::HashMethod {
 public:
   HeaderHashMethod(const std::string& header_name) : header_name_(header_name) {}
@@ -318,6 +330,11 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
     hash_policy_.reset(new HashPolicyImpl(route.route().hash_policy()));
   }
 
+  if (route.route().has_request_coalescing()) {
+    request_coalescing_policy_.reset(
+        new RequestCoalescingPolicyImpl(route.route().request_coalescing()));
+  }
+
   // Only set include_vh_rate_limits_ to true if the rate limit policy for the route is empty
   // or the route set `include_vh_rate_limits` to true.
   include_vh_rate_limits_ =
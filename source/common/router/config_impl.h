@@ -189,11 +189,15 @@ public:
   std::chrono::milliseconds perTryTimeout() const override { return per_try_timeout_; }
   uint32_t numRetries() const override { return num_retries_; }
   uint32_t retryOn() const override { return retry_on_; }
+  std::chrono::milliseconds hedgeDelay() const override { return hedge_delay_; }
+  double hedgeLatencyPercentile() const override { return hedge_latency_percentile_; }
 
 private:
   std::chrono::milliseconds per_try_timeout_{0};
   uint32_t num_retries_{};
   uint32_t retry_on_{};
+  std::chrono::milliseconds hedge_delay_{0};
+  double hedge_latency_percentile_{};
 };
 
 /**
@@ -212,6 +216,22 @@ private:
   std::string runtime_key_;
 };
 
+/**
+ * Implementation of RequestCoalescingPolicy that reads from the proto route config.
+ */
+class RequestCoalescingPolicyImpl : public RequestCoalescingPolicy {
+public:
+  RequestCoalescingPolicyImpl(const envoy::api::v2::route::RouteAction::RequestCoalescing& config);
+
+  // Router::RequestCoalescingPolicy
+  uint32_t maxWaiters() const override { return max_waiters_; }
+  std::chrono::milliseconds maxWait() const override { return max_wait_; }
+
+private:
+  const uint32_t max_waiters_;
+  const std::chrono::milliseconds max_wait_;
+};
+
 /**
  * Implementation of HashPolicy that reads from the proto route config and only currently supports
  * hashing on an HTTP header.
@@ -305,6 +325,9 @@ public:
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
   const RetryPolicy& retryPolicy() const override { return retry_policy_; }
   const ShadowPolicy& shadowPolicy() const override { return shadow_policy_; }
+  const RequestCoalescingPolicy* requestCoalescingPolicy() const override {
+    return request_coalescing_policy_.get();
+  }
   const VirtualCluster* virtualCluster(const Http::HeaderMap& headers) const override {
     return vhost_.virtualClusterFromEntries(headers);
   }
@@ -380,6 +403,9 @@ private:
     const RateLimitPolicy& rateLimitPolicy() const override { return parent_->rateLimitPolicy(); }
     const RetryPolicy& retryPolicy() const override { return parent_->retryPolicy(); }
     const ShadowPolicy& shadowPolicy() const override { return parent_->shadowPolicy(); }
+    const RequestCoalescingPolicy* requestCoalescingPolicy() const override {
+      return parent_->requestCoalescingPolicy();
+    }
     std::chrono::milliseconds timeout() const override { return parent_->timeout(); }
     const MetadataMatchCriteria* metadataMatchCriteria() const override {
       return parent_->metadataMatchCriteria();
@@ -510,6 +536,7 @@ private:
   std::vector<WeightedClusterEntrySharedPtr> weighted_clusters_;
   const uint64_t total_cluster_weight_;
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
+  std::unique_ptr<const RequestCoalescingPolicyImpl> request_coalescing_policy_;
   MetadataMatchCriteriaConstPtr metadata_match_criteria_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
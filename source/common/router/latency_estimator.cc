@@ -0,0 +1,65 @@
+#include "common/router/latency_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Router {
+
+// These are defined in the header, but an ODR use needs storage.
+const uint32_t LatencyEstimator::MIN_SAMPLES;
+const uint32_t LatencyEstimator::DECAY_SAMPLES;
+
+void LatencyEstimator::addSample(std::chrono::milliseconds latency) {
+  counts_[bucket(latency.count() > 0 ? latency.count() : 0)]++;
+  samples_++;
+
+  if (++samples_since_decay_ == DECAY_SAMPLES) {
+    samples_since_decay_ = 0;
+    samples_ = 0;
+    for (uint32_t& count : counts_) {
+      count /= 2;
+      samples_ += count;
+    }
+  }
+}
+
+absl::optional<std::chrono::milliseconds> LatencyEstimator::percentile(double percentile) const {
+  ASSERT(percentile > 0 && percentile <= 100);
+  if (samples_ < MIN_SAMPLES) {
+    return absl::nullopt;
+  }
+
+  const uint64_t rank = std::max<uint64_t>(1, std::ceil(samples_ * percentile / 100));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::chrono::milliseconds(bucketUpperBound(i));
+    }
+  }
+  NOT_REACHED;
+}
+
+uint32_t LatencyEstimator::bucket(uint64_t value) {
+  if (value < 4) {
+    return value;
+  }
+  // The position of the highest bit, at least 2, picks the power of two and the next two bits the
+  // quarter within it.
+  const uint32_t exponent = 63 - __builtin_clzll(value);
+  return 4 * (exponent - 1) + ((value >> (exponent - 2)) & 3);
+}
+
+uint64_t LatencyEstimator::bucketUpperBound(uint32_t bucket) {
+  if (bucket < 4) {
+    return bucket;
+  }
+  const uint32_t shift = bucket / 4 - 1;
+  return (static_cast<uint64_t>(5 + bucket % 4) << shift) - 1;
+}
+
+} // namespace Router
+} // namespace Envoy
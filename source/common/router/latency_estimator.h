@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Estimates percentiles of recent latencies. Latencies are counted in a histogram whose buckets
+ * are at most a quarter as wide as the values in them, so that an estimate is at most 25% above
+ * the actual percentile. The counts halve every DECAY_SAMPLES samples, so that old latencies weigh
+ * less than recent ones. Not thread safe.
+ */
+class LatencyEstimator {
+public:
+  // The samples needed before there are estimates.
+  static const uint32_t MIN_SAMPLES = 100;
+  // The samples after which the counts halve.
+  static const uint32_t DECAY_SAMPLES = 1000;
+
+  /**
+   * Count a latency.
+   * @param latency supplies the latency.
+   */
+  void addSample(std::chrono::milliseconds latency);
+
+  /**
+   * @param percentile supplies the percentile to estimate, in (0, 100].
+   * @return absl::optional<std::chrono::milliseconds> the estimate, or nothing until there have
+   *         been MIN_SAMPLES samples.
+   */
+  absl::optional<std::chrono::milliseconds> percentile(double percentile) const;
+
+private:
+  // Values below 4 have a bucket each, and each power of two above that is split in 4 buckets.
+  static const uint32_t BUCKETS = 4 * 63;
+
+  static uint32_t bucket(uint64_t value);
+  static uint64_t bucketUpperBound(uint32_t bucket);
+
+  std::array<uint32_t, BUCKETS> counts_{};
+  uint64_t samples_{};
+  uint32_t samples_since_decay_{};
+};
+
+} // namespace Router
+} // namespace Envoy
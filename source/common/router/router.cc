@@ -1,5 +1,6 @@
 #include "common/router/router.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -32,6 +33,9 @@ namespace Envoy {
 namespace Router {
 namespace {
 uint32_t getLength(const Buffer::Instance* instance) { return instance ? instance->length() : 0; }
+
+// How many times the load balancer is asked for a host other than the one of the first attempt.
+const uint32_t HedgeHostSelectionAttempts = 3;
 } // namespace
 
 void FilterUtility::setUpstreamScheme(Http::HeaderMap& headers,
@@ -100,10 +104,81 @@ FilterUtility::finalTimeout(const RouteEntry& route, Http::HeaderMap& request_he
   return timeout;
 }
 
+bool FilterUtility::coalescable(const Http::HeaderMap& request_headers) {
+  return request_headers.Method()->value() == Http::Headers::get().MethodValues.Get.c_str() &&
+         request_headers.Authorization() == nullptr &&
+         request_headers.get(Http::Headers::get().Cookie) == nullptr &&
+         request_headers.get(Http::Headers::get().Range) == nullptr;
+}
+
+std::string FilterUtility::coalescingKey(const std::string& cluster_name,
+                                         const Http::HeaderMap& request_headers) {
+  std::string key(cluster_name);
+  key.append("\n");
+  // The router has already replaced :scheme with the upstream scheme, so use the downstream scheme
+  // that the connection manager recorded in x-forwarded-proto when it is there.
+  const Http::HeaderEntry* scheme = request_headers.ForwardedProto() != nullptr
+                                        ? request_headers.ForwardedProto()
+                                        : request_headers.Scheme();
+  if (scheme != nullptr) {
+    key.append(scheme->value().c_str(), scheme->value().size());
+  }
+  key.append("\n");
+  key.append(request_headers.Host()->value().c_str(), request_headers.Host()->value().size());
+  key.append("\n");
+  key.append(request_headers.Path()->value().c_str(), request_headers.Path()->value().size());
+  return key;
+}
+
+bool FilterUtility::shareableResponse(const Http::HeaderMap& response_headers) {
+  if (response_headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    return false;
+  }
+  const Http::HeaderEntry* vary = response_headers.Vary();
+  if (vary != nullptr && StringUtil::findToken(vary->value().getStringView(), ",", "*")) {
+    return false;
+  }
+  const Http::HeaderEntry* cache_control = response_headers.CacheControl();
+  if (cache_control == nullptr) {
+    return true;
+  }
+  const absl::string_view directives = cache_control->value().getStringView();
+  return !StringUtil::caseFindToken(directives, ",",
+                                    Http::Headers::get().CacheControlValues.Private) &&
+         !StringUtil::caseFindToken(directives, ",",
+                                    Http::Headers::get().CacheControlValues.NoStore) &&
+         !StringUtil::caseFindToken(directives, ",",
+                                    Http::Headers::get().CacheControlValues.NoCache);
+}
+
+bool FilterUtility::varyMatches(const Http::HeaderMap& response_headers,
+                                const Http::HeaderMap& request_headers,
+                                const Http::HeaderMap& coalesced_request_headers) {
+  const Http::HeaderEntry* vary = response_headers.Vary();
+  if (vary == nullptr) {
+    return true;
+  }
+  for (absl::string_view name : StringUtil::splitToken(vary->value().getStringView(), ",")) {
+    const Http::LowerCaseString header(std::string(StringUtil::trim(name)));
+    const Http::HeaderEntry* entry = request_headers.get(header);
+    const Http::HeaderEntry* coalesced_entry = coalesced_request_headers.get(header);
+    if (entry == nullptr || coalesced_entry == nullptr) {
+      if (entry != coalesced_entry) {
+        return false;
+      }
+    } else if (entry->value().getStringView() != coalesced_entry->value().getStringView()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 Filter::~Filter() {
   // Upstream resources should already have been cleaned.
   ASSERT(!upstream_request_);
+  ASSERT(!hedge_request_);
   ASSERT(!retry_state_);
+  ASSERT(coalescing_key_.empty() && coalesced_waiters_.empty() && !coalescing_leader_);
 }
 
 const std::string Filter::upstreamZone(Upstream::HostDescriptionConstSharedPtr upstream_host) {
@@ -284,9 +359,14 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool e
                        config_.random_, callbacks_->dispatcher(), route_entry_->priority());
   do_shadowing_ = FilterUtility::shouldShadow(route_entry_->shadowPolicy(), config_.runtime_,
                                               callbacks_->streamId());
+  do_hedging_ = route_entry_->retryPolicy().hedgeDelay().count() > 0;
 
   ENVOY_STREAM_LOG(debug, "router decoding headers:\n{}", *callbacks_, headers);
 
+  if (end_stream && joinCoalescedRequest(headers)) {
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
   upstream_request_.reset(new UpstreamRequest(*this, *conn_pool));
   upstream_request_->encodeHeaders(end_stream);
   if (end_stream) {
@@ -319,18 +399,19 @@ void Filter::sendNoHealthyUpstreamResponse() {
 }
 
 Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_stream) {
-  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_;
+  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_ || do_hedging_;
   if (buffering && buffer_limit_ > 0 &&
       getLength(callbacks_->decodingBuffer()) + data.length() > buffer_limit_) {
-    // The request is larger than we should buffer. Give up on the retry/shadow
+    // The request is larger than we should buffer. Give up on the retry/shadow/hedge
     cluster_->stats().retry_or_shadow_abandoned_.inc();
     retry_state_.reset();
     buffering = false;
     do_shadowing_ = false;
+    do_hedging_ = false;
   }
 
-  // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-  // since it's all moves from here on.
+  // If we are going to buffer for retries, shadowing or hedging, we need to make a copy before
+  // encoding since it's all moves from here on.
   if (buffering) {
     Buffer::OwnedImpl copy(data);
     upstream_request_->encodeData(copy, end_stream);
@@ -365,12 +446,31 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 }
 
 void Filter::cleanup() {
+  // Requests that waited for this one either go upstream on their own or, if their response has
+  // started, are reset. On a complete response they have left already.
+  unregisterCoalescedRequest();
+  if (!coalesced_waiters_.empty()) {
+    if (downstream_response_started_) {
+      resetCoalescedWaiters();
+    } else {
+      releaseCoalescedWaiters();
+    }
+  }
+
   upstream_request_.reset();
+  if (hedge_request_) {
+    hedge_request_.reset();
+    cluster_->resourceManager(route_entry_->priority()).retries().dec();
+  }
   retry_state_.reset();
   if (response_timeout_) {
     response_timeout_->disableTimer();
     response_timeout_.reset();
   }
+  if (hedge_timer_) {
+    hedge_timer_->disableTimer();
+    hedge_timer_.reset();
+  }
 }
 
 void Filter::maybeDoShadowing() {
@@ -408,13 +508,22 @@ void Filter::onRequestComplete() {
           callbacks_->dispatcher().createTimer([this]() -> void { onResponseTimeout(); });
       response_timeout_->enableTimer(timeout_.global_timeout_);
     }
+
+    if (do_hedging_) {
+      hedge_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { onHedgeTimeout(); });
+      hedge_timer_->enableTimer(hedgeDelay());
+    }
   }
 }
 
 void Filter::onDestroy() {
+  leaveCoalescedRequest();
   if (upstream_request_) {
     upstream_request_->resetStream();
   }
+  if (hedge_request_) {
+    hedge_request_->resetStream();
+  }
   stream_destroyed_ = true;
   cleanup();
 }
@@ -431,6 +540,12 @@ void Filter::onResponseTimeout() {
     }
     upstream_request_->resetStream();
   }
+  if (hedge_request_) {
+    if (hedge_request_->upstream_host_) {
+      hedge_request_->upstream_host_->stats().rq_timeout_.inc();
+    }
+    hedge_request_->resetStream();
+  }
 
   onUpstreamReset(UpstreamResetType::GlobalTimeout, absl::optional<Http::StreamResetReason>());
 }
@@ -550,9 +665,15 @@ void Filter::handleNon5xxResponseHeaders(const Http::HeaderMap& headers, bool en
   }
 }
 
-void Filter::onUpstream100ContinueHeaders(Http::HeaderMapPtr&& headers) {
+void Filter::onUpstream100ContinueHeaders(UpstreamRequest& upstream_request,
+                                          Http::HeaderMapPtr&& headers) {
   ENVOY_STREAM_LOG(debug, "upstream 100 continue", *callbacks_);
 
+  // The response of this attempt is starting, so a hedged one is of no use.
+  if (hedge_request_) {
+    abandonOtherAttempt(upstream_request);
+  }
+
   downstream_response_started_ = true;
   // Don't send retries after 100-Continue has been sent on. Arguably we could attempt to do a
   // retry, assume the next upstream would also send an 100-Continue and swallow the second one
@@ -563,10 +684,16 @@ void Filter::onUpstream100ContinueHeaders(Http::HeaderMapPtr&& headers) {
   callbacks_->encode100ContinueHeaders(std::move(headers));
 }
 
-void Filter::onUpstreamHeaders(const uint64_t response_code, Http::HeaderMapPtr&& headers,
-                               bool end_stream) {
+void Filter::onUpstreamHeaders(UpstreamRequest& upstream_request, const uint64_t response_code,
+                               Http::HeaderMapPtr&& headers, bool end_stream) {
   ENVOY_STREAM_LOG(debug, "upstream headers complete: end_stream={}", *callbacks_, end_stream);
 
+  if (hedge_request_ && !onHedgedAttemptHeaders(upstream_request, response_code, end_stream)) {
+    return;
+  }
+  ASSERT(&upstream_request == upstream_request_.get());
+  recordResponseTime(upstream_request);
+
   upstream_request_->upstream_host_->outlierDetector().putHttpResponseCode(response_code);
 
   if (headers->EnvoyImmediateHealthCheckFail() != nullptr) {
@@ -612,6 +739,12 @@ void Filter::onUpstreamHeaders(const uint64_t response_code, Http::HeaderMapPtr&
     handleNon5xxResponseHeaders(*headers, end_stream);
   }
 
+  // Requests coalesced with this one get the response without this request's routing cookies and
+  // response headers to add.
+  if (!coalesced_waiters_.empty() || !coalescing_key_.empty()) {
+    shareCoalescedHeaders(*headers, end_stream);
+  }
+
   // Append routing cookies
   for (const auto& header_value : downstream_set_cookies_) {
     headers->addReferenceKey(Http::Headers::get().SetCookie, header_value);
@@ -631,6 +764,10 @@ void Filter::onUpstreamHeaders(const uint64_t response_code, Http::HeaderMapPtr&
 }
 
 void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
+  if (!coalesced_waiters_.empty()) {
+    shareCoalescedData(data, end_stream);
+  }
+
   if (end_stream) {
     // gRPC request termination without trailers is an error.
     if (upstream_request_->grpc_rq_success_deferred_) {
@@ -643,6 +780,10 @@ void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onUpstreamTrailers(Http::HeaderMapPtr&& trailers) {
+  if (!coalesced_waiters_.empty()) {
+    shareCoalescedTrailers(*trailers);
+  }
+
   if (upstream_request_->grpc_rq_success_deferred_) {
     absl::optional<Grpc::Status::GrpcStatus> grpc_status = Grpc::Common::getGrpcStatus(*trailers);
     if (grpc_status &&
@@ -708,6 +849,333 @@ void Filter::onUpstreamComplete() {
   cleanup();
 }
 
+bool Filter::joinCoalescedRequest(const Http::HeaderMap& headers) {
+  const RequestCoalescingPolicy* policy = route_entry_->requestCoalescingPolicy();
+  if (policy == nullptr || config_.coalesced_requests_ == nullptr ||
+      !FilterUtility::coalescable(headers)) {
+    return false;
+  }
+
+  CoalescedRequests& requests = config_.coalesced_requests_->getTyped<CoalescedRequests>();
+  std::string key = FilterUtility::coalescingKey(route_entry_->clusterName(), headers);
+  auto leader = requests.leaders_.find(key);
+  if (leader == requests.leaders_.end()) {
+    // This request goes upstream, and identical ones that arrive before its response starts wait
+    // for it.
+    coalescing_key_ = std::move(key);
+    requests.leaders_.emplace(coalescing_key_, this);
+    return false;
+  }
+
+  if (leader->second->coalesced_waiters_.size() >= policy->maxWaiters()) {
+    config_.stats_.rq_coalesced_overflow_.inc();
+    return false;
+  }
+
+  ENVOY_STREAM_LOG(debug, "waiting for the response of an identical request", *callbacks_);
+  config_.stats_.rq_coalesced_.inc();
+  coalescing_leader_ = leader->second;
+  coalesced_waiter_ = coalescing_leader_->coalesced_waiters_.insert(
+      coalescing_leader_->coalesced_waiters_.end(), this);
+  coalescing_timeout_ =
+      callbacks_->dispatcher().createTimer([this]() -> void { onCoalescedWaitTimeout(); });
+  coalescing_timeout_->enableTimer(policy->maxWait());
+  return true;
+}
+
+void Filter::unregisterCoalescedRequest() {
+  if (coalescing_key_.empty()) {
+    return;
+  }
+  config_.coalesced_requests_->getTyped<CoalescedRequests>().leaders_.erase(coalescing_key_);
+  coalescing_key_.clear();
+}
+
+std::vector<Filter*> Filter::coalescedWaiters() {
+  // Sending a waiter its response can end other streams, which then leave the waiters. Callers
+  // check that each waiter in this copy is still waiting before using it. Filters are deleted after
+  // the current event, so the pointers stay valid.
+  return std::vector<Filter*>(coalesced_waiters_.begin(), coalesced_waiters_.end());
+}
+
+void Filter::releaseCoalescedWaiters() {
+  for (Filter* waiter : coalescedWaiters()) {
+    if (waiter->coalescing_leader_ == this) {
+      waiter->leaveCoalescedRequest();
+      waiter->startUncoalescedRequest();
+    }
+  }
+}
+
+void Filter::resetCoalescedWaiters() {
+  for (Filter* waiter : coalescedWaiters()) {
+    if (waiter->coalescing_leader_ == this) {
+      waiter->leaveCoalescedRequest();
+      waiter->callbacks_->resetStream();
+    }
+  }
+}
+
+void Filter::shareCoalescedHeaders(const Http::HeaderMap& headers, bool end_stream) {
+  // The response has started, so a request that arrives now must go upstream itself.
+  unregisterCoalescedRequest();
+  if (!FilterUtility::shareableResponse(headers)) {
+    releaseCoalescedWaiters();
+    return;
+  }
+
+  for (Filter* waiter : coalescedWaiters()) {
+    if (waiter->coalescing_leader_ != this) {
+      continue;
+    }
+    // The response may depend on request headers that differ between the requests, in which case
+    // the waiter needs a response of its own.
+    if (!FilterUtility::varyMatches(headers, *downstream_headers_, *waiter->downstream_headers_)) {
+      waiter->leaveCoalescedRequest();
+      waiter->startUncoalescedRequest();
+      continue;
+    }
+    waiter->onCoalescedHeaders(Http::HeaderMapPtr{new Http::HeaderMapImpl(headers)}, end_stream);
+  }
+}
+
+void Filter::shareCoalescedData(Buffer::Instance& data, bool end_stream) {
+  const std::vector<Filter*> waiters = coalescedWaiters();
+  Buffer::OwnedImpl* owned = dynamic_cast<Buffer::OwnedImpl*>(&data);
+  if (owned == nullptr || owned->usesOldImpl()) {
+    for (Filter* waiter : waiters) {
+      if (waiter->coalescing_leader_ == this) {
+        Buffer::OwnedImpl copy(data);
+        waiter->onCoalescedData(copy, end_stream);
+      }
+    }
+    return;
+  }
+
+  // Every response references the slices of the upstream data rather than copying them.
+  std::vector<Buffer::SliceSharedPtr> slices;
+  owned->drainRetained(owned->length(), slices);
+  for (Filter* waiter : waiters) {
+    if (waiter->coalescing_leader_ == this) {
+      Buffer::OwnedImpl shared;
+      shared.addSharedSlices(slices);
+      waiter->onCoalescedData(shared, end_stream);
+    }
+  }
+  owned->addSharedSlices(slices);
+}
+
+void Filter::shareCoalescedTrailers(const Http::HeaderMap& trailers) {
+  for (Filter* waiter : coalescedWaiters()) {
+    if (waiter->coalescing_leader_ == this) {
+      waiter->onCoalescedTrailers(Http::HeaderMapPtr{new Http::HeaderMapImpl(trailers)});
+    }
+  }
+}
+
+void Filter::leaveCoalescedRequest() {
+  if (coalescing_leader_ == nullptr) {
+    return;
+  }
+  coalescing_leader_->coalesced_waiters_.erase(coalesced_waiter_);
+  coalescing_leader_ = nullptr;
+  coalescing_timeout_->disableTimer();
+}
+
+void Filter::onCoalescedWaitTimeout() {
+  ENVOY_STREAM_LOG(debug, "identical request did not respond in time", *callbacks_);
+  config_.stats_.rq_coalesced_timeout_.inc();
+  leaveCoalescedRequest();
+  startUncoalescedRequest();
+}
+
+void Filter::onCoalescedHeaders(Http::HeaderMapPtr&& headers, bool end_stream) {
+  ENVOY_STREAM_LOG(debug, "coalesced response headers: end_stream={}", *callbacks_, end_stream);
+  if (end_stream) {
+    leaveCoalescedRequest();
+  } else {
+    // The response has started, so the wait is over even though the body is still to come.
+    coalescing_timeout_->disableTimer();
+  }
+
+  for (const auto& header_value : downstream_set_cookies_) {
+    headers->addReferenceKey(Http::Headers::get().SetCookie, header_value);
+  }
+  route_entry_->finalizeResponseHeaders(*headers, callbacks_->requestInfo());
+
+  downstream_response_started_ = true;
+  callbacks_->encodeHeaders(std::move(headers), end_stream);
+}
+
+void Filter::onCoalescedData(Buffer::Instance& data, bool end_stream) {
+  if (end_stream) {
+    leaveCoalescedRequest();
+  }
+  callbacks_->encodeData(data, end_stream);
+}
+
+void Filter::onCoalescedTrailers(Http::HeaderMapPtr&& trailers) {
+  leaveCoalescedRequest();
+  callbacks_->encodeTrailers(std::move(trailers));
+}
+
+void Filter::startUncoalescedRequest() {
+  Http::ConnectionPool::Instance* conn_pool = getConnPool();
+  if (!conn_pool) {
+    sendNoHealthyUpstreamResponse();
+    cleanup();
+    return;
+  }
+
+  upstream_request_.reset(new UpstreamRequest(*this, *conn_pool));
+  upstream_request_->encodeHeaders(true);
+  onRequestComplete();
+}
+
+std::chrono::milliseconds Filter::hedgeDelay() {
+  const RetryPolicy& policy = route_entry_->retryPolicy();
+  if (policy.hedgeLatencyPercentile() > 0 && config_.response_times_ != nullptr) {
+    const auto& clusters = config_.response_times_->getTyped<ClusterResponseTimes>().clusters_;
+    const auto response_times = clusters.find(route_entry_->clusterName());
+    if (response_times != clusters.end()) {
+      const absl::optional<std::chrono::milliseconds> delay =
+          response_times->second.percentile(policy.hedgeLatencyPercentile());
+      if (delay) {
+        return std::max(delay.value(), std::chrono::milliseconds(1));
+      }
+    }
+  }
+  return policy.hedgeDelay();
+}
+
+void Filter::onHedgeTimeout() {
+  // There is nothing to hedge during a retry backoff or once the response has started.
+  if (!upstream_request_ || hedge_request_ || downstream_response_started_) {
+    return;
+  }
+
+  Upstream::Resource& hedges = cluster_->resourceManager(route_entry_->priority()).retries();
+  if (!hedges.canCreate()) {
+    ENVOY_STREAM_LOG(debug, "not hedging due to circuit breaking", *callbacks_);
+    cluster_->stats().upstream_rq_hedge_overflow_.inc();
+    return;
+  }
+
+  Http::ConnectionPool::Instance* conn_pool = getHedgeConnPool();
+  if (!conn_pool) {
+    ENVOY_STREAM_LOG(debug, "not hedging without another host", *callbacks_);
+    return;
+  }
+
+  ENVOY_STREAM_LOG(debug, "hedging request", *callbacks_);
+  cluster_->stats().upstream_rq_hedge_.inc();
+  hedges.inc();
+  hedge_request_.reset(new UpstreamRequest(*this, *conn_pool));
+  hedge_request_->encodeHeaders(!callbacks_->decodingBuffer() && !downstream_trailers_);
+  // It's possible the hedge got immediately reset.
+  if (hedge_request_) {
+    if (callbacks_->decodingBuffer()) {
+      Buffer::OwnedImpl copy(*callbacks_->decodingBuffer());
+      hedge_request_->encodeData(copy, !downstream_trailers_);
+    }
+
+    if (downstream_trailers_) {
+      hedge_request_->encodeTrailers(*downstream_trailers_);
+    }
+
+    hedge_request_->setupPerTryTimeout();
+  }
+}
+
+Http::ConnectionPool::Instance* Filter::getHedgeConnPool() {
+  // Each host has its own connection pools, so another pool is another host.
+  for (uint32_t i = 0; i < HedgeHostSelectionAttempts; i++) {
+    Http::ConnectionPool::Instance* conn_pool = getConnPool();
+    if (conn_pool != &upstream_request_->conn_pool_) {
+      return conn_pool;
+    }
+  }
+  return nullptr;
+}
+
+bool Filter::onHedgedAttemptFailed(UpstreamRequest& upstream_request, UpstreamResetType type) {
+  if (!hedge_request_) {
+    return false;
+  }
+
+  ENVOY_STREAM_LOG(debug, "hedged attempt failed, waiting for the other one", *callbacks_);
+  if (upstream_request.upstream_host_) {
+    upstream_request.upstream_host_->outlierDetector().putHttpResponseCode(
+        enumToInt(type == UpstreamResetType::Reset ? Http::Code::ServiceUnavailable
+                                                   : timeout_response_code_));
+    upstream_request.upstream_host_->stats().rq_error_.inc();
+  }
+  abandonAttempt(upstream_request);
+  return true;
+}
+
+bool Filter::onHedgedAttemptHeaders(UpstreamRequest& upstream_request, uint64_t response_code,
+                                    bool end_stream) {
+  if (Http::CodeUtility::is5xx(response_code)) {
+    ENVOY_STREAM_LOG(debug, "hedged attempt got a {} response, waiting for the other one",
+                     *callbacks_, response_code);
+    upstream_request.upstream_host_->outlierDetector().putHttpResponseCode(response_code);
+    upstream_request.upstream_host_->stats().rq_error_.inc();
+    if (!end_stream) {
+      upstream_request.resetStream();
+    }
+    abandonAttempt(upstream_request);
+    return false;
+  }
+
+  if (&upstream_request == hedge_request_.get()) {
+    cluster_->stats().upstream_rq_hedge_won_.inc();
+  }
+  abandonOtherAttempt(upstream_request);
+  return true;
+}
+
+void Filter::abandonOtherAttempt(UpstreamRequest& upstream_request) {
+  UpstreamRequest& other =
+      &upstream_request == upstream_request_.get() ? *hedge_request_ : *upstream_request_;
+  // The other attempt has taken at least this long. Counting it keeps the estimate from drifting
+  // towards the response times of the attempts that win.
+  recordResponseTime(other);
+  other.resetStream();
+  abandonAttempt(other);
+}
+
+void Filter::abandonAttempt(UpstreamRequest& upstream_request) {
+  ASSERT(hedge_request_);
+  if (&upstream_request == upstream_request_.get()) {
+    upstream_request_.swap(hedge_request_);
+  }
+  ASSERT(&upstream_request == hedge_request_.get());
+  hedge_request_.reset();
+  cluster_->resourceManager(route_entry_->priority()).retries().dec();
+
+  // The request info reports the host of the attempt that selected one last.
+  if (upstream_request_->upstream_host_) {
+    callbacks_->requestInfo().onUpstreamHostSelected(upstream_request_->upstream_host_);
+  }
+}
+
+void Filter::recordResponseTime(const UpstreamRequest& upstream_request) {
+  if (route_entry_->retryPolicy().hedgeLatencyPercentile() == 0 ||
+      config_.response_times_ == nullptr ||
+      !DateUtil::timePointValid(downstream_request_complete_time_)) {
+    return;
+  }
+
+  // An attempt that started before the request was complete waited for the request first.
+  const MonotonicTime start =
+      std::max(upstream_request.start_time_, downstream_request_complete_time_);
+  config_.response_times_->getTyped<ClusterResponseTimes>()
+      .clusters_[route_entry_->clusterName()]
+      .addSample(std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start));
+}
+
 bool Filter::setupRetry(bool end_stream) {
   // If we responded before the request was complete we don't bother doing a retry. This may not
   // catch certain cases where we are in full streaming mode and we have a connect timeout or an
@@ -758,8 +1226,9 @@ void Filter::doRetry() {
 
 Filter::UpstreamRequest::UpstreamRequest(Filter& parent, Http::ConnectionPool::Instance& pool)
     : parent_(parent), conn_pool_(pool), grpc_rq_success_deferred_(false),
-      request_info_(pool.protocol()), calling_encode_headers_(false), upstream_canary_(false),
-      encode_complete_(false), encode_trailers_(false) {
+      request_info_(pool.protocol()), start_time_(std::chrono::steady_clock::now()),
+      calling_encode_headers_(false), upstream_canary_(false), encode_complete_(false),
+      encode_trailers_(false) {
 
   if (parent_.config_.start_child_span_) {
     span_ = parent_.callbacks_->activeSpan().spawnChild(
@@ -791,7 +1260,7 @@ Filter::UpstreamRequest::~UpstreamRequest() {
 
 void Filter::UpstreamRequest::decode100ContinueHeaders(Http::HeaderMapPtr&& headers) {
   ASSERT(100 == Http::Utility::getResponseStatus(*headers));
-  parent_.onUpstream100ContinueHeaders(std::move(headers));
+  parent_.onUpstream100ContinueHeaders(*this, std::move(headers));
 }
 
 void Filter::UpstreamRequest::decodeHeaders(Http::HeaderMapPtr&& headers, bool end_stream) {
@@ -803,7 +1272,7 @@ void Filter::UpstreamRequest::decodeHeaders(Http::HeaderMapPtr&& headers, bool e
   upstream_headers_ = headers.get();
   const uint64_t response_code = Http::Utility::getResponseStatus(*headers);
   request_info_.response_code_ = static_cast<uint32_t>(response_code);
-  parent_.onUpstreamHeaders(response_code, std::move(headers), end_stream);
+  parent_.onUpstreamHeaders(*this, response_code, std::move(headers), end_stream);
 }
 
 void Filter::UpstreamRequest::decodeData(Buffer::Instance& data, bool end_stream) {
@@ -882,8 +1351,10 @@ void Filter::UpstreamRequest::onResetStream(Http::StreamResetReason reason) {
   clearRequestEncoder();
   if (!calling_encode_headers_) {
     request_info_.setResponseFlag(parent_.streamResetReasonToResponseFlag(reason));
-    parent_.onUpstreamReset(UpstreamResetType::Reset,
-                            absl::optional<Http::StreamResetReason>(reason));
+    if (!parent_.onHedgedAttemptFailed(*this, UpstreamResetType::Reset)) {
+      parent_.onUpstreamReset(UpstreamResetType::Reset,
+                              absl::optional<Http::StreamResetReason>(reason));
+    }
   } else {
     deferred_reset_reason_ = reason;
   }
@@ -924,9 +1395,11 @@ void Filter::UpstreamRequest::onPerTryTimeout() {
     }
     resetStream();
     request_info_.setResponseFlag(RequestInfo::ResponseFlag::UpstreamRequestTimeout);
-    parent_.onUpstreamReset(
-        UpstreamResetType::PerTryTimeout,
-        absl::optional<Http::StreamResetReason>(Http::StreamResetReason::LocalReset));
+    if (!parent_.onHedgedAttemptFailed(*this, UpstreamResetType::PerTryTimeout)) {
+      parent_.onUpstreamReset(
+          UpstreamResetType::PerTryTimeout,
+          absl::optional<Http::StreamResetReason>(Http::StreamResetReason::LocalReset));
+    }
   } else {
     ENVOY_STREAM_LOG(debug,
                      "ignored upstream per try timeout due to already started downstream response",
@@ -2,8 +2,11 @@
 
 #include <chrono>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "envoy/config/filter/http/router/v2/router.pb.h"
 #include "envoy/http/codec.h"
@@ -14,6 +17,7 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/access_log/access_log_impl.h"
@@ -25,6 +29,7 @@
 #include "common/http/utility.h"
 #include "common/request_info/request_info_impl.h"
 #include "common/router/config_impl.h"
+#include "common/router/latency_estimator.h"
 
 namespace Envoy {
 namespace Router {
@@ -38,6 +43,9 @@ namespace Router {
   COUNTER(no_cluster)                                                                              \
   COUNTER(rq_redirect)                                                                             \
   COUNTER(rq_direct_response)                                                                      \
+  COUNTER(rq_coalesced)                                                                            \
+  COUNTER(rq_coalesced_overflow)                                                                   \
+  COUNTER(rq_coalesced_timeout)                                                                    \
   COUNTER(rq_total)
 // clang-format on
 
@@ -84,6 +92,59 @@ public:
    */
   static TimeoutData finalTimeout(const RouteEntry& route, Http::HeaderMap& request_headers,
                                   bool insert_envoy_expected_request_timeout_ms);
+
+  /**
+   * Determine whether a request may share an upstream request with identical ones.
+   * @param request_headers supplies the request headers.
+   * @return TRUE for a GET request without an authorization, cookie or range header.
+   */
+  static bool coalescable(const Http::HeaderMap& request_headers);
+
+  /**
+   * @param cluster_name supplies the upstream cluster of the request.
+   * @param request_headers supplies the final request headers.
+   * @return std::string the key under which identical requests are coalesced. It is made of the
+   *         cluster, the downstream scheme, the authority and the path.
+   */
+  static std::string coalescingKey(const std::string& cluster_name,
+                                   const Http::HeaderMap& request_headers);
+
+  /**
+   * Determine whether a response may be sent to the requests coalesced with the one it answers.
+   * @param response_headers supplies the response headers.
+   * @return TRUE unless the response is private, must not be stored, must be revalidated, varies
+   *         on every request or sets a cookie.
+   */
+  static bool shareableResponse(const Http::HeaderMap& response_headers);
+
+  /**
+   * Determine whether a shareable response may be sent to a particular coalesced request.
+   * @param response_headers supplies the response headers.
+   * @param request_headers supplies the headers of the request the response answers.
+   * @param coalesced_request_headers supplies the headers of the coalesced request.
+   * @return TRUE if the two requests have the same values for every header named in Vary.
+   */
+  static bool varyMatches(const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& coalesced_request_headers);
+};
+
+class Filter;
+
+/**
+ * The requests that went upstream on a route with request coalescing, by coalescing key, on one
+ * worker.
+ */
+struct CoalescedRequests : public ThreadLocal::ThreadLocalObject {
+  std::unordered_map<std::string, Filter*> leaders_;
+};
+
+/**
+ * The recent response times of the clusters that routes hedge to after a percentile of them, by
+ * cluster name, on one worker.
+ */
+struct ClusterResponseTimes : public ThreadLocal::ThreadLocalObject {
+  std::unordered_map<std::string, LatencyEstimator> clusters_;
 };
 
 /**
@@ -110,10 +171,36 @@ public:
     for (const auto& upstream_log : config.upstream_log()) {
       upstream_logs_.push_back(AccessLog::AccessLogFactory::fromProto(upstream_log, context));
     }
+    enableRequestCoalescing(context.threadLocal());
+    enableResponseTimeTracking(context.threadLocal());
   }
 
   ShadowWriter& shadowWriter() { return *shadow_writer_; }
 
+  /**
+   * Track the requests in flight on each worker so that routes with request coalescing can use it.
+   * Without this, requests are never coalesced.
+   * @param tls supplies the slot allocator to track the requests with.
+   */
+  void enableRequestCoalescing(ThreadLocal::SlotAllocator& tls) {
+    coalesced_requests_ = tls.allocateSlot();
+    coalesced_requests_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+      return std::make_shared<CoalescedRequests>();
+    });
+  }
+
+  /**
+   * Track the recent response times of clusters on each worker so that routes that hedge after a
+   * percentile of them can use it. Without this, such routes hedge after their fixed delay.
+   * @param tls supplies the slot allocator to track the response times with.
+   */
+  void enableResponseTimeTracking(ThreadLocal::SlotAllocator& tls) {
+    response_times_ = tls.allocateSlot();
+    response_times_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+      return std::make_shared<ClusterResponseTimes>();
+    });
+  }
+
   Stats::Scope& scope_;
   const LocalInfo::LocalInfo& local_info_;
   Upstream::ClusterManager& cm_;
@@ -124,6 +211,8 @@ public:
   const bool start_child_span_;
   const bool suppress_envoy_headers_;
   std::list<AccessLog::InstanceSharedPtr> upstream_logs_;
+  ThreadLocal::SlotPtr coalesced_requests_;
+  ThreadLocal::SlotPtr response_times_;
 
 private:
   ShadowWriterPtr shadow_writer_;
@@ -140,7 +229,7 @@ class Filter : Logger::Loggable<Logger::Id::router>,
 public:
   Filter(FilterConfig& config)
       : config_(config), downstream_response_started_(false), downstream_end_stream_(false),
-        do_shadowing_(false) {}
+        do_shadowing_(false), do_hedging_(false) {}
 
   ~Filter();
 
@@ -298,6 +387,7 @@ private:
     RequestInfo::RequestInfoImpl request_info_;
     Http::HeaderMap* upstream_headers_{};
     Http::HeaderMap* upstream_trailers_{};
+    const MonotonicTime start_time_;
 
     bool calling_encode_headers_ : 1;
     bool upstream_canary_ : 1;
@@ -327,8 +417,10 @@ private:
   void maybeDoShadowing();
   void onRequestComplete();
   void onResponseTimeout();
-  void onUpstream100ContinueHeaders(Http::HeaderMapPtr&& headers);
-  void onUpstreamHeaders(uint64_t response_code, Http::HeaderMapPtr&& headers, bool end_stream);
+  void onUpstream100ContinueHeaders(UpstreamRequest& upstream_request,
+                                    Http::HeaderMapPtr&& headers);
+  void onUpstreamHeaders(UpstreamRequest& upstream_request, uint64_t response_code,
+                         Http::HeaderMapPtr&& headers, bool end_stream);
   void onUpstreamData(Buffer::Instance& data, bool end_stream);
   void onUpstreamTrailers(Http::HeaderMapPtr&& trailers);
   void onUpstreamComplete();
@@ -341,6 +433,36 @@ private:
   // and handle difference between gRPC and non-gRPC requests.
   void handleNon5xxResponseHeaders(const Http::HeaderMap& headers, bool end_stream);
 
+  // Request coalescing. joinCoalescedRequest() either registers a request as the one identical
+  // requests wait for or makes it wait. The methods for the request that went upstream:
+  bool joinCoalescedRequest(const Http::HeaderMap& headers);
+  void unregisterCoalescedRequest();
+  std::vector<Filter*> coalescedWaiters();
+  void releaseCoalescedWaiters();
+  void resetCoalescedWaiters();
+  void shareCoalescedHeaders(const Http::HeaderMap& headers, bool end_stream);
+  void shareCoalescedData(Buffer::Instance& data, bool end_stream);
+  void shareCoalescedTrailers(const Http::HeaderMap& trailers);
+  // And for the requests waiting for its response:
+  void leaveCoalescedRequest();
+  void onCoalescedWaitTimeout();
+  void onCoalescedHeaders(Http::HeaderMapPtr&& headers, bool end_stream);
+  void onCoalescedData(Buffer::Instance& data, bool end_stream);
+  void onCoalescedTrailers(Http::HeaderMapPtr&& trailers);
+  void startUncoalescedRequest();
+
+  // Hedging. While a hedge is in flight, upstream_request_ and hedge_request_ are the two attempts.
+  // Once one of them is abandoned, the other one is upstream_request_.
+  std::chrono::milliseconds hedgeDelay();
+  void onHedgeTimeout();
+  Http::ConnectionPool::Instance* getHedgeConnPool();
+  bool onHedgedAttemptFailed(UpstreamRequest& upstream_request, UpstreamResetType type);
+  bool onHedgedAttemptHeaders(UpstreamRequest& upstream_request, uint64_t response_code,
+                              bool end_stream);
+  void abandonOtherAttempt(UpstreamRequest& upstream_request);
+  void abandonAttempt(UpstreamRequest& upstream_request);
+  void recordResponseTime(const UpstreamRequest& upstream_request);
+
   FilterConfig& config_;
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   RouteConstSharedPtr route_;
@@ -352,6 +474,8 @@ private:
   FilterUtility::TimeoutData timeout_;
   Http::Code timeout_response_code_ = Http::Code::GatewayTimeout;
   UpstreamRequestPtr upstream_request_;
+  UpstreamRequestPtr hedge_request_;
+  Event::TimerPtr hedge_timer_;
   bool grpc_request_{};
   Http::HeaderMap* downstream_headers_{};
   Http::HeaderMap* downstream_trailers_{};
@@ -363,9 +487,19 @@ private:
   // list of cookies to add to upstream headers
   std::vector<std::string> downstream_set_cookies_;
 
+  // The key this request is registered under while other requests can join it, and the requests
+  // waiting for its response.
+  std::string coalescing_key_;
+  std::list<Filter*> coalesced_waiters_;
+  // The request whose response this one waits for, and this request's entry in its waiters.
+  Filter* coalescing_leader_{};
+  std::list<Filter*>::iterator coalesced_waiter_;
+  Event::TimerPtr coalescing_timeout_;
+
   bool downstream_response_started_ : 1;
   bool downstream_end_stream_ : 1;
   bool do_shadowing_ : 1;
+  bool do_hedging_ : 1;
 };
 
 class ProdFilter : public Filter {
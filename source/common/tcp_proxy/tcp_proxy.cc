@@ -51,6 +51,7 @@ Config::SharedConfig::SharedConfig(
 Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& config,
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
+      use_splice_(config.use_splice()),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)) {
 
@@ -197,6 +198,9 @@ void Filter::readDisableUpstream(bool disable) {
   }
 
   upstream_connection_->readDisable(disable);
+  if (upstream_splice_ != nullptr && !upstream_splice_->complete()) {
+    upstream_splice_->readDisable(disable);
+  }
   if (disable) {
     read_callbacks_->upstreamHost()
         ->cluster()
@@ -212,6 +216,9 @@ void Filter::readDisableUpstream(bool disable) {
 
 void Filter::readDisableDownstream(bool disable) {
   read_callbacks_->connection().readDisable(disable);
+  if (downstream_splice_ != nullptr && !downstream_splice_->complete()) {
+    downstream_splice_->readDisable(disable);
+  }
 
   if (disable) {
     config_->stats().downstream_flow_control_paused_reading_total_.inc();
@@ -392,6 +399,11 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::RemoteClose ||
+      event == Network::ConnectionEvent::LocalClose) {
+    resetSplice();
+  }
+
   if (upstream_connection_) {
     if (event == Network::ConnectionEvent::RemoteClose) {
       upstream_connection_->close(Network::ConnectionCloseType::FlushWrite);
@@ -414,6 +426,10 @@ void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
   ENVOY_CONN_LOG(trace, "upstream connection received {} bytes, end_stream={}",
                  read_callbacks_->connection(), data.length(), end_stream);
   request_info_.bytes_sent_ += data.length();
+  if (splicing_) {
+    downstream_unsent_bytes_ += data.length();
+    upstream_end_stream_ |= end_stream;
+  }
   read_callbacks_->connection().write(data, end_stream);
   ASSERT(0 == data.length());
   resetIdleTimer(); // TODO(ggreenway) PERF: do we need to reset timer on both send and receive?
@@ -433,6 +449,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    resetSplice();
     finalizeUpstreamConnectionStats();
     read_callbacks_->connection().dispatcher().deferredDelete(std::move(upstream_connection_));
     disableIdleTimer();
@@ -461,6 +478,10 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
   } else if (event == Network::ConnectionEvent::Connected) {
     connect_timespan_->complete();
 
+    if (config_->useSplice()) {
+      initializeSplice();
+    }
+
     // Re-enable downstream reads now that the upstream connection is established
     // so we have a place to send downstream data to.
     read_callbacks_->connection().readDisable(false);
@@ -507,6 +528,77 @@ void Filter::disableIdleTimer() {
   }
 }
 
+void Filter::initializeSplice() {
+  Network::Connection& downstream = read_callbacks_->connection();
+  if (downstream.ssl() != nullptr || upstream_connection_->ssl() != nullptr) {
+    return;
+  }
+  // Spliced data bypasses the connection's filters, so any other filter would miss the payload.
+  if (read_callbacks_->hasOtherFilters()) {
+    ENVOY_CONN_LOG(debug, "not splicing, the connection has other filters", downstream);
+    return;
+  }
+
+  // Downstream reads are still disabled at this point, so nothing has been written upstream and
+  // the pump can take over the downstream socket right away.
+  downstream_splice_ = Network::SplicePump::create(
+      downstream, *upstream_connection_, upstream_connection_->bufferLimit(),
+      [this](uint64_t bytes) {
+        request_info_.bytes_received_ += bytes;
+        config_->stats().downstream_cx_rx_bytes_total_.add(bytes);
+        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_total_.add(bytes);
+        resetIdleTimer();
+      });
+  if (downstream_splice_ == nullptr) {
+    return;
+  }
+
+  splicing_ = true;
+  config_->stats().downstream_cx_splice_total_.inc();
+  downstream.addBytesSentCallback([this](uint64_t bytes) { onDownstreamBytesSent(bytes); });
+
+  // The upstream connection may read in the same event that raised Connected, so its pump is
+  // started from the next loop iteration rather than from within its own event.
+  splice_timer_ = downstream.dispatcher().createTimer([this]() -> void { maybeSpliceUpstream(); });
+  splice_timer_->enableTimer(std::chrono::milliseconds(0));
+}
+
+void Filter::maybeSpliceUpstream() {
+  if (upstream_splice_ != nullptr || upstream_end_stream_ || downstream_unsent_bytes_ > 0 ||
+      upstream_connection_ == nullptr ||
+      upstream_connection_->state() != Network::Connection::State::Open) {
+    return;
+  }
+
+  Network::Connection& downstream = read_callbacks_->connection();
+  upstream_splice_ = Network::SplicePump::create(
+      *upstream_connection_, downstream, downstream.bufferLimit(), [this](uint64_t bytes) {
+        request_info_.bytes_sent_ += bytes;
+        config_->stats().downstream_cx_tx_bytes_total_.add(bytes);
+        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_bytes_total_.add(bytes);
+        resetIdleTimer();
+      });
+}
+
+void Filter::onDownstreamBytesSent(uint64_t bytes) {
+  // Only upstream data written through the downstream connection is reported here; spliced bytes
+  // bypass the connection buffers.
+  ASSERT(downstream_unsent_bytes_ >= bytes);
+  downstream_unsent_bytes_ -= bytes;
+  if (downstream_unsent_bytes_ == 0 && upstream_splice_ == nullptr && splice_timer_ != nullptr) {
+    splice_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void Filter::resetSplice() {
+  if (splice_timer_ != nullptr) {
+    splice_timer_->disableTimer();
+    splice_timer_.reset();
+  }
+  downstream_splice_.reset();
+  upstream_splice_.reset();
+}
+
 UpstreamDrainManager::~UpstreamDrainManager() {
   // If connections aren't closed before they are destructed an ASSERT fires,
   // so cancel all pending drains, which causes the connections to be closed.
@@ -20,6 +20,7 @@
 #include "common/common/logger.h"
 #include "common/network/cidr_range.h"
 #include "common/network/filter_impl.h"
+#include "common/network/splice_pump.h"
 #include "common/network/utility.h"
 #include "common/request_info/request_info_impl.h"
 
@@ -37,6 +38,7 @@ namespace TcpProxy {
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_splice_total)                                                              \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
@@ -101,6 +103,7 @@ public:
   const TcpProxyStats& stats() { return shared_config_->stats(); }
   const std::vector<AccessLog::InstanceSharedPtr>& accessLogs() { return access_logs_; }
   uint32_t maxConnectAttempts() const { return max_connect_attempts_; }
+  bool useSplice() const { return use_splice_; }
   const absl::optional<std::chrono::milliseconds>& idleTimeout() {
     return shared_config_->idleTimeout();
   }
@@ -125,6 +128,7 @@ private:
   std::vector<Route> routes_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
   const uint32_t max_connect_attempts_;
+  const bool use_splice_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
@@ -234,6 +238,10 @@ protected:
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
+  void initializeSplice();
+  void maybeSpliceUpstream();
+  void onDownstreamBytesSent(uint64_t bytes);
+  void resetSplice();
 
   const ConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
@@ -248,6 +256,18 @@ protected:
                                                           // read filter.
   RequestInfo::RequestInfoImpl request_info_;
   uint32_t connect_attempts_{};
+
+  // Splice state, only used when the config enables splice and neither connection uses TLS. The
+  // downstream pump is started as soon as the upstream connects. The upstream pump must not
+  // overtake upstream bytes that were already written to the downstream connection through its
+  // buffer, so it is started from a timer once those have been sent. The pumps reference both
+  // connections and are therefore declared after upstream_connection_ so they are destroyed first.
+  bool splicing_{};
+  bool upstream_end_stream_{};
+  uint64_t downstream_unsent_bytes_{};
+  Event::TimerPtr splice_timer_;
+  Network::SplicePumpPtr downstream_splice_; // downstream -> upstream
+  Network::SplicePumpPtr upstream_splice_;   // upstream -> downstream
 };
 
 // This class holds ownership of an upstream connection that needs to finish
@@ -875,11 +875,12 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
   }
 
   priority_set_.addMemberUpdateCb(
-      [this](uint32_t, const HostVector&, const HostVector& hosts_removed) -> void {
+      [this](uint32_t, const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
         // We need to go through and purge any connection pools for hosts that got deleted.
         // Even if two hosts actually point to the same address this will be safe, since if a
         // host is readded it will be a different physical HostSharedPtr.
         parent_.drainConnPools(hosts_removed);
+        prefetchConnPools(hosts_added);
       });
 }
 
@@ -923,14 +924,40 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     }
   }
 
+  return &connPool(host, hash_key, priority, protocol,
+                   have_options ? context->downstreamConnection()->socketOptions() : nullptr);
+}
+
+Http::ConnectionPool::Instance&
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
+    HostConstSharedPtr host, const std::vector<uint8_t>& hash_key, ResourcePriority priority,
+    Http::Protocol protocol, const Network::ConnectionSocket::OptionsSharedPtr& options) {
   ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
   if (!container.pools_[hash_key]) {
     container.pools_[hash_key] = parent_.parent_.factory_.allocateConnPool(
-        parent_.thread_local_dispatcher_, host, priority, protocol,
-        have_options ? context->downstreamConnection()->socketOptions() : nullptr);
+        parent_.thread_local_dispatcher_, host, priority, protocol, options);
   }
 
-  return container.pools_[hash_key].get();
+  return *container.pools_[hash_key];
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prefetchConnPools(
+    const HostVector& hosts) {
+  const uint32_t connections = cluster_info_->warmConnectionsPerHost();
+  if (connections == 0) {
+    return;
+  }
+
+  // Warm the pools that the router uses for requests of the default priority without downstream
+  // socket options, for the protocol configured for the cluster.
+  const Http::Protocol protocol = (cluster_info_->features() & ClusterInfo::Features::HTTP2)
+                                      ? Http::Protocol::Http2
+                                      : Http::Protocol::Http11;
+  const std::vector<uint8_t> hash_key = {uint8_t(protocol), uint8_t(ResourcePriority::Default)};
+  for (const HostSharedPtr& host : hosts) {
+    ENVOY_LOG(debug, "prefetching {} connections to {}", connections, host->address()->asString());
+    connPool(host, hash_key, ResourcePriority::Default, protocol, nullptr).prefetch(connections);
+  }
 }
 
 ClusterManagerPtr ProdClusterManagerFactory::clusterManagerFromProto(
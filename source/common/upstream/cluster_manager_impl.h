@@ -240,6 +240,11 @@ private:
 
       Http::ConnectionPool::Instance* connPool(ResourcePriority priority, Http::Protocol protocol,
                                                LoadBalancerContext* context);
+      Http::ConnectionPool::Instance&
+      connPool(HostConstSharedPtr host, const std::vector<uint8_t>& hash_key,
+               ResourcePriority priority, Http::Protocol protocol,
+               const Network::ConnectionSocket::OptionsSharedPtr& options);
+      void prefetchConnPools(const HostVector& hosts);
 
       // Upstream::ThreadLocalCluster
       const PrioritySet& prioritySet() override { return priority_set_; }
@@ -262,6 +262,14 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
       features_(parseFeatures(config)),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
+      http2_max_connections_per_host_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.http2_connection_pool_options(), max_connections_per_host, 1)),
+      http2_busy_stream_threshold_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.http2_connection_pool_options(), busy_stream_threshold, 100)),
+      per_upstream_prefetch_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.prefetch_policy(), per_upstream_prefetch_ratio, 1.0)),
+      warm_connections_per_host_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.prefetch_policy(), warm_connections_per_host, 0)),
       resource_managers_(config, runtime, name_),
       maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
       source_address_(getSourceAddress(config, bind_config)),
@@ -331,6 +331,10 @@ public:
   }
   uint64_t features() const override { return features_; }
   const Http::Http2Settings& http2Settings() const override { return http2_settings_; }
+  uint32_t http2MaxConnectionsPerHost() const override { return http2_max_connections_per_host_; }
+  uint32_t http2BusyStreamThreshold() const override { return http2_busy_stream_threshold_; }
+  float perUpstreamPrefetchRatio() const override { return per_upstream_prefetch_ratio_; }
+  uint32_t warmConnectionsPerHost() const override { return warm_connections_per_host_; }
   LoadBalancerType lbType() const override { return lb_type_; }
   envoy::api::v2::Cluster::DiscoveryType type() const override { return type_; }
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&
@@ -389,6 +393,10 @@ private:
   Network::TransportSocketFactoryPtr transport_socket_factory_;
   const uint64_t features_;
   const Http::Http2Settings http2_settings_;
+  const uint32_t http2_max_connections_per_host_;
+  const uint32_t http2_busy_stream_threshold_;
+  const float per_upstream_prefetch_ratio_;
+  const uint32_t warm_connections_per_host_;
   mutable ResourceManagers resource_managers_;
   const std::string maintenance_mode_runtime_key_;
   const Network::Address::InstanceConstSharedPtr source_address_;
@@ -3,8 +3,10 @@
 #include <iostream>
 #include <memory>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/common/perf_annotation.h"
+#include "common/event/dispatcher_impl.h"
 #include "common/event/libevent.h"
 #include "common/network/utility.h"
 #include "common/stats/stats_impl.h"
@@ -44,6 +46,9 @@ MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
   RELEASE_ASSERT(Envoy::Server::validateProtoDescriptors());
 
   Stats::RawStatData::configure(options_);
+  Buffer::OwnedImpl::useOldImpl(options_.libeventBuffersEnabled());
+  Event::DispatcherImpl::useIoUring(options_.ioUringEnabled());
+  Event::DispatcherImpl::useTimerWheel(options_.timerWheelEnabled());
   switch (options_.mode()) {
   case Server::Mode::InitOnly:
   case Server::Mode::Serve: {
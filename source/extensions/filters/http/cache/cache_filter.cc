@@ -0,0 +1,319 @@
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include <time.h>
+
+#include "common/common/enum_to_int.h"
+#include "common/common/utility.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+const uint64_t DefaultMaxBytes = 64 * 1024 * 1024;
+const uint64_t DefaultMaxBodyBytes = 1024 * 1024;
+
+// A delta-seconds argument. An invalid one makes the response stale, as RFC 7234 requires.
+std::chrono::seconds parseSeconds(absl::string_view argument) {
+  uint64_t seconds;
+  if (!StringUtil::atoul(std::string(argument).c_str(), seconds)) {
+    return std::chrono::seconds(0);
+  }
+  return std::chrono::seconds(seconds);
+}
+
+} // namespace
+
+CacheControl::CacheControl(absl::string_view value) {
+  for (absl::string_view directive : StringUtil::splitToken(value, ",")) {
+    absl::string_view name = StringUtil::trim(directive);
+    absl::string_view argument;
+    const size_t equals = name.find('=');
+    if (equals != absl::string_view::npos) {
+      argument = StringUtil::trim(name.substr(equals + 1));
+      name = StringUtil::trim(name.substr(0, equals));
+      if (argument.size() >= 2 && argument.front() == '"' && argument.back() == '"') {
+        argument = argument.substr(1, argument.size() - 2);
+      }
+    }
+
+    // A no-cache or private directive that names headers is treated like one that does not.
+    if (StringUtil::caseCompare(name, Http::Headers::get().CacheControlValues.NoCache)) {
+      no_cache_ = true;
+    } else if (StringUtil::caseCompare(name, Http::Headers::get().CacheControlValues.NoStore)) {
+      no_store_ = true;
+    } else if (StringUtil::caseCompare(name, Http::Headers::get().CacheControlValues.Private)) {
+      private_ = true;
+    } else if (StringUtil::caseCompare(name, "max-age")) {
+      max_age_ = parseSeconds(argument);
+    } else if (StringUtil::caseCompare(name, "s-maxage")) {
+      s_maxage_ = parseSeconds(argument);
+    }
+  }
+}
+
+CacheFilterConfig::CacheFilterConfig(
+    const envoy::config::filter::http::cache::v2alpha::Cache& config,
+    const std::string& stats_prefix, Stats::Scope& scope, SystemTimeSource& system_time_source,
+    MonotonicTimeSource& monotonic_time_source)
+    : stats_(generateStats(stats_prefix + "cache.", scope)),
+      cache_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_bytes, DefaultMaxBytes), stats_),
+      max_body_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_body_bytes, DefaultMaxBodyBytes)),
+      system_time_source_(system_time_source), monotonic_time_source_(monotonic_time_source) {}
+
+CacheStats CacheFilterConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
+  return {ALL_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
+std::string CacheFilter::cacheKey(const Http::HeaderMap& request_headers) {
+  // The connection manager records the downstream scheme in x-forwarded-proto; :scheme is only
+  // present on some requests.
+  const Http::HeaderEntry* scheme = request_headers.ForwardedProto() != nullptr
+                                        ? request_headers.ForwardedProto()
+                                        : request_headers.Scheme();
+  std::string key;
+  if (scheme != nullptr) {
+    key.append(scheme->value().c_str(), scheme->value().size());
+  }
+  key.append("://");
+  key.append(request_headers.Host()->value().c_str(), request_headers.Host()->value().size());
+  key.append(request_headers.Path()->value().c_str(), request_headers.Path()->value().size());
+  return key;
+}
+
+absl::optional<std::chrono::seconds>
+CacheFilter::freshnessLifetime(const Http::HeaderMap& response_headers, SystemTime now) {
+  if (Http::Utility::getResponseStatus(response_headers) != enumToInt(Http::Code::OK) ||
+      response_headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    return absl::nullopt;
+  }
+  const Http::HeaderEntry* vary = response_headers.Vary();
+  if (vary != nullptr && StringUtil::findToken(vary->value().getStringView(), ",", "*")) {
+    return absl::nullopt;
+  }
+
+  absl::optional<std::chrono::seconds> lifetime;
+  const Http::HeaderEntry* cache_control_header = response_headers.CacheControl();
+  if (cache_control_header != nullptr) {
+    // The cache never revalidates, so a response that must be revalidated is not stored.
+    const CacheControl cache_control(cache_control_header->value().getStringView());
+    if (cache_control.no_cache_ || cache_control.no_store_ || cache_control.private_) {
+      return absl::nullopt;
+    }
+    lifetime = cache_control.s_maxage_ ? cache_control.s_maxage_ : cache_control.max_age_;
+  }
+
+  if (!lifetime) {
+    const Http::HeaderEntry* expires_header = response_headers.get(Http::Headers::get().Expires);
+    if (expires_header == nullptr) {
+      return absl::nullopt;
+    }
+    const absl::optional<SystemTime> expires =
+        parseHttpDate(expires_header->value().getStringView());
+    if (!expires) {
+      return absl::nullopt;
+    }
+    absl::optional<SystemTime> date;
+    if (response_headers.Date() != nullptr) {
+      date = parseHttpDate(response_headers.Date()->value().getStringView());
+    }
+    lifetime = std::chrono::duration_cast<std::chrono::seconds>(*expires - date.value_or(now));
+  }
+
+  if (lifetime->count() <= 0) {
+    return absl::nullopt;
+  }
+  return lifetime;
+}
+
+absl::optional<SystemTime> CacheFilter::parseHttpDate(absl::string_view value) {
+  const std::string date(value);
+  std::tm tm{};
+  const char* end = strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  if (end == nullptr || *end != '\0') {
+    return absl::nullopt;
+  }
+  return std::chrono::system_clock::from_time_t(timegm(&tm));
+}
+
+bool CacheFilter::varyMatches(const CachedResponse& response,
+                              const Http::HeaderMap& request_headers) {
+  for (const auto& header : response.vary_headers_) {
+    const Http::HeaderEntry* entry = request_headers.get(header.first);
+    const absl::string_view value = entry != nullptr ? entry->value().getStringView() : "";
+    if (value != header.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (!end_stream || headers.Host() == nullptr || headers.Path() == nullptr ||
+      headers.Method()->value() != Http::Headers::get().MethodValues.Get.c_str() ||
+      headers.Authorization() != nullptr ||
+      headers.get(Http::Headers::get().Range) != nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  bool lookup = true;
+  const Http::HeaderEntry* cache_control_header = headers.CacheControl();
+  if (cache_control_header != nullptr) {
+    const CacheControl cache_control(cache_control_header->value().getStringView());
+    if (cache_control.no_store_) {
+      return Http::FilterHeadersStatus::Continue;
+    }
+    // A request that does not accept a cached response without revalidation goes upstream, and
+    // its response replaces the cached one.
+    lookup = !cache_control.no_cache_ &&
+             !(cache_control.max_age_ && cache_control.max_age_->count() == 0);
+  }
+
+  state_ = State::Insert;
+  key_ = cacheKey(headers);
+  request_headers_ = &headers;
+  if (!lookup) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  CachedResponseConstSharedPtr response = config_->cache().lookup(key_);
+  if (response != nullptr && varyMatches(*response, headers)) {
+    if (config_->monotonicTimeSource().currentTime() < response->expiry_time_) {
+      config_->stats().hit_.inc();
+      serveFromCache(*response);
+      return Http::FilterHeadersStatus::StopIteration;
+    }
+    config_->cache().remove(key_, *response);
+  }
+  config_->stats().miss_.inc();
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (state_ != State::Insert) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  const absl::optional<std::chrono::seconds> lifetime =
+      freshnessLifetime(headers, config_->systemTimeSource().currentTime());
+  uint64_t value;
+  std::chrono::seconds age(0);
+  const Http::HeaderEntry* age_header = headers.get(Http::Headers::get().Age);
+  if (age_header != nullptr && StringUtil::atoul(age_header->value().c_str(), value)) {
+    age = std::chrono::seconds(value);
+  }
+  const Http::HeaderEntry* content_length = headers.ContentLength();
+  if (!lifetime || age >= *lifetime ||
+      (content_length != nullptr && StringUtil::atoul(content_length->value().c_str(), value) &&
+       value > config_->maxBodyBytes())) {
+    state_ = State::Bypass;
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  response_ = std::make_shared<CachedResponse>();
+  response_->headers_.reset(new Http::HeaderMapImpl(headers));
+  response_->headers_->removeEnvoyUpstreamServiceTime();
+  const Http::HeaderEntry* vary = headers.Vary();
+  if (vary != nullptr) {
+    for (absl::string_view name : StringUtil::splitToken(vary->value().getStringView(), ",")) {
+      Http::LowerCaseString header(std::string(StringUtil::trim(name)));
+      const Http::HeaderEntry* entry = request_headers_->get(header);
+      response_->vary_headers_.emplace_back(
+          header, entry != nullptr ? std::string(entry->value().getStringView()) : "");
+    }
+  }
+  const MonotonicTime now = config_->monotonicTimeSource().currentTime();
+  response_->response_time_ = now;
+  response_->initial_age_ = age;
+  response_->expiry_time_ = now + (*lifetime - age);
+
+  if (end_stream) {
+    finishInsert();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (state_ != State::Insert) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  if (body_.length() + data.length() > config_->maxBodyBytes()) {
+    abandonInsert();
+    return Http::FilterDataStatus::Continue;
+  }
+  body_.add(data);
+  if (end_stream) {
+    finishInsert();
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::HeaderMap&) {
+  // Responses with trailers are not cached.
+  if (state_ == State::Insert) {
+    abandonInsert();
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void CacheFilter::serveFromCache(const CachedResponse& response) {
+  ENVOY_STREAM_LOG(debug, "serving response from cache", *decoder_callbacks_);
+  state_ = State::Hit;
+
+  Http::HeaderMapPtr headers{new Http::HeaderMapImpl(*response.headers_)};
+  const std::chrono::seconds age =
+      response.initial_age_ + std::chrono::duration_cast<std::chrono::seconds>(
+                                  config_->monotonicTimeSource().currentTime() -
+                                  response.response_time_);
+  headers->remove(Http::Headers::get().Age);
+  headers->addReferenceKey(Http::Headers::get().Age, age.count());
+
+  const bool end_stream = response.body_length_ == 0;
+  decoder_callbacks_->encodeHeaders(std::move(headers), end_stream);
+  if (!end_stream) {
+    Buffer::OwnedImpl body;
+    if (body.usesOldImpl()) {
+      for (const Buffer::SliceSharedPtr& slice : response.body_) {
+        body.add(slice->data(), slice->dataSize());
+      }
+    } else {
+      body.addSharedSlices(response.body_);
+    }
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+void CacheFilter::abandonInsert() {
+  state_ = State::Bypass;
+  response_.reset();
+  body_.drain(body_.length());
+}
+
+void CacheFilter::finishInsert() {
+  const uint64_t length = body_.length();
+  response_->body_length_ = length;
+  if (body_.usesOldImpl()) {
+    if (length > 0) {
+      response_->body_.emplace_back(Buffer::OwnedSlice::create(body_.linearize(length), length));
+      body_.drain(length);
+    }
+  } else {
+    // The slices that the body was copied into become the cached body as they are.
+    body_.drainRetained(length, response_->body_);
+  }
+
+  config_->cache().insert(key_, std::move(response_));
+  state_ = State::Bypass;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/stats.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * The directives of a cache-control header that the cache acts on.
+ */
+struct CacheControl {
+  /**
+   * @param value supplies the value of the header. Unknown directives are ignored.
+   */
+  explicit CacheControl(absl::string_view value);
+
+  bool no_cache_{};
+  bool no_store_{};
+  bool private_{};
+  absl::optional<std::chrono::seconds> max_age_;
+  absl::optional<std::chrono::seconds> s_maxage_;
+};
+
+/**
+ * Configuration for the cache filter, including the cache itself.
+ */
+class CacheFilterConfig {
+public:
+  CacheFilterConfig(const envoy::config::filter::http::cache::v2alpha::Cache& config,
+                    const std::string& stats_prefix, Stats::Scope& scope,
+                    SystemTimeSource& system_time_source,
+                    MonotonicTimeSource& monotonic_time_source);
+
+  HttpCache& cache() { return cache_; }
+  CacheStats& stats() { return stats_; }
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+  SystemTimeSource& systemTimeSource() { return system_time_source_; }
+  MonotonicTimeSource& monotonicTimeSource() { return monotonic_time_source_; }
+
+private:
+  static CacheStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  CacheStats stats_;
+  HttpCache cache_;
+  const uint64_t max_body_bytes_;
+  SystemTimeSource& system_time_source_;
+  MonotonicTimeSource& monotonic_time_source_;
+};
+
+typedef std::shared_ptr<CacheFilterConfig> CacheFilterConfigSharedPtr;
+
+/**
+ * A filter that answers GET requests from an in-memory cache of the responses to earlier ones.
+ * Hits are sent from decodeHeaders() without any upstream request; on a miss, the response is
+ * stored as it passes through if its headers allow it to be shared.
+ */
+class CacheFilter : public Http::StreamFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  CacheFilter(CacheFilterConfigSharedPtr config) : config_(config) {}
+
+  /**
+   * @param request_headers supplies the request headers.
+   * @return std::string the key under which the response to the request is cached. It is made of
+   *         the downstream scheme, the authority and the path.
+   */
+  static std::string cacheKey(const Http::HeaderMap& request_headers);
+
+  /**
+   * Determine how long a response may be served from the cache after it was received.
+   * @param response_headers supplies the response headers.
+   * @param now supplies the current time, used when the response has no date header.
+   * @return the freshness lifetime, or an empty optional if the response may not be cached.
+   */
+  static absl::optional<std::chrono::seconds>
+  freshnessLifetime(const Http::HeaderMap& response_headers, SystemTime now);
+
+  /**
+   * @param value supplies an HTTP-date in the preferred format, e.g. "Sun, 06 Nov 1994 08:49:37
+   *        GMT".
+   * @return the time, or an empty optional if the value is not a date in that format.
+   */
+  static absl::optional<SystemTime> parseHttpDate(absl::string_view value);
+
+  /**
+   * @param response supplies a cached response.
+   * @param request_headers supplies the headers of a request for the same key.
+   * @return whether the request has the same values as the request the response answered for
+   *         every header the response varies on.
+   */
+  static bool varyMatches(const CachedResponse& response, const Http::HeaderMap& request_headers);
+
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  enum class State {
+    // The response is neither served from nor stored in the cache.
+    Bypass,
+    // The response is stored in the cache if it may be.
+    Insert,
+    // The response is served from the cache.
+    Hit,
+  };
+
+  void serveFromCache(const CachedResponse& response);
+  void abandonInsert();
+  void finishInsert();
+
+  CacheFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+  State state_{State::Bypass};
+  std::string key_;
+  const Http::HeaderMap* request_headers_{};
+  std::shared_ptr<CachedResponse> response_;
+  Buffer::OwnedImpl body_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
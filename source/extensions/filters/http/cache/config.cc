@@ -0,0 +1,36 @@
+#include "extensions/filters/http/cache/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/common/utility.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+Http::FilterFactoryCb CacheFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::cache::v2alpha::Cache& config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  // The cache is shared by the filters of every worker.
+  CacheFilterConfigSharedPtr filter_config = std::make_shared<CacheFilterConfig>(
+      config, stats_prefix, context.scope(), ProdSystemTimeSource::instance_,
+      ProdMonotonicTimeSource::instance_);
+  return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<CacheFilter>(filter_config));
+  };
+}
+
+/**
+ * Static registration for the cache filter. @see RegisterFactory.
+ */
+static Registry::RegisterFactory<CacheFilterFactory,
+                                 Server::Configuration::NamedHttpFilterConfigFactory>
+    register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.validate.h"
+
+#include "extensions/filters/http/common/factory_base.h"
+#include "extensions/filters/http/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Config registration for the cache filter. @see NamedHttpFilterConfigFactory.
+ */
+class CacheFilterFactory
+    : public Common::FactoryBase<envoy::config::filter::http::cache::v2alpha::Cache> {
+public:
+  CacheFilterFactory() : FactoryBase(HttpFilterNames::get().CACHE) {}
+
+private:
+  Http::FilterFactoryCb createFilterFactoryFromProtoTyped(
+      const envoy::config::filter::http::cache::v2alpha::Cache& config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context) override;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
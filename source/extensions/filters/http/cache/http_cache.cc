@@ -0,0 +1,79 @@
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+HttpCache::HttpCache(uint64_t max_bytes, CacheStats& stats)
+    : max_shard_bytes_(max_bytes / SHARDS), stats_(stats) {}
+
+HttpCache::Shard& HttpCache::shard(const std::string& key) {
+  return shards_[HashUtil::xxHash64(key) % SHARDS];
+}
+
+CachedResponseConstSharedPtr HttpCache::lookup(const std::string& key) {
+  Shard& shard = this->shard(key);
+  Thread::LockGuard lock(shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+  shard.entries_.splice(shard.entries_.begin(), shard.entries_, it->second);
+  return it->second->response_;
+}
+
+void HttpCache::insert(const std::string& key, CachedResponseConstSharedPtr response) {
+  // The key is held twice, by the entry and the index. The body is charged for the whole of its
+  // slices, which are rounded up to pages, rather than for the bytes it uses of them.
+  uint64_t size = 2 * key.size() + response->headers_->byteSize();
+  for (const Buffer::SliceSharedPtr& slice : response->body_) {
+    size += slice->size();
+  }
+  if (size > max_shard_bytes_) {
+    return;
+  }
+
+  Shard& shard = this->shard(key);
+  Thread::LockGuard lock(shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    erase(shard, it->second);
+  }
+  while (shard.size_ + size > max_shard_bytes_) {
+    erase(shard, std::prev(shard.entries_.end()));
+    stats_.eviction_.inc();
+  }
+
+  shard.entries_.push_front({key, std::move(response), size});
+  shard.index_.emplace(key, shard.entries_.begin());
+  shard.size_ += size;
+  stats_.insert_.inc();
+  stats_.entries_.inc();
+  stats_.size_bytes_.add(size);
+}
+
+void HttpCache::remove(const std::string& key, const CachedResponse& response) {
+  Shard& shard = this->shard(key);
+  Thread::LockGuard lock(shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end() && it->second->response_.get() == &response) {
+    erase(shard, it->second);
+  }
+}
+
+void HttpCache::erase(Shard& shard, std::list<Entry>::iterator entry) {
+  shard.size_ -= entry->size_;
+  stats_.entries_.dec();
+  stats_.size_bytes_.sub(entry->size_);
+  shard.index_.erase(entry->key_);
+  shard.entries_.erase(entry);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
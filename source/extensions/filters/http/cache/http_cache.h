@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All stats for the cache filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CACHE_STATS(COUNTER, GAUGE)                                                            \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(insert)                                                                                  \
+  COUNTER(eviction)                                                                                \
+  GAUGE  (entries)                                                                                 \
+  GAUGE  (size_bytes)
+// clang-format on
+
+/**
+ * Struct definition for all cache filter stats. @see stats_macros.h
+ */
+struct CacheStats {
+  ALL_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A response held by the cache. It is immutable once inserted and shared by all workers; the body
+ * slices are attached to the buffers of the responses served from it rather than copied.
+ */
+struct CachedResponse {
+  Http::HeaderMapPtr headers_;
+  std::vector<Buffer::SliceSharedPtr> body_;
+  uint64_t body_length_{};
+  // The request headers named by the vary header of the response, with their values in the
+  // request it answered. An absent header has an empty value.
+  std::vector<std::pair<Http::LowerCaseString, std::string>> vary_headers_;
+  // When the response was received, its age at that time, and when it becomes stale.
+  MonotonicTime response_time_;
+  std::chrono::seconds initial_age_{};
+  MonotonicTime expiry_time_;
+};
+
+typedef std::shared_ptr<const CachedResponse> CachedResponseConstSharedPtr;
+
+/**
+ * An in-memory response cache shared by all workers. Keys are spread over shards that each have
+ * their own lock, LRU list and share of the byte budget, so that workers rarely contend.
+ */
+class HttpCache {
+public:
+  static const uint32_t SHARDS = 16;
+
+  /**
+   * @param max_bytes supplies the number of bytes of responses the cache may hold. A response
+   *        counts the memory of its body slices in full, even where the body does not fill them.
+   * @param stats supplies the stats to update on insertion and eviction.
+   */
+  HttpCache(uint64_t max_bytes, CacheStats& stats);
+
+  /**
+   * Find the response stored under a key and mark it as the most recently used in its shard.
+   * @param key supplies the key.
+   * @return the response, or nullptr if there is none.
+   */
+  CachedResponseConstSharedPtr lookup(const std::string& key);
+
+  /**
+   * Store a response under a key, replacing any response already stored under it and evicting
+   * the least recently used responses of the shard as needed. A response that is larger than the
+   * budget of a shard is not stored.
+   * @param key supplies the key.
+   * @param response supplies the response.
+   */
+  void insert(const std::string& key, CachedResponseConstSharedPtr response);
+
+  /**
+   * Remove the response stored under a key, if it is still the given one.
+   * @param key supplies the key.
+   * @param response supplies the response to remove.
+   */
+  void remove(const std::string& key, const CachedResponse& response);
+
+private:
+  struct Entry {
+    std::string key_;
+    CachedResponseConstSharedPtr response_;
+    uint64_t size_;
+  };
+
+  struct Shard {
+    Thread::MutexBasicLockable mutex_;
+    // Most recently used first.
+    std::list<Entry> entries_ GUARDED_BY(mutex_);
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_ GUARDED_BY(mutex_);
+    uint64_t size_ GUARDED_BY(mutex_){};
+  };
+
+  Shard& shard(const std::string& key);
+  void erase(Shard& shard, std::list<Entry>::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint64_t max_shard_bytes_;
+  CacheStats& stats_;
+  Shard shards_[SHARDS];
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -44,6 +44,8 @@ public:
   const std::string EXT_AUTHORIZATION = "envoy.ext_authz";
   // RBAC HTTP Authorization filter
   const std::string RBAC = "envoy.filters.http.rbac";
+  // Cache filter
+  const std::string CACHE = "envoy.filters.http.cache";
 
   // Converts names from v1 to v2
   const Config::V1Converter v1_converter_;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.validate.h"
+#include "envoy/server/filter_config.h"
+
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+#include "extensions/filters/udp/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+/**
+ * Config registration for the UDP proxy filter. @see NamedUdpListenerFilterConfigFactory.
+ */
+class UdpProxyFilterConfigFactory
+    : public Server::Configuration::NamedUdpListenerFilterConfigFactory {
+public:
+  // NamedUdpListenerFilterConfigFactory
+  Network::UdpListenerFilterFactoryCb
+  createFilterFactoryFromProto(const Protobuf::Message& config,
+                               Server::Configuration::ListenerFactoryContext& context) override;
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig>();
+  }
+
+  std::string name() override { return UdpFilterNames::get().UDP_PROXY; }
+};
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,190 @@
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include <unistd.h>
+
+#include <cstring>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+UdpProxyFilterConfig::UdpProxyFilterConfig(
+    Upstream::ClusterManager& cluster_manager, Stats::Scope& root_scope,
+    const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config)
+    : cluster_manager_(cluster_manager), cluster_(config.cluster()),
+      session_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, idle_timeout, 60 * 1000)),
+      stats_(generateStats(config.stat_prefix(), root_scope)) {}
+
+UdpProxyStats UdpProxyFilterConfig::generateStats(const std::string& stat_prefix,
+                                                  Stats::Scope& scope) {
+  const std::string final_prefix = fmt::format("udp.{}.", stat_prefix);
+  return {ALL_UDP_PROXY_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                              POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
+UdpProxyFilter::LoadBalancerContext::LoadBalancerContext(const Network::Address::Instance& peer)
+    : hash_(HashUtil::xxHash64(peer.asString())) {}
+
+UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                               const UdpProxyFilterConfigSharedPtr& config)
+    : callbacks_(callbacks), config_(config) {}
+
+UdpProxyFilter::~UdpProxyFilter() {
+  pending_flush_.clear();
+  sessions_.clear();
+}
+
+void UdpProxyFilter::onData(Network::UdpRecvData& data) {
+  ActiveSession* session;
+  auto existing = sessions_.find(data.peer_address_->asString());
+  if (existing != sessions_.end()) {
+    session = existing->second.get();
+  } else {
+    session = createSession(data.peer_address_);
+    if (session == nullptr) {
+      return;
+    }
+  }
+
+  session->write(*data.buffer_);
+}
+
+void UdpProxyFilter::onReadComplete() {
+  for (ActiveSession* session : pending_flush_) {
+    session->flush();
+  }
+  pending_flush_.clear();
+}
+
+UdpProxyFilter::ActiveSession*
+UdpProxyFilter::createSession(const Network::Address::InstanceConstSharedPtr& peer) {
+  Upstream::ThreadLocalCluster* cluster = config_->clusterManager().get(config_->cluster());
+  if (cluster == nullptr) {
+    ENVOY_LOG(debug, "udp proxy: unknown cluster '{}'", config_->cluster());
+    config_->stats().downstream_sess_no_route_.inc();
+    return nullptr;
+  }
+
+  LoadBalancerContext context(*peer);
+  Upstream::HostConstSharedPtr host = cluster->loadBalancer().chooseHost(&context);
+  if (host == nullptr) {
+    ENVOY_LOG(debug, "udp proxy: no healthy host in cluster '{}'", config_->cluster());
+    cluster->info()->stats().upstream_cx_none_healthy_.inc();
+    config_->stats().downstream_sess_no_route_.inc();
+    return nullptr;
+  }
+
+  // Connecting the socket makes the kernel drop datagrams from anyone but the host, and lets
+  // writes skip the destination address.
+  const int fd = host->address()->socket(Network::Address::SocketType::Datagram);
+  if (fd == -1 || host->address()->connect(fd) == -1) {
+    ENVOY_LOG(debug, "udp proxy: cannot open socket to {}: {}", host->address()->asString(),
+              strerror(errno));
+    if (fd != -1) {
+      ::close(fd);
+    }
+    config_->stats().upstream_sess_error_.inc();
+    return nullptr;
+  }
+
+  ActiveSessionPtr session(new ActiveSession(*this, peer, host, fd));
+  ActiveSession* raw_session = session.get();
+  sessions_.emplace(peer->asString(), std::move(session));
+  return raw_session;
+}
+
+void UdpProxyFilter::removeSession(ActiveSession& session) {
+  // Timers and upstream reads never run while a listener batch is being delivered.
+  ASSERT(pending_flush_.empty());
+  sessions_.erase(session.peer()->asString());
+}
+
+UdpProxyFilter::ActiveSession::ActiveSession(UdpProxyFilter& parent,
+                                             const Network::Address::InstanceConstSharedPtr& peer,
+                                             const Upstream::HostConstSharedPtr& host, int fd)
+    : parent_(parent), peer_(peer), host_(host), fd_(fd),
+      read_event_(parent.callbacks_.dispatcher().createFileEvent(
+          fd, [this](uint32_t) -> void { onReadReady(); }, Event::FileTriggerType::Level,
+          Event::FileReadyType::Read)),
+      idle_timer_(parent.callbacks_.dispatcher().createTimer([this] { onIdleTimeout(); })) {
+  ENVOY_LOG(debug, "udp proxy: new session from {} to {}", peer_->asString(),
+            host_->address()->asString());
+  parent_.config_->stats().downstream_sess_total_.inc();
+  parent_.config_->stats().downstream_sess_active_.inc();
+  // The idle timer is armed by the first write(), which always follows.
+}
+
+UdpProxyFilter::ActiveSession::~ActiveSession() {
+  parent_.config_->stats().downstream_sess_active_.dec();
+  read_event_.reset();
+  ::close(fd_);
+}
+
+void UdpProxyFilter::ActiveSession::write(Buffer::Instance& data) {
+  UdpProxyStats& stats = parent_.config_->stats();
+  stats.downstream_sess_rx_datagrams_.inc();
+  stats.downstream_sess_rx_bytes_.add(data.length());
+
+  // The session joins the flush list, and its timer is pushed back, once per listener batch.
+  if (send_queue_.empty()) {
+    parent_.pending_flush_.push_back(this);
+    idle_timer_->enableTimer(parent_.config_->sessionTimeout());
+  }
+  send_queue_.add(nullptr, data);
+}
+
+void UdpProxyFilter::ActiveSession::flush() {
+  const Network::UdpSendQueue::Result result = send_queue_.flush(fd_);
+  parent_.config_->stats().upstream_sess_tx_datagrams_dropped_.add(result.dropped_);
+}
+
+void UdpProxyFilter::ActiveSession::onReadReady() {
+  UdpProxyStats& stats = parent_.config_->stats();
+  Network::UdpListener& listener = parent_.callbacks_.udpListener();
+  uint32_t read = 0;
+  while (read < MaxDatagramsPerEvent) {
+    const Network::UdpReader::Result result = parent_.reader_.read(
+        fd_, false,
+        [this, &stats, &listener](const Network::Address::InstanceConstSharedPtr&,
+                                  Buffer::InstancePtr&& buffer) {
+          stats.downstream_sess_tx_datagrams_.inc();
+          stats.downstream_sess_tx_bytes_.add(buffer->length());
+          listener.send(peer_, *buffer);
+        });
+    const uint32_t batch = result.datagrams_ + result.truncated_;
+    read += batch;
+    if (result.error_ != 0) {
+      // Typically ECONNREFUSED, reported after the host answered a datagram with an ICMP port
+      // unreachable.
+      ENVOY_LOG(trace, "udp proxy: read error from {}: {}", host_->address()->asString(),
+                strerror(result.error_));
+      stats.upstream_sess_rx_errors_.inc();
+    }
+    if (batch < Network::UdpReader::BatchSize) {
+      break;
+    }
+  }
+
+  if (read > 0) {
+    idle_timer_->enableTimer(parent_.config_->sessionTimeout());
+    listener.flush();
+  }
+}
+
+void UdpProxyFilter::ActiveSession::onIdleTimeout() {
+  ENVOY_LOG(debug, "udp proxy: session from {} timed out", peer_->asString());
+  parent_.config_->stats().idle_timeout_.inc();
+  parent_.removeSession(*this);
+}
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
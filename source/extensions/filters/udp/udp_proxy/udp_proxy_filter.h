@@ -0,0 +1,170 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/filter.h"
+#include "envoy/network/listener.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/cluster_manager.h"
+#include "envoy/upstream/load_balancer.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+#include "common/network/udp_io.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+/**
+ * All UDP proxy stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_UDP_PROXY_STATS(COUNTER, GAUGE)                                                        \
+  COUNTER(downstream_sess_total)                                                                   \
+  GAUGE  (downstream_sess_active)                                                                  \
+  COUNTER(downstream_sess_no_route)                                                                \
+  COUNTER(downstream_sess_rx_datagrams)                                                            \
+  COUNTER(downstream_sess_rx_bytes)                                                                \
+  COUNTER(downstream_sess_tx_datagrams)                                                            \
+  COUNTER(downstream_sess_tx_bytes)                                                                \
+  COUNTER(idle_timeout)                                                                            \
+  COUNTER(upstream_sess_error)                                                                     \
+  COUNTER(upstream_sess_rx_errors)                                                                 \
+  COUNTER(upstream_sess_tx_datagrams_dropped)
+// clang-format on
+
+/**
+ * Struct definition for all UDP proxy stats. @see stats_macros.h
+ */
+struct UdpProxyStats {
+  ALL_UDP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Filter configuration shared by the filter instances of all workers.
+ */
+class UdpProxyFilterConfig {
+public:
+  UdpProxyFilterConfig(
+      Upstream::ClusterManager& cluster_manager, Stats::Scope& root_scope,
+      const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config);
+
+  Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
+  const std::string& cluster() const { return cluster_; }
+  std::chrono::milliseconds sessionTimeout() const { return session_timeout_; }
+  UdpProxyStats& stats() const { return stats_; }
+
+private:
+  static UdpProxyStats generateStats(const std::string& stat_prefix, Stats::Scope& scope);
+
+  Upstream::ClusterManager& cluster_manager_;
+  const std::string cluster_;
+  const std::chrono::milliseconds session_timeout_;
+  mutable UdpProxyStats stats_;
+};
+
+typedef std::shared_ptr<const UdpProxyFilterConfig> UdpProxyFilterConfigSharedPtr;
+
+/**
+ * A UDP listener filter that forwards the datagrams of each downstream peer to a host of the
+ * configured cluster, and the host's replies back to the peer. Every peer gets a session with its
+ * own connected upstream socket, so that replies can be told apart without looking at their
+ * source. Datagrams are queued as they arrive and written with one sendmmsg() per session and
+ * listener batch.
+ */
+class UdpProxyFilter : public Network::UdpListenerReadFilter,
+                       Logger::Loggable<Logger::Id::filter> {
+public:
+  UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                 const UdpProxyFilterConfigSharedPtr& config);
+  ~UdpProxyFilter();
+
+  // Network::UdpListenerReadFilter
+  void onData(Network::UdpRecvData& data) override;
+  void onReadComplete() override;
+
+  // Datagrams read from a session's upstream socket per readiness event.
+  static const uint32_t MaxDatagramsPerEvent = 64;
+
+private:
+  /**
+   * The state of a single downstream peer.
+   */
+  class ActiveSession : NonCopyable {
+  public:
+    ActiveSession(UdpProxyFilter& parent, const Network::Address::InstanceConstSharedPtr& peer,
+                  const Upstream::HostConstSharedPtr& host, int fd);
+    ~ActiveSession();
+
+    /**
+     * Queue a datagram from the peer for the upstream host.
+     */
+    void write(Buffer::Instance& data);
+
+    /**
+     * Write the queued datagrams to the upstream host.
+     */
+    void flush();
+
+    const Network::Address::InstanceConstSharedPtr& peer() const { return peer_; }
+
+  private:
+    void onReadReady();
+    void onIdleTimeout();
+
+    UdpProxyFilter& parent_;
+    const Network::Address::InstanceConstSharedPtr peer_;
+    const Upstream::HostConstSharedPtr host_;
+    const int fd_;
+    Event::FileEventPtr read_event_;
+    Event::TimerPtr idle_timer_;
+    Network::UdpSendQueue send_queue_;
+  };
+
+  typedef std::unique_ptr<ActiveSession> ActiveSessionPtr;
+
+  /**
+   * Hashes the peer address, so that hash based load balancers keep sending a peer to the same
+   * host when its session is recreated, possibly on another worker.
+   */
+  class LoadBalancerContext : public Upstream::LoadBalancerContext {
+  public:
+    LoadBalancerContext(const Network::Address::Instance& peer);
+
+    // Upstream::LoadBalancerContext
+    absl::optional<uint64_t> computeHashKey() override { return hash_; }
+    const Router::MetadataMatchCriteria* metadataMatchCriteria() override { return nullptr; }
+    const Network::Connection* downstreamConnection() const override { return nullptr; }
+
+  private:
+    const uint64_t hash_;
+  };
+
+  ActiveSession* createSession(const Network::Address::InstanceConstSharedPtr& peer);
+  void removeSession(ActiveSession& session);
+
+  Network::UdpReadFilterCallbacks& callbacks_;
+  const UdpProxyFilterConfigSharedPtr config_;
+  // The upstream sockets of all sessions are read on this worker, so they share a reader and its
+  // buffers.
+  Network::UdpReader reader_;
+  // Sessions keyed by the peer address. The local side of every datagram is the listener address.
+  std::unordered_map<std::string, ActiveSessionPtr> sessions_;
+  // Sessions with datagrams queued during the current listener batch.
+  std::vector<ActiveSession*> pending_flush_;
+};
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,27 +1,48 @@
 #include "extensions/transport_sockets/raw_buffer/config.h"
 
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.h"
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.validate.h"
 #include "envoy/registry/registry.h"
 
 #include "common/network/raw_buffer_socket.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace RawBuffer {
 
+namespace {
+
+Network::TransportSocketFactoryPtr
+createFactory(const Protobuf::Message& message,
+              Server::Configuration::TransportSocketFactoryContext& context) {
+  const auto& config = MessageUtil::downcastAndValidate<
+      const envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer&>(message);
+  Network::ZeroCopyConfigConstSharedPtr zero_copy_config;
+  if (config.has_zerocopy_threshold_bytes()) {
+    zero_copy_config = std::make_shared<const Network::ZeroCopyConfig>(
+        config.zerocopy_threshold_bytes().value(), context.statsScope());
+  }
+  return std::make_unique<Network::RawBufferSocketFactory>(zero_copy_config);
+}
+
+} // namespace
+
 Network::TransportSocketFactoryPtr UpstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+    const Protobuf::Message& message,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  return createFactory(message, context);
 }
 
 Network::TransportSocketFactoryPtr DownstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&,
+    const Protobuf::Message& message, Server::Configuration::TransportSocketFactoryContext& context,
     const std::vector<std::string>&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+  return createFactory(message, context);
 }
 
 ProtobufTypes::MessagePtr RawBufferSocketFactory::createEmptyConfigProto() {
-  return std::make_unique<ProtobufWkt::Empty>();
+  return std::make_unique<envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer>();
 }
 
 static Registry::RegisterFactory<UpstreamRawBufferSocketFactory,
@@ -26,5 +26,10 @@ Network::ListenerPtr ValidationDispatcher::createListener(Network::Socket&,
   NOT_IMPLEMENTED;
 }
 
+Network::UdpListenerPtr ValidationDispatcher::createUdpListener(Network::Socket&,
+                                                                Network::UdpListenerCallbacks&) {
+  NOT_IMPLEMENTED;
+}
+
 } // namespace Event
 } // namespace Envoy
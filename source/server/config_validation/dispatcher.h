@@ -25,6 +25,8 @@ public:
   Network::ListenerPtr createListener(Network::Socket&, Network::ListenerCallbacks&,
                                       bool bind_to_port,
                                       bool hand_off_restored_destination_connections) override;
+  Network::UdpListenerPtr createUdpListener(Network::Socket&,
+                                            Network::UdpListenerCallbacks&) override;
 
 protected:
   std::shared_ptr<Network::ValidationDnsResolver> dns_resolver_{
@@ -110,6 +110,11 @@ public:
       Configuration::ListenerFactoryContext& context) override {
     return ProdListenerComponentFactory::createListenerFilterFactoryList_(filters, context);
   }
+  std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+      Configuration::ListenerFactoryContext& context) override {
+    return ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(filters, context);
+  }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr,
                                               const Network::Socket::OptionsSharedPtr&,
                                               bool) override {
@@ -117,13 +122,26 @@ public:
     // validation mock.
     return nullptr;
   }
+  std::vector<Network::SocketSharedPtr>
+  createWorkerListenSockets(Network::Address::InstanceConstSharedPtr,
+                            const Network::Socket::OptionsSharedPtr&, uint32_t num_sockets,
+                            bool) override {
+    // As above, but the listener expects a socket slot per worker.
+    return std::vector<Network::SocketSharedPtr>(num_sockets);
+  }
+  std::vector<Network::SocketSharedPtr>
+  createUdpListenSockets(Network::Address::InstanceConstSharedPtr,
+                         const Network::Socket::OptionsSharedPtr&, uint32_t num_sockets,
+                         bool) override {
+    return std::vector<Network::SocketSharedPtr>(num_sockets);
+  }
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType) override {
     return nullptr;
   }
   uint64_t nextListenerTag() override { return 0; }
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override {
+  WorkerPtr createWorker(uint32_t) override {
     // Returned workers are not currently used so we can return nothing here safely vs. a
     // validation mock.
     return nullptr;
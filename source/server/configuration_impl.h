@@ -102,6 +102,13 @@ public:
    */
   static bool buildFilterChain(Network::ListenerFilterManager& filter_manager,
                                const std::vector<Network::ListenerFilterFactoryCb>& factories);
+
+  /**
+   * Given a UdpListenerFilterManager and a list of factories, create a new filter chain.
+   */
+  static bool buildFilterChain(Network::UdpListenerFilterManager& filter_manager,
+                               Network::UdpReadFilterCallbacks& callbacks,
+                               const std::vector<Network::UdpListenerFilterFactoryCb>& factories);
 };
 
 /**
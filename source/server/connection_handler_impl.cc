@@ -13,14 +13,27 @@
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             uint32_t worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index) {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
+  if (config.socketType() == Network::Address::SocketType::Datagram) {
+    udp_listeners_.emplace_back(new ActiveUdpListener(*this, config));
+    return;
+  }
+
   ActiveListenerPtr l(new ActiveListener(*this, config));
   listeners_.emplace_back(config.socket().localAddress(), std::move(l));
 }
 
+Network::Socket& ConnectionHandlerImpl::listenSocket(Network::ListenerConfig& config) {
+  // Listeners that bind a SO_REUSEPORT socket per worker hand each worker its own socket, so that
+  // the kernel rather than the worker wakeup order decides which worker accepts a connection.
+  Network::Socket* worker_socket = config.workerSocket(worker_index_);
+  return worker_socket != nullptr ? *worker_socket : config.socket();
+}
+
 void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
   for (auto listener = listeners_.begin(); listener != listeners_.end();) {
     if (listener->second->listener_tag_ == listener_tag) {
@@ -29,20 +42,53 @@ void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
       ++listener;
     }
   }
+  udp_listeners_.remove_if([listener_tag](const ActiveUdpListenerPtr& listener) {
+    return listener->listener_tag_ == listener_tag;
+  });
 }
 
 void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
   for (auto& listener : listeners_) {
     if (listener.second->listener_tag_ == listener_tag) {
-      listener.second->listener_.reset();
+      listener.second->stopListening();
+    }
+  }
+  for (auto& listener : udp_listeners_) {
+    if (listener->listener_tag_ == listener_tag) {
+      listener->stopListening();
     }
   }
 }
 
 void ConnectionHandlerImpl::stopListeners() {
   for (auto& listener : listeners_) {
-    listener.second->listener_.reset();
+    listener.second->stopListening();
+  }
+  for (auto& listener : udp_listeners_) {
+    listener->stopListening();
+  }
+}
+
+void ConnectionHandlerImpl::post(uint64_t listener_tag, Network::ConnectionSocketPtr&& socket) {
+  // Posted callbacks must be copyable, so the socket travels in a shared_ptr.
+  std::shared_ptr<Network::ConnectionSocketPtr> posted_socket =
+      std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  dispatcher_.post([this, listener_tag, posted_socket]() -> void {
+    // The listener may have been stopped or removed on this worker since the socket was handed
+    // over, in which case the socket is closed when the callback is destroyed.
+    ActiveListener* listener = findActiveListenerByTag(listener_tag);
+    if (listener != nullptr) {
+      listener->acceptSocket(std::move(*posted_socket),
+                             listener->config_.handOffRestoredDestinationConnections());
+    }
+  });
+}
+
+void ConnectionHandlerImpl::ActiveListener::stopListening() {
+  if (balancer_ != nullptr && listener_ != nullptr) {
+    balancer_->unregisterHandler(parent_.worker_index_);
   }
+  listener_.reset();
 }
 
 void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& connection) {
@@ -52,13 +98,39 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.dispatcher_.deferredDelete(std::move(removed));
   ASSERT(parent_.num_connections_ > 0);
   parent_.num_connections_--;
+  updateAcceptState();
+}
+
+void ConnectionHandlerImpl::ActiveListener::updateAcceptState() {
+  if (balancer_ != nullptr) {
+    balancer_->onConnectionCount(parent_.worker_index_, sockets_.size() + connections_.size());
+  }
+
+  if (listener_ == nullptr || max_connections_ == 0) {
+    return;
+  }
+
+  // Sockets still running listener filters count towards the limit as they become connections.
+  const bool at_limit = sockets_.size() + connections_.size() >= max_connections_;
+  if (at_limit && !accept_paused_) {
+    ENVOY_LOG_TO_LOGGER(parent_.logger_, debug, "pausing accept: {} connections",
+                        sockets_.size() + connections_.size());
+    listener_->disable();
+    stats_.downstream_cx_accept_paused_.inc();
+    accept_paused_ = true;
+  } else if (!at_limit && accept_paused_) {
+    ENVOY_LOG_TO_LOGGER(parent_.logger_, debug, "resuming accept");
+    listener_->enable();
+    accept_paused_ = false;
+  }
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerConfig& config)
     : ActiveListener(
           parent,
-          parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
+          parent.dispatcher_.createListener(parent.listenSocket(config), *this,
+                                            config.bindToPort(),
                                             config.handOffRestoredDestinationConnections()),
           config) {}
 
@@ -67,9 +139,21 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())), listener_tag_(config.listenerTag()),
-      config_(config) {}
+      config_(config), max_connections_(config.maxConnectionsPerWorker()),
+      balancer_(config.connectionBalancer()) {
+  if (listener_ != nullptr) {
+    listener_->setAcceptBatchSize(config.acceptBatchSize());
+    listener_->setAcceptStats(
+        {stats_.downstream_cx_accept_batch_size_, stats_.downstream_cx_accept_latency_us_});
+    if (balancer_ != nullptr) {
+      balancer_->registerHandler(parent_.worker_index_, parent_);
+    }
+  }
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  stopListening();
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -119,6 +203,17 @@ ConnectionHandlerImpl::findActiveListenerByAddress(const Network::Address::Insta
   return (listener_it != listeners_.end()) ? listener_it->second.get() : nullptr;
 }
 
+ConnectionHandlerImpl::ActiveListener*
+ConnectionHandlerImpl::findActiveListenerByTag(uint64_t listener_tag) {
+  // We do not return stopped listeners.
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == listener_tag && listener.second->listener_ != nullptr) {
+      return listener.second.get();
+    }
+  }
+  return nullptr;
+}
+
 void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
   if (success) {
     if (iter_ == accept_filters_.end()) {
@@ -148,7 +243,7 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destionations' as false to
       // prevent further redirection.
-      new_listener->onAccept(std::move(socket_), false);
+      new_listener->acceptSocket(std::move(socket_), false);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -164,11 +259,28 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
   if (inserted()) {
     ActiveSocketPtr removed = removeFromList(listener_.sockets_);
     listener_.parent_.dispatcher_.deferredDelete(std::move(removed));
+    listener_.updateAcceptState();
   }
 }
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
+  if (balancer_ != nullptr) {
+    // Move the socket to a less loaded worker before any filter runs on it.
+    Network::BalancedConnectionHandler& target =
+        balancer_->pickTargetHandler(parent_.worker_index_);
+    if (&target != &parent_) {
+      stats_.downstream_cx_rebalanced_.inc();
+      target.post(listener_tag_, std::move(socket));
+      return;
+    }
+  }
+
+  acceptSocket(std::move(socket), hand_off_restored_destination_connections);
+}
+
+void ConnectionHandlerImpl::ActiveListener::acceptSocket(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
   Network::Address::InstanceConstSharedPtr local_address = socket->localAddress();
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
@@ -182,6 +294,8 @@ void ConnectionHandlerImpl::ActiveListener::onAccept(
   if (active_socket->iter_ != active_socket->accept_filters_.end()) {
     active_socket->moveIntoListBack(std::move(active_socket), sockets_);
   }
+
+  updateAcceptState();
 }
 
 void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSocketPtr&& socket) {
@@ -242,6 +356,37 @@ ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
   conn_length_->complete();
 }
 
+ConnectionHandlerImpl::ActiveUdpListener::ActiveUdpListener(ConnectionHandlerImpl& parent,
+                                                            Network::ListenerConfig& config)
+    : parent_(parent),
+      udp_listener_(parent.dispatcher_.createUdpListener(parent.listenSocket(config), *this)),
+      stats_(generateStats(config.listenerScope())), listener_tag_(config.listenerTag()) {
+  udp_listener_->setStats({stats_.downstream_rx_datagrams_,
+                           stats_.downstream_rx_datagrams_truncated_,
+                           stats_.downstream_tx_datagrams_, stats_.downstream_tx_datagrams_dropped_,
+                           stats_.downstream_rx_batch_size_});
+  config.filterChainFactory().createUdpListenerFilterChain(*this, *this);
+}
+
+ConnectionHandlerImpl::ActiveUdpListener::~ActiveUdpListener() { stopListening(); }
+
+void ConnectionHandlerImpl::ActiveUdpListener::stopListening() {
+  read_filters_.clear();
+  udp_listener_.reset();
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onData(Network::UdpRecvData& data) {
+  for (auto& filter : read_filters_) {
+    filter->onData(data);
+  }
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onReadComplete() {
+  for (auto& filter : read_filters_) {
+    filter->onReadComplete();
+  }
+}
+
 ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
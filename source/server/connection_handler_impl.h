@@ -8,6 +8,7 @@
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -29,6 +30,15 @@ namespace Server {
   COUNTER  (downstream_cx_destroy)                                                                 \
   GAUGE    (downstream_cx_active)                                                                  \
   HISTOGRAM(downstream_cx_length_ms)                                                               \
+  HISTOGRAM(downstream_cx_accept_batch_size)                                                       \
+  HISTOGRAM(downstream_cx_accept_latency_us)                                                       \
+  COUNTER  (downstream_cx_accept_paused)                                                           \
+  COUNTER  (downstream_cx_rebalanced)                                                              \
+  COUNTER  (downstream_rx_datagrams)                                                               \
+  COUNTER  (downstream_rx_datagrams_truncated)                                                     \
+  HISTOGRAM(downstream_rx_batch_size)                                                              \
+  COUNTER  (downstream_tx_datagrams)                                                               \
+  COUNTER  (downstream_tx_datagrams_dropped)                                                       \
   COUNTER  (no_filter_chain_match)
 // clang-format on
 
@@ -43,9 +53,16 @@ struct ListenerStats {
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
  */
-class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
+class ConnectionHandlerImpl : public Network::ConnectionHandler,
+                              public Network::BalancedConnectionHandler,
+                              NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param worker_index supplies the index of the worker that owns the handler. It selects the
+   *        listen socket of listeners that bind a socket per worker.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        uint32_t worker_index = 0);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -56,9 +73,15 @@ public:
 
   Network::Listener* findListenerByAddress(const Network::Address::Instance& address) override;
 
+  // Network::BalancedConnectionHandler
+  uint32_t loopUtilization() const override { return dispatcher_.loopUtilization(); }
+  void post(uint64_t listener_tag, Network::ConnectionSocketPtr&& socket) override;
+
 private:
   struct ActiveListener;
   ActiveListener* findActiveListenerByAddress(const Network::Address::Instance& address);
+  ActiveListener* findActiveListenerByTag(uint64_t listener_tag);
+  Network::Socket& listenSocket(Network::ListenerConfig& config);
 
   struct ActiveConnection;
   typedef std::unique_ptr<ActiveConnection> ActiveConnectionPtr;
@@ -81,6 +104,17 @@ private:
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
 
+    /**
+     * Run the listener filters on a socket accepted by, or handed over to, this worker.
+     */
+    void acceptSocket(Network::ConnectionSocketPtr&& socket,
+                      bool hand_off_restored_destination_connections);
+
+    /**
+     * Stop accepting on the listener and stop receiving sockets from other workers.
+     */
+    void stopListening();
+
     /**
      * Remove and destroy an active connection.
      * @param connection supplies the connection to remove.
@@ -92,6 +126,12 @@ private:
      */
     void newConnection(Network::ConnectionSocketPtr&& socket);
 
+    /**
+     * Report the number of connections and sockets owned by this listener to the balancer, and
+     * pause or resume accepting depending on whether they are within the configured limit.
+     */
+    void updateAcceptState();
+
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
@@ -99,10 +139,50 @@ private:
     std::list<ActiveConnectionPtr> connections_;
     const uint64_t listener_tag_;
     Network::ListenerConfig& config_;
+    const uint32_t max_connections_;
+    Network::ConnectionBalancer* const balancer_;
+    bool accept_paused_{};
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
 
+  /**
+   * Wrapper for an active UDP listener owned by this handler. It owns the instances of the
+   * listener's filters on this worker, which see every datagram the worker receives.
+   */
+  struct ActiveUdpListener : public Network::UdpListenerCallbacks,
+                             public Network::UdpListenerFilterManager,
+                             public Network::UdpReadFilterCallbacks {
+    ActiveUdpListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
+    ~ActiveUdpListener();
+
+    // Network::UdpListenerCallbacks
+    void onData(Network::UdpRecvData& data) override;
+    void onReadComplete() override;
+
+    // Network::UdpListenerFilterManager
+    void addReadFilter(Network::UdpListenerReadFilterPtr&& filter) override {
+      read_filters_.emplace_back(std::move(filter));
+    }
+
+    // Network::UdpReadFilterCallbacks
+    Network::UdpListener& udpListener() override { return *udp_listener_; }
+    Event::Dispatcher& dispatcher() override { return parent_.dispatcher_; }
+
+    /**
+     * Stop receiving on the listener. The filters go first as they may still send through it.
+     */
+    void stopListening();
+
+    ConnectionHandlerImpl& parent_;
+    Network::UdpListenerPtr udp_listener_;
+    ListenerStats stats_;
+    std::list<Network::UdpListenerReadFilterPtr> read_filters_;
+    const uint64_t listener_tag_;
+  };
+
+  typedef std::unique_ptr<ActiveUdpListener> ActiveUdpListenerPtr;
+
   /**
    * Wrapper for an active connection owned by this handler.
    */
@@ -163,7 +243,9 @@ private:
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const uint32_t worker_index_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
+  std::list<ActiveUdpListenerPtr> udp_listeners_;
   std::atomic<uint64_t> num_connections_{};
 };
 
@@ -26,7 +26,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 11;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -220,6 +220,16 @@ void HotRestartImpl::drainParentListeners() {
 }
 
 int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+  return requestParentListenSocket(address, -1);
+}
+
+int HotRestartImpl::duplicateParentWorkerListenSocket(const std::string& address,
+                                                      uint32_t worker_index) {
+  return requestParentListenSocket(address, worker_index);
+}
+
+int HotRestartImpl::requestParentListenSocket(const std::string& address,
+                                              int32_t worker_index) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -227,6 +237,7 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
@@ -353,11 +364,28 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   RpcGetListenSocketReply reply;
   reply.fd_ = -1;
 
-  Network::Address::InstanceConstSharedPtr addr =
-      Network::Utility::resolveUrl(std::string(rpc.address_));
+  const std::string url(rpc.address_);
+  Network::Address::InstanceConstSharedPtr addr = Network::Utility::resolveUrl(url);
+  // TCP and UDP listeners may share an address.
+  const Network::Address::SocketType socket_type = Network::Utility::urlIsUdpScheme(url)
+                                                       ? Network::Address::SocketType::Datagram
+                                                       : Network::Address::SocketType::Stream;
   for (const auto& listener : server_->listenerManager().listeners()) {
-    if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().fd();
+    if (*listener.get().socket().localAddress() == *addr &&
+        listener.get().socketType() == socket_type) {
+      // Only hand out sockets of the kind that was asked for. A child that shares one socket
+      // between its workers must not end up with a socket of a parent's SO_REUSEPORT group and
+      // vice versa.
+      if (rpc.worker_index_ < 0) {
+        if (listener.get().workerSocket(0) == nullptr) {
+          reply.fd_ = listener.get().socket().fd();
+        }
+      } else {
+        const Network::Socket* socket = listener.get().workerSocket(rpc.worker_index_);
+        if (socket != nullptr) {
+          reply.fd_ = socket->fd();
+        }
+      }
       break;
     }
   }
@@ -122,6 +122,8 @@ public:
   // Server::HotRestart
   void drainParentListeners() override;
   int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentWorkerListenSocket(const std::string& address,
+                                        uint32_t worker_index) override;
   void getParentStats(GetParentStatsInfo& info) override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
@@ -167,6 +169,8 @@ private:
     RpcGetListenSocketRequest() : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
     char address_[256]{0};
+    // Index of the requested per-worker socket, or -1 for the socket shared by all workers.
+    int32_t worker_index_{-1};
   } __attribute__((packed));
 
   struct RpcGetListenSocketReply : public RpcBase {
@@ -197,6 +201,7 @@ private:
   }
 
   int bindDomainSocket(uint64_t id);
+  int requestParentListenSocket(const std::string& address, int32_t worker_index);
   void initDomainSocketAddress(sockaddr_un* address);
   sockaddr_un createDomainSocketAddress(uint64_t id);
   void onGetListenSocket(RpcGetListenSocketRequest& rpc);
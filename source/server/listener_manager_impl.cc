@@ -1,5 +1,10 @@
 #include "server/listener_manager_impl.h"
 
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+
 #include "envoy/admin/v2alpha/config_dump.pb.h"
 #include "envoy/registry/registry.h"
 #include "envoy/server/transport_socket_config.h"
@@ -9,7 +14,9 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/config/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
+#include "common/network/listener_impl.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/socket_option_factory.h"
 #include "common/network/utility.h"
@@ -81,6 +88,30 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
   return ret;
 }
 
+std::vector<Network::UdpListenerFilterFactoryCb>
+ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+    Configuration::ListenerFactoryContext& context) {
+  std::vector<Network::UdpListenerFilterFactoryCb> ret;
+  for (ssize_t i = 0; i < filters.size(); i++) {
+    const auto& proto_config = filters[i];
+    const ProtobufTypes::String string_name = proto_config.name();
+    ENVOY_LOG(debug, "  udp filter #{}:", i);
+    ENVOY_LOG(debug, "    name: {}", string_name);
+    const Json::ObjectSharedPtr filter_config =
+        MessageUtil::getJsonObjectFromMessage(proto_config.config());
+    ENVOY_LOG(debug, "  config: {}", filter_config->asJsonString());
+
+    // Now see if there is a factory that will accept the config.
+    auto& factory =
+        Config::Utility::getAndCheckFactory<Configuration::NamedUdpListenerFilterConfigFactory>(
+            string_name);
+    auto message = Config::Utility::translateToFactoryConfig(proto_config, factory);
+    ret.push_back(factory.createFilterFactoryFromProto(*message, context));
+  }
+  return ret;
+}
+
 Network::SocketSharedPtr
 ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                                  const Network::Socket::OptionsSharedPtr& options,
@@ -109,6 +140,88 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   return std::make_shared<Network::TcpListenSocket>(address, options, bind_to_port);
 }
 
+std::vector<Network::SocketSharedPtr> ProdListenerComponentFactory::createWorkerListenSockets(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets, bool cpu_steering) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  ASSERT(num_sockets > 0);
+
+  Network::Socket::OptionsSharedPtr reuse_port_options =
+      std::make_shared<std::vector<Network::Socket::OptionConstSharedPtr>>();
+  Network::Socket::appendOptions(reuse_port_options,
+                                 Network::SocketOptionFactory::buildReusePortOptions());
+  if (options) {
+    Network::Socket::appendOptions(reuse_port_options, options);
+  }
+
+  // Each worker's socket is fetched from the parent separately. If the parent had fewer workers,
+  // the remaining sockets join its SO_REUSEPORT group.
+  const std::string addr = fmt::format("tcp://{}", address->asString());
+  std::vector<Network::SocketSharedPtr> sockets;
+  for (uint32_t i = 0; i < num_sockets; i++) {
+    const int fd = server_.hotRestart().duplicateParentWorkerListenSocket(addr, i);
+    if (fd != -1) {
+      ENVOY_LOG(debug, "obtained socket {} for address {} from parent", i, addr);
+      sockets.push_back(std::make_shared<Network::TcpListenSocket>(fd, address, options));
+      continue;
+    }
+
+    // Bind the other sockets to the port of the first one in case the configured port is 0.
+    sockets.push_back(std::make_shared<Network::TcpListenSocket>(
+        sockets.empty() ? address : sockets[0]->localAddress(), reuse_port_options, true));
+    // The kernel numbers the sockets of a SO_REUSEPORT group in the order that they start
+    // listening. Listen here rather than on the workers so that socket i is member i of the group.
+    if (::listen(sockets.back()->fd(), Network::ListenerImpl::ListenBacklog) == -1) {
+      throw EnvoyException(
+          fmt::format("cannot listen on '{}': {}", address->asString(), strerror(errno)));
+    }
+  }
+
+  if (cpu_steering &&
+      !Network::Utility::attachReusePortCpuSteering(sockets[0]->fd(), num_sockets)) {
+    throw EnvoyException(fmt::format("cannot attach CPU steering program to '{}': {}",
+                                     address->asString(), strerror(errno)));
+  }
+  return sockets;
+}
+
+std::vector<Network::SocketSharedPtr> ProdListenerComponentFactory::createUdpListenSockets(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets, bool cpu_steering) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  ASSERT(num_sockets > 0);
+
+  Network::Socket::OptionsSharedPtr reuse_port_options =
+      std::make_shared<std::vector<Network::Socket::OptionConstSharedPtr>>();
+  Network::Socket::appendOptions(reuse_port_options,
+                                 Network::SocketOptionFactory::buildReusePortOptions());
+  if (options) {
+    Network::Socket::appendOptions(reuse_port_options, options);
+  }
+
+  // As with TCP worker sockets, each one is fetched from the parent separately.
+  const std::string addr = fmt::format("udp://{}", address->asString());
+  std::vector<Network::SocketSharedPtr> sockets;
+  for (uint32_t i = 0; i < num_sockets; i++) {
+    const int fd = server_.hotRestart().duplicateParentWorkerListenSocket(addr, i);
+    if (fd != -1) {
+      ENVOY_LOG(debug, "obtained socket {} for address {} from parent", i, addr);
+      sockets.push_back(std::make_shared<Network::UdpListenSocket>(fd, address, options));
+      continue;
+    }
+
+    sockets.push_back(std::make_shared<Network::UdpListenSocket>(
+        sockets.empty() ? address : sockets[0]->localAddress(), reuse_port_options));
+  }
+
+  if (cpu_steering &&
+      !Network::Utility::attachReusePortCpuSteering(sockets[0]->fd(), num_sockets)) {
+    throw EnvoyException(fmt::format("cannot attach CPU steering program to '{}': {}",
+                                     address->asString(), strerror(errno)));
+  }
+  return sockets;
+}
+
 DrainManagerPtr
 ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::DrainType drain_type) {
   return DrainManagerPtr{new DrainManagerImpl(server_, drain_type)};
@@ -118,18 +231,49 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
                            ListenerManagerImpl& parent, const std::string& name, bool modifiable,
                            bool workers_started, uint64_t hash)
     : parent_(parent), address_(Network::Address::resolveProtoAddress(config.address())),
+      socket_type_(config.address().socket_address().protocol() ==
+                           envoy::api::v2::core::SocketAddress::UDP
+                       ? Network::Address::SocketType::Datagram
+                       : Network::Address::SocketType::Stream),
       global_scope_(parent_.server_.stats().createScope("")),
-      listener_scope_(
-          parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
+      // TCP and UDP listeners may share an address, so UDP listener stats get a prefix of their
+      // own.
+      listener_scope_(parent_.server_.stats().createScope(
+          fmt::format(socket_type_ == Network::Address::SocketType::Datagram ? "listener.udp.{}."
+                                                                              : "listener.{}.",
+                      address_->asString()))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
+      accept_batch_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, accept_batch_size, 64)),
+      max_connections_per_worker_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connections_per_worker, 0)),
+      reuse_port_(config.has_reuse_port() ||
+                  socket_type_ == Network::Address::SocketType::Datagram),
+      reuse_port_cpu_steering_(config.reuse_port().cpu_steering()),
       listener_tag_(parent_.factory_.nextListenerTag()), name_(name), modifiable_(modifiable),
       workers_started_(workers_started), hash_(hash),
       local_drain_manager_(parent.factory_.createDrainManager(config.drain_type())),
       config_(config), version_info_(version_info) {
+  if (socket_type_ == Network::Address::SocketType::Datagram && !bind_to_port_) {
+    throw EnvoyException(fmt::format(
+        "error adding listener '{}': UDP listeners must bind to their port", address_->asString()));
+  }
+  if (reuse_port_ && (address_->type() != Network::Address::Type::Ip || !bind_to_port_)) {
+    throw EnvoyException(fmt::format("error adding listener '{}': reuse_port requires an IP "
+                                     "address and a listener that binds to its port",
+                                     address_->asString()));
+  }
+  if (config.has_connection_balance()) {
+    connection_balancer_ = std::make_unique<Network::ConnectionBalancerImpl>(
+        std::max(1U, parent_.server_.options().concurrency()),
+        config.connection_balance().load_metric() ==
+                envoy::api::v2::Listener::ConnectionBalance::LOOP_UTILIZATION
+            ? Network::ConnectionBalancerImpl::LoadMetric::LoopUtilization
+            : Network::ConnectionBalancerImpl::LoadMetric::ActiveConnections);
+  }
   if (config.has_transparent()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpTransparentOptions());
   }
@@ -141,6 +285,26 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
         config.tcp_fast_open_queue_length().value()));
   }
 
+  if (socket_type_ == Network::Address::SocketType::Datagram) {
+    // There are no connections for listener filters to run on or for filter chains to be matched
+    // against, so a UDP listener takes one plain filter chain made of UDP listener filters.
+    if (config.filter_chains().size() != 1 || config.filter_chains()[0].has_filter_chain_match() ||
+        config.filter_chains()[0].has_tls_context() ||
+        config.filter_chains()[0].has_transport_socket() ||
+        config.filter_chains()[0].has_use_proxy_proto() || !config.listener_filters().empty() ||
+        config.has_use_original_dst() || config.has_connection_balance() ||
+        config.has_tcp_fast_open_queue_length()) {
+      throw EnvoyException(fmt::format(
+          "error adding listener '{}': UDP listeners take a single filter chain without match "
+          "rules or TLS, and do not support listener filters, use_original_dst, "
+          "connection_balance or tcp_fast_open_queue_length",
+          address_->asString()));
+    }
+    udp_listener_filter_factories_ = parent_.factory_.createUdpListenerFilterFactoryList(
+        config.filter_chains()[0].filters(), *this);
+    return;
+  }
+
   if (!config.listener_filters().empty()) {
     listener_filter_factories_ =
         parent_.factory_.createListenerFilterFactoryList(config.listener_filters(), *this);
@@ -397,6 +561,12 @@ bool ListenerImpl::createListenerFilterChain(Network::ListenerFilterManager& man
   return Configuration::FilterChainUtility::buildFilterChain(manager, listener_filter_factories_);
 }
 
+bool ListenerImpl::createUdpListenerFilterChain(Network::UdpListenerFilterManager& manager,
+                                                Network::UdpReadFilterCallbacks& callbacks) {
+  return Configuration::FilterChainUtility::buildFilterChain(manager, callbacks,
+                                                             udp_listener_filter_factories_);
+}
+
 bool ListenerImpl::drainClose() const {
   // When a listener is draining, the "drain close" decision is the union of the per-listener drain
   // manager and the server wide drain manager. This allows individual listeners to be drained and
@@ -435,25 +605,53 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
   ASSERT(!socket_);
   socket_ = socket;
   // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
-    // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
-                                            Network::Socket::SocketState::PostBind);
-    const std::string message =
-        fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
-    if (!ok) {
-      ENVOY_LOG(warn, "{}", message);
-      throw EnvoyException(message);
-    } else {
-      ENVOY_LOG(debug, "{}", message);
+  if (socket_) {
+    applyListenSocketOptions(*socket_);
+  }
+}
+
+void ListenerImpl::setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(worker_sockets_.empty());
+  ASSERT(!sockets.empty());
+  setSocket(sockets[0]);
+  for (size_t i = 1; i < sockets.size(); i++) {
+    if (sockets[i]) {
+      applyListenSocketOptions(*sockets[i]);
     }
+  }
+  worker_sockets_ = sockets;
+}
 
-    // Add the options to the socket_ so that SocketState::Listening options can be
-    // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+void ListenerImpl::inheritSockets(const ListenerImpl& listener) {
+  if (listener.getWorkerSockets().empty()) {
+    setSocket(listener.getSocket());
+  } else {
+    setWorkerSockets(listener.getWorkerSockets());
   }
 }
 
+void ListenerImpl::applyListenSocketOptions(Network::Socket& socket) {
+  if (!listen_socket_options_) {
+    return;
+  }
+
+  // 'pre_bind = false' as bind() is never done after this.
+  bool ok = Network::Socket::applyOptions(listen_socket_options_, socket,
+                                          Network::Socket::SocketState::PostBind);
+  const std::string message =
+      fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
+  if (!ok) {
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  } else {
+    ENVOY_LOG(debug, "{}", message);
+  }
+
+  // Add the options to the socket so that SocketState::Listening options can be
+  // set in the worker after listen()/evconnlistener_new() is called.
+  socket.addOptions(listen_socket_options_);
+}
+
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
                                          ListenerComponentFactory& listener_factory,
                                          WorkerFactory& worker_factory)
@@ -461,7 +659,7 @@ ListenerManagerImpl::ListenerManagerImpl(Instance& server,
       config_tracker_entry_(server.admin().getConfigTracker().add(
           "listeners", [this] { return dumpListenerConfigs(); })) {
   for (uint32_t i = 0; i < std::max(1U, server.options().concurrency()); i++) {
-    workers_.emplace_back(worker_factory.createWorker());
+    workers_.emplace_back(worker_factory.createWorker(i));
   }
 }
 
@@ -542,17 +740,39 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // The sockets are kept across updates, so neither the kind of socket nor the choice between one
+  // shared socket and per-worker sockets can change.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->socketType() != new_listener->socketType()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->socketType() != new_listener->socketType())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different protocol from existing listener", name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different reuse_port setting from existing listener",
+        name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->inheritSockets(**existing_warming_listener);
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->inheritSockets(**existing_active_listener);
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -581,21 +801,28 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->socketType() == listener.listener_->socketType() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->inheritSockets(*existing_draining_listener->listener_);
+    } else if (new_listener->socketType() == Network::Address::SocketType::Datagram) {
+      new_listener->setWorkerSockets(factory_.createUdpListenSockets(
+          new_listener->address(), new_listener->listenSocketOptions(), workers_.size(),
+          new_listener->reusePortCpuSteering()));
+    } else if (new_listener->reusePort()) {
+      new_listener->setWorkerSockets(factory_.createWorkerListenSockets(
+          new_listener->address(), new_listener->listenSocketOptions(), workers_.size(),
+          new_listener->reusePortCpuSteering()));
+    } else {
+      new_listener->setSocket(factory_.createListenSocket(new_listener->address(),
+                                                          new_listener->listenSocketOptions(),
+                                                          new_listener->bindToPort()));
     }
-
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -781,11 +1008,13 @@ void ListenerManagerImpl::startWorkers(GuardDog& guard_dog) {
   ENVOY_LOG(info, "all dependencies initialized. starting workers");
   ASSERT(!workers_started_);
   workers_started_ = true;
+  uint32_t i = 0;
   for (const auto& worker : workers_) {
     ASSERT(warming_listeners_.empty());
     for (const auto& listener : active_listeners_) {
       addListenerToWorker(*worker, *listener);
     }
+    worker->initializeStats(server_.stats(), fmt::format("listener_manager.worker_{}.", i++));
     worker->start(guard_dog);
   }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/api/v2/listener/listener.pb.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/filter.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/server/instance.h"
@@ -38,6 +39,12 @@ public:
   static std::vector<Network::ListenerFilterFactoryCb> createListenerFilterFactoryList_(
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context);
+  /**
+   * Static worker for createUdpListenerFilterFactoryList() that can be used directly in tests.
+   */
+  static std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList_(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+      Configuration::ListenerFactoryContext& context);
 
   // Server::ListenerComponentFactory
   LdsApiPtr createLdsApi(const envoy::api::v2::core::ConfigSource& lds_config) override {
@@ -55,9 +62,22 @@ public:
       Configuration::ListenerFactoryContext& context) override {
     return createListenerFilterFactoryList_(filters, context);
   }
+  std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+      Configuration::ListenerFactoryContext& context) override {
+    return createUdpListenerFilterFactoryList_(filters, context);
+  }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               const Network::Socket::OptionsSharedPtr& options,
                                               bool bind_to_port) override;
+  std::vector<Network::SocketSharedPtr>
+  createWorkerListenSockets(Network::Address::InstanceConstSharedPtr address,
+                            const Network::Socket::OptionsSharedPtr& options,
+                            uint32_t num_sockets, bool cpu_steering) override;
+  std::vector<Network::SocketSharedPtr>
+  createUdpListenSockets(Network::Address::InstanceConstSharedPtr address,
+                         const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets,
+                         bool cpu_steering) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -223,10 +243,19 @@ public:
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
   const envoy::api::v2::Listener& config() { return config_; }
   const Network::SocketSharedPtr& getSocket() const { return socket_; }
+  const std::vector<Network::SocketSharedPtr>& getWorkerSockets() const { return worker_sockets_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
   void setSocket(const Network::SocketSharedPtr& socket);
+  void setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets);
+  /**
+   * Take over the socket or per-worker sockets of a listener with the same address.
+   * @param listener supplies the listener that currently owns the sockets.
+   */
+  void inheritSockets(const ListenerImpl& listener);
+  bool reusePort() const { return reuse_port_; }
+  bool reusePortCpuSteering() const { return reuse_port_cpu_steering_; }
   void setSocketAndOptions(const Network::SocketSharedPtr& socket);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
@@ -235,11 +264,18 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
   Network::Socket& socket() override { return *socket_; }
+  Network::Socket* workerSocket(uint32_t worker_index) override {
+    return worker_index < worker_sockets_.size() ? worker_sockets_[worker_index].get() : nullptr;
+  }
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
   }
   uint32_t perConnectionBufferLimitBytes() override { return per_connection_buffer_limit_bytes_; }
+  uint32_t acceptBatchSize() const override { return accept_batch_size_; }
+  uint32_t maxConnectionsPerWorker() const override { return max_connections_per_worker_; }
+  Network::Address::SocketType socketType() const override { return socket_type_; }
+  Network::ConnectionBalancer* connectionBalancer() override { return connection_balancer_.get(); }
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
@@ -294,6 +330,8 @@ public:
   bool createNetworkFilterChain(Network::Connection& connection,
                                 const std::vector<Network::FilterFactoryCb>& factories) override;
   bool createListenerFilterChain(Network::ListenerFilterManager& manager) override;
+  bool createUdpListenerFilterChain(Network::UdpListenerFilterManager& manager,
+                                    Network::UdpReadFilterCallbacks& callbacks) override;
 
   // Configuration::TransportSocketFactoryContext
   Ssl::ContextManager& sslContextManager() override { return parent_.server_.sslContextManager(); }
@@ -319,6 +357,7 @@ private:
           transport_protocol_match,
       const Network::ConnectionSocket& socket) const;
   static bool isWildcardServerName(const std::string& name);
+  void applyListenSocketOptions(Network::Socket& socket);
 
   // Mapping of FilterChain's configured server name and transport protocol, i.e.
   //   map[server_name][transport_protocol][application_protocol] => FilterChainSharedPtr
@@ -333,12 +372,21 @@ private:
 
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
+  const Network::Address::SocketType socket_type_;
   Network::SocketSharedPtr socket_;
+  // One SO_REUSEPORT socket per worker if reuse_port is configured or the listener is a UDP
+  // listener, with socket_ being the first.
+  std::vector<Network::SocketSharedPtr> worker_sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
   const bool bind_to_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  const uint32_t accept_batch_size_;
+  const uint32_t max_connections_per_worker_;
+  const bool reuse_port_;
+  const bool reuse_port_cpu_steering_;
+  Network::ConnectionBalancerPtr connection_balancer_;
   const uint64_t listener_tag_;
   const std::string name_;
   const bool modifiable_;
@@ -347,6 +395,7 @@ private:
   InitManagerImpl dynamic_init_manager_;
   bool initialize_canceled_{};
   std::vector<Network::ListenerFilterFactoryCb> listener_filter_factories_;
+  std::vector<Network::UdpListenerFilterFactoryCb> udp_listener_filter_factories_;
   DrainManagerPtr local_drain_manager_;
   bool saw_listener_create_failure_{};
   const envoy::api::v2::Listener config_;
@@ -105,6 +105,16 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                              cmd);
   TCLAP::SwitchArg disable_hot_restart("", "disable-hot-restart",
                                        "Disable hot restart functionality", cmd, false);
+  TCLAP::SwitchArg use_libevent_buffers("", "use-libevent-buffers",
+                                        "Use the original libevent buffer implementation", cmd,
+                                        false);
+  TCLAP::SwitchArg use_io_uring("", "use-io-uring",
+                                "Poll file events through io_uring where supported", cmd, false);
+  TCLAP::SwitchArg worker_cpu_affinity("", "worker-cpu-affinity",
+                                       "Pin each worker thread to the CPU with the same index", cmd,
+                                       false);
+  TCLAP::SwitchArg use_timer_wheel("", "use-timer-wheel",
+                                   "Run timers on a hierarchical timer wheel", cmd, false);
 
   cmd.setExceptionHandling(false);
   try {
@@ -139,6 +149,10 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   // TODO(jmarantz): should we also multiply these to bound the total amount of memory?
 
   hot_restart_disabled_ = disable_hot_restart.getValue();
+  libevent_buffers_enabled_ = use_libevent_buffers.getValue();
+  io_uring_enabled_ = use_io_uring.getValue();
+  worker_cpu_affinity_ = worker_cpu_affinity.getValue();
+  timer_wheel_enabled_ = use_timer_wheel.getValue();
 
   log_level_ = default_log_level;
   for (size_t i = 0; i < ARRAY_SIZE(spdlog::level::level_names); i++) {
@@ -66,6 +66,16 @@ public:
   void setHotRestartDisabled(bool hot_restart_disabled) {
     hot_restart_disabled_ = hot_restart_disabled;
   }
+  void setLibeventBuffersEnabled(bool libevent_buffers_enabled) {
+    libevent_buffers_enabled_ = libevent_buffers_enabled;
+  }
+  void setIoUringEnabled(bool io_uring_enabled) { io_uring_enabled_ = io_uring_enabled; }
+  void setWorkerCpuAffinity(bool worker_cpu_affinity) {
+    worker_cpu_affinity_ = worker_cpu_affinity;
+  }
+  void setTimerWheelEnabled(bool timer_wheel_enabled) {
+    timer_wheel_enabled_ = timer_wheel_enabled;
+  }
 
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
@@ -93,6 +103,10 @@ public:
   uint64_t maxStats() const override { return max_stats_; }
   uint64_t maxObjNameLength() const override { return max_obj_name_length_; }
   bool hotRestartDisabled() const override { return hot_restart_disabled_; }
+  bool libeventBuffersEnabled() const override { return libevent_buffers_enabled_; }
+  bool ioUringEnabled() const override { return io_uring_enabled_; }
+  bool workerCpuAffinity() const override { return worker_cpu_affinity_; }
+  bool timerWheelEnabled() const override { return timer_wheel_enabled_; }
 
 private:
   uint64_t base_id_;
@@ -116,6 +130,10 @@ private:
   uint64_t max_stats_;
   uint64_t max_obj_name_length_;
   bool hot_restart_disabled_;
+  bool libevent_buffers_enabled_;
+  bool io_uring_enabled_;
+  bool worker_cpu_affinity_;
+  bool timer_wheel_enabled_;
 };
 
 /**
@@ -54,7 +54,7 @@ InstanceImpl::InstanceImpl(Options& options, Network::Address::InstanceConstShar
       singleton_manager_(new Singleton::ManagerImpl()),
       handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
       random_generator_(std::move(random_generator)), listener_component_factory_(*this),
-      worker_factory_(thread_local_, *api_, hooks),
+      worker_factory_(thread_local_, *api_, hooks, options.workerCpuAffinity()),
       dns_resolver_(dispatcher_->createDnsResolver({})),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store), terminated_(false) {
 
@@ -254,6 +254,7 @@ void InstanceImpl::initialize(Options& options,
 
   // We can now initialize stats for threading.
   stats_store_.initializeThreading(*dispatcher_, thread_local_);
+  dispatcher_->initializeStats(stats_store_, "server.main_thread.");
 
   // Runtime gets initialized before the main configuration since during main configuration
   // load things may grab a reference to the loader for later use.
@@ -1,6 +1,12 @@
 #include "server/worker_impl.h"
 
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <thread>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
@@ -14,11 +20,16 @@
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker() {
+WorkerPtr ProdWorkerFactory::createWorker(uint32_t index) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
-  return WorkerPtr{new WorkerImpl(
-      tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+  Network::ConnectionHandlerPtr handler(
+      new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher, index));
+  std::unique_ptr<WorkerImpl> worker(
+      new WorkerImpl(tls_, hooks_, std::move(dispatcher), std::move(handler)));
+  if (cpu_affinity_) {
+    worker->setCpuAffinity(index % std::max(1U, std::thread::hardware_concurrency()));
+  }
+  return worker;
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
@@ -43,6 +54,10 @@ void WorkerImpl::addListener(Network::ListenerConfig& listener, AddListenerCompl
   });
 }
 
+void WorkerImpl::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  dispatcher_->initializeStats(scope, prefix);
+}
+
 uint64_t WorkerImpl::numConnections() {
   uint64_t ret = 0;
   if (handler_) {
@@ -87,7 +102,26 @@ void WorkerImpl::stopListeners() {
   dispatcher_->post([this]() -> void { handler_->stopListeners(); });
 }
 
+void WorkerImpl::pinToCpu(uint32_t cpu) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  const int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  if (rc != 0) {
+    ENVOY_LOG(warn, "unable to pin worker to CPU {}: {}", cpu, strerror(rc));
+    return;
+  }
+  ENVOY_LOG(debug, "worker pinned to CPU {}", cpu);
+#else
+  ENVOY_LOG(warn, "unable to pin worker to CPU {}: not supported on this platform", cpu);
+#endif
+}
+
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
+  if (cpu_affinity_.has_value()) {
+    pinToCpu(cpu_affinity_.value());
+  }
   ENVOY_LOG(debug, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(Thread::Thread::currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
@@ -15,21 +15,28 @@
 
 #include "server/test_hooks.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Server {
 
 class ProdWorkerFactory : public WorkerFactory, Logger::Loggable<Logger::Id::main> {
 public:
-  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks)
-      : tls_(tls), api_(api), hooks_(hooks) {}
+  /**
+   * @param cpu_affinity supplies whether worker N is pinned to CPU N, modulo the number of CPUs.
+   */
+  ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks,
+                    bool cpu_affinity)
+      : tls_(tls), api_(api), hooks_(hooks), cpu_affinity_(cpu_affinity) {}
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override;
+  WorkerPtr createWorker(uint32_t index) override;
 
 private:
   ThreadLocal::Instance& tls_;
   Api::Api& api_;
   TestHooks& hooks_;
+  const bool cpu_affinity_;
 };
 
 /**
@@ -42,6 +49,7 @@ public:
 
   // Server::Worker
   void addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) override;
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override;
   uint64_t numConnections() override;
   void removeListener(Network::ListenerConfig& listener, std::function<void()> completion) override;
   void start(GuardDog& guard_dog) override;
@@ -49,7 +57,14 @@ public:
   void stopListener(Network::ListenerConfig& listener) override;
   void stopListeners() override;
 
+  /**
+   * Pin the worker thread to a CPU when it starts.
+   * @param cpu supplies the CPU number.
+   */
+  void setCpuAffinity(uint32_t cpu) { cpu_affinity_ = cpu; }
+
 private:
+  void pinToCpu(uint32_t cpu);
   void threadRoutine(GuardDog& guard_dog);
 
   ThreadLocal::Instance& tls_;
@@ -57,6 +72,7 @@ private:
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
   Thread::ThreadPtr thread_;
+  absl::optional<uint32_t> cpu_affinity_;
 };
 
 } // namespace Server
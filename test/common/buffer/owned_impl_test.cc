@@ -14,14 +14,24 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public testing::Test {
+// Run each test against both the native slice-based implementation and the libevent one.
+class OwnedImplTest : public testing::TestWithParam<bool> {
 public:
-  OwnedImplTest() {}
+  OwnedImplTest() { OwnedImpl::useOldImpl(GetParam()); }
+  ~OwnedImplTest() { OwnedImpl::useOldImpl(false); }
+
+  static std::string toString(const Instance& buffer) {
+    std::string output(buffer.length(), '\0');
+    buffer.copyOut(0, output.size(), &output[0]);
+    return output;
+  }
 
   bool release_callback_called_ = false;
 };
 
-TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
+INSTANTIATE_TEST_CASE_P(OwnedImplTest, OwnedImplTest, testing::Bool());
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
@@ -32,7 +42,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, addBufferFragmentWithCleanup) {
+TEST_P(OwnedImplTest, addBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
@@ -50,7 +60,7 @@ TEST_F(OwnedImplTest, addBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, addBufferFragmentDynamicAllocation) {
+TEST_P(OwnedImplTest, addBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -75,7 +85,159 @@ TEST_F(OwnedImplTest, addBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, write) {
+TEST_P(OwnedImplTest, ImplSelection) {
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(GetParam(), buffer.usesOldImpl());
+  EXPECT_EQ(GetParam(), OwnedImpl::newBuffersUseOldImpl());
+}
+
+TEST_P(OwnedImplTest, AddAcrossSlices) {
+  Buffer::OwnedImpl buffer;
+  const std::string data(40000, 'a');
+  buffer.add(data);
+  buffer.add("b");
+  EXPECT_EQ(40001, buffer.length());
+  EXPECT_EQ(data + "b", toString(buffer));
+
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  RawSlice slices[num_slices];
+  buffer.getRawSlices(slices, num_slices);
+  uint64_t total = 0;
+  for (const RawSlice& slice : slices) {
+    total += slice.len_;
+  }
+  EXPECT_EQ(40001, total);
+}
+
+TEST_P(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("hello");
+
+  RawSlice iovecs[2];
+  const uint64_t num_reserved = buffer.reserve(100, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  ASSERT_GE(iovecs[0].len_, 6);
+  memcpy(iovecs[0].mem_, " world", 6);
+  iovecs[0].len_ = 6;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ("hello world", toString(buffer));
+
+  // A reservation larger than any single slice spans multiple iovecs or one large slice.
+  const uint64_t num_large = buffer.reserve(65536, iovecs, 2);
+  uint64_t reserved = 0;
+  for (uint64_t i = 0; i < num_large; i++) {
+    reserved += iovecs[i].len_;
+  }
+  EXPECT_GE(reserved, 65536);
+  buffer.commit(iovecs, 0);
+  EXPECT_EQ(11, buffer.length());
+}
+
+TEST_P(OwnedImplTest, Search) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("abcd");
+  Buffer::OwnedImpl second("efgh");
+  buffer.move(second);
+  Buffer::OwnedImpl third("ijkl");
+  buffer.move(third);
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  EXPECT_EQ(2, buffer.search("cdef", 4, 0));
+  EXPECT_EQ(3, buffer.search("defghij", 7, 0));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 1));
+  EXPECT_EQ(8, buffer.search("ijkl", 4, 5));
+  EXPECT_EQ(-1, buffer.search("klm", 3, 0));
+  EXPECT_EQ(-1, buffer.search("x", 1, 0));
+  EXPECT_EQ(-1, buffer.search("a", 1, 13));
+}
+
+TEST_P(OwnedImplTest, MovePartial) {
+  Buffer::OwnedImpl source("hello");
+  Buffer::OwnedImpl second(" world");
+  source.move(second);
+  EXPECT_EQ(0, second.length());
+
+  Buffer::OwnedImpl destination;
+  destination.move(source, 7);
+  EXPECT_EQ("hello w", toString(destination));
+  EXPECT_EQ("orld", toString(source));
+
+  destination.move(source);
+  EXPECT_EQ("hello world", toString(destination));
+  EXPECT_EQ(0, source.length());
+}
+
+TEST_P(OwnedImplTest, MoveBetweenImplementations) {
+  Buffer::OwnedImpl source("hello world");
+  OwnedImpl::useOldImpl(!GetParam());
+  Buffer::OwnedImpl destination;
+  EXPECT_NE(source.usesOldImpl(), destination.usesOldImpl());
+
+  destination.move(source, 6);
+  EXPECT_EQ("hello ", toString(destination));
+  destination.move(source);
+  EXPECT_EQ("hello world", toString(destination));
+  EXPECT_EQ(0, source.length());
+}
+
+TEST_P(OwnedImplTest, MoveAssignBetweenImplementations) {
+  Buffer::OwnedImpl destination("stale");
+  OwnedImpl::useOldImpl(!GetParam());
+  destination = Buffer::OwnedImpl("hello world");
+  EXPECT_EQ(!GetParam(), destination.usesOldImpl());
+  EXPECT_EQ("hello world", toString(destination));
+
+  destination.add(" again");
+  EXPECT_EQ("hello world again", toString(destination));
+}
+
+TEST_P(OwnedImplTest, MoveLeavesSourceEmpty) {
+  Buffer::OwnedImpl source("hello");
+  Buffer::OwnedImpl constructed(std::move(source));
+  EXPECT_EQ("hello", toString(constructed));
+  EXPECT_EQ(0, source.length());
+  EXPECT_EQ(0, source.getRawSlices(nullptr, 0));
+
+  source.add("world");
+  Buffer::OwnedImpl assigned;
+  assigned = std::move(source);
+  EXPECT_EQ("world", toString(assigned));
+  EXPECT_EQ(0, source.length());
+
+  // The moved-from buffer is still usable.
+  source.add("again");
+  EXPECT_EQ("again", toString(source));
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  Buffer::OwnedImpl buffer("hello");
+  Buffer::OwnedImpl second(" world");
+  buffer.move(second);
+
+  const char* data = static_cast<const char*>(buffer.linearize(8));
+  EXPECT_EQ("hello wo", std::string(data, 8));
+  EXPECT_EQ("hello world", toString(buffer));
+}
+
+TEST_P(OwnedImplTest, AddBufferFragmentThenData) {
+  char input[] = "hello";
+  BufferFragmentImpl frag(input, 5, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag);
+  buffer.add(" world");
+  EXPECT_EQ("hello world", toString(buffer));
+
+  Buffer::OwnedImpl destination;
+  destination.move(buffer);
+  EXPECT_FALSE(release_callback_called_);
+  destination.drain(5);
+  EXPECT_TRUE(release_callback_called_);
+  EXPECT_EQ(" world", toString(destination));
+}
+
+TEST_P(OwnedImplTest, write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -113,7 +275,7 @@ TEST_F(OwnedImplTest, write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, read) {
+TEST_P(OwnedImplTest, read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -134,6 +296,95 @@ TEST_F(OwnedImplTest, read) {
   EXPECT_EQ(0, buffer.length());
 }
 
+// Drained slices stay alive while retained, and a partly drained slice is shared with the buffer.
+TEST(OwnedImplDrainRetainedTest, RetainsDrainedMemory) {
+  bool release_callback_called = false;
+  char input[] = "hello";
+  BufferFragmentImpl frag(input, 5, [&](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called = true;
+  });
+
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag);
+  buffer.add(" world");
+  std::vector<SliceSharedPtr> retained;
+  buffer.drainRetained(8, retained);
+  EXPECT_EQ(3, buffer.length());
+  ASSERT_EQ(2, retained.size());
+  EXPECT_EQ(input, retained[0]->data());
+  EXPECT_FALSE(release_callback_called);
+
+  // The remainder of the partly drained slice is still readable and new data goes to a new slice.
+  const void* remainder = retained[1]->data();
+  buffer.add("!");
+  RawSlice slices[2];
+  ASSERT_EQ(2, buffer.getRawSlices(slices, 2));
+  EXPECT_EQ(remainder, slices[0].mem_);
+  EXPECT_EQ("rld", std::string(static_cast<const char*>(slices[0].mem_), slices[0].len_));
+  EXPECT_EQ("rld!", OwnedImplTest::toString(buffer));
+
+  // Draining the rest of the buffer leaves the retained memory intact.
+  buffer.drain(4);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ("rld", std::string(static_cast<const char*>(retained[1]->data()), 3));
+  EXPECT_FALSE(release_callback_called);
+
+  retained.clear();
+  EXPECT_TRUE(release_callback_called);
+}
+
+// Retained slices can be added to several buffers, each of which drains its own view of them.
+TEST(OwnedImplDrainRetainedTest, AddSharedSlices) {
+  Buffer::OwnedImpl buffer("hello");
+  buffer.add(std::string(20000, 'a'));
+  const uint64_t length = buffer.length();
+  std::vector<SliceSharedPtr> retained;
+  buffer.drainRetained(length, retained);
+  EXPECT_EQ(0, buffer.length());
+
+  Buffer::OwnedImpl copy1;
+  Buffer::OwnedImpl copy2;
+  copy1.addSharedSlices(retained);
+  copy2.addSharedSlices(retained);
+  buffer.addSharedSlices(retained);
+  EXPECT_EQ(length, copy1.length());
+  EXPECT_EQ(length, copy2.length());
+  EXPECT_EQ(length, buffer.length());
+
+  RawSlice slice;
+  ASSERT_EQ(retained.size(), copy1.getRawSlices(&slice, 1));
+  EXPECT_EQ(retained[0]->data(), slice.mem_);
+
+  copy1.drain(3);
+  EXPECT_EQ("lo", OwnedImplTest::toString(copy1).substr(0, 2));
+  EXPECT_EQ("hello", OwnedImplTest::toString(copy2).substr(0, 5));
+  EXPECT_EQ("hello", OwnedImplTest::toString(buffer).substr(0, 5));
+
+  // The shared slices take no new data.
+  copy2.add("!");
+  EXPECT_EQ(length + 1, copy2.length());
+  EXPECT_EQ(length, buffer.length());
+}
+
+// Only slices whose memory the buffer owns alone report a size.
+TEST(OwnedImplOwnedSliceSizeTest, OnlyOwnedSlices) {
+  char input[] = "hello";
+  BufferFragmentImpl frag(input, 5, nullptr);
+
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag);
+  buffer.add(" world");
+  EXPECT_EQ(0, buffer.ownedSliceSize(0));
+  EXPECT_LE(6, buffer.ownedSliceSize(1));
+
+  std::vector<SliceSharedPtr> retained;
+  buffer.drainRetained(8, retained);
+  // The rest of the partly drained slice is shared with the retained one.
+  EXPECT_EQ(0, buffer.ownedSliceSize(0));
+  buffer.add(std::string(8000, 'a'));
+  EXPECT_LE(8000, buffer.ownedSliceSize(1));
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
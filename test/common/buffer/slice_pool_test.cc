@@ -0,0 +1,164 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_pool.h"
+#include "common/common/thread.h"
+#include "common/stats/stats_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SlicePoolTest : public testing::Test {
+public:
+  SlicePoolTest() : pool_(SlicePool::create(4 * SlicePool::PageSize)) {
+    pool_->initializeStats(stats_store_, "buffer_pool.");
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("buffer_pool." + name).value();
+  }
+  uint64_t residentBytes() { return stats_store_.gauge("buffer_pool.resident_bytes").value(); }
+
+  // A size that allocates exactly the given number of pages.
+  static uint64_t pagesToSize(uint64_t pages) {
+    return pages * SlicePool::PageSize - SlicePool::HeaderSize;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  SlicePoolSharedPtr pool_;
+};
+
+TEST_F(SlicePoolTest, NoCurrentPoolUsesHeap) {
+  EXPECT_EQ(nullptr, SlicePool::current());
+  void* memory = SlicePool::allocate(pagesToSize(1));
+  SlicePool::deallocate(memory);
+  EXPECT_EQ(0, counter("misses"));
+  EXPECT_EQ(0, counter("hits"));
+  EXPECT_EQ(0, pool_->residentBytes());
+}
+
+TEST_F(SlicePoolTest, ReuseOnOwningThread) {
+  SlicePool::ScopedCurrent current(*pool_);
+  EXPECT_EQ(pool_.get(), SlicePool::current());
+
+  void* memory = SlicePool::allocate(pagesToSize(1));
+  EXPECT_EQ(1, counter("misses"));
+  SlicePool::deallocate(memory);
+  EXPECT_EQ(SlicePool::PageSize, pool_->residentBytes());
+  EXPECT_EQ(SlicePool::PageSize, residentBytes());
+
+  void* reused = SlicePool::allocate(pagesToSize(1));
+  EXPECT_EQ(memory, reused);
+  EXPECT_EQ(1, counter("hits"));
+  EXPECT_EQ(0, residentBytes());
+
+  // A different size class does not share the free list.
+  void* larger = SlicePool::allocate(pagesToSize(2));
+  EXPECT_EQ(2, counter("misses"));
+  SlicePool::deallocate(larger);
+  SlicePool::deallocate(reused);
+  EXPECT_EQ(3 * SlicePool::PageSize, residentBytes());
+}
+
+TEST_F(SlicePoolTest, UnpoolableSizes) {
+  SlicePool::ScopedCurrent current(*pool_);
+  // Not a whole number of pages.
+  SlicePool::deallocate(SlicePool::allocate(100));
+  // Larger than the biggest size class.
+  SlicePool::deallocate(SlicePool::allocate(pagesToSize(SlicePool::MaxPooledPages + 1)));
+  EXPECT_EQ(0, counter("misses"));
+  EXPECT_EQ(0, residentBytes());
+}
+
+TEST_F(SlicePoolTest, ResidentBytesLimit) {
+  SlicePool::ScopedCurrent current(*pool_);
+  void* first = SlicePool::allocate(pagesToSize(3));
+  void* second = SlicePool::allocate(pagesToSize(3));
+  SlicePool::deallocate(first);
+  // This one would take the pool past its 4 page limit, so it goes back to the heap.
+  SlicePool::deallocate(second);
+  EXPECT_EQ(3 * SlicePool::PageSize, residentBytes());
+}
+
+TEST_F(SlicePoolTest, ReleaseOnOtherThread) {
+  void* memory;
+  {
+    SlicePool::ScopedCurrent current(*pool_);
+    memory = SlicePool::allocate(pagesToSize(1));
+  }
+
+  Thread::Thread thread([memory]() { SlicePool::deallocate(memory); });
+  thread.join();
+  // Remote releases are only picked up when the owner next needs a block.
+  EXPECT_EQ(0, residentBytes());
+
+  SlicePool::ScopedCurrent current(*pool_);
+  EXPECT_EQ(memory, SlicePool::allocate(pagesToSize(1)));
+  EXPECT_EQ(1, counter("hits"));
+  SlicePool::deallocate(memory);
+}
+
+TEST_F(SlicePoolTest, PoolOutlivesOwner) {
+  void* memory;
+  {
+    SlicePool::ScopedCurrent current(*pool_);
+    memory = SlicePool::allocate(pagesToSize(1));
+  }
+  // The owner drops its reference while a block is still outstanding. The block keeps the pool
+  // alive and releasing it destroys the pool.
+  std::weak_ptr<SlicePool> weak_pool = pool_;
+  pool_.reset();
+  EXPECT_FALSE(weak_pool.expired());
+  SlicePool::deallocate(memory);
+  EXPECT_TRUE(weak_pool.expired());
+}
+
+// A pool that outlives its owner does not touch the stats once they are detached, so the scope can
+// go away first.
+TEST(SlicePoolStatsTest, DetachStats) {
+  auto stats_store = std::make_unique<Stats::IsolatedStoreImpl>();
+  SlicePoolSharedPtr pool = SlicePool::create();
+  pool->initializeStats(*stats_store, "buffer_pool.");
+  void* memory;
+  {
+    SlicePool::ScopedCurrent current(*pool);
+    memory = SlicePool::allocate(SlicePool::PageSize - SlicePool::HeaderSize);
+    SlicePool::deallocate(SlicePool::allocate(2 * SlicePool::PageSize - SlicePool::HeaderSize));
+  }
+  Stats::Gauge& resident_bytes = stats_store->gauge("buffer_pool.resident_bytes");
+  EXPECT_EQ(2 * SlicePool::PageSize, resident_bytes.value());
+
+  pool->detachStats();
+  EXPECT_EQ(0, resident_bytes.value());
+  pool.reset();
+  stats_store.reset();
+  SlicePool::deallocate(memory);
+}
+
+TEST_F(SlicePoolTest, BufferMovedAcrossThreads) {
+  OwnedImpl::useOldImpl(false);
+  std::unique_ptr<OwnedImpl> buffer;
+  {
+    SlicePool::ScopedCurrent current(*pool_);
+    buffer = std::make_unique<OwnedImpl>();
+    RawSlice slice;
+    buffer->reserve(16384, &slice, 1);
+    slice.len_ = 1;
+    buffer->commit(&slice, 1);
+  }
+  EXPECT_EQ(1, counter("misses"));
+
+  Thread::Thread thread([&buffer]() { buffer.reset(); });
+  thread.join();
+
+  SlicePool::ScopedCurrent current(*pool_);
+  OwnedImpl reused;
+  RawSlice slice;
+  reused.reserve(16384, &slice, 1);
+  EXPECT_EQ(1, counter("hits"));
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
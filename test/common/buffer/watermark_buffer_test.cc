@@ -97,6 +97,16 @@ TEST_F(WatermarkBufferTest, Drain) {
   EXPECT_EQ(2, times_high_watermark_called_);
 }
 
+TEST_F(WatermarkBufferTest, DrainRetained) {
+  buffer_.add(TEN_BYTES, 11);
+  EXPECT_EQ(1, times_high_watermark_called_);
+
+  std::vector<SliceSharedPtr> retained;
+  buffer_.drainRetained(7, retained);
+  EXPECT_EQ(4, buffer_.length());
+  EXPECT_EQ(1, times_low_watermark_called_);
+}
+
 TEST_F(WatermarkBufferTest, MoveFullBuffer) {
   buffer_.add(TEN_BYTES, 10);
   OwnedImpl data("a");
@@ -0,0 +1,92 @@
+#include <vector>
+
+#include "common/common/intrusive_list.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+struct Item : IntrusiveListNode<Item> {
+  Item(int value) : value_(value) {}
+
+  int value_;
+};
+
+std::vector<int> values(IntrusiveList<Item>& list) {
+  std::vector<int> ret;
+  for (Item& item : list) {
+    ret.push_back(item.value_);
+  }
+  return ret;
+}
+
+TEST(IntrusiveList, PushAndRemove) {
+  IntrusiveList<Item> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(std::vector<int>{}, values(list));
+
+  Item a(1), b(2), c(3);
+  list.pushFront(b);
+  list.pushFront(a);
+  list.pushBack(c);
+  EXPECT_FALSE(list.empty());
+  EXPECT_EQ(3U, list.size());
+  EXPECT_EQ(1, list.front().value_);
+  EXPECT_EQ(3, list.back().value_);
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), values(list));
+  EXPECT_TRUE(b.linked());
+
+  list.remove(b);
+  EXPECT_FALSE(b.linked());
+  EXPECT_EQ((std::vector<int>{1, 3}), values(list));
+  list.remove(a);
+  list.remove(c);
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(0U, list.size());
+}
+
+TEST(IntrusiveList, MoveToFront) {
+  IntrusiveList<Item> ready;
+  IntrusiveList<Item> busy;
+  Item a(1), b(2);
+  ready.pushBack(a);
+  ready.pushBack(b);
+
+  busy.moveToFront(b, ready);
+  EXPECT_EQ((std::vector<int>{1}), values(ready));
+  EXPECT_EQ((std::vector<int>{2}), values(busy));
+
+  // Moving within the same list makes the object the front.
+  ready.remove(a);
+  busy.pushBack(a);
+  EXPECT_EQ((std::vector<int>{2, 1}), values(busy));
+  busy.moveToFront(a, busy);
+  EXPECT_EQ((std::vector<int>{1, 2}), values(busy));
+
+  busy.remove(a);
+  busy.remove(b);
+}
+
+TEST(IntrusiveList, Swap) {
+  IntrusiveList<Item> list1;
+  IntrusiveList<Item> list2;
+  Item a(1), b(2), c(3);
+  list1.pushBack(a);
+  list1.pushBack(b);
+  list2.pushBack(c);
+
+  list1.swap(list2);
+  EXPECT_EQ((std::vector<int>{3}), values(list1));
+  EXPECT_EQ((std::vector<int>{1, 2}), values(list2));
+
+  IntrusiveList<Item> empty;
+  empty.swap(list2);
+  EXPECT_TRUE(list2.empty());
+  EXPECT_EQ((std::vector<int>{1, 2}), values(empty));
+
+  list1.remove(c);
+  empty.remove(a);
+  empty.remove(b);
+}
+
+} // namespace Envoy
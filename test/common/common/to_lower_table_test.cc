@@ -26,5 +26,25 @@ TEST(ToLowerTableTest, All) {
     table.toLowerCase(input);
     EXPECT_EQ(input, "\x90hello\x90");
   }
+  {
+    // Long enough to be converted a word at a time, with every byte value on either side of the
+    // upper case range and a tail.
+    std::string input("@AZ[`az{\xc0\xc1\xda\xdb\xe0\xe1\xfa\xfbX-Forwarded-FOR");
+    table.toLowerCase(input);
+    EXPECT_EQ(input, "@az[`az{\xc0\xc1\xda\xdb\xe0\xe1\xfa\xfbx-forwarded-for");
+  }
+  {
+    // Every byte value, at every offset within a word.
+    for (size_t offset = 0; offset < 8; offset++) {
+      std::string input(offset, 'a');
+      std::string expected(offset, 'a');
+      for (int c = 0; c < 256; c++) {
+        input.push_back(static_cast<char>(c));
+        expected.push_back(static_cast<char>((c >= 'A' && c <= 'Z') ? c | 0x20 : c));
+      }
+      table.toLowerCase(input);
+      EXPECT_EQ(expected, input);
+    }
+  }
 }
 } // namespace Envoy
@@ -3,6 +3,7 @@
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "test/mocks/common.h"
 
@@ -53,6 +54,32 @@ TEST(DeferredDeleteTest, DeferredDelete) {
   dispatcher.clearDeferredDeleteList();
 }
 
+// Slices still held after the dispatcher is gone keep its slice pool alive, and releasing them
+// must not update stats in a scope that may be gone too.
+TEST(DispatcherSlicePoolTest, PoolOutlivesDispatcher) {
+  auto stats_store = std::make_unique<Stats::IsolatedStoreImpl>();
+  auto dispatcher = std::make_unique<DispatcherImpl>();
+  dispatcher->initializeStats(*stats_store, "worker.");
+  void* memory;
+  {
+    Buffer::SlicePool::ScopedCurrent current(dispatcher->slicePool());
+    memory = Buffer::SlicePool::allocate(2 * Buffer::SlicePool::PageSize -
+                                         Buffer::SlicePool::HeaderSize);
+    Buffer::SlicePool::deallocate(
+        Buffer::SlicePool::allocate(Buffer::SlicePool::PageSize - Buffer::SlicePool::HeaderSize));
+  }
+  Stats::Gauge& resident_bytes = stats_store->gauge("worker.buffer_pool.resident_bytes");
+  EXPECT_EQ(Buffer::SlicePool::PageSize, resident_bytes.value());
+
+  std::weak_ptr<Buffer::SlicePool> pool = dispatcher->slicePool().shared_from_this();
+  dispatcher.reset();
+  EXPECT_EQ(0, resident_bytes.value());
+  stats_store.reset();
+  EXPECT_FALSE(pool.expired());
+  Buffer::SlicePool::deallocate(memory);
+  EXPECT_TRUE(pool.expired());
+}
+
 class DispatcherImplTest : public ::testing::Test {
 protected:
   DispatcherImplTest() : dispatcher_(std::make_unique<DispatcherImpl>()), work_finished_(false) {
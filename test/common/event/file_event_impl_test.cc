@@ -2,6 +2,7 @@
 
 #include "envoy/event/file_event.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/event/dispatcher_impl.h"
 
 #include "test/mocks/common.h"
@@ -13,9 +14,12 @@
 namespace Envoy {
 namespace Event {
 
-class FileEventImplTest : public testing::Test {
+// Runs against both polling backends. Where io_uring is not available the dispatcher falls back to
+// libevent, so both instances still pass.
+class FileEventImplTest : public testing::TestWithParam<bool> {
 public:
   void SetUp() override {
+    DispatcherImpl::useIoUring(GetParam());
     int rc = socketpair(AF_UNIX, SOCK_DGRAM, 0, fds_);
     ASSERT_EQ(0, rc);
     int data = 1;
@@ -24,6 +28,7 @@ public:
   }
 
   void TearDown() override {
+    DispatcherImpl::useIoUring(false);
     close(fds_[0]);
     close(fds_[1]);
   }
@@ -32,6 +37,8 @@ protected:
   int fds_[2];
 };
 
+INSTANTIATE_TEST_CASE_P(Backends, FileEventImplTest, testing::Bool());
+
 class FileEventImplActivateTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 
 INSTANTIATE_TEST_CASE_P(IpVersions, FileEventImplActivateTest,
@@ -78,7 +85,7 @@ TEST_P(FileEventImplActivateTest, Activate) {
   close(fd);
 }
 
-TEST_F(FileEventImplTest, EdgeTrigger) {
+TEST_P(FileEventImplTest, EdgeTrigger) {
   DispatcherImpl dispatcher;
   ReadyWatcher read_event;
   EXPECT_CALL(read_event, ready()).Times(1);
@@ -101,7 +108,7 @@ TEST_F(FileEventImplTest, EdgeTrigger) {
   dispatcher.run(Event::Dispatcher::RunType::NonBlock);
 }
 
-TEST_F(FileEventImplTest, LevelTrigger) {
+TEST_P(FileEventImplTest, LevelTrigger) {
   DispatcherImpl dispatcher;
   ReadyWatcher read_event;
   EXPECT_CALL(read_event, ready()).Times(2);
@@ -129,7 +136,7 @@ TEST_F(FileEventImplTest, LevelTrigger) {
   dispatcher.run(Event::Dispatcher::RunType::Block);
 }
 
-TEST_F(FileEventImplTest, SetEnabled) {
+TEST_P(FileEventImplTest, SetEnabled) {
   DispatcherImpl dispatcher;
   ReadyWatcher read_event;
   EXPECT_CALL(read_event, ready()).Times(2);
@@ -162,5 +169,119 @@ TEST_F(FileEventImplTest, SetEnabled) {
   dispatcher.run(Event::Dispatcher::RunType::NonBlock);
 }
 
+TEST_P(FileEventImplTest, Activate) {
+  DispatcherImpl dispatcher;
+  ReadyWatcher closed_event;
+  EXPECT_CALL(closed_event, ready()).Times(1);
+
+  // Injected events are delivered even when they are not enabled.
+  Event::FileEventPtr file_event = dispatcher.createFileEvent(
+      fds_[0],
+      [&](uint32_t events) -> void {
+        if (events == FileReadyType::Closed) {
+          closed_event.ready();
+        }
+      },
+      FileTriggerType::Edge, 0);
+
+  file_event->activate(FileReadyType::Closed);
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// An event that is destroyed by the callback of another event ready in the same pass of the loop
+// is not called.
+TEST_P(FileEventImplTest, DeleteOtherEventInCallback) {
+  DispatcherImpl dispatcher;
+  Event::FileEventPtr file_event_1;
+  Event::FileEventPtr file_event_2;
+  ReadyWatcher ready;
+  EXPECT_CALL(ready, ready()).Times(1);
+
+  file_event_1 = dispatcher.createFileEvent(fds_[0],
+                                            [&](uint32_t) -> void {
+                                              ready.ready();
+                                              file_event_2.reset();
+                                            },
+                                            FileTriggerType::Edge, FileReadyType::Read);
+  file_event_2 = dispatcher.createFileEvent(fds_[0],
+                                            [&](uint32_t) -> void {
+                                              ready.ready();
+                                              file_event_1.reset();
+                                            },
+                                            FileTriggerType::Edge, FileReadyType::Read);
+
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+}
+
+// Data received by the io_uring backend on the owner's behalf is reported as a read event and
+// handed over by receive(), and stays queued while reads are disabled.
+TEST_P(FileEventImplTest, Receive) {
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+  DispatcherImpl dispatcher;
+  Buffer::OwnedImpl received;
+  bool ended = false;
+  Event::FileEventPtr file_event;
+  file_event = dispatcher.createFileEvent(fds[0],
+                                          [&](uint32_t events) -> void {
+                                            ASSERT_EQ(FileReadyType::Read, events);
+                                            int rc;
+                                            while ((rc = file_event->receive(received, 3)) > 0) {
+                                            }
+                                            if (rc == 0) {
+                                              ended = true;
+                                            } else {
+                                              EXPECT_EQ(EAGAIN, errno);
+                                            }
+                                            dispatcher.exit();
+                                          },
+                                          FileTriggerType::Edge, FileReadyType::Read);
+  if (!file_event->enableReceive()) {
+    // libevent, or a kernel without multishot receive.
+    file_event.reset();
+    close(fds[0]);
+    close(fds[1]);
+    return;
+  }
+
+  ASSERT_EQ(5, write(fds[1], "hello", 5));
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ("hello", received.toString());
+
+  file_event->setEnabled(0);
+  ASSERT_EQ(5, write(fds[1], "world", 5));
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ("hello", received.toString());
+
+  file_event->setEnabled(FileReadyType::Read);
+  while (received.length() < 10) {
+    dispatcher.run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ("helloworld", received.toString());
+
+  shutdown(fds[1], SHUT_WR);
+  while (!ended) {
+    dispatcher.run(Event::Dispatcher::RunType::Block);
+  }
+  EXPECT_EQ("helloworld", received.toString());
+
+  file_event.reset();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+// Only edge triggered events can receive, and only through io_uring.
+TEST_P(FileEventImplTest, ReceiveUnavailable) {
+  DispatcherImpl dispatcher;
+  Event::FileEventPtr level_event = dispatcher.createFileEvent(
+      fds_[0], [](uint32_t) -> void {}, FileTriggerType::Level, FileReadyType::Read);
+  EXPECT_FALSE(level_event->enableReceive());
+  if (!dispatcher.ioUringEnabled()) {
+    Event::FileEventPtr edge_event = dispatcher.createFileEvent(
+        fds_[0], [](uint32_t) -> void {}, FileTriggerType::Edge, FileReadyType::Read);
+    EXPECT_FALSE(edge_event->enableReceive());
+  }
+}
+
 } // namespace Event
 } // namespace Envoy
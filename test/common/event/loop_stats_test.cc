@@ -0,0 +1,122 @@
+#include <chrono>
+#include <thread>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/loop_stats.h"
+
+#include "test/mocks/stats/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::AtLeast;
+using testing::Ge;
+using testing::NiceMock;
+using testing::Property;
+
+namespace Envoy {
+namespace Event {
+
+class LoopStatsTest : public testing::Test {
+protected:
+  LoopStatsTest() : loop_stats_(store_, "test.loop.") {}
+
+  void busyFor(std::chrono::milliseconds duration) { std::this_thread::sleep_for(duration); }
+
+  NiceMock<Stats::MockIsolatedStatsStore> store_;
+  LoopStats loop_stats_;
+};
+
+TEST_F(LoopStatsTest, NotInstalled) {
+  EXPECT_EQ(nullptr, LoopStats::current());
+  {
+    LoopStats::ScopedCallback callback(LoopStats::Category::Timer);
+  }
+
+  EXPECT_CALL(store_, deliverHistogramToSinks(_, _)).Times(0);
+  loop_stats_.endIteration();
+}
+
+TEST_F(LoopStatsTest, IdlePass) {
+  LoopStats::ScopedCurrent current(loop_stats_);
+  EXPECT_EQ(&loop_stats_, LoopStats::current());
+  EXPECT_CALL(store_, deliverHistogramToSinks(_, _)).Times(0);
+  loop_stats_.endIteration();
+}
+
+// Time in a nested callback goes to its own category, and only outermost callbacks are events.
+TEST_F(LoopStatsTest, Categories) {
+  {
+    LoopStats::ScopedCurrent current(loop_stats_);
+    {
+      LoopStats::ScopedCallback timer(LoopStats::Category::Timer);
+      busyFor(std::chrono::milliseconds(2));
+      LoopStats::ScopedCallback post(LoopStats::Category::Post);
+      busyFor(std::chrono::milliseconds(4));
+    }
+    {
+      LoopStats::ScopedCallback file_event(LoopStats::Category::FileEvent);
+      busyFor(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_CALL(store_, deliverHistogramToSinks(
+                            Property(&Stats::Metric::name, "test.loop.duration_us"), Ge(7000U)));
+    EXPECT_CALL(store_,
+                deliverHistogramToSinks(Property(&Stats::Metric::name, "test.loop.events"), 2));
+    EXPECT_CALL(store_, deliverHistogramToSinks(
+                            Property(&Stats::Metric::name, "test.loop.timer_us"), Ge(2000U)));
+    EXPECT_CALL(store_, deliverHistogramToSinks(
+                            Property(&Stats::Metric::name, "test.loop.post_us"), Ge(4000U)));
+    EXPECT_CALL(store_, deliverHistogramToSinks(
+                            Property(&Stats::Metric::name, "test.loop.file_event_us"), Ge(1000U)));
+    loop_stats_.endIteration();
+  }
+  EXPECT_EQ(nullptr, LoopStats::current());
+
+  // The next pass starts from scratch.
+  testing::Mock::VerifyAndClearExpectations(&store_);
+  EXPECT_CALL(store_, deliverHistogramToSinks(_, _)).Times(0);
+  loop_stats_.endIteration();
+}
+
+// A pass that was busy for nearly all of the time since the previous one raises the utilization,
+// weighted by how long that time was.
+TEST_F(LoopStatsTest, Utilization) {
+  EXPECT_EQ(0U, loop_stats_.utilization());
+  LoopStats::ScopedCurrent current(loop_stats_);
+  {
+    LoopStats::ScopedCallback timer(LoopStats::Category::Timer);
+    busyFor(std::chrono::milliseconds(20));
+  }
+  loop_stats_.endIteration();
+  EXPECT_LT(0U, loop_stats_.utilization());
+  EXPECT_GE(100U, loop_stats_.utilization());
+}
+
+// Once stats are initialized, a dispatcher records each busy pass of its loop.
+TEST(DispatcherLoopStatsTest, RecordsPasses) {
+  NiceMock<Stats::MockIsolatedStatsStore> store;
+  DispatcherImpl dispatcher;
+  dispatcher.initializeStats(store, "test.");
+
+  uint32_t fired = 0;
+  TimerPtr timer;
+  timer = dispatcher.createTimer([&]() -> void {
+    if (++fired < 3) {
+      timer->enableTimer(std::chrono::milliseconds(1));
+    }
+  });
+  timer->enableTimer(std::chrono::milliseconds(1));
+
+  EXPECT_CALL(store, deliverHistogramToSinks(Property(&Stats::Metric::name, "test.loop.events"), 1))
+      .Times(AtLeast(3));
+  EXPECT_CALL(store,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "test.loop.timer_us"), _))
+      .Times(AtLeast(3));
+  dispatcher.run(Dispatcher::RunType::Block);
+  EXPECT_EQ(3U, fired);
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,123 @@
+// Usage: bazel run //test/common/event:post_benchmark
+//
+// Measures Dispatcher::post() from the main thread to worker dispatchers running on their own
+// threads, as when cluster or TLS updates are fanned out to all workers. The benchmark argument is
+// the number of workers.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+class Workers {
+public:
+  Workers(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      dispatchers_.emplace_back(new DispatcherImpl());
+      // A pending timer keeps the loop from returning while it is idle.
+      keepalive_timers_.emplace_back(dispatchers_.back()->createTimer([]() -> void {}));
+      keepalive_timers_.back()->enableTimer(std::chrono::hours(1));
+    }
+    for (auto& dispatcher : dispatchers_) {
+      DispatcherImpl* raw = dispatcher.get();
+      threads_.emplace_back(
+          new Thread::Thread([raw]() -> void { raw->run(Dispatcher::RunType::Block); }));
+    }
+  }
+
+  ~Workers() {
+    for (auto& dispatcher : dispatchers_) {
+      dispatcher->exit();
+    }
+    for (auto& thread : threads_) {
+      thread->join();
+    }
+    keepalive_timers_.clear();
+  }
+
+  std::vector<std::unique_ptr<DispatcherImpl>> dispatchers_;
+  std::vector<TimerPtr> keepalive_timers_;
+  std::vector<std::unique_ptr<Thread::Thread>> threads_;
+};
+
+// Each iteration posts one callback to every worker and waits until all of them have run. The
+// latency counter is the mean time from post() to the callback starting on the worker.
+void BM_PostLatency(benchmark::State& state) {
+  std::atomic<uint64_t> done{0};
+  std::atomic<uint64_t> latency_ns{0};
+  Workers workers(state.range(0));
+  uint64_t expected = 0;
+  for (auto _ : state) {
+    for (auto& dispatcher : workers.dispatchers_) {
+      const MonotonicTime posted = std::chrono::steady_clock::now();
+      dispatcher->post([posted, &done, &latency_ns]() -> void {
+        latency_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - posted)
+                          .count();
+        done++;
+      });
+    }
+    expected += workers.dispatchers_.size();
+    while (done < expected) {
+      std::this_thread::yield();
+    }
+  }
+  state.counters["latency_ns"] = latency_ns.load() / std::max<uint64_t>(1, expected);
+  state.SetItemsProcessed(expected);
+}
+BENCHMARK(BM_PostLatency)->Arg(1)->Arg(4)->Arg(32)->UseRealTime();
+
+// Each iteration posts a burst of 256 callbacks to every worker before waiting for them, so
+// wakeups coalesce and the cost is dominated by enqueueing and running callbacks.
+void BM_PostBurst(benchmark::State& state) {
+  const uint64_t burst = 256;
+  std::atomic<uint64_t> done{0};
+  Workers workers(state.range(0));
+  uint64_t expected = 0;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < burst; i++) {
+      for (auto& dispatcher : workers.dispatchers_) {
+        dispatcher->post([&done]() -> void { done++; });
+      }
+    }
+    expected += burst * workers.dispatchers_.size();
+    while (done < expected) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(expected);
+}
+BENCHMARK(BM_PostBurst)->Arg(1)->Arg(4)->Arg(32)->UseRealTime();
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,147 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/common/thread.h"
+#include "common/event/post_queue.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+
+TEST(PostQueueTest, Fifo) {
+  PostQueue queue;
+  std::vector<int> order;
+  for (int i = 0; i < 5; i++) {
+    queue.push([&order, i]() -> void { order.push_back(i); });
+  }
+
+  PostCb callback;
+  while (queue.pop(callback)) {
+    callback();
+  }
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), order);
+  EXPECT_FALSE(queue.pop(callback));
+}
+
+TEST(PostQueueTest, CoalescedWakeups) {
+  PostQueue queue;
+  EXPECT_TRUE(queue.push([]() -> void {}));
+  EXPECT_FALSE(queue.push([]() -> void {}));
+
+  // Once the consumer starts draining, the next push needs a new wakeup.
+  queue.beginDrain();
+  PostCb callback;
+  EXPECT_TRUE(queue.pop(callback));
+  EXPECT_TRUE(queue.push([]() -> void {}));
+  EXPECT_FALSE(queue.push([]() -> void {}));
+  EXPECT_TRUE(queue.pop(callback));
+  EXPECT_TRUE(queue.pop(callback));
+  EXPECT_TRUE(queue.pop(callback));
+  EXPECT_FALSE(queue.pop(callback));
+}
+
+TEST(PostQueueTest, PushFromCallback) {
+  PostQueue queue;
+  uint32_t ran = 0;
+  queue.push([&]() -> void {
+    ran++;
+    queue.push([&]() -> void { ran++; });
+  });
+
+  PostCb callback;
+  while (queue.pop(callback)) {
+    callback();
+  }
+  EXPECT_EQ(2U, ran);
+}
+
+// Pending callbacks, and anything they captured, are destroyed with the queue.
+TEST(PostQueueTest, DestroyPending) {
+  std::shared_ptr<int> captured = std::make_shared<int>(0);
+  {
+    PostQueue queue;
+    queue.push([captured]() -> void {});
+    EXPECT_EQ(2, captured.use_count());
+  }
+  EXPECT_EQ(1, captured.use_count());
+}
+
+// Nodes are recycled across drains, and the queue keeps working once the stub node has been
+// pushed behind the last node.
+TEST(PostQueueTest, Reuse) {
+  PostQueue queue;
+  uint64_t sum = 0;
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < round % 7; i++) {
+      queue.push([&sum, i]() -> void { sum += i; });
+    }
+    queue.beginDrain();
+    PostCb callback;
+    while (queue.pop(callback)) {
+      callback();
+    }
+  }
+
+  uint64_t expected = 0;
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < round % 7; i++) {
+      expected += i;
+    }
+  }
+  EXPECT_EQ(expected, sum);
+}
+
+// Several producers push while the consumer drains. Every callback runs exactly once and each
+// producer's callbacks run in the order they were pushed. No callback is left behind without a
+// wakeup having been requested.
+TEST(PostQueueTest, ConcurrentProducers) {
+  const uint32_t producers = 4;
+  const uint32_t per_producer = 20000;
+  PostQueue queue;
+  std::vector<uint32_t> next(producers, 0);
+  std::atomic<uint32_t> wakeups{0};
+  bool in_order = true;
+
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (uint32_t p = 0; p < producers; p++) {
+    threads.emplace_back(new Thread::Thread([&, p]() -> void {
+      for (uint32_t i = 0; i < per_producer; i++) {
+        if (queue.push([&, p, i]() -> void {
+              in_order &= (next[p] == i);
+              next[p] = i + 1;
+            })) {
+          wakeups++;
+        }
+      }
+    }));
+  }
+
+  uint32_t ran = 0;
+  uint32_t drained_wakeups = 0;
+  while (ran < producers * per_producer) {
+    // Drain only when asked to, as the dispatcher does.
+    if (wakeups.load() == drained_wakeups) {
+      std::this_thread::yield();
+      continue;
+    }
+    drained_wakeups++;
+    queue.beginDrain();
+    PostCb callback;
+    while (queue.pop(callback)) {
+      callback();
+      ran++;
+    }
+  }
+
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(producers * per_producer, ran);
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,97 @@
+// Usage: bazel run //test/common/event:timer_benchmark
+//
+// Compares libevent timers against wheel timers (--use-timer-wheel) with many pending timeouts.
+// The second benchmark argument selects the implementation: 0 for libevent, 1 for the wheel.
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Creates a dispatcher with the selected timer implementation and fills it with pending timers,
+// standing in for the idle and per-try timeouts of in-flight streams.
+class TimerLoad {
+public:
+  TimerLoad(benchmark::State& state) : rng_(0) {
+    DispatcherImpl::useTimerWheel(state.range(1) != 0);
+    dispatcher_ = std::make_unique<DispatcherImpl>();
+    DispatcherImpl::useTimerWheel(false);
+    state.SetLabel(state.range(1) != 0 ? "wheel" : "libevent");
+
+    timers_.reserve(state.range(0));
+    for (int64_t i = 0; i < state.range(0); i++) {
+      timers_.emplace_back(dispatcher_->createTimer([]() -> void {}));
+      timers_.back()->enableTimer(timeout());
+    }
+  }
+
+  // Stream timeouts are between 15 and 60 seconds, so none fire while the benchmark runs.
+  std::chrono::milliseconds timeout() { return std::chrono::milliseconds(15000 + rng_() % 45000); }
+  Timer& randomTimer() { return *timers_[rng_() % timers_.size()]; }
+
+  std::mt19937 rng_;
+  std::unique_ptr<DispatcherImpl> dispatcher_;
+  std::vector<TimerPtr> timers_;
+};
+
+// Each iteration is one request event on a random stream: the stream's timeout is re-armed, and
+// every fourth event ends a stream, disabling its timer before a new stream arms it again. The
+// event loop runs once every 64 events, as it would between batches of socket reads.
+void BM_RearmUnderLoad(benchmark::State& state) {
+  TimerLoad load(state);
+  uint64_t events = 0;
+  for (auto _ : state) {
+    Timer& timer = load.randomTimer();
+    if (++events % 4 == 0) {
+      timer.disableTimer();
+    }
+    timer.enableTimer(load.timeout());
+    if (events % 64 == 0) {
+      load.dispatcher_->run(Dispatcher::RunType::NonBlock);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RearmUnderLoad)
+    ->Args({10000, 0})
+    ->Args({10000, 1})
+    ->Args({1000000, 0})
+    ->Args({1000000, 1})
+    ->Unit(benchmark::kNanosecond);
+
+// Each iteration is a complete short stream: its timer is created, armed, re-armed once and
+// destroyed, with the pending timers of all other streams in place.
+void BM_StreamLifecycle(benchmark::State& state) {
+  TimerLoad load(state);
+  for (auto _ : state) {
+    TimerPtr timer = load.dispatcher_->createTimer([]() -> void {});
+    timer->enableTimer(load.timeout());
+    timer->enableTimer(load.timeout());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StreamLifecycle)->Ranges({{10000, 1000000}, {0, 1}});
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Event::Libevent::Global::initialize();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,287 @@
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/timer_wheel.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+
+class TestEntry : public TimerWheel::Entry {
+public:
+  TestEntry(std::function<void()> cb = nullptr) : cb_(cb) {}
+
+  uint32_t expirations_{};
+
+private:
+  // TimerWheel::Entry
+  void onExpiry() override {
+    expirations_++;
+    if (cb_) {
+      cb_();
+    }
+  }
+
+  std::function<void()> cb_;
+};
+
+TEST(TimerWheelTest, ExpiresAtTick) {
+  TimerWheel wheel(0);
+  TestEntry entry;
+  EXPECT_FALSE(wheel.nextWakeup().has_value());
+
+  wheel.schedule(entry, 10);
+  EXPECT_TRUE(entry.scheduled());
+  EXPECT_EQ(10U, entry.expiry());
+  EXPECT_EQ(1U, wheel.size());
+  EXPECT_EQ(10U, wheel.nextWakeup().value());
+
+  wheel.advance(9);
+  EXPECT_EQ(0U, entry.expirations_);
+  wheel.advance(10);
+  EXPECT_EQ(1U, entry.expirations_);
+  EXPECT_FALSE(entry.scheduled());
+  EXPECT_EQ(0U, wheel.size());
+  EXPECT_FALSE(wheel.nextWakeup().has_value());
+}
+
+TEST(TimerWheelTest, Cancel) {
+  TimerWheel wheel(0);
+  TestEntry entry;
+  wheel.schedule(entry, 5);
+  wheel.cancel(entry);
+  EXPECT_FALSE(entry.scheduled());
+  EXPECT_FALSE(wheel.nextWakeup().has_value());
+  wheel.advance(100);
+  EXPECT_EQ(0U, entry.expirations_);
+
+  // Cancelling an entry that isn't scheduled does nothing.
+  wheel.cancel(entry);
+  EXPECT_EQ(0U, wheel.size());
+}
+
+TEST(TimerWheelTest, Reschedule) {
+  TimerWheel wheel(0);
+  TestEntry entry;
+  wheel.schedule(entry, 5);
+  wheel.schedule(entry, 5000);
+  EXPECT_EQ(1U, wheel.size());
+  wheel.advance(4999);
+  EXPECT_EQ(0U, entry.expirations_);
+  wheel.advance(5000);
+  EXPECT_EQ(1U, entry.expirations_);
+}
+
+TEST(TimerWheelTest, PastExpiry) {
+  TimerWheel wheel(100);
+  TestEntry entry;
+  wheel.schedule(entry, 50);
+  EXPECT_EQ(100U, wheel.nextWakeup().value());
+  wheel.advance(100);
+  EXPECT_EQ(1U, entry.expirations_);
+}
+
+TEST(TimerWheelTest, DestroyEntry) {
+  TimerWheel wheel(0);
+  {
+    TestEntry entry;
+    wheel.schedule(entry, 5);
+  }
+  EXPECT_EQ(0U, wheel.size());
+  EXPECT_FALSE(wheel.nextWakeup().has_value());
+}
+
+TEST(TimerWheelTest, DestroyWheel) {
+  TestEntry entry;
+  {
+    TimerWheel wheel(0);
+    wheel.schedule(entry, 5);
+  }
+  EXPECT_FALSE(entry.scheduled());
+}
+
+// Entries at every level of the wheel, and past it, expire on their tick in order.
+TEST(TimerWheelTest, ExpiryOrder) {
+  const uint64_t start = 12345;
+  TimerWheel wheel(start);
+  const std::vector<uint64_t> delays{1,       63,         64,         65,         4095,
+                                     4096,    4097,       262143,     262144,     1000000,
+                                     1 << 24, 20000000,   1ULL << 30, 1ULL << 36, (1ULL << 37) + 1};
+
+  std::vector<uint64_t> expired;
+  std::vector<std::unique_ptr<TestEntry>> entries;
+  for (auto it = delays.rbegin(); it != delays.rend(); ++it) {
+    const uint64_t expiry = start + *it;
+    entries.emplace_back(new TestEntry([&wheel, &expired, expiry]() -> void {
+      EXPECT_EQ(expiry, wheel.now());
+      expired.push_back(expiry);
+    }));
+    wheel.schedule(*entries.back(), expiry);
+  }
+  EXPECT_EQ(delays.size(), wheel.size());
+
+  // Jump from wakeup to wakeup, like an owner sleeping until nextWakeup() would.
+  uint32_t wakeups = 0;
+  while (wheel.nextWakeup().has_value()) {
+    const uint64_t wakeup = wheel.nextWakeup().value();
+    EXPECT_GE(wakeup, wheel.now());
+    wheel.advance(wakeup);
+    wakeups++;
+  }
+
+  ASSERT_EQ(delays.size(), expired.size());
+  for (size_t i = 0; i < delays.size(); i++) {
+    EXPECT_EQ(start + delays[i], expired[i]);
+  }
+  // Cascading costs a bounded number of extra wakeups per entry.
+  EXPECT_LT(wakeups, delays.size() * 8);
+}
+
+TEST(TimerWheelTest, LargeAdvance) {
+  TimerWheel wheel(0);
+  TestEntry entry1;
+  TestEntry entry2;
+  TestEntry entry3;
+  wheel.schedule(entry1, 100);
+  wheel.schedule(entry2, 100000);
+  wheel.schedule(entry3, 100001);
+
+  wheel.advance(100000);
+  EXPECT_EQ(1U, entry1.expirations_);
+  EXPECT_EQ(1U, entry2.expirations_);
+  EXPECT_EQ(0U, entry3.expirations_);
+  EXPECT_EQ(100000U, wheel.now());
+  EXPECT_EQ(100001U, wheel.nextWakeup().value());
+
+  // Moving backwards is a no-op.
+  wheel.advance(5);
+  EXPECT_EQ(100000U, wheel.now());
+}
+
+TEST(TimerWheelTest, SameTickInScheduleOrder) {
+  TimerWheel wheel(0);
+  std::vector<int> order;
+  TestEntry entry1([&]() -> void { order.push_back(1); });
+  TestEntry entry2([&]() -> void { order.push_back(2); });
+  TestEntry entry3([&]() -> void { order.push_back(3); });
+  wheel.schedule(entry2, 300);
+  wheel.schedule(entry1, 300);
+  wheel.schedule(entry3, 300);
+  wheel.advance(300);
+  EXPECT_EQ((std::vector<int>{2, 1, 3}), order);
+}
+
+TEST(TimerWheelTest, ChangesFromExpiryCallback) {
+  TimerWheel wheel(0);
+  TestEntry entry3;
+  TestEntry entry4;
+  TestEntry entry2([&]() -> void {
+    // entry3 expires on the same tick but is cancelled before it runs. entry4 is moved out.
+    wheel.cancel(entry3);
+    wheel.schedule(entry4, 200);
+  });
+  std::unique_ptr<TestEntry> entry1;
+  entry1.reset(new TestEntry([&]() -> void {
+    // Entries may reschedule themselves from their own callback.
+    if (entry1->expirations_ == 1) {
+      wheel.schedule(*entry1, 20);
+    }
+  }));
+
+  wheel.schedule(*entry1, 10);
+  wheel.schedule(entry2, 10);
+  wheel.schedule(entry3, 10);
+  wheel.schedule(entry4, 10);
+  wheel.advance(10);
+  EXPECT_EQ(1U, entry1->expirations_);
+  EXPECT_EQ(1U, entry2.expirations_);
+  EXPECT_EQ(0U, entry3.expirations_);
+  EXPECT_EQ(0U, entry4.expirations_);
+  EXPECT_EQ(2U, wheel.size());
+
+  wheel.advance(200);
+  EXPECT_EQ(2U, entry1->expirations_);
+  EXPECT_EQ(1U, entry4.expirations_);
+  EXPECT_EQ(0U, wheel.size());
+}
+
+class WheelTimerImplTest : public testing::Test {
+protected:
+  WheelTimerImplTest() {
+    DispatcherImpl::useTimerWheel(true);
+    dispatcher_ = std::make_unique<DispatcherImpl>();
+    DispatcherImpl::useTimerWheel(false);
+  }
+
+  std::unique_ptr<DispatcherImpl> dispatcher_;
+};
+
+TEST_F(WheelTimerImplTest, Enabled) {
+  EXPECT_TRUE(dispatcher_->timerWheelEnabled());
+  EXPECT_FALSE(DispatcherImpl().timerWheelEnabled());
+}
+
+TEST_F(WheelTimerImplTest, Timeout) {
+  ReadyWatcher watcher;
+  TimerPtr timer = dispatcher_->createTimer([&]() -> void { watcher.ready(); });
+  const MonotonicTime start = std::chrono::steady_clock::now();
+  timer->enableTimer(std::chrono::milliseconds(20));
+
+  EXPECT_CALL(watcher, ready());
+  dispatcher_->run(Dispatcher::RunType::Block);
+  EXPECT_LE(std::chrono::milliseconds(20), std::chrono::steady_clock::now() - start);
+}
+
+TEST_F(WheelTimerImplTest, ZeroTimeout) {
+  ReadyWatcher watcher;
+  TimerPtr timer = dispatcher_->createTimer([&]() -> void { watcher.ready(); });
+  timer->enableTimer(std::chrono::milliseconds(0));
+  timer->enableTimer(std::chrono::milliseconds(0));
+
+  EXPECT_CALL(watcher, ready());
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(WheelTimerImplTest, DisableAndRearm) {
+  ReadyWatcher watcher1;
+  ReadyWatcher watcher2;
+  TimerPtr timer1 = dispatcher_->createTimer([&]() -> void { watcher1.ready(); });
+  TimerPtr timer2 = dispatcher_->createTimer([&]() -> void { watcher2.ready(); });
+
+  // timer1 is disabled before it fires, and timer2 moves from an immediate to a later timeout.
+  timer1->enableTimer(std::chrono::milliseconds(1));
+  timer1->disableTimer();
+  timer2->enableTimer(std::chrono::milliseconds(0));
+  timer2->enableTimer(std::chrono::milliseconds(5));
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  EXPECT_CALL(watcher1, ready()).Times(0);
+  EXPECT_CALL(watcher2, ready());
+  dispatcher_->run(Dispatcher::RunType::Block);
+}
+
+TEST_F(WheelTimerImplTest, RearmFromCallback) {
+  uint32_t fired = 0;
+  TimerPtr timer;
+  timer = dispatcher_->createTimer([&]() -> void {
+    if (++fired < 3) {
+      timer->enableTimer(std::chrono::milliseconds(1));
+    }
+  });
+  timer->enableTimer(std::chrono::milliseconds(1));
+  dispatcher_->run(Dispatcher::RunType::Block);
+  EXPECT_EQ(3U, fired);
+}
+
+} // namespace Event
+} // namespace Envoy
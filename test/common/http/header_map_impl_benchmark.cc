@@ -0,0 +1,260 @@
+// Usage: bazel run //test/common/http:header_map_impl_benchmark
+//
+// Measures lookups and removals of custom headers in maps of 10, 50 and 200 headers. Maps of
+// HeaderMapImpl::MinIndexedHeaders or more headers are looked up through the hash index; the *Scan
+// benchmarks walk the same maps with iterate(), which is what get() did for every map before.
+//
+// The *StaticLookup* benchmarks resolve the header names of a browser request (argument 0) and of
+// a gRPC request and response (argument 1) against the inline headers, with the perfect hash table
+// and with the character trie that it replaced.
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/header_map_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+std::vector<LowerCaseString> customKeys(uint64_t count) {
+  std::vector<LowerCaseString> keys;
+  for (uint64_t i = 0; i < count; i++) {
+    keys.emplace_back(fmt::format("x-custom-header-{}", i));
+  }
+  return keys;
+}
+
+// A request with the usual inline headers, padded with custom ones up to the requested size.
+void fillHeaders(HeaderMapImpl& headers, const std::vector<LowerCaseString>& keys) {
+  headers.insertMethod().value(std::string("GET"));
+  headers.insertPath().value(std::string("/"));
+  headers.insertHost().value(std::string("example.com"));
+  headers.insertUserAgent().value(std::string("benchmark"));
+  for (const LowerCaseString& key : keys) {
+    headers.addCopy(key, "value");
+  }
+}
+
+const HeaderEntry* scan(const HeaderMap& headers, const LowerCaseString& key) {
+  struct State {
+    const LowerCaseString& key_;
+    const HeaderEntry* entry_;
+  } state{key, nullptr};
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        State* state = static_cast<State*>(context);
+        if (header.key() == state->key_.get().c_str()) {
+          state->entry_ = &header;
+          return HeaderMap::Iterate::Break;
+        }
+        return HeaderMap::Iterate::Continue;
+      },
+      &state);
+  return state.entry_;
+}
+
+// Looks up every custom header of the map, and one that is not there, per iteration.
+void BM_HeaderMapGet(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys = customKeys(state.range(0) - 4);
+  const LowerCaseString missing("x-missing");
+  HeaderMapImpl headers;
+  fillHeaders(headers, keys);
+
+  for (auto _ : state) {
+    for (const LowerCaseString& key : keys) {
+      benchmark::DoNotOptimize(headers.get(key));
+    }
+    benchmark::DoNotOptimize(headers.get(missing));
+  }
+  state.SetItemsProcessed(state.iterations() * (keys.size() + 1));
+}
+BENCHMARK(BM_HeaderMapGet)->Arg(10)->Arg(50)->Arg(200);
+
+void BM_HeaderMapGetScan(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys = customKeys(state.range(0) - 4);
+  const LowerCaseString missing("x-missing");
+  HeaderMapImpl headers;
+  fillHeaders(headers, keys);
+
+  for (auto _ : state) {
+    for (const LowerCaseString& key : keys) {
+      benchmark::DoNotOptimize(scan(headers, key));
+    }
+    benchmark::DoNotOptimize(scan(headers, missing));
+  }
+  state.SetItemsProcessed(state.iterations() * (keys.size() + 1));
+}
+BENCHMARK(BM_HeaderMapGetScan)->Arg(10)->Arg(50)->Arg(200);
+
+// Builds a map, looks up a few headers as a filter would, and removes one. This includes the cost
+// of building the index for the larger maps.
+void BM_HeaderMapFillGetRemove(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys = customKeys(state.range(0) - 4);
+  const LowerCaseString missing("x-missing");
+
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    fillHeaders(headers, keys);
+    benchmark::DoNotOptimize(headers.get(keys.front()));
+    benchmark::DoNotOptimize(headers.get(keys.back()));
+    benchmark::DoNotOptimize(headers.get(missing));
+    headers.remove(keys[keys.size() / 2]);
+    headers.remove(missing);
+  }
+}
+BENCHMARK(BM_HeaderMapFillGetRemove)->Arg(10)->Arg(50)->Arg(200);
+
+const std::vector<std::string>& headerNames(int64_t set) {
+  static const std::vector<std::string> browser{
+      ":method",
+      ":authority",
+      ":scheme",
+      ":path",
+      "cache-control",
+      "upgrade-insecure-requests",
+      "user-agent",
+      "accept",
+      "sec-fetch-site",
+      "sec-fetch-mode",
+      "sec-fetch-user",
+      "sec-fetch-dest",
+      "referer",
+      "accept-encoding",
+      "accept-language",
+      "cookie",
+  };
+  static const std::vector<std::string> grpc{
+      ":method",
+      ":scheme",
+      ":path",
+      ":authority",
+      "content-type",
+      "te",
+      "grpc-accept-encoding",
+      "user-agent",
+      "grpc-timeout",
+      "x-request-id",
+      "x-b3-traceid",
+      "x-b3-spanid",
+      "x-b3-sampled",
+      ":status",
+      "content-type",
+      "grpc-status",
+      "grpc-message",
+  };
+  return set == 0 ? browser : grpc;
+}
+
+class StaticLookupTablePeer : public HeaderMapImpl {
+public:
+  using HeaderMapImpl::StaticLookupTable;
+};
+
+// The character trie that the static lookup table used to be.
+class Trie {
+public:
+  Trie() {
+#define TRIE_ADD_INLINE_HEADER(name) add(Headers::get().name.get().c_str());
+    ALL_INLINE_HEADERS(TRIE_ADD_INLINE_HEADER)
+    add(Headers::get().HostLegacy.get().c_str());
+  }
+
+  bool find(const char* key) const {
+    const Node* current = &root_;
+    while (uint8_t c = *key) {
+      current = current->children_[c].get();
+      if (current == nullptr) {
+        return false;
+      }
+      key++;
+    }
+    return current->terminal_;
+  }
+
+private:
+  struct Node {
+    bool terminal_{};
+    std::array<std::unique_ptr<Node>, 256> children_;
+  };
+
+  void add(const char* key) {
+    Node* current = &root_;
+    while (uint8_t c = *key) {
+      if (!current->children_[c]) {
+        current->children_[c].reset(new Node());
+      }
+      current = current->children_[c].get();
+      key++;
+    }
+    current->terminal_ = true;
+  }
+
+  Node root_;
+};
+
+void BM_StaticLookupPerfectHash(benchmark::State& state) {
+  const std::vector<std::string>& names = headerNames(state.range(0));
+  const StaticLookupTablePeer::StaticLookupTable table;
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      benchmark::DoNotOptimize(table.find(name));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_StaticLookupPerfectHash)->Arg(0)->Arg(1);
+
+void BM_StaticLookupTrie(benchmark::State& state) {
+  const std::vector<std::string>& names = headerNames(state.range(0));
+  const Trie trie;
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      benchmark::DoNotOptimize(trie.find(name.c_str()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_StaticLookupTrie)->Arg(0)->Arg(1);
+
+// Adds the headers to a map the way the codecs do, with copied keys and values moved in.
+void BM_HeaderMapIngest(benchmark::State& state) {
+  const std::vector<std::string>& names = headerNames(state.range(0));
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    for (const std::string& name : names) {
+      HeaderString key;
+      key.setCopy(name.c_str(), name.size());
+      HeaderString value;
+      value.setCopy("value", 5);
+      headers.addViaMove(std::move(key), std::move(value));
+    }
+    benchmark::DoNotOptimize(headers.size());
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_HeaderMapIngest)->Arg(0)->Arg(1);
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
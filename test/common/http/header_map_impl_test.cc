@@ -1,5 +1,8 @@
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "common/common/fmt.h"
 #include "common/http/header_map_impl.h"
 
 #include "test/test_common/printers.h"
@@ -102,13 +105,36 @@ TEST(HeaderStringTest, All) {
     EXPECT_STREQ("HELLO", string.c_str());
   }
 
-  // Static to append.
+  // Static to append copies the referenced string.
   {
     std::string static_string("HELLO");
     HeaderString string(static_string);
     EXPECT_EQ(HeaderString::Type::Reference, string.type());
     string.append("a", 1);
-    EXPECT_STREQ("a", string.c_str());
+    EXPECT_EQ(HeaderString::Type::Inline, string.type());
+    EXPECT_STREQ("HELLOa", string.c_str());
+    EXPECT_EQ("HELLO", static_string);
+  }
+
+  // Static to append past the inline buffer.
+  {
+    std::string static_string(100, 'a');
+    HeaderString string(static_string);
+    const std::string suffix(100, 'b');
+    string.append(suffix.c_str(), suffix.size());
+    EXPECT_EQ(HeaderString::Type::Dynamic, string.type());
+    EXPECT_EQ(static_string + suffix, string.c_str());
+  }
+
+  // Reference to a null terminated span of a larger buffer.
+  {
+    char buffer[] = "name: value\r\n";
+    buffer[4] = 0;
+    HeaderString string;
+    string.setReference(buffer, 4);
+    EXPECT_EQ(HeaderString::Type::Reference, string.type());
+    EXPECT_EQ(buffer, string.c_str());
+    EXPECT_EQ("name", string.getStringView());
   }
 
   // Copy inline
@@ -386,6 +412,59 @@ TEST(HeaderMapImplTest, RemoveRegex) {
   EXPECT_EQ(nullptr, headers.ContentLength());
 }
 
+TEST(HeaderMapImplTest, Retain) {
+  auto storage = std::make_shared<std::string>("value");
+  std::weak_ptr<std::string> weak_storage = storage;
+  {
+    HeaderMapImpl headers;
+    headers.retain(storage);
+    HeaderString key;
+    key.setCopy("key", 3);
+    HeaderString value;
+    value.setReference(storage->c_str(), storage->size());
+    headers.addViaMove(std::move(key), std::move(value));
+    storage.reset();
+    EXPECT_FALSE(weak_storage.expired());
+    EXPECT_EQ(HeaderString::Type::Reference, headers.get(LowerCaseString("key"))->value().type());
+    EXPECT_STREQ("value", headers.get(LowerCaseString("key"))->value().c_str());
+  }
+  EXPECT_TRUE(weak_storage.expired());
+}
+
+// Only references into the given range are copied, after which the storage can be released.
+TEST(HeaderMapImplTest, MoveReferences) {
+  auto storage = std::make_shared<std::string>("key\0value", 9);
+  std::weak_ptr<std::string> weak_storage = storage;
+  const std::string other("other");
+  HeaderMapImpl headers;
+  headers.retain(storage);
+  HeaderString key;
+  key.setReference(storage->c_str(), 3);
+  HeaderString value;
+  value.setReference(storage->c_str() + 4, 5);
+  headers.addViaMove(std::move(key), std::move(value));
+  headers.addReference(LowerCaseString("static"), other);
+
+  auto copy = std::make_shared<std::string>(*storage);
+  headers.moveReferences(storage->c_str(), storage->c_str() + storage->size(), copy->c_str());
+  storage.reset();
+  headers.releaseRetained();
+  EXPECT_TRUE(weak_storage.expired());
+  headers.retain(copy);
+
+  const HeaderEntry* entry = headers.get(LowerCaseString("key"));
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(HeaderString::Type::Reference, entry->key().type());
+  EXPECT_EQ(copy->c_str(), entry->key().c_str());
+  EXPECT_EQ(HeaderString::Type::Reference, entry->value().type());
+  EXPECT_EQ(copy->c_str() + 4, entry->value().c_str());
+  EXPECT_STREQ("value", entry->value().c_str());
+  EXPECT_EQ(HeaderString::Type::Reference,
+            headers.get(LowerCaseString("static"))->value().type());
+}
+
+// Strings passed to addViaMove() are left empty, references included, even when the map drops
+// them.
 TEST(HeaderMapImplTest, SetRemovesAllValues) {
   HeaderMapImpl headers;
 
@@ -640,5 +719,96 @@ TEST(HeaderMapImplTest, Get) {
   }
 }
 
+class StaticLookupTablePeer : public HeaderMapImpl {
+public:
+  using HeaderMapImpl::StaticLookupTable;
+};
+
+#define EXPECT_INLINE_HEADER_FOUND(name)                                                           \
+  {                                                                                                \
+    HeaderMapImpl headers;                                                                         \
+    auto cb = table.find(Headers::get().name.get());                                               \
+    ASSERT_NE(nullptr, cb) << Headers::get().name.get();                                           \
+    headers.insert##name();                                                                        \
+    EXPECT_NE(nullptr, *cb(headers).entry_);                                                       \
+    EXPECT_EQ(&Headers::get().name, cb(headers).key_);                                             \
+  }
+
+// Every inline header is found with a single probe, and nothing else is.
+TEST(HeaderMapImplTest, StaticLookupTable) {
+  const StaticLookupTablePeer::StaticLookupTable table;
+  ALL_INLINE_HEADERS(EXPECT_INLINE_HEADER_FOUND)
+
+  HeaderMapImpl headers;
+  headers.insertHost();
+  auto cb = table.find("host");
+  ASSERT_NE(nullptr, cb);
+  EXPECT_EQ(&Headers::get().Host, cb(headers).key_);
+
+  for (const char* key : {"", ":", "x-envoy-", "content-lengt", "content-length2", "Content-Length",
+                          "cookie", "set-cookie", "x-custom-header"}) {
+    EXPECT_EQ(nullptr, table.find(key)) << key;
+  }
+  EXPECT_EQ(nullptr, table.find(absl::string_view("content-length\0", 15)));
+}
+
+// Maps past MinIndexedHeaders find custom headers through the hash index, which has to follow
+// every way of adding and removing headers.
+TEST(HeaderMapImplTest, IndexedLookup) {
+  std::vector<LowerCaseString> keys;
+  for (size_t i = 0; i < 4 * HeaderMapImpl::MinIndexedHeaders; i++) {
+    keys.emplace_back(fmt::format("x-custom-{}", i));
+  }
+
+  const LowerCaseString late_key("x-late");
+  const std::string late_value("late");
+
+  TestHeaderMapImpl headers;
+  headers.insertContentLength().value(5);
+  for (size_t i = 0; i < keys.size(); i++) {
+    headers.addCopy(keys[i], i);
+  }
+  // The index is built by the first lookup, and grows as headers are added.
+  EXPECT_STREQ("0", headers.get(keys[0])->value().c_str());
+  headers.addCopy(LowerCaseString("x-custom-0"), "again");
+  headers.addReference(late_key, late_value);
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(std::to_string(i), headers.get_(keys[i]));
+  }
+  EXPECT_EQ("late", headers.get_("x-late"));
+  EXPECT_EQ("5", headers.get_("content-length"));
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("x-missing")));
+
+  // All values of a key are removed, however the key was added.
+  headers.remove(keys[0]);
+  EXPECT_EQ(nullptr, headers.get(keys[0]));
+  headers.remove(LowerCaseString("x-missing"));
+  headers.removeContentLength();
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("content-length")));
+  headers.insertContentLength().value(6);
+  EXPECT_EQ("6", headers.get_("content-length"));
+  headers.setReferenceKey(keys[1], "set");
+  EXPECT_EQ("set", headers.get_(keys[1]));
+
+  // Removing keys shifts the ones that collided with them back in the table.
+  for (size_t i = 2; i < keys.size(); i += 2) {
+    headers.remove(keys[i]);
+  }
+  for (size_t i = 2; i < keys.size(); i++) {
+    EXPECT_EQ(i % 2 == 0, headers.get(keys[i]) == nullptr) << keys[i].get();
+  }
+
+  headers.removePrefix(LowerCaseString("x-custom-"));
+  for (const LowerCaseString& key : keys) {
+    EXPECT_EQ(nullptr, headers.get(key));
+  }
+  EXPECT_EQ("late", headers.get_("x-late"));
+  EXPECT_EQ(2UL, headers.size());
+
+  // The index is kept once the map shrinks.
+  headers.addCopy(keys[3], "again");
+  EXPECT_EQ("again", headers.get_(keys[3]));
+}
+
 } // namespace Http
 } // namespace Envoy
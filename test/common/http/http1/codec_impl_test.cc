@@ -27,8 +27,11 @@ namespace Envoy {
 namespace Http {
 namespace Http1 {
 
-class Http1ServerConnectionImplTest : public ::testing::Test {
+// Run each test against both http_parser and the scanning parser.
+class Http1ServerConnectionImplTest : public testing::TestWithParam<bool> {
 public:
+  Http1ServerConnectionImplTest() { codec_settings_.scanning_parser_ = GetParam(); }
+
   void initialize() {
     codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_));
   }
@@ -83,7 +86,9 @@ void Http1ServerConnectionImplTest::expectHeadersTest(Protocol p, bool allow_abs
   EXPECT_EQ(p, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
+INSTANTIATE_TEST_CASE_P(Parsers, Http1ServerConnectionImplTest, testing::Bool());
+
+TEST_P(Http1ServerConnectionImplTest, EmptyHeader) {
   initialize();
 
   InSequence sequence;
@@ -104,7 +109,7 @@ TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10) {
+TEST_P(Http1ServerConnectionImplTest, Http10) {
   initialize();
 
   InSequence sequence;
@@ -121,7 +126,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10) {
   EXPECT_EQ(Protocol::Http10, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{{":path", "/"}, {":method", "GET"}};
@@ -129,7 +134,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
+TEST_P(Http1ServerConnectionImplTest, Http10Absolute) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -138,7 +143,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -147,7 +152,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -156,7 +161,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   TestHeaderMapImpl expected_headers{
       {":authority", "www.somewhere.com:4532"}, {":path", "/foo/bar"}, {":method", "GET"}};
   Buffer::OwnedImpl buffer(
@@ -164,7 +169,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -173,7 +178,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
+TEST_P(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   initialize();
 
   // Invalid because www.somewhere.com is not an absolute path nor an absolute url
@@ -181,7 +186,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -190,21 +195,21 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET * HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET http://foobar.com:1000000 HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
+TEST_P(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -213,7 +218,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   expectHeadersTest(Protocol::Http11, false, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11Options) {
+TEST_P(Http1ServerConnectionImplTest, Http11Options) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -222,7 +227,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11Options) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
+TEST_P(Http1ServerConnectionImplTest, SimpleGet) {
   initialize();
 
   InSequence sequence;
@@ -238,7 +243,166 @@ TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
+// The scanning parser lets headers reference the read buffer, whose slices then live as long as
+// the header map. Lines split across reads and folded values are copied. The large header makes
+// the head big enough for its slice to be worth pinning.
+TEST_P(Http1ServerConnectionImplTest, HeadersReferenceReadBuffer) {
+  initialize();
+
+  Http::MockStreamDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_)).WillOnce(ReturnRef(decoder));
+  HeaderMapPtr headers;
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](HeaderMapPtr& decoded_headers, bool) {
+        headers = std::move(decoded_headers);
+      }));
+
+  {
+    Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\nX-Custom: Value\r\nX-Large: " +
+                             std::string(1024, 'a') + "\r\nFolded: a\r\n b\r\nX-Sp");
+    codec_->dispatch(buffer);
+    EXPECT_EQ(0U, buffer.length());
+  }
+  {
+    Buffer::OwnedImpl buffer("lit: split\r\n\r\n");
+    codec_->dispatch(buffer);
+    EXPECT_EQ(0U, buffer.length());
+  }
+
+  const HeaderString::Type referenced =
+      GetParam() ? HeaderString::Type::Reference : HeaderString::Type::Inline;
+  const HeaderEntry* large = headers->get(LowerCaseString("x-large"));
+  ASSERT_NE(nullptr, large);
+  EXPECT_EQ(std::string(1024, 'a'), large->value().c_str());
+  EXPECT_EQ(GetParam() ? HeaderString::Type::Reference : HeaderString::Type::Dynamic,
+            large->value().type());
+
+  const HeaderEntry* custom = headers->get(LowerCaseString("x-custom"));
+  ASSERT_NE(nullptr, custom);
+  EXPECT_STREQ("x-custom", custom->key().c_str());
+  EXPECT_EQ(referenced, custom->key().type());
+  EXPECT_STREQ("Value", custom->value().c_str());
+  EXPECT_EQ(referenced, custom->value().type());
+
+  const HeaderEntry* folded = headers->get(LowerCaseString("folded"));
+  ASSERT_NE(nullptr, folded);
+  EXPECT_STREQ("a b", folded->value().c_str());
+  EXPECT_EQ(HeaderString::Type::Inline, folded->value().type());
+
+  const HeaderEntry* split = headers->get(LowerCaseString("x-split"));
+  ASSERT_NE(nullptr, split);
+  EXPECT_STREQ("split", split->value().c_str());
+  EXPECT_EQ(HeaderString::Type::Inline, split->value().type());
+
+  // Changing a referenced value copies it.
+  headers->get(LowerCaseString("x-custom"))->value(std::string("changed"));
+  EXPECT_STREQ("changed", headers->get(LowerCaseString("x-custom"))->value().c_str());
+}
+
+// A typical head read into a 16KB slice, as the raw buffer socket does, would pin the whole slice
+// for the life of the request. Its headers stay referenced, but in an exact size copy of the head
+// rather than in the read buffer.
+TEST_P(Http1ServerConnectionImplTest, SmallHeadsReferencedInCompactCopy) {
+  initialize();
+
+  Http::MockStreamDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_)).WillOnce(ReturnRef(decoder));
+  HeaderMapPtr headers;
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](HeaderMapPtr& decoded_headers, bool) {
+        headers = std::move(decoded_headers);
+      }));
+
+  const std::string request =
+      "GET /index.html?query=value HTTP/1.1\r\n"
+      "Host: www.example.com\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101 Firefox/60.0\r\n"
+      "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+      "Accept-Language: en-US,en;q=0.5\r\n"
+      "Accept-Encoding: gzip, deflate, br\r\n"
+      "Referer: https://www.example.com/\r\n"
+      "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+      "Connection: keep-alive\r\n"
+      "Upgrade-Insecure-Requests: 1\r\n"
+      "Cache-Control: max-age=0\r\n\r\n";
+  ASSERT_LT(400U, request.size());
+  ASSERT_GT(600U, request.size());
+  const char* slice_begin;
+  const char* slice_end;
+  {
+    Buffer::OwnedImpl buffer;
+    Buffer::RawSlice iovec;
+    buffer.reserve(16384, &iovec, 1);
+    ASSERT_LE(16384U, iovec.len_);
+    memcpy(iovec.mem_, request.data(), request.size());
+    iovec.len_ = request.size();
+    buffer.commit(&iovec, 1);
+    slice_begin = static_cast<const char*>(iovec.mem_);
+    slice_end = slice_begin + 16384;
+    codec_->dispatch(buffer);
+    EXPECT_EQ(0U, buffer.length());
+  }
+
+  const HeaderString::Type referenced =
+      GetParam() ? HeaderString::Type::Reference : HeaderString::Type::Inline;
+  const HeaderEntry* language = headers->get(LowerCaseString("accept-language"));
+  ASSERT_NE(nullptr, language);
+  EXPECT_STREQ("accept-language", language->key().c_str());
+  EXPECT_EQ(referenced, language->key().type());
+  EXPECT_STREQ("en-US,en;q=0.5", language->value().c_str());
+  EXPECT_EQ(referenced, language->value().type());
+
+  const HeaderEntry* cookie = headers->get(LowerCaseString("cookie"));
+  ASSERT_NE(nullptr, cookie);
+  EXPECT_STREQ("session=0123456789abcdef0123456789abcdef; theme=dark", cookie->value().c_str());
+  EXPECT_EQ(referenced, cookie->value().type());
+
+  // No header points into the read slice, so it was released with the buffer.
+  std::pair<const char*, const char*> slice(slice_begin, slice_end);
+  headers->iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        const auto* slice = static_cast<std::pair<const char*, const char*>*>(context);
+        for (const HeaderString* string : {&header.key(), &header.value()}) {
+          EXPECT_FALSE(string->c_str() >= slice->first && string->c_str() < slice->second);
+        }
+        return HeaderMap::Iterate::Continue;
+      },
+      &slice);
+}
+
+// Memory the read buffer does not own alone, such as a buffer fragment, is neither modified nor
+// referenced.
+TEST_P(Http1ServerConnectionImplTest, HeadersNotReferencedInFragments) {
+  initialize();
+
+  Http::MockStreamDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_)).WillOnce(ReturnRef(decoder));
+  HeaderMapPtr headers;
+  EXPECT_CALL(decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](HeaderMapPtr& decoded_headers, bool) {
+        headers = std::move(decoded_headers);
+      }));
+
+  const std::string request =
+      "GET / HTTP/1.1\r\nX-Large: " + std::string(1024, 'a') + "\r\nX-Custom: Value\r\n\r\n";
+  std::string fragment_data = request;
+  Buffer::BufferFragmentImpl fragment(fragment_data.data(), fragment_data.size(), nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(fragment);
+  codec_->dispatch(buffer);
+  EXPECT_EQ(0U, buffer.length());
+  EXPECT_EQ(request, fragment_data);
+
+  const HeaderEntry* custom = headers->get(LowerCaseString("x-custom"));
+  ASSERT_NE(nullptr, custom);
+  EXPECT_STREQ("Value", custom->value().c_str());
+  EXPECT_EQ(HeaderString::Type::Inline, custom->value().type());
+  const HeaderEntry* large = headers->get(LowerCaseString("x-large"));
+  ASSERT_NE(nullptr, large);
+  EXPECT_EQ(HeaderString::Type::Dynamic, large->value().type());
+}
+
+TEST_P(Http1ServerConnectionImplTest, BadRequestNoStream) {
   initialize();
 
   std::string output;
@@ -249,7 +413,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
+TEST_P(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   initialize();
 
   std::string output;
@@ -266,7 +430,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
+TEST_P(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   initialize();
 
   InSequence sequence;
@@ -282,7 +446,7 @@ TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
+TEST_P(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   initialize();
 
   InSequence sequence;
@@ -302,7 +466,7 @@ TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   EXPECT_NE(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
+TEST_P(Http1ServerConnectionImplTest, PostWithContentLength) {
   initialize();
 
   InSequence sequence;
@@ -324,7 +488,7 @@ TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -347,7 +511,7 @@ TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
+TEST_P(Http1ServerConnectionImplTest, ChunkedResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -374,7 +538,7 @@ TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
             output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
+TEST_P(Http1ServerConnectionImplTest, ContentLengthResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -400,7 +564,7 @@ TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 11\r\n\r\nHello World", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeadRequestResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -423,7 +587,7 @@ TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
+TEST_P(Http1ServerConnectionImplTest, DoubleRequest) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -448,7 +612,7 @@ TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
+TEST_P(Http1ServerConnectionImplTest, RequestWithTrailers) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -465,7 +629,7 @@ TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, WatermarkTest) {
+TEST_P(Http1ServerConnectionImplTest, WatermarkTest) {
   EXPECT_CALL(connection_, bufferLimit()).Times(1).WillOnce(Return(10));
   initialize();
 
@@ -499,16 +663,22 @@ TEST_F(Http1ServerConnectionImplTest, WatermarkTest) {
       ->onUnderlyingConnectionBelowWriteBufferLowWatermark();
 }
 
-class Http1ClientConnectionImplTest : public testing::Test {
+class Http1ClientConnectionImplTest : public testing::TestWithParam<bool> {
 public:
-  void initialize() { codec_.reset(new ClientConnectionImpl(connection_, callbacks_)); }
+  void initialize() {
+    Http1Settings settings;
+    settings.scanning_parser_ = GetParam();
+    codec_.reset(new ClientConnectionImpl(connection_, callbacks_, settings));
+  }
 
   NiceMock<Network::MockConnection> connection_;
   NiceMock<Http::MockConnectionCallbacks> callbacks_;
   std::unique_ptr<ClientConnectionImpl> codec_;
 };
 
-TEST_F(Http1ClientConnectionImplTest, SimpleGet) {
+INSTANTIATE_TEST_CASE_P(Parsers, Http1ClientConnectionImplTest, testing::Bool());
+
+TEST_P(Http1ClientConnectionImplTest, SimpleGet) {
   initialize();
 
   Http::MockStreamDecoder response_decoder;
@@ -522,7 +692,7 @@ TEST_F(Http1ClientConnectionImplTest, SimpleGet) {
   EXPECT_EQ("GET / HTTP/1.1\r\ncontent-length: 0\r\n\r\n", output);
 }
 
-TEST_F(Http1ClientConnectionImplTest, HostHeaderTranslate) {
+TEST_P(Http1ClientConnectionImplTest, HostHeaderTranslate) {
   initialize();
 
   Http::MockStreamDecoder response_decoder;
@@ -536,7 +706,7 @@ TEST_F(Http1ClientConnectionImplTest, HostHeaderTranslate) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n", output);
 }
 
-TEST_F(Http1ClientConnectionImplTest, Reset) {
+TEST_P(Http1ClientConnectionImplTest, Reset) {
   initialize();
 
   Http::MockStreamDecoder response_decoder;
@@ -548,7 +718,7 @@ TEST_F(Http1ClientConnectionImplTest, Reset) {
   request_encoder.getStream().resetStream(StreamResetReason::LocalReset);
 }
 
-TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
+TEST_P(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   initialize();
 
   Http::MockStreamDecoder response_decoder;
@@ -579,14 +749,14 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ntransfer-encoding: chunked\r\n\r\n0\r\n\r\n", output);
 }
 
-TEST_F(Http1ClientConnectionImplTest, PrematureResponse) {
+TEST_P(Http1ClientConnectionImplTest, PrematureResponse) {
   initialize();
 
   Buffer::OwnedImpl response("HTTP/1.1 408 Request Timeout\r\nConnection: Close\r\n\r\n");
   EXPECT_THROW(codec_->dispatch(response), PrematureResponseException);
 }
 
-TEST_F(Http1ClientConnectionImplTest, HeadRequest) {
+TEST_P(Http1ClientConnectionImplTest, HeadRequest) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -599,7 +769,7 @@ TEST_F(Http1ClientConnectionImplTest, HeadRequest) {
   codec_->dispatch(response);
 }
 
-TEST_F(Http1ClientConnectionImplTest, 204Response) {
+TEST_P(Http1ClientConnectionImplTest, 204Response) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -612,7 +782,7 @@ TEST_F(Http1ClientConnectionImplTest, 204Response) {
   codec_->dispatch(response);
 }
 
-TEST_F(Http1ClientConnectionImplTest, 100Response) {
+TEST_P(Http1ClientConnectionImplTest, 100Response) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -631,7 +801,7 @@ TEST_F(Http1ClientConnectionImplTest, 100Response) {
   codec_->dispatch(response);
 }
 
-TEST_F(Http1ClientConnectionImplTest, BadEncodeParams) {
+TEST_P(Http1ClientConnectionImplTest, BadEncodeParams) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -644,7 +814,7 @@ TEST_F(Http1ClientConnectionImplTest, BadEncodeParams) {
                CodecClientException);
 }
 
-TEST_F(Http1ClientConnectionImplTest, NoContentLengthResponse) {
+TEST_P(Http1ClientConnectionImplTest, NoContentLengthResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -665,7 +835,7 @@ TEST_F(Http1ClientConnectionImplTest, NoContentLengthResponse) {
   codec_->dispatch(empty);
 }
 
-TEST_F(Http1ClientConnectionImplTest, ResponseWithTrailers) {
+TEST_P(Http1ClientConnectionImplTest, ResponseWithTrailers) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -679,7 +849,7 @@ TEST_F(Http1ClientConnectionImplTest, ResponseWithTrailers) {
   EXPECT_EQ(0UL, response.length());
 }
 
-TEST_F(Http1ClientConnectionImplTest, GiantPath) {
+TEST_P(Http1ClientConnectionImplTest, GiantPath) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> response_decoder;
@@ -693,7 +863,7 @@ TEST_F(Http1ClientConnectionImplTest, GiantPath) {
   codec_->dispatch(response);
 }
 
-TEST_F(Http1ClientConnectionImplTest, WatermarkTest) {
+TEST_P(Http1ClientConnectionImplTest, WatermarkTest) {
   EXPECT_CALL(connection_, bufferLimit()).Times(1).WillOnce(Return(10));
   initialize();
 
@@ -723,7 +893,7 @@ TEST_F(Http1ClientConnectionImplTest, WatermarkTest) {
 }
 
 // For issue #1421 regression test that Envoy's HTTP parser applies header limits early.
-TEST_F(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
+TEST_P(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
   initialize();
 
   std::string exception_reason;
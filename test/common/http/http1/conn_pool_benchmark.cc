@@ -0,0 +1,158 @@
+// Usage: bazel run //test/common/http/http1:conn_pool_benchmark
+//
+// Measures the bookkeeping of a connection pool under request churn: each iteration sends a burst
+// of as many requests as the argument to a pool that has that many idle connections, and completes
+// their responses. The connections and codecs are mocks, so the rate includes their cost; compare
+// it with the 100k requests per second a worker has to sustain.
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/codec_client.h"
+#include "common/http/http1/conn_pool.h"
+#include "common/upstream/resource_manager_impl.h"
+
+#include "test/common/http/common.h"
+#include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// A pool whose clients have mock codecs that hand each response decoder to the benchmark.
+class BenchmarkConnPool : public ConnPoolImpl {
+public:
+  BenchmarkConnPool(Event::MockDispatcher& dispatcher, Upstream::ClusterInfoConstSharedPtr cluster)
+      : ConnPoolImpl(dispatcher, Upstream::makeTestHost(cluster, "tcp://127.0.0.1:9000"),
+                     Upstream::ResourcePriority::Default, nullptr),
+        dispatcher_(dispatcher) {}
+
+  CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override {
+    connections_.push_back(
+        dynamic_cast<Network::MockClientConnection*>(data.connection_.get()));
+    NiceMock<Http::MockClientConnection>* codec = new NiceMock<Http::MockClientConnection>();
+    ON_CALL(*codec, newStream(_))
+        .WillByDefault(Invoke([this](StreamDecoder& decoder) -> StreamEncoder& {
+          response_decoders_.push_back(&decoder);
+          return request_encoder_;
+        }));
+    return CodecClientPtr{new CodecClientForTest(std::move(data.connection_), codec, nullptr,
+                                                 data.host_description_, dispatcher_)};
+  }
+
+  Event::MockDispatcher& dispatcher_;
+  std::vector<Network::MockClientConnection*> connections_;
+  std::vector<StreamDecoder*> response_decoders_;
+  NiceMock<MockStreamEncoder> request_encoder_;
+};
+
+class Callbacks : public ConnectionPool::Callbacks {
+public:
+  // Http::ConnectionPool::Callbacks
+  void onPoolReady(StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr) override {
+    encoder.encodeHeaders(request_headers_, true);
+  }
+  void onPoolFailure(ConnectionPool::PoolFailureReason,
+                     Upstream::HostDescriptionConstSharedPtr) override {}
+
+  TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/"}, {":authority", "example.com"}};
+};
+
+static void BM_RequestChurn(benchmark::State& state) {
+  const uint32_t burst = state.range(0);
+  NiceMock<Runtime::MockLoader> runtime;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster{new NiceMock<Upstream::MockClusterInfo>()};
+  cluster->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime, "fake_key", burst, 1024, 1024, 1));
+  // Have the pool track idle time, as it does in production.
+  ON_CALL(*cluster, idleTimeout()).WillByDefault(Return(std::chrono::milliseconds(60000)));
+
+  NiceMock<Event::MockDispatcher> dispatcher;
+  ON_CALL(dispatcher, createTimer_(_))
+      .WillByDefault(Invoke([](Event::TimerCb) -> Event::Timer* {
+        return new NiceMock<Event::MockTimer>();
+      }));
+  ON_CALL(dispatcher, createClientConnection_(_, _, _, _))
+      .WillByDefault(Invoke([](Network::Address::InstanceConstSharedPtr,
+                               Network::Address::InstanceConstSharedPtr,
+                               Network::TransportSocketPtr&,
+                               const Network::ConnectionSocket::OptionsSharedPtr&)
+                                -> Network::ClientConnection* {
+        return new NiceMock<Network::MockClientConnection>();
+      }));
+  ON_CALL(dispatcher, clearDeferredDeleteList()).WillByDefault(Invoke([&dispatcher]() -> void {
+    dispatcher.to_delete_.clear();
+  }));
+
+  BenchmarkConnPool pool(dispatcher, cluster);
+  NiceMock<MockStreamDecoder> decoder;
+  Callbacks callbacks;
+  const auto complete_responses = [&]() -> void {
+    for (StreamDecoder* response_decoder : pool.response_decoders_) {
+      response_decoder->decodeHeaders(HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}}},
+                                      true);
+    }
+    pool.response_decoders_.clear();
+    dispatcher.clearDeferredDeleteList();
+    for (Network::MockClientConnection* connection : pool.connections_) {
+      connection->dispatcher_.to_delete_.clear();
+    }
+  };
+
+  // Open the connections with a first burst.
+  for (uint32_t i = 0; i < burst; i++) {
+    pool.newStream(decoder, callbacks);
+  }
+  for (Network::MockClientConnection* connection : pool.connections_) {
+    connection->raiseEvent(Network::ConnectionEvent::Connected);
+  }
+  complete_responses();
+  if (pool.connections_.size() != burst) {
+    state.SkipWithError("the first burst did not open a connection per request");
+  }
+
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < burst; i++) {
+      pool.newStream(decoder, callbacks);
+    }
+    complete_responses();
+  }
+
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_RequestChurn)->Arg(1)->Arg(10)->Arg(100);
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
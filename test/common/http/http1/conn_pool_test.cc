@@ -11,6 +11,7 @@
 #include "test/common/http/common.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -28,6 +29,7 @@ using testing::Invoke;
 using testing::NiceMock;
 using testing::Property;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::ReturnRef;
 using testing::SaveArg;
 using testing::_;
@@ -43,9 +45,10 @@ class ConnPoolImplForTest : public ConnPoolImpl {
 public:
   ConnPoolImplForTest(Event::MockDispatcher& dispatcher,
                       Upstream::ClusterInfoConstSharedPtr cluster,
-                      NiceMock<Event::MockTimer>* upstream_ready_timer)
+                      NiceMock<Event::MockTimer>* upstream_ready_timer,
+                      MonotonicTimeSource& time_source)
       : ConnPoolImpl(dispatcher, Upstream::makeTestHost(cluster, "tcp://127.0.0.1:9000"),
-                     Upstream::ResourcePriority::Default, nullptr),
+                     Upstream::ResourcePriority::Default, nullptr, time_source),
         mock_dispatcher_(dispatcher), mock_upstream_ready_timer_(upstream_ready_timer) {}
 
   ~ConnPoolImplForTest() {
@@ -120,9 +123,7 @@ public:
  */
 class Http1ConnPoolImplTest : public testing::Test {
 public:
-  Http1ConnPoolImplTest()
-      : upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
-        conn_pool_(dispatcher_, cluster_, upstream_ready_timer_) {}
+  Http1ConnPoolImplTest() : Http1ConnPoolImplTest(absl::nullopt) {}
 
   ~Http1ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -133,9 +134,41 @@ public:
 
   NiceMock<Event::MockDispatcher> dispatcher_;
   std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  NiceMock<Event::MockTimer>* idle_timer_;
   NiceMock<Event::MockTimer>* upstream_ready_timer_;
   ConnPoolImplForTest conn_pool_;
   NiceMock<Runtime::MockLoader> runtime_;
+
+protected:
+  Http1ConnPoolImplTest(absl::optional<std::chrono::milliseconds> idle_timeout)
+      : idle_timer_(expectIdleTimer(idle_timeout)),
+        upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
+        conn_pool_(dispatcher_, cluster_, upstream_ready_timer_, time_source_) {}
+
+private:
+  // The pool creates its idle timer after the upstream ready timer, and mock timers are handed out
+  // in the reverse order of their creation.
+  NiceMock<Event::MockTimer>*
+  expectIdleTimer(absl::optional<std::chrono::milliseconds> idle_timeout) {
+    if (!idle_timeout) {
+      return nullptr;
+    }
+    ON_CALL(*cluster_, idleTimeout()).WillByDefault(Return(idle_timeout));
+    return new NiceMock<Event::MockTimer>(&dispatcher_);
+  }
+};
+
+/**
+ * Test fixture for a pool whose cluster has an idle timeout of a second.
+ */
+class Http1ConnPoolImplIdleTest : public Http1ConnPoolImplTest {
+public:
+  Http1ConnPoolImplIdleTest() : Http1ConnPoolImplTest(std::chrono::milliseconds(1000)) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&now_));
+  }
+
+  MonotonicTime now_;
 };
 
 /**
@@ -674,6 +707,154 @@ TEST_F(Http1ConnPoolImplTest, DrainWhileConnecting) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Verify that prefetched connections count towards the connections asked for, that a request waits
+ * for a prefetched connection that is still connecting, and that used and wasted prefetched
+ * connections are counted.
+ */
+TEST_F(Http1ConnPoolImplTest, Prefetch) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 3, 1024, 1024, 1));
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  conn_pool_.prefetch(2);
+  conn_pool_.prefetch(2);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  r1.expectNewStream();
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+}
+
+/**
+ * Verify that the pool keeps the prefetch ratio of connections to its active and pending requests.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchForDemand) {
+  InSequence s;
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+
+  // The first request opens a connection for itself and prefetches one for the next request.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  r1.expectNewStream();
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The second request finds the prefetched connection ready. The pool would prefetch a third, but
+  // it is at its connection limit.
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  r1.startRequest();
+  r1.completeResponse(false);
+  r2.startRequest();
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+}
+
+/**
+ * Verify that a request goes to the ready connection that was used most recently.
+ */
+TEST_F(Http1ConnPoolImplTest, ReuseMostRecentlyUsed) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  r1.completeResponse(false);
+  r2.startRequest();
+  r2.completeResponse(false);
+
+  ActiveTestRequest r3(*this, 1, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  r3.completeResponse(false);
+  ActiveTestRequest r4(*this, 1, ActiveTestRequest::Type::Immediate);
+  r4.startRequest();
+  r4.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Verify that a single timer closes ready connections once they have been idle for the cluster's
+ * idle timeout.
+ */
+TEST_F(Http1ConnPoolImplIdleTest, IdleTimeout) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  r2.startRequest();
+
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(1000)));
+  r1.completeResponse(false);
+  now_ += std::chrono::milliseconds(600);
+  r2.completeResponse(false);
+
+  // The connection that went idle first is closed, and the timer waits for the other.
+  now_ += std::chrono::milliseconds(400);
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(600)));
+  idle_timer_->callback_();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  // Reusing the connection restarts its idle time.
+  now_ += std::chrono::milliseconds(300);
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  r3.completeResponse(false);
+
+  now_ += std::chrono::milliseconds(300);
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(700)));
+  idle_timer_->callback_();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+
+  now_ += std::chrono::milliseconds(700);
+  EXPECT_CALL(*idle_timer_, enableTimer(_)).Times(0);
+  idle_timer_->callback_();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(Http1ConnPoolImplTest, RemoteCloseToCompleteResponse) {
   InSequence s;
 
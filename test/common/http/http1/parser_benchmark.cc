@@ -0,0 +1,128 @@
+// Usage: bazel run //test/common/http/http1:parser_benchmark
+//
+// Measures how fast LegacyParserImpl (argument 0) and ScanningParserImpl (argument 1) read a
+// browser request, a gRPC request and a chunked response, each a thousand times over in one
+// buffer. Throughput is reported in bytes per second.
+
+#include <string>
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/scanning_parser_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Callbacks that only keep what the codec would need to look at.
+class NullCallbacks : public ParserCallbacks {
+public:
+  // Http1::ParserCallbacks
+  void onMessageBegin() override {}
+  void onUrl(const char*, size_t length) override { bytes_ += length; }
+  void onHeaderField(const char*, size_t length) override { bytes_ += length; }
+  void onHeaderValue(const char*, size_t length) override { bytes_ += length; }
+  int onHeadersComplete() override { return 0; }
+  void onBody(const char*, size_t length) override { bytes_ += length; }
+  void onMessageComplete() override { messages_++; }
+
+  uint64_t bytes_{};
+  uint64_t messages_{};
+};
+
+const char BrowserRequest[] =
+    "GET /wiki/Hypertext_Transfer_Protocol HTTP/1.1\r\n"
+    "Host: en.wikipedia.org\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_13_4) AppleWebKit/537.36 (KHTML, like "
+    "Gecko) Chrome/66.0.3359.181 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8"
+    "\r\n"
+    "Referer: https://www.google.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Cookie: WMF-Last-Access=30-May-2018; GeoIP=US:CA:San_Francisco:37.77:-122.41:v4; "
+    "enwikiUserName=Example; enwikimwuser-sessionId=0123456789abcdef0123\r\n"
+    "\r\n";
+
+const char GrpcRequest[] = "POST /helloworld.Greeter/SayHello HTTP/1.1\r\n"
+                           "Host: greeter.example.com:50051\r\n"
+                           "Content-Type: application/grpc\r\n"
+                           "TE: trailers\r\n"
+                           "grpc-timeout: 1S\r\n"
+                           "grpc-accept-encoding: identity,deflate,gzip\r\n"
+                           "Content-Length: 12\r\n"
+                           "\r\n"
+                           "\x00\x00\x00\x00\x07\n\x05world";
+
+const char ChunkedResponse[] = "HTTP/1.1 200 OK\r\n"
+                               "Date: Wed, 30 May 2018 17:00:00 GMT\r\n"
+                               "Content-Type: text/html; charset=UTF-8\r\n"
+                               "Transfer-Encoding: chunked\r\n"
+                               "Cache-Control: private, max-age=0\r\n"
+                               "Server: envoy\r\n"
+                               "\r\n"
+                               "1a\r\nabcdefghijklmnopqrstuvwxyz\r\n"
+                               "10\r\n0123456789abcdef\r\n"
+                               "0\r\n\r\n";
+
+void parse(benchmark::State& state, MessageType type, const std::string& message) {
+  std::string stream;
+  for (uint32_t i = 0; i < 1000; i++) {
+    stream += message;
+  }
+
+  for (auto _ : state) {
+    NullCallbacks callbacks;
+    ParserPtr parser;
+    if (state.range(0) == 0) {
+      parser.reset(new LegacyParserImpl(type, callbacks));
+    } else {
+      parser.reset(new ScanningParserImpl(type, callbacks));
+    }
+    const size_t parsed = parser->execute(stream.data(), stream.size());
+    if (parsed != stream.size() || callbacks.messages_ != 1000) {
+      state.SkipWithError("stream did not parse");
+      break;
+    }
+    benchmark::DoNotOptimize(callbacks.bytes_);
+  }
+  state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+static void BM_ParseBrowserRequest(benchmark::State& state) {
+  parse(state, MessageType::Request, BrowserRequest);
+}
+BENCHMARK(BM_ParseBrowserRequest)->Arg(0)->Arg(1);
+
+static void BM_ParseGrpcRequest(benchmark::State& state) {
+  parse(state, MessageType::Request, std::string(GrpcRequest, sizeof(GrpcRequest) - 1));
+}
+BENCHMARK(BM_ParseGrpcRequest)->Arg(0)->Arg(1);
+
+static void BM_ParseChunkedResponse(benchmark::State& state) {
+  parse(state, MessageType::Response, ChunkedResponse);
+}
+BENCHMARK(BM_ParseChunkedResponse)->Arg(0)->Arg(1);
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
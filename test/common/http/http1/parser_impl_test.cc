@@ -0,0 +1,156 @@
+#include <string>
+#include <vector>
+
+#include "common/http/http1/scanning_parser_impl.h"
+
+#include "test/common/http/http1/parser_recorder.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+struct Message {
+  MessageType type_;
+  std::string input_;
+};
+
+// Streams that exercise http_parser's quirks and strict mode checks as well as ordinary traffic.
+// Each one is parsed whole and split in two at every offset.
+const std::vector<Message>& messages() {
+  static const std::vector<Message>* messages = new std::vector<Message>{
+      // Requests.
+      {MessageType::Request, "GET /index.html?q=1#top HTTP/1.1\r\nHost: example.com\r\n"
+                             "User-Agent: curl/7.54.0\r\nAccept: */*\r\n\r\n"},
+      {MessageType::Request, "\r\n\nPOST /a HTTP/1.0\r\nContent-Length: 5  \r\n\r\nhello"
+                             "GET / HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                             "5;name=value\r\nhello\r\nA\r\n0123456789\r\n0\r\nTrailer: t\r\n\r\n"},
+      {MessageType::Request, "M-SEARCH * HTTP/1.1\r\nEmpty:\r\nFolded: \r\n  value\r\n"
+                             "Continued: a\r\n\tb\r\n c\r\n\r\n"},
+      {MessageType::Request, "GET http://user@host:8080/p?a#b HTTP/1.1\nA: b\n\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n x\r\n\r\n"},
+      {MessageType::Request, "GET /\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 10\r\n\r\nshort"},
+      {MessageType::Request, "CONNECT example.com:443 HTTP/1.1\r\n\r\ntunneled bytes"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nConnection: keep-alive, Upgrade\r\n"
+                             "Upgrade: websocket\r\n\r\nframes"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nConnection: up,upgrade\r\nUpgrade: ws\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.0\r\nConnection: x, Keep-Alive\r\n\r\n"
+                             "GET / HTTP/1.1\r\nContent-Length: 5 \r\n 6\r\n\r\nhello"},
+      // Bad requests, some of which only strict mode turns away.
+      {MessageType::Request, "GET / HTTP/1.0\r\n\r\n\r\nGET / HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nConnection: close\r\n\r\nGET / HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.0\r\nConnection: keep-alive\r\n z\r\n\r\nGET /"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nSpaced Name: value\r\n\r\n"},
+      {MessageType::Request, "GET / HXTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET /a\tb HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET /\x80 HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nA:\rX\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\n\rX"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 5\r\n 6\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 5 x\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\rX"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\naX"},
+      {MessageType::Request, "GETS / HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "get / HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET  HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET http:/x HTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET / XTTP/1.1\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/0.9\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\rX\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nA: b\rX\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nNo@Good: b\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\n: b\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length:\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nContent-Length: 5\r\n"
+                             "Transfer-Encoding: chunked\r\n\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nZ\r\n"},
+      {MessageType::Request, "GET / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                             "fffffffffffffffff\r\n"},
+      // Responses.
+      {MessageType::Response, "HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc"
+                              "HTTP/1.1 204 No Content\r\n\r\nHTTP/1.1 304\r\n\r\n"},
+      {MessageType::Response, "HTTP/1.0 200 OK\r\nServer: test\r\n\r\nread until the end"},
+      {MessageType::Response, "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 301 Moved\r\n"
+                              "Transfer-Encoding: CHUNKED  \r\n\r\n1\r\nx\r\n0\r\n\r\n"},
+      {MessageType::Response, "HTTP/1.1 101 Switching Protocols\r\nConnection: upgrade\r\n"
+                              "Upgrade: h2c\r\n\r\nframes"},
+      {MessageType::Response, "HTTP/1.1  200\nA: b\n\n"},
+      // Bad responses.
+      {MessageType::Response, "HTTP/1.1 2000 OK\r\n\r\n"},
+      {MessageType::Response, "HTTP/1.1 20x OK\r\n\r\n"},
+      {MessageType::Response, "HTTP/1.x 200 OK\r\n\r\n"},
+      {MessageType::Response, "XTTP/1.1 200 OK\r\n\r\n"},
+      {MessageType::Response, "HTXP/1.1 200 OK\r\n\r\n"},
+      {MessageType::Response, "HTTP/1.1 200 OK\rX\r\n"},
+  };
+  return *messages;
+}
+
+// The scanning parser reports the same things as http_parser, however the stream is split.
+TEST(ParserImplTest, ParityWithHttpParser) {
+  for (const Message& message : messages()) {
+    const std::string expected = ParserRecorder::parse(false, message.type_, message.input_, {});
+    EXPECT_EQ(expected, ParserRecorder::parse(true, message.type_, message.input_, {}))
+        << message.input_;
+    for (size_t split = 1; split < message.input_.size(); split++) {
+      EXPECT_EQ(expected, ParserRecorder::parse(true, message.type_, message.input_, {split}))
+          << message.input_ << " split at " << split;
+      EXPECT_EQ(expected, ParserRecorder::parse(false, message.type_, message.input_, {split}))
+          << message.input_ << " split at " << split;
+    }
+  }
+}
+
+TEST(ParserImplTest, ByteAtATime) {
+  for (const Message& message : messages()) {
+    std::vector<size_t> splits;
+    for (size_t split = 1; split < message.input_.size(); split++) {
+      splits.push_back(split);
+    }
+    EXPECT_EQ(ParserRecorder::parse(false, message.type_, message.input_, splits),
+              ParserRecorder::parse(true, message.type_, message.input_, splits))
+        << message.input_;
+  }
+}
+
+// Long values are found with vector compares, which must stop at the first delimiter whatever
+// its place in a block.
+TEST(ParserImplTest, LongValues) {
+  for (size_t length = 0; length < 100; length++) {
+    const std::string input = "GET /" + std::string(length, 'p') + " HTTP/1.1\r\nName: " +
+                              std::string(length, 'v') + "\r\n\r\n";
+    EXPECT_EQ(ParserRecorder::parse(false, MessageType::Request, input, {}),
+              ParserRecorder::parse(true, MessageType::Request, input, {}));
+  }
+}
+
+// Unlike http_parser, the scanning parser rejects every control character in a header value.
+TEST(ParserImplTest, ControlCharacterInValue) {
+  const std::string input = "GET / HTTP/1.1\r\nName: a\x01z\r\n\r\n";
+  EXPECT_EQ("error HPE_INVALID_HEADER_TOKEN\n",
+            ParserRecorder::parse(true, MessageType::Request, input, {}));
+  EXPECT_EQ("error HPE_INVALID_HEADER_TOKEN\n",
+            ParserRecorder::parse(true, MessageType::Request, input, {25}));
+}
+
+TEST(ParserImplTest, HeaderOverflow) {
+  const std::string input =
+      "GET / HTTP/1.1\r\nName: " + std::string(HTTP_MAX_HEADER_SIZE, 'v') + "\r\n\r\n";
+  EXPECT_EQ("error HPE_HEADER_OVERFLOW\n",
+            ParserRecorder::parse(true, MessageType::Request, input, {}));
+  EXPECT_EQ("error HPE_HEADER_OVERFLOW\n",
+            ParserRecorder::parse(true, MessageType::Request, input, {100}));
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/parser.h"
+#include "common/http/http1/scanning_parser_impl.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Writes down what a Parser reports while it reads a stream, so that parsers can be compared.
+ * Consecutive data callbacks for the same element are joined, since parsers are free to split
+ * them differently.
+ */
+class ParserRecorder : public ParserCallbacks {
+public:
+  /**
+   * Parse input in pieces ending at each of splits, then at its end, and then end the stream.
+   * @param scanning_parser supplies whether to use ScanningParserImpl or LegacyParserImpl.
+   * @return std::string the transcript. Once a parser fails, what it reported since the last
+   *         complete message is dropped, as parsers may get different distances into a bad
+   *         message before they notice.
+   */
+  static std::string parse(bool scanning_parser, MessageType type, absl::string_view input,
+                           const std::vector<size_t>& splits) {
+    ParserRecorder recorder;
+    if (scanning_parser) {
+      recorder.parser_.reset(new ScanningParserImpl(type, recorder));
+    } else {
+      recorder.parser_.reset(new LegacyParserImpl(type, recorder));
+    }
+
+    size_t offset = 0;
+    std::vector<size_t> ends = splits;
+    ends.push_back(input.size());
+    for (size_t end : ends) {
+      if (end <= offset) {
+        // A zero length span would end the stream.
+        continue;
+      }
+      const size_t parsed = recorder.parser_->execute(input.data() + offset, end - offset);
+      if (recorder.parser_->status() == ParserStatus::Error) {
+        return recorder.fail();
+      }
+      if (parsed != end - offset) {
+        // The connection was upgraded, and the rest is not HTTP.
+        recorder.note("upgrade at " + std::to_string(offset + parsed));
+        return recorder.transcript_;
+      }
+      offset = end;
+    }
+
+    recorder.parser_->execute(nullptr, 0);
+    if (recorder.parser_->status() == ParserStatus::Error) {
+      return recorder.fail();
+    }
+    return recorder.transcript_;
+  }
+
+  // Http1::ParserCallbacks
+  void onMessageBegin() override { note("begin"); }
+  void onUrl(const char* data, size_t length) override { append("url", data, length); }
+  void onHeaderField(const char* data, size_t length) override {
+    append("field", data, length);
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    append("value", data, length);
+  }
+  int onHeadersComplete() override {
+    note(fmt::format("headers method={} status={} version={}.{} body={}",
+                     static_cast<int>(parser_->method()), parser_->statusCode(),
+                     parser_->httpMajor(), parser_->httpMinor(), parser_->hasBody()));
+    return 0;
+  }
+  void onBody(const char* data, size_t length) override { append("body", data, length); }
+  void onMessageComplete() override {
+    note("complete");
+    complete_length_ = transcript_.size();
+  }
+
+private:
+  void note(const std::string& event) {
+    transcript_ += event + "\n";
+    last_element_.clear();
+  }
+
+  void append(const std::string& element, const char* data, size_t length) {
+    if (element != last_element_) {
+      transcript_ += element + ":";
+      last_element_ = element;
+    } else {
+      // Take off the newline that ended the last piece.
+      transcript_.pop_back();
+    }
+    transcript_.append(data, length);
+    transcript_ += "\n";
+  }
+
+  std::string fail() {
+    transcript_.resize(complete_length_);
+    return transcript_ + "error " + parser_->errorName() + "\n";
+  }
+
+  ParserPtr parser_;
+  std::string transcript_;
+  std::string last_element_;
+  size_t complete_length_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
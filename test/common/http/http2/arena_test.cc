@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "common/http/http2/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+TEST(Http2ArenaTest, ReusesReleasedBlocks) {
+  Arena arena;
+  void* first = arena.allocate(100);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(Arena::CHUNK_SIZE, arena.chunkBytes());
+  arena.release(first);
+
+  // The same size class comes from the free list, and a different one from the chunk.
+  EXPECT_EQ(first, arena.allocate(90));
+  void* other = arena.allocate(1000);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(Arena::CHUNK_SIZE, arena.chunkBytes());
+  arena.release(other);
+  arena.release(first);
+  arena.release(nullptr);
+}
+
+TEST(Http2ArenaTest, Alignment) {
+  Arena arena;
+  for (size_t size : {0, 1, 7, 48, 49, 100, 4000, 10000}) {
+    void* ptr = arena.allocate(size);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t));
+    arena.release(ptr);
+  }
+}
+
+TEST(Http2ArenaTest, NewChunks) {
+  Arena arena;
+  // 1000 bytes and the block header fit a 1024 byte block, so the 65th of them needs a new chunk.
+  for (size_t i = 0; i < Arena::CHUNK_SIZE / 1024; i++) {
+    arena.allocate(1000);
+  }
+  EXPECT_EQ(Arena::CHUNK_SIZE, arena.chunkBytes());
+  arena.allocate(1000);
+  EXPECT_EQ(2 * Arena::CHUNK_SIZE, arena.chunkBytes());
+}
+
+TEST(Http2ArenaTest, LargeBlocksUseMalloc) {
+  Arena arena;
+  void* ptr = arena.allocate(100000);
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 'a', 100000);
+  EXPECT_EQ(0U, arena.chunkBytes());
+  arena.release(ptr);
+}
+
+TEST(Http2ArenaTest, Reallocate) {
+  Arena arena;
+  char* ptr = static_cast<char*>(arena.reallocate(nullptr, 10));
+  ASSERT_NE(nullptr, ptr);
+  memcpy(ptr, "helloworld", 10);
+
+  // Growing within the block's size class keeps the block.
+  EXPECT_EQ(ptr, arena.reallocate(ptr, 40));
+
+  // Growing past it moves to a larger class, then to malloc.
+  ptr = static_cast<char*>(arena.reallocate(ptr, 1000));
+  EXPECT_EQ("helloworld", std::string(ptr, 10));
+  ptr = static_cast<char*>(arena.reallocate(ptr, 100000));
+  EXPECT_EQ("helloworld", std::string(ptr, 10));
+  ptr = static_cast<char*>(arena.reallocate(ptr, 10));
+  EXPECT_EQ("helloworld", std::string(ptr, 10));
+  arena.release(ptr);
+}
+
+TEST(Http2ArenaTest, AllocateZeroed) {
+  Arena arena;
+  char* ptr = static_cast<char*>(arena.allocate(200));
+  memset(ptr, 'a', 200);
+  arena.release(ptr);
+
+  ptr = static_cast<char*>(arena.allocateZeroed(20, 10));
+  for (size_t i = 0; i < 200; i++) {
+    EXPECT_EQ(0, ptr[i]);
+  }
+  arena.release(ptr);
+  EXPECT_EQ(nullptr, arena.allocateZeroed(SIZE_MAX / 2, 4));
+}
+
+TEST(Http2ArenaTest, Nghttp2Mem) {
+  Arena arena;
+  nghttp2_mem* mem = arena.mem();
+  void* ptr = mem->malloc(100, mem->mem_user_data);
+  ptr = mem->realloc(ptr, 200, mem->mem_user_data);
+  mem->free(ptr, mem->mem_user_data);
+  EXPECT_EQ(ptr, mem->calloc(1, 200, mem->mem_user_data));
+  mem->free(ptr, mem->mem_user_data);
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdint>
+
+#include "common/http/http2/bdp_estimator.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+const uint32_t MinWindow = 65535;
+const uint32_t MaxWindow = 1024 * 1024;
+
+class Http2BdpEstimatorTest : public testing::Test {
+public:
+  Http2BdpEstimatorTest() : estimator_(MinWindow, MaxWindow, time_source_) {}
+
+  // Receive the given bytes over a round trip of the given length, starting a sample.
+  bool sample(uint64_t bytes, std::chrono::microseconds rtt) {
+    EXPECT_CALL(time_source_, currentTime()).WillOnce(Return(now_));
+    EXPECT_TRUE(estimator_.onData(bytes / 2));
+    EXPECT_FALSE(estimator_.onData(bytes - bytes / 2));
+    now_ += rtt;
+    EXPECT_CALL(time_source_, currentTime()).WillOnce(Return(now_));
+    return estimator_.onPingAck();
+  }
+
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
+  BdpEstimator estimator_;
+};
+
+TEST_F(Http2BdpEstimatorTest, StartsAtMinimum) {
+  EXPECT_EQ(MinWindow, estimator_.window());
+  // An acknowledgement without a sample changes nothing.
+  EXPECT_FALSE(estimator_.onPingAck());
+  EXPECT_EQ(MinWindow, estimator_.window());
+}
+
+TEST_F(Http2BdpEstimatorTest, GrowsWhenWindowLimited) {
+  const std::chrono::microseconds rtt(50000);
+  EXPECT_TRUE(sample(60000, rtt));
+  EXPECT_EQ(120000U, estimator_.window());
+
+  // Less than two thirds of the window does not grow it.
+  EXPECT_FALSE(sample(70000, rtt));
+  EXPECT_EQ(120000U, estimator_.window());
+
+  // Nor does a full window at a lower bandwidth than seen before.
+  EXPECT_FALSE(sample(110000, std::chrono::microseconds(200000)));
+  EXPECT_EQ(120000U, estimator_.window());
+
+  EXPECT_TRUE(sample(110000, rtt));
+  EXPECT_EQ(220000U, estimator_.window());
+
+  // Growth stops at the maximum.
+  EXPECT_TRUE(sample(900000, std::chrono::microseconds(1000)));
+  EXPECT_EQ(MaxWindow, estimator_.window());
+  EXPECT_FALSE(sample(MaxWindow, std::chrono::microseconds(100)));
+  EXPECT_EQ(MaxWindow, estimator_.window());
+}
+
+TEST_F(Http2BdpEstimatorTest, ShrinksWhenUnderused) {
+  const std::chrono::microseconds rtt(1000);
+  EXPECT_TRUE(sample(400000, rtt));
+  EXPECT_EQ(800000U, estimator_.window());
+
+  // It takes SHRINK_SAMPLES samples in a row under a quarter of the window to halve it, and a
+  // sample that uses more starts the count over.
+  for (uint32_t i = 0; i < BdpEstimator::SHRINK_SAMPLES - 1; i++) {
+    EXPECT_FALSE(sample(1000, rtt));
+  }
+  EXPECT_FALSE(sample(300000, rtt));
+  for (uint32_t i = 0; i < BdpEstimator::SHRINK_SAMPLES - 1; i++) {
+    EXPECT_FALSE(sample(1000, rtt));
+  }
+  EXPECT_TRUE(sample(1000, rtt));
+  EXPECT_EQ(400000U, estimator_.window());
+
+  // The window grows again, even at a lower bandwidth than before it shrank.
+  EXPECT_TRUE(sample(300000, rtt * 10));
+  EXPECT_EQ(600000U, estimator_.window());
+
+  // It never shrinks below the minimum.
+  for (uint32_t i = 0; i < 10 * BdpEstimator::SHRINK_SAMPLES; i++) {
+    sample(1, rtt);
+  }
+  EXPECT_EQ(MinWindow, estimator_.window());
+}
+
+TEST_F(Http2BdpEstimatorTest, MaximumBelowMinimum) {
+  BdpEstimator estimator(MaxWindow, MinWindow, time_source_);
+  EXPECT_TRUE(estimator.onData(MaxWindow));
+  EXPECT_FALSE(estimator.onPingAck());
+  EXPECT_EQ(MaxWindow, estimator.window());
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,172 @@
+// Usage: bazel run //test/common/http/http2:codec_impl_benchmark
+//
+// Measures a server connection that answers 100 concurrent streams with response headers and a
+// 256 byte body each, sending frames as they are encoded (argument 0) and coalescing them until
+// the end of the event loop iteration (argument 1). The label reports the writes to the
+// connection per iteration; over TLS each write is at least one record.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/fmt.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "nghttp2/nghttp2.h"
+#include "testing/base/public/benchmark.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+const uint32_t Streams = 100;
+const uint64_t BodySize = 256;
+
+class NullStreamDecoder : public StreamDecoder {
+public:
+  // Http::StreamDecoder
+  void decode100ContinueHeaders(HeaderMapPtr&&) override {}
+  void decodeHeaders(HeaderMapPtr&&, bool) override {}
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeTrailers(HeaderMapPtr&&) override {}
+};
+
+class Callbacks : public ServerConnectionCallbacks {
+public:
+  // Http::ConnectionCallbacks
+  void onGoAway() override {}
+
+  // Http::ServerConnectionCallbacks
+  StreamDecoder& newStream(StreamEncoder& response_encoder) override {
+    encoders_.push_back(&response_encoder);
+    return decoder_;
+  }
+
+  NullStreamDecoder decoder_;
+  std::vector<StreamEncoder*> encoders_;
+};
+
+// The client preface, SETTINGS and a HEADERS frame for each of the concurrent requests, as a
+// client connection would send them.
+std::string requests() {
+  std::string wire;
+  nghttp2_session_callbacks* callbacks;
+  nghttp2_session_callbacks_new(&callbacks);
+  nghttp2_session_callbacks_set_send_callback(
+      callbacks, [](nghttp2_session*, const uint8_t* data, size_t length, int,
+                    void* wire) -> ssize_t {
+        static_cast<std::string*>(wire)->append(reinterpret_cast<const char*>(data), length);
+        return length;
+      });
+  nghttp2_session* session;
+  nghttp2_session_client_new(&session, callbacks, &wire);
+  nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, nullptr, 0);
+
+  TestHeaderMapImpl headers{{":method", "GET"},
+                            {":path", "/"},
+                            {":scheme", "https"},
+                            {":authority", "example.com"}};
+  std::vector<nghttp2_nv> nva;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        nghttp2_nv nv;
+        nv.name = reinterpret_cast<uint8_t*>(const_cast<char*>(header.key().c_str()));
+        nv.namelen = header.key().size();
+        nv.value = reinterpret_cast<uint8_t*>(const_cast<char*>(header.value().c_str()));
+        nv.valuelen = header.value().size();
+        nv.flags = NGHTTP2_NV_FLAG_NONE;
+        static_cast<std::vector<nghttp2_nv>*>(context)->push_back(nv);
+        return HeaderMap::Iterate::Continue;
+      },
+      &nva);
+  for (uint32_t i = 0; i < Streams; i++) {
+    nghttp2_submit_request(session, nullptr, nva.data(), nva.size(), nullptr, nullptr);
+  }
+  nghttp2_session_send(session);
+  nghttp2_session_del(session);
+  nghttp2_session_callbacks_del(callbacks);
+  return wire;
+}
+
+static void BM_RespondConcurrentStreams(benchmark::State& state) {
+  const std::string request_wire = requests();
+  Stats::IsolatedStoreImpl stats;
+  Http2Settings settings;
+  settings.coalesce_writes_ = state.range(0) == 1;
+
+  NiceMock<Network::MockConnection> connection;
+  uint64_t writes = 0;
+  ON_CALL(connection, write(_, _))
+      .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+        writes++;
+        data.drain(data.length());
+      }));
+  Event::TimerCb flush;
+  ON_CALL(connection.dispatcher_, createTimer_(_))
+      .WillByDefault(Invoke([&](Event::TimerCb cb) -> Event::Timer* {
+        flush = cb;
+        return new NiceMock<Event::MockTimer>();
+      }));
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"content-type", "text/plain"}};
+  const std::string body(BodySize, 'a');
+  uint64_t response_writes = 0;
+  for (auto _ : state) {
+    Callbacks callbacks;
+    ServerConnectionImpl server(connection, callbacks, stats, settings);
+    Buffer::OwnedImpl request_buffer(request_wire);
+    server.dispatch(request_buffer);
+    if (callbacks.encoders_.size() != Streams) {
+      state.SkipWithError("requests did not decode");
+      break;
+    }
+
+    writes = 0;
+    for (StreamEncoder* encoder : callbacks.encoders_) {
+      Buffer::OwnedImpl response_body(body);
+      encoder->encodeHeaders(response_headers, false);
+      encoder->encodeData(response_body, true);
+    }
+    if (settings.coalesce_writes_) {
+      // The end of the event loop iteration.
+      flush();
+    }
+    response_writes += writes;
+  }
+
+  state.SetItemsProcessed(state.iterations() * Streams);
+  if (state.iterations() > 0) {
+    state.SetLabel(fmt::format("{} writes", response_writes / state.iterations()));
+  }
+}
+BENCHMARK(BM_RespondConcurrentStreams)->Arg(0)->Arg(1);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -9,8 +9,11 @@
 #include "common/stats/stats_impl.h"
 
 #include "test/common/http/common.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
@@ -23,6 +26,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::NiceMock;
+using testing::Property;
 using testing::Return;
 using testing::_;
 
@@ -329,6 +333,49 @@ TEST_P(Http2CodecImplTest, TrailingHeaders) {
   response_encoder_->encodeTrailers(TestHeaderMapImpl{{"trailing", "header"}});
 }
 
+TEST_P(Http2CodecImplTest, HeadersReferenceHpackStrings) {
+  initialize();
+
+  const std::string metadata(1024, 'm');
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-metadata", metadata);
+
+  HeaderMapPtr first_headers;
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](HeaderMapPtr& headers, bool) -> void {
+        first_headers = std::move(headers);
+      }));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  const HeaderEntry* first = first_headers->get(LowerCaseString("x-metadata"));
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(HeaderString::Type::Reference, first->key().type());
+  EXPECT_EQ(HeaderString::Type::Reference, first->value().type());
+  EXPECT_EQ(metadata, first->value().c_str());
+
+  // The second request gets the header from the HPACK dynamic table, if there is one, and then
+  // shares the decoded string with the first.
+  MockStreamDecoder response_decoder;
+  StreamEncoder& request_encoder = client_.newStream(response_decoder);
+  MockStreamDecoder request_decoder;
+  EXPECT_CALL(server_callbacks_, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder&) -> StreamDecoder& { return request_decoder; }));
+  HeaderMapPtr second_headers;
+  EXPECT_CALL(request_decoder, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](HeaderMapPtr& headers, bool) -> void {
+        second_headers = std::move(headers);
+      }));
+  request_encoder.encodeHeaders(request_headers, true);
+
+  const HeaderEntry* second = second_headers->get(LowerCaseString("x-metadata"));
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(metadata, second->value().c_str());
+  if (server_http2settings_.hpack_table_size_ >= Http2Settings::DEFAULT_HPACK_TABLE_SIZE) {
+    EXPECT_EQ(first->value().c_str(), second->value().c_str());
+  }
+}
+
 TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   initialize();
 
@@ -753,6 +800,204 @@ TEST_P(Http2CodecImplTest, TestCodecHeaderLimits) {
   request_encoder_->encodeHeaders(request_headers, false);
 }
 
+// The server coalesces writes, the client does not.
+class Http2CodecImplCoalescingTest : public testing::Test {
+public:
+  Http2CodecImplCoalescingTest()
+      : client_(client_connection_, client_callbacks_, stats_store_, Http2Settings()),
+        flush_timer_(new Event::MockTimer(&server_connection_.dispatcher_)),
+        server_(server_connection_, server_callbacks_, stats_store_, coalescingSettings()) {
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+          Buffer::OwnedImpl buffer;
+          buffer.move(data);
+          server_.dispatch(buffer);
+        }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+          server_writes_++;
+          Buffer::OwnedImpl buffer;
+          buffer.move(data);
+          client_.dispatch(buffer);
+        }));
+    EXPECT_CALL(stats_store_, deliverHistogramToSinks(_, _)).Times(AnyNumber());
+  }
+
+  static Http2Settings coalescingSettings() {
+    Http2Settings settings;
+    settings.coalesce_writes_ = true;
+    return settings;
+  }
+
+  // Start a request on the client and return the server's encoder for it.
+  StreamEncoder& startRequest(MockStreamDecoder& response_decoder,
+                              MockStreamDecoder& request_decoder) {
+    StreamEncoder& request_encoder = client_.newStream(response_decoder);
+    StreamEncoder* response_encoder{};
+    EXPECT_CALL(server_callbacks_, newStream(_))
+        .WillOnce(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+          response_encoder = &encoder;
+          return request_decoder;
+        }));
+    EXPECT_CALL(request_decoder, decodeHeaders_(_, true));
+    TestHeaderMapImpl request_headers;
+    HttpTestUtility::addDefaultHeaders(request_headers);
+    request_encoder.encodeHeaders(request_headers, true);
+    return *response_encoder;
+  }
+
+  NiceMock<Stats::MockIsolatedStatsStore> stats_store_;
+  NiceMock<Network::MockConnection> client_connection_;
+  MockConnectionCallbacks client_callbacks_;
+  ClientConnectionImpl client_;
+  NiceMock<Network::MockConnection> server_connection_;
+  MockServerConnectionCallbacks server_callbacks_;
+  Event::MockTimer* flush_timer_;
+  ServerConnectionImpl server_;
+  uint64_t server_writes_{};
+};
+
+TEST_F(Http2CodecImplCoalescingTest, CoalesceStreams) {
+  MockStreamDecoder response_decoder1;
+  MockStreamDecoder request_decoder1;
+  StreamEncoder& response_encoder1 = startRequest(response_decoder1, request_decoder1);
+  MockStreamDecoder response_decoder2;
+  MockStreamDecoder request_decoder2;
+  StreamEncoder& response_encoder2 = startRequest(response_decoder2, request_decoder2);
+
+  // Frames that answer received data, such as the SETTINGS ACK, are not deferred.
+  EXPECT_NE(0U, server_writes_);
+  server_writes_ = 0;
+
+  // Both responses are encoded but nothing is written until the end of the loop iteration.
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(0)));
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  Buffer::OwnedImpl body1("hello");
+  response_encoder1.encodeHeaders(response_headers, false);
+  response_encoder1.encodeData(body1, true);
+  Buffer::OwnedImpl body2("world");
+  response_encoder2.encodeHeaders(response_headers, false);
+  response_encoder2.encodeData(body2, true);
+  EXPECT_EQ(0U, server_writes_);
+
+  // Then the HEADERS and DATA frames of both streams go out in one write.
+  EXPECT_CALL(stats_store_, deliverHistogramToSinks(
+                                Property(&Stats::Metric::name, "http2.frames_per_write"), 4));
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder1, decodeData(BufferStringEqual("hello"), true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder2, decodeData(BufferStringEqual("world"), true));
+  flush_timer_->callback_();
+  EXPECT_EQ(1U, server_writes_);
+}
+
+TEST_F(Http2CodecImplCoalescingTest, DispatchFlushesDeferredFrames) {
+  MockStreamDecoder response_decoder;
+  MockStreamDecoder request_decoder;
+  StreamEncoder& response_encoder = startRequest(response_decoder, request_decoder);
+  server_writes_ = 0;
+
+  EXPECT_CALL(*flush_timer_, enableTimer(_));
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  response_encoder.encodeHeaders(response_headers, true);
+  EXPECT_EQ(0U, server_writes_);
+
+  // The server flushes when it is done dispatching the next request, which cancels the timer.
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, true));
+  MockStreamDecoder response_decoder2;
+  MockStreamDecoder request_decoder2;
+  startRequest(response_decoder2, request_decoder2);
+  EXPECT_EQ(1U, server_writes_);
+}
+
+TEST_F(Http2CodecImplCoalescingTest, GoAwayAndWantsToWriteFlush) {
+  MockStreamDecoder response_decoder;
+  MockStreamDecoder request_decoder;
+  StreamEncoder& response_encoder = startRequest(response_decoder, request_decoder);
+  server_writes_ = 0;
+
+  EXPECT_CALL(*flush_timer_, enableTimer(_));
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  response_encoder.encodeHeaders(response_headers, false);
+  EXPECT_EQ(0U, server_writes_);
+
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, false));
+  EXPECT_FALSE(server_.wantsToWrite());
+  EXPECT_EQ(1U, server_writes_);
+
+  EXPECT_CALL(client_callbacks_, onGoAway());
+  server_.goAway();
+  EXPECT_EQ(2U, server_writes_);
+}
+
+// The server tunes its windows to the bandwidth-delay product, the client does not.
+class Http2CodecImplAdaptiveWindowTest : public testing::Test {
+public:
+  Http2CodecImplAdaptiveWindowTest()
+      : client_(client_connection_, client_callbacks_, stats_store_, Http2Settings()),
+        server_(server_connection_, server_callbacks_, stats_store_, adaptiveSettings()) {
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+          Buffer::OwnedImpl buffer;
+          buffer.move(data);
+          server_.dispatch(buffer);
+        }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+          Buffer::OwnedImpl buffer;
+          buffer.move(data);
+          client_.dispatch(buffer);
+        }));
+  }
+
+  static Http2Settings adaptiveSettings() {
+    Http2Settings settings;
+    settings.adaptive_window_ = true;
+    settings.adaptive_window_max_size_ = 1024 * 1024;
+    return settings;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<Network::MockConnection> client_connection_;
+  MockConnectionCallbacks client_callbacks_;
+  TestClientConnectionImpl client_;
+  NiceMock<Network::MockConnection> server_connection_;
+  MockServerConnectionCallbacks server_callbacks_;
+  TestServerConnectionImpl server_;
+};
+
+TEST_F(Http2CodecImplAdaptiveWindowTest, GrowWindow) {
+  // The windows start at the HTTP/2 default rather than the initial window sizes.
+  EXPECT_EQ(65535, nghttp2_session_get_remote_window_size(client_.session()));
+  EXPECT_EQ(Http2Settings::MIN_INITIAL_STREAM_WINDOW_SIZE,
+            nghttp2_session_get_remote_settings(client_.session(),
+                                                NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+
+  MockStreamDecoder response_decoder;
+  StreamEncoder& request_encoder = client_.newStream(response_decoder);
+  MockStreamDecoder request_decoder;
+  EXPECT_CALL(server_callbacks_, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder&) -> StreamDecoder& { return request_decoder; }));
+  EXPECT_CALL(request_decoder, decodeHeaders_(_, false));
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_encoder.encodeHeaders(request_headers, false);
+
+  // The body fills most of the window within a round trip of the PING the server sends when it
+  // starts to arrive, so both windows grow to twice its size once the client acknowledges it.
+  EXPECT_CALL(request_decoder, decodeData(_, _)).Times(AtLeast(1));
+  Buffer::OwnedImpl body(std::string(60000, 'a'));
+  request_encoder.encodeData(body, true);
+
+  EXPECT_EQ(1U, stats_store_.counter("http2.window_increase").value());
+  EXPECT_EQ(0U, stats_store_.counter("http2.window_decrease").value());
+  EXPECT_EQ(120000, nghttp2_session_get_effective_local_window_size(server_.session()));
+  EXPECT_EQ(120000U, nghttp2_session_get_remote_settings(client_.session(),
+                                                         NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
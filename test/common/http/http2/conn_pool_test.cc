@@ -146,14 +146,21 @@ TEST_F(Http2ConnPoolImplTest, DrainConnections) {
   r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
   expectClientConnect(1);
 
-  // This will move primary to draining and destroy draining.
+  // This will move the ready client to draining, next to the first one.
   pool_.drainConnections();
-  EXPECT_CALL(*this, onClientDestroy());
-  dispatcher_.clearDeferredDeleteList();
 
-  // This will destroy draining.
+  // A new stream needs a new connection.
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 2);
+  EXPECT_CALL(r3.inner_encoder_, encodeHeaders(_, true));
+  r3.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(2);
+
+  // This will destroy all of them.
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
-  EXPECT_CALL(*this, onClientDestroy());
+  test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(3);
   dispatcher_.clearDeferredDeleteList();
 }
 
@@ -447,6 +454,125 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+/**
+ * Verify that streams go to the connection with the fewest active streams, and that another
+ * connection is opened while that one is busy, up to the limit per host.
+ */
+TEST_F(Http2ConnPoolImplTest, SpreadStreamsOverConnections) {
+  InSequence s;
+  cluster_->http2_max_connections_per_host_ = 2;
+  cluster_->http2_busy_stream_threshold_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+  ActiveTestRequest r2(*this, 0);
+
+  // The first connection is busy.
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 1);
+  expectClientConnect(1);
+  ActiveTestRequest r4(*this, 1);
+
+  // Both connections are busy and there may not be more, so the stream goes to the one with the
+  // fewest active streams.
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  ActiveTestRequest r5(*this, 0);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+}
+
+/**
+ * Verify that a connection with too much data waiting to be written is busy.
+ */
+TEST_F(Http2ConnPoolImplTest, WriteBufferBusy) {
+  InSequence s;
+  cluster_->http2_max_connections_per_host_ = 3;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+  test_clients_[0].connection_->runHighWatermarkCallbacks();
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+
+  // Once its streams are done and its write buffer drains, the first connection takes the next
+  // stream rather than a third connection.
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  test_clients_[0].connection_->runLowWatermarkCallbacks();
+  ActiveTestRequest r3(*this, 0);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Verify that the pool keeps the prefetch ratio of stream capacity to its active streams, and that
+ * new streams go to the prefetched connection.
+ */
+TEST_F(Http2ConnPoolImplTest, Prefetch) {
+  cluster_->http2_max_connections_per_host_ = 2;
+  cluster_->http2_busy_stream_threshold_ = 2;
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+
+  // Prefetching connections that the pool already has does nothing.
+  expectClientCreate();
+  pool_.prefetch(1);
+  pool_.prefetch(1);
+  expectClientConnect(0);
+
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+
+  // Two streams at a ratio of 1.5 need the capacity of two connections.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 0);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  expectClientConnect(1);
+
+  // The prefetched connection has the fewest streams. The pool is then at its connection limit.
+  ActiveTestRequest r3(*this, 1);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_used_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+}
+
+/**
+ * Verify that prefetching stops at the limit of connections per host, and that a prefetched
+ * connection that never has a stream is counted as wasted.
+ */
+TEST_F(Http2ConnPoolImplTest, PrefetchWasted) {
+  expectClientCreate();
+  pool_.prefetch(2);
+  expectClientConnect(0);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_total_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_wasted_.value());
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -121,6 +121,12 @@ TEST(HttpUtility, parseHttp2Settings) {
               http2_settings.initial_stream_window_size_);
     EXPECT_EQ(Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE,
               http2_settings.initial_connection_window_size_);
+    EXPECT_FALSE(http2_settings.coalesce_writes_);
+    EXPECT_FALSE(http2_settings.adaptive_window_);
+    EXPECT_EQ(Http2Settings::MIN_INITIAL_STREAM_WINDOW_SIZE,
+              http2_settings.adaptive_window_min_size_);
+    EXPECT_EQ(Http2Settings::DEFAULT_ADAPTIVE_WINDOW_MAX_SIZE,
+              http2_settings.adaptive_window_max_size_);
   }
 
   {
@@ -0,0 +1,121 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+
+class ConnectionBalancerImplTest : public testing::Test {
+public:
+  void initialize(ConnectionBalancerImpl::LoadMetric metric) {
+    balancer_ = std::make_unique<ConnectionBalancerImpl>(3, metric);
+    for (uint32_t i = 0; i < 3; i++) {
+      balancer_->registerHandler(i, handlers_[i]);
+    }
+  }
+
+  void setUtilization(uint32_t worker_index, uint32_t utilization) {
+    ON_CALL(handlers_[worker_index], loopUtilization()).WillByDefault(Return(utilization));
+  }
+
+  NiceMock<MockBalancedConnectionHandler> handlers_[3];
+  std::unique_ptr<ConnectionBalancerImpl> balancer_;
+};
+
+TEST_F(ConnectionBalancerImplTest, ActiveConnections) {
+  initialize(ConnectionBalancerImpl::LoadMetric::ActiveConnections);
+
+  // Connections stay on the accepting worker until it holds ConnectionMargin more than another,
+  // and each pick counts straight away.
+  for (uint64_t i = 0; i < ConnectionBalancerImpl::ConnectionMargin; i++) {
+    EXPECT_EQ(&handlers_[0], &balancer_->pickTargetHandler(0));
+  }
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[0], &balancer_->pickTargetHandler(0));
+
+  // Reported counts replace the picked ones, and the least loaded worker is picked.
+  balancer_->onConnectionCount(0, 20);
+  balancer_->onConnectionCount(1, 10);
+  balancer_->onConnectionCount(2, 15);
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(2));
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(2));
+}
+
+TEST_F(ConnectionBalancerImplTest, ActiveConnectionsNearEqualLoadStaysLocal) {
+  initialize(ConnectionBalancerImpl::LoadMetric::ActiveConnections);
+
+  // Within the absolute margin.
+  balancer_->onConnectionCount(0, 10);
+  balancer_->onConnectionCount(1, 10 - ConnectionBalancerImpl::ConnectionMargin + 1);
+  balancer_->onConnectionCount(2, 10);
+  EXPECT_EQ(&handlers_[0], &balancer_->pickTargetHandler(0));
+  balancer_->onConnectionCount(0, 10);
+  balancer_->onConnectionCount(1, 10 - ConnectionBalancerImpl::ConnectionMargin);
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+
+  // Within the relative margin, which is larger than the absolute one at high counts.
+  balancer_->onConnectionCount(0, 1000);
+  balancer_->onConnectionCount(1, 951);
+  balancer_->onConnectionCount(2, 960);
+  for (uint32_t i = 0; i < 3; i++) {
+    EXPECT_EQ(&handlers_[i], &balancer_->pickTargetHandler(i));
+  }
+  balancer_->onConnectionCount(0, 1000);
+  balancer_->onConnectionCount(1, 950);
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+
+  // A steady stream of accepts spread evenly over the workers never crosses threads.
+  for (uint32_t i = 0; i < 3; i++) {
+    balancer_->onConnectionCount(i, 100);
+  }
+  for (uint32_t i = 0; i < 300; i++) {
+    EXPECT_EQ(&handlers_[i % 3], &balancer_->pickTargetHandler(i % 3));
+  }
+}
+
+TEST_F(ConnectionBalancerImplTest, Unregistered) {
+  initialize(ConnectionBalancerImpl::LoadMetric::ActiveConnections);
+  balancer_->onConnectionCount(0, 10);
+  balancer_->unregisterHandler(1);
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(0));
+
+  // Registering again starts from no connections.
+  balancer_->registerHandler(1, handlers_[1]);
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+}
+
+TEST_F(ConnectionBalancerImplTest, LoopUtilization) {
+  initialize(ConnectionBalancerImpl::LoadMetric::LoopUtilization);
+  setUtilization(0, 90);
+  setUtilization(1, 45);
+  setUtilization(2, 30);
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(1));
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(2));
+
+  // Workers that are less loaded, but within the margin, don't get the connection.
+  setUtilization(2, 45 - ConnectionBalancerImpl::UtilizationMargin + 1);
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(1));
+  setUtilization(2, 45 - ConnectionBalancerImpl::UtilizationMargin);
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(1));
+
+  // Equally utilized workers are picked by connections.
+  setUtilization(1, 20);
+  setUtilization(2, 20);
+  balancer_->onConnectionCount(1, 3);
+  balancer_->onConnectionCount(2, 2);
+  EXPECT_EQ(&handlers_[2], &balancer_->pickTargetHandler(0));
+  EXPECT_EQ(&handlers_[1], &balancer_->pickTargetHandler(0));
+}
+
+} // namespace Network
+} // namespace Envoy
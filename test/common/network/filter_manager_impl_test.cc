@@ -149,6 +149,25 @@ TEST_F(NetworkFilterManagerTest, EndStream) {
   manager.onWrite();
 }
 
+TEST_F(NetworkFilterManagerTest, HasOtherFilters) {
+  NiceMock<MockConnection> connection;
+  FilterManagerImpl manager(connection, *this);
+  MockFilter* filter(new MockFilter());
+  manager.addFilter(FilterSharedPtr{filter});
+  // A filter that reads and writes is only counted once.
+  EXPECT_FALSE(filter->callbacks_->hasOtherFilters());
+
+  manager.addWriteFilter(WriteFilterSharedPtr{new MockWriteFilter()});
+  EXPECT_TRUE(filter->callbacks_->hasOtherFilters());
+
+  FilterManagerImpl read_manager(connection, *this);
+  MockReadFilter* read_filter(new MockReadFilter());
+  read_manager.addReadFilter(ReadFilterSharedPtr{read_filter});
+  EXPECT_FALSE(read_filter->callbacks_->hasOtherFilters());
+  read_manager.addReadFilter(ReadFilterSharedPtr{new MockReadFilter()});
+  EXPECT_TRUE(read_filter->callbacks_->hasOtherFilters());
+}
+
 // This is a very important flow so make sure it works correctly in aggregate.
 TEST_F(NetworkFilterManagerTest, RateLimitAndTcpProxy) {
   InSequence s;
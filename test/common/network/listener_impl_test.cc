@@ -5,6 +5,7 @@
 
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
 #include "test/test_common/utility.h"
@@ -13,6 +14,7 @@
 #include "gtest/gtest.h"
 
 using testing::Invoke;
+using testing::NiceMock;
 using testing::Return;
 using testing::_;
 
@@ -242,5 +244,50 @@ TEST_P(ListenerImplTest, WildcardListenerIpv4Compat) {
   dispatcher.run(Event::Dispatcher::RunType::Block);
 }
 
+// Connections beyond the batch size wait for the next pass of the event loop, and a disabled
+// listener leaves connections in the backlog.
+TEST_P(ListenerImplTest, AcceptBatchSizeAndDisable) {
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(version_), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::TestListenerImpl listener(dispatcher, socket, listener_callbacks, true, false);
+  NiceMock<Stats::MockHistogram> batch_size;
+  NiceMock<Stats::MockHistogram> latency;
+  listener.setAcceptStats({batch_size, latency});
+  listener.setAcceptBatchSize(2);
+
+  std::vector<int> client_fds;
+  for (uint32_t i = 0; i < 3; i++) {
+    client_fds.push_back(socket.localAddress()->socket(Address::SocketType::Stream));
+    ASSERT_EQ(0, socket.localAddress()->connect(client_fds.back()));
+  }
+
+  std::vector<Network::ConnectionSocketPtr> accepted;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillRepeatedly(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        accepted.emplace_back(std::move(socket));
+      }));
+
+  EXPECT_CALL(batch_size, recordValue(2));
+  EXPECT_CALL(latency, recordValue(_)).Times(2);
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(2U, accepted.size());
+
+  listener.disable();
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(2U, accepted.size());
+
+  EXPECT_CALL(batch_size, recordValue(1));
+  EXPECT_CALL(latency, recordValue(_));
+  listener.enable();
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(3U, accepted.size());
+
+  for (int fd : client_fds) {
+    close(fd);
+  }
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -0,0 +1,149 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/network/splice_pump.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+using testing::_;
+
+namespace Envoy {
+namespace Network {
+
+class SplicePumpTest : public testing::Test {
+public:
+  SplicePumpTest() {
+    // Index 0 of each pair is the remote peer, index 1 is the socket owned by the connection.
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, source_fds_));
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, destination_fds_));
+    for (int fd : {source_fds_[0], source_fds_[1], destination_fds_[0], destination_fds_[1]}) {
+      ::fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+
+    ON_CALL(source_, fd()).WillByDefault(Return(source_fds_[1]));
+    ON_CALL(source_, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+    ON_CALL(destination_, fd()).WillByDefault(Return(destination_fds_[1]));
+  }
+
+  ~SplicePumpTest() {
+    pump_.reset();
+    for (int fd : {source_fds_[0], source_fds_[1], destination_fds_[0], destination_fds_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  void createPump(uint32_t pipe_size) {
+    EXPECT_CALL(source_, readDisable(true));
+    pump_ = SplicePump::create(source_, destination_, pipe_size,
+                               [this](uint64_t bytes) { moved_ += bytes; });
+    ASSERT_NE(nullptr, pump_);
+  }
+
+  // Writes as much of payload as the source peer accepts, runs the loop once, and appends whatever
+  // reached the destination peer to received_.
+  void pumpOnce(const std::string& payload, size_t& written) {
+    if (written < payload.size()) {
+      ssize_t rc = ::write(source_fds_[0], payload.data() + written, payload.size() - written);
+      if (rc > 0) {
+        written += rc;
+      }
+    }
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+    readDestination();
+  }
+
+  void readDestination() {
+    char buffer[16384];
+    ssize_t rc;
+    while ((rc = ::read(destination_fds_[0], buffer, sizeof(buffer))) > 0) {
+      received_.append(buffer, rc);
+    }
+  }
+
+  Event::DispatcherImpl dispatcher_;
+  NiceMock<MockConnection> source_;
+  NiceMock<MockConnection> destination_;
+  int source_fds_[2];
+  int destination_fds_[2];
+  SplicePumpPtr pump_;
+  uint64_t moved_{};
+  std::string received_;
+};
+
+// Moves a payload much larger than the pipe, then hands the source back once the peer closes.
+TEST_F(SplicePumpTest, MovesDataAndHandsBackOnEndOfStream) {
+  createPump(4096);
+
+  std::string payload;
+  for (uint32_t i = 0; payload.size() < 1024 * 1024; i++) {
+    payload.append(std::to_string(i));
+  }
+
+  size_t written = 0;
+  for (uint32_t i = 0; i < 100000 && received_.size() < payload.size(); i++) {
+    pumpOnce(payload, written);
+  }
+  EXPECT_EQ(payload, received_);
+  EXPECT_EQ(payload.size(), moved_);
+  EXPECT_FALSE(pump_->complete());
+
+  EXPECT_CALL(source_, readDisable(false));
+  ::shutdown(source_fds_[0], SHUT_WR);
+  for (uint32_t i = 0; i < 1000 && !pump_->complete(); i++) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_TRUE(pump_->complete());
+  EXPECT_EQ(0U, pump_->pipeBytes());
+}
+
+// Reads stop while the pump is read disabled and resume when it is enabled again.
+TEST_F(SplicePumpTest, ReadDisable) {
+  createPump(0);
+
+  pump_->readDisable(true);
+  pump_->readDisable(true);
+  EXPECT_EQ(5, ::write(source_fds_[0], "hello", 5));
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  readDestination();
+  EXPECT_EQ("", received_);
+
+  pump_->readDisable(false);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  readDestination();
+  EXPECT_EQ("", received_);
+
+  pump_->readDisable(false);
+  for (uint32_t i = 0; i < 1000 && received_.empty(); i++) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+    readDestination();
+  }
+  EXPECT_EQ("hello", received_);
+}
+
+// Destroying an active pump hands the source back to its connection.
+TEST_F(SplicePumpTest, DestroyReleasesSource) {
+  createPump(0);
+
+  EXPECT_CALL(source_, readDisable(false));
+  pump_.reset();
+}
+
+// No pump is created for a connection without a socket.
+TEST_F(SplicePumpTest, ClosedSocket) {
+  ON_CALL(source_, fd()).WillByDefault(Return(-1));
+  EXPECT_CALL(source_, readDisable(_)).Times(0);
+  EXPECT_EQ(nullptr, SplicePump::create(source_, destination_, 0, [](uint64_t) {}));
+}
+
+} // namespace Network
+} // namespace Envoy
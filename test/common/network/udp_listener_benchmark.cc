@@ -0,0 +1,174 @@
+// Usage: bazel run //test/common/network:udp_listener_benchmark
+//
+// Measures datagrams per second through a single worker's UDP listener, which reads with
+// recvmmsg() and writes with sendmmsg(), against a loop that handles the same datagrams with one
+// recvfrom() and one sendto() each. The client runs on the benchmark thread over loopback and
+// sends each burst with sendmmsg() in every case, so differences come from the worker side. The
+// benchmark arguments are the burst size and the datagram size.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_io.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class Client {
+public:
+  Client(const Address::InstanceConstSharedPtr& server_address)
+      : fd_(server_address->socket(Address::SocketType::Datagram)) {
+    RELEASE_ASSERT(fd_ != -1 && server_address->connect(fd_) == 0);
+  }
+  ~Client() { ::close(fd_); }
+
+  void send(uint64_t count, const std::string& payload) {
+    for (uint64_t i = 0; i < count; i++) {
+      Buffer::OwnedImpl data(payload);
+      queue_.add(nullptr, data);
+    }
+    queue_.flush(fd_);
+  }
+
+  // Drain the replies, returning how many there were.
+  uint64_t receive() {
+    uint64_t received = 0;
+    UdpReader::Result result;
+    do {
+      result = reader_.read(fd_, false, [&received](const Address::InstanceConstSharedPtr&,
+                                                    Buffer::InstancePtr&&) { received++; });
+    } while (result.datagrams_ == UdpReader::BatchSize);
+    return received;
+  }
+
+  const int fd_;
+  UdpSendQueue queue_;
+  UdpReader reader_;
+};
+
+class Callbacks : public UdpListenerCallbacks {
+public:
+  // Network::UdpListenerCallbacks
+  void onData(UdpRecvData& data) override {
+    received_++;
+    if (listener_ != nullptr) {
+      listener_->send(data.peer_address_, *data.buffer_);
+    }
+  }
+  void onReadComplete() override {}
+
+  UdpListener* listener_{};
+  uint64_t received_{};
+};
+
+// Run the dispatcher until it has read the expected number of datagrams, or a pass reads nothing
+// because the kernel dropped some of them.
+void drain(Event::Dispatcher& dispatcher, Callbacks& callbacks, uint64_t expected) {
+  while (callbacks.received_ < expected) {
+    const uint64_t before = callbacks.received_;
+    dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+    if (callbacks.received_ == before) {
+      break;
+    }
+  }
+}
+
+void listenerBenchmark(benchmark::State& state, bool echo) {
+  Event::DispatcherImpl dispatcher;
+  UdpListenSocket socket(std::make_shared<Address::Ipv4Instance>("127.0.0.1"), nullptr);
+  Client client(socket.localAddress());
+  Callbacks callbacks;
+  UdpListenerPtr listener = dispatcher.createUdpListener(socket, callbacks);
+  callbacks.listener_ = echo ? listener.get() : nullptr;
+  const uint64_t burst = state.range(0);
+  const std::string payload(state.range(1), 'a');
+
+  uint64_t replies = 0;
+  for (auto _ : state) {
+    client.send(burst, payload);
+    drain(dispatcher, callbacks, callbacks.received_ + burst);
+    if (echo) {
+      replies += client.receive();
+    }
+  }
+  state.counters["lost"] = state.iterations() * burst - (echo ? replies : callbacks.received_);
+  state.SetItemsProcessed(callbacks.received_);
+}
+
+void recvfromBenchmark(benchmark::State& state, bool echo) {
+  UdpListenSocket socket(std::make_shared<Address::Ipv4Instance>("127.0.0.1"), nullptr);
+  Client client(socket.localAddress());
+  const uint64_t burst = state.range(0);
+  const std::string payload(state.range(1), 'a');
+  char buffer[UdpReader::MaxDatagramSize];
+
+  uint64_t received = 0;
+  uint64_t replies = 0;
+  for (auto _ : state) {
+    client.send(burst, payload);
+    for (;;) {
+      sockaddr_storage peer;
+      socklen_t peer_len = sizeof(peer);
+      const ssize_t rc = ::recvfrom(socket.fd(), buffer, sizeof(buffer), MSG_DONTWAIT,
+                                    reinterpret_cast<sockaddr*>(&peer), &peer_len);
+      if (rc == -1) {
+        break;
+      }
+      // Copy into a buffer as the listener hands one to its callbacks.
+      Buffer::OwnedImpl data(buffer, rc);
+      received++;
+      if (echo) {
+        ::sendto(socket.fd(), buffer, data.length(), MSG_DONTWAIT,
+                 reinterpret_cast<sockaddr*>(&peer), peer_len);
+      }
+    }
+    if (echo) {
+      replies += client.receive();
+    }
+  }
+  state.counters["lost"] = state.iterations() * burst - (echo ? replies : received);
+  state.SetItemsProcessed(received);
+}
+
+void BM_UdpListenerReceive(benchmark::State& state) { listenerBenchmark(state, false); }
+BENCHMARK(BM_UdpListenerReceive)->Args({16, 64})->Args({64, 64})->Args({64, 1200});
+
+void BM_RecvfromReceive(benchmark::State& state) { recvfromBenchmark(state, false); }
+BENCHMARK(BM_RecvfromReceive)->Args({16, 64})->Args({64, 64})->Args({64, 1200});
+
+void BM_UdpListenerEcho(benchmark::State& state) { listenerBenchmark(state, true); }
+BENCHMARK(BM_UdpListenerEcho)->Args({16, 64})->Args({64, 64})->Args({64, 1200});
+
+void BM_RecvfromEcho(benchmark::State& state) { recvfromBenchmark(state, true); }
+BENCHMARK(BM_RecvfromEcho)->Args({16, 64})->Args({64, 64})->Args({64, 1200});
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
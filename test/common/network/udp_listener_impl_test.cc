@@ -0,0 +1,170 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_io.h"
+#include "common/network/udp_listener_impl.h"
+#include "common/network/utility.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::_;
+
+namespace Envoy {
+namespace Network {
+
+class UdpListenerImplTest : public testing::TestWithParam<Address::IpVersion> {
+protected:
+  UdpListenerImplTest()
+      : server_socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr),
+        stats_{stats_store_.counter("rx_datagrams"), stats_store_.counter("rx_datagrams_truncated"),
+               stats_store_.counter("tx_datagrams"), stats_store_.counter("tx_datagrams_dropped"),
+               stats_store_.histogram("rx_batch_size")} {
+    auto client = Network::Test::bindFreeLoopbackPort(GetParam(), Address::SocketType::Datagram);
+    client_address_ = client.first;
+    client_fd_ = client.second;
+    listener_ = dispatcher_.createUdpListener(server_socket_, listener_callbacks_);
+    listener_->setStats(stats_);
+  }
+
+  ~UdpListenerImplTest() { ::close(client_fd_); }
+
+  void clientSend(const std::string& payload) {
+    Buffer::OwnedImpl data(payload);
+    UdpSendQueue queue;
+    queue.add(server_socket_.localAddress(), data);
+    EXPECT_EQ(1, queue.flush(client_fd_).datagrams_);
+  }
+
+  std::vector<std::string> clientReceive() {
+    std::vector<std::string> payloads;
+    UdpReader reader;
+    while (reader
+               .read(client_fd_, true,
+                     [&](const Address::InstanceConstSharedPtr& peer_address,
+                         Buffer::InstancePtr&& buffer) {
+                       EXPECT_EQ(*server_socket_.localAddress(), *peer_address);
+                       payloads.push_back(TestUtility::bufferToString(*buffer));
+                     })
+               .datagrams_ == UdpReader::BatchSize) {
+    }
+    return payloads;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  Event::DispatcherImpl dispatcher_;
+  UdpListenSocket server_socket_;
+  UdpListener::UdpStats stats_;
+  Address::InstanceConstSharedPtr client_address_;
+  int client_fd_;
+  MockUdpListenerCallbacks listener_callbacks_;
+  UdpListenerPtr listener_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpListenerImplTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Datagrams that are already queued are read in batches and delivered in a single pass, with one
+// onReadComplete() at the end.
+TEST_P(UdpListenerImplTest, ReceiveBatch) {
+  const uint32_t count = UdpReader::BatchSize + 4;
+  for (uint32_t i = 0; i < count; i++) {
+    clientSend(std::to_string(i));
+  }
+
+  std::vector<std::string> received;
+  EXPECT_CALL(listener_callbacks_, onData(_))
+      .Times(count)
+      .WillRepeatedly(Invoke([&](UdpRecvData& data) -> void {
+        EXPECT_EQ(*server_socket_.localAddress(), *data.local_address_);
+        EXPECT_EQ(*client_address_, *data.peer_address_);
+        received.push_back(TestUtility::bufferToString(*data.buffer_));
+      }));
+  EXPECT_CALL(listener_callbacks_, onReadComplete());
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  ASSERT_EQ(count, received.size());
+  for (uint32_t i = 0; i < count; i++) {
+    EXPECT_EQ(std::to_string(i), received[i]);
+  }
+  EXPECT_EQ(count, stats_store_.counter("rx_datagrams").value());
+  EXPECT_EQ(0, stats_store_.counter("rx_datagrams_truncated").value());
+}
+
+// Replies queued from the callbacks are written once the batch is complete.
+TEST_P(UdpListenerImplTest, Echo) {
+  clientSend("hello");
+  clientSend("world");
+
+  EXPECT_CALL(listener_callbacks_, onData(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](UdpRecvData& data) -> void {
+        listener_->send(data.peer_address_, *data.buffer_);
+        EXPECT_EQ(0, data.buffer_->length());
+      }));
+  EXPECT_CALL(listener_callbacks_, onReadComplete());
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  EXPECT_EQ((std::vector<std::string>{"hello", "world"}), clientReceive());
+  EXPECT_EQ(2, stats_store_.counter("tx_datagrams").value());
+  EXPECT_EQ(0, stats_store_.counter("tx_datagrams_dropped").value());
+}
+
+// Datagrams can also be sent outside of a read pass, and made of several slices.
+TEST_P(UdpListenerImplTest, SendAndFlush) {
+  Buffer::OwnedImpl data("hello ");
+  Buffer::OwnedImpl more("world");
+  data.move(more);
+  listener_->send(client_address_, data);
+  listener_->flush();
+
+  EXPECT_EQ(std::vector<std::string>{"hello world"}, clientReceive());
+  EXPECT_EQ(1, stats_store_.counter("tx_datagrams").value());
+}
+
+// Datagrams larger than the read buffers are dropped.
+TEST_P(UdpListenerImplTest, Truncated) {
+  clientSend(std::string(UdpReader::MaxDatagramSize + 1, 'a'));
+  clientSend("ok");
+
+  EXPECT_CALL(listener_callbacks_, onData(_)).WillOnce(Invoke([&](UdpRecvData& data) -> void {
+    EXPECT_EQ("ok", TestUtility::bufferToString(*data.buffer_));
+  }));
+  EXPECT_CALL(listener_callbacks_, onReadComplete());
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  EXPECT_EQ(1, stats_store_.counter("rx_datagrams").value());
+  EXPECT_EQ(1, stats_store_.counter("rx_datagrams_truncated").value());
+}
+
+// A disabled listener leaves datagrams in the socket until it is enabled again.
+TEST_P(UdpListenerImplTest, DisableEnable) {
+  listener_->disable();
+  clientSend("hello");
+
+  EXPECT_CALL(listener_callbacks_, onData(_)).Times(0);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  listener_->enable();
+  EXPECT_CALL(listener_callbacks_, onData(_));
+  EXPECT_CALL(listener_callbacks_, onReadComplete());
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+}
+
+} // namespace Network
+} // namespace Envoy
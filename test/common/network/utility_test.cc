@@ -1,3 +1,6 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <cstdint>
 #include <list>
 #include <string>
@@ -60,6 +63,10 @@ TEST(NetworkUtility, resolveUrl) {
   EXPECT_EQ("[1::2:3]:4", Utility::resolveUrl("tcp://[1::2:3]:4")->asString());
   EXPECT_EQ("[a::1]:0", Utility::resolveUrl("tcp://[a::1]:0")->asString());
   EXPECT_EQ("[a:b:c:d::]:0", Utility::resolveUrl("tcp://[a:b:c:d::]:0")->asString());
+
+  EXPECT_EQ("1.2.3.4:1234", Utility::resolveUrl("udp://1.2.3.4:1234")->asString());
+  EXPECT_EQ("[::1]:1", Utility::resolveUrl("udp://[::1]:1")->asString());
+  EXPECT_THROW(Utility::resolveUrl("udp://foo:0"), EnvoyException);
 }
 
 TEST(NetworkUtility, ParseInternetAddress) {
@@ -132,6 +139,18 @@ TEST_P(NetworkUtilityGetLocalAddress, GetLocalAddress) {
 
 TEST(NetworkUtility, GetOriginalDst) { EXPECT_EQ(nullptr, Utility::getOriginalDst(-1)); }
 
+TEST(NetworkUtility, AttachReusePortCpuSteering) {
+  EXPECT_FALSE(Utility::attachReusePortCpuSteering(-1, 2));
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_NE(-1, fd);
+  int on = 1;
+  ASSERT_EQ(0, setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)));
+  EXPECT_TRUE(Utility::attachReusePortCpuSteering(fd, 2));
+  close(fd);
+#endif
+}
+
 TEST(NetworkUtility, InternalAddress) {
   EXPECT_TRUE(Utility::isInternalAddress(Address::Ipv4Instance("127.0.0.1")));
   EXPECT_TRUE(Utility::isInternalAddress(Address::Ipv4Instance("10.0.0.1")));
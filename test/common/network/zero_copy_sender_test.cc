@@ -0,0 +1,251 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/zero_copy_sender.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::ReturnPointee;
+using testing::_;
+
+namespace Envoy {
+namespace Network {
+
+class ZeroCopySenderTest : public testing::Test {
+public:
+  ZeroCopySenderTest() {
+    // Connect a pair of loopback TCP sockets. Only TCP supports SO_ZEROCOPY.
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_length = sizeof(address);
+    EXPECT_EQ(0, ::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length));
+    EXPECT_EQ(0, ::listen(listener, 1));
+    EXPECT_EQ(0, ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_length));
+
+    fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(0, ::connect(fd_, reinterpret_cast<sockaddr*>(&address), address_length));
+    peer_fd_ = ::accept(listener, nullptr, nullptr);
+    ::close(listener);
+    ::fcntl(fd_, F_SETFL, O_NONBLOCK);
+    ::fcntl(peer_fd_, F_SETFL, O_NONBLOCK);
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&now_));
+  }
+
+  ~ZeroCopySenderTest() {
+    ZeroCopySender::onDispatcherDestroyed(dispatcher_);
+    sender_.reset();
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+    ::close(peer_fd_);
+  }
+
+  void readPeer() {
+    char buffer[16384];
+    ssize_t rc;
+    while ((rc = ::read(peer_fd_, buffer, sizeof(buffer))) > 0) {
+      received_.append(buffer, rc);
+    }
+  }
+
+  // Adds payload to buffer through a fragment so the test can see when the memory is released.
+  void addPayload(Buffer::OwnedImpl& buffer, const std::string& payload) {
+    fragment_ = std::make_unique<Buffer::BufferFragmentImpl>(
+        payload.data(), payload.size(),
+        [this](const void*, size_t, const Buffer::BufferFragmentImpl*) { released_ = true; });
+    buffer.addBufferFragment(*fragment_);
+  }
+
+  // Fill the socket so that the peer has to read before the sends can complete.
+  void sendUntilBlocked(Buffer::OwnedImpl& buffer, const std::string& payload) {
+    // A small receive window keeps most of the payload queued on the sending socket.
+    const int window = 4096;
+    ::setsockopt(peer_fd_, SOL_SOCKET, SO_RCVBUF, &window, sizeof(window));
+    addPayload(buffer, payload);
+    while ((rc_ = sender_->send(buffer)) > 0) {
+      sent_ += rc_;
+    }
+  }
+
+  int fd_;
+  int peer_fd_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
+  ZeroCopySenderPtr sender_;
+  int sent_{};
+  int rc_{};
+  std::unique_ptr<Buffer::BufferFragmentImpl> fragment_;
+  bool released_{};
+  std::string received_;
+};
+
+// Sent memory is held until the kernel reports the send complete.
+TEST_F(ZeroCopySenderTest, RetainsUntilComplete) {
+  sender_ = ZeroCopySender::create(fd_);
+  if (sender_ == nullptr) {
+    // The kernel predates SO_ZEROCOPY.
+    return;
+  }
+
+  const std::string payload(65536, 'a');
+  Buffer::OwnedImpl buffer;
+  addPayload(buffer, payload);
+  ASSERT_EQ(static_cast<int>(payload.size()), sender_->send(buffer));
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(1U, sender_->pendingSends());
+
+  for (uint32_t i = 0; i < 1000 && sender_->pendingSends() > 0; i++) {
+    readPeer();
+    struct pollfd poll_fd = {fd_, 0, 0};
+    ::poll(&poll_fd, 1, 10);
+    EXPECT_FALSE(released_ && sender_->pendingSends() > 0);
+    sender_->reap();
+  }
+  EXPECT_EQ(0U, sender_->pendingSends());
+  EXPECT_TRUE(released_);
+  readPeer();
+  EXPECT_EQ(payload, received_);
+}
+
+// A released sender keeps the memory of outstanding sends alive after the owner closes the socket,
+// and the peer still receives everything followed by end of stream.
+TEST_F(ZeroCopySenderTest, LingersAfterRelease) {
+  sender_ = ZeroCopySender::create(fd_);
+  if (sender_ == nullptr) {
+    return;
+  }
+
+  std::string payload;
+  for (uint32_t i = 0; payload.size() < 64 * 1024; i++) {
+    payload.append(std::to_string(i));
+  }
+  std::unique_ptr<Buffer::OwnedImpl> buffer = std::make_unique<Buffer::OwnedImpl>();
+  sendUntilBlocked(*buffer, payload);
+  ASSERT_GT(sent_, 0);
+  const std::string expected = payload.substr(0, sent_);
+
+  Event::MockTimer* sweep_timer = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*sweep_timer, enableTimer(std::chrono::milliseconds(1000)));
+  ZeroCopySender::release(std::move(sender_), dispatcher_, time_source_);
+  EXPECT_EQ(1U, ZeroCopySender::lingeringSenders());
+  ::close(fd_);
+  fd_ = -1;
+  buffer.reset();
+  EXPECT_FALSE(released_);
+
+  bool end_stream = false;
+  for (uint32_t i = 0; i < 10000 && !end_stream; i++) {
+    char chunk[16384];
+    const ssize_t read_rc = ::read(peer_fd_, chunk, sizeof(chunk));
+    if (read_rc > 0) {
+      received_.append(chunk, read_rc);
+    } else if (read_rc == 0) {
+      end_stream = true;
+    } else {
+      struct pollfd poll_fd = {peer_fd_, POLLIN, 0};
+      ::poll(&poll_fd, 1, 10);
+    }
+  }
+  EXPECT_TRUE(end_stream);
+  EXPECT_EQ(expected, received_);
+
+  // Creating another sender sweeps the lingering one once its sends have completed.
+  EXPECT_CALL(*sweep_timer, disableTimer());
+  int other_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  for (uint32_t i = 0; i < 1000 && ZeroCopySender::lingeringSenders() > 0; i++) {
+    ::usleep(1000);
+    ZeroCopySender::create(other_fd);
+  }
+  ::close(other_fd);
+  EXPECT_EQ(0U, ZeroCopySender::lingeringSenders());
+  EXPECT_TRUE(released_);
+}
+
+// A released sender with nothing outstanding is freed immediately.
+TEST_F(ZeroCopySenderTest, ReleaseIdle) {
+  sender_ = ZeroCopySender::create(fd_);
+  if (sender_ == nullptr) {
+    return;
+  }
+
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
+  ZeroCopySender::release(std::move(sender_), dispatcher_, time_source_);
+  EXPECT_EQ(0U, ZeroCopySender::lingeringSenders());
+}
+
+// The dispatcher's timer sweeps lingering senders without any further senders being created or
+// released, and resets the sockets whose sends do not complete in time.
+TEST_F(ZeroCopySenderTest, SweptByTimer) {
+  sender_ = ZeroCopySender::create(fd_);
+  if (sender_ == nullptr) {
+    return;
+  }
+
+  Buffer::OwnedImpl buffer;
+  sendUntilBlocked(buffer, std::string(1024 * 1024, 'a'));
+  ASSERT_GT(sent_, 0);
+  buffer.drain(buffer.length());
+
+  Event::MockTimer* sweep_timer = new Event::MockTimer(&dispatcher_);
+  EXPECT_CALL(*sweep_timer, enableTimer(std::chrono::milliseconds(1000)));
+  ZeroCopySender::release(std::move(sender_), dispatcher_, time_source_);
+  ASSERT_EQ(1U, ZeroCopySender::lingeringSenders());
+  ::close(fd_);
+  fd_ = -1;
+
+  // The peer does not read, so the sends cannot complete and the timer keeps sweeping.
+  now_ += std::chrono::seconds(5);
+  EXPECT_CALL(*sweep_timer, enableTimer(std::chrono::milliseconds(1000)));
+  sweep_timer->callback_();
+  EXPECT_EQ(1U, ZeroCopySender::lingeringSenders());
+  EXPECT_FALSE(released_);
+
+  // Past the timeout the socket is reset and the memory released.
+  now_ += std::chrono::seconds(5);
+  EXPECT_CALL(*sweep_timer, disableTimer());
+  sweep_timer->callback_();
+  EXPECT_EQ(0U, ZeroCopySender::lingeringSenders());
+  EXPECT_TRUE(released_);
+
+  bool reset = false;
+  for (uint32_t i = 0; i < 1000 && !reset; i++) {
+    char chunk[16384];
+    const ssize_t read_rc = ::read(peer_fd_, chunk, sizeof(chunk));
+    if (read_rc == -1 && errno == EAGAIN) {
+      struct pollfd poll_fd = {peer_fd_, POLLIN, 0};
+      ::poll(&poll_fd, 1, 10);
+    } else if (read_rc <= 0) {
+      reset = read_rc == -1 && errno == ECONNRESET;
+      break;
+    }
+  }
+  EXPECT_TRUE(reset);
+}
+
+// Sockets other than TCP do not support zero copy.
+TEST(ZeroCopySenderUnsupportedTest, UnixSocket) {
+  int fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  EXPECT_EQ(nullptr, ZeroCopySender::create(fds[0]));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+} // namespace Network
+} // namespace Envoy
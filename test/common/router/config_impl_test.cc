@@ -1987,6 +1987,51 @@ TEST(RouteMatcherTest, Shadow) {
                     .runtimeKey());
 }
 
+TEST(RouteMatcherTest, RequestCoalescing) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: www2
+    domains: ["www.lyft.com"]
+    routes:
+      - match: { prefix: "/foo" }
+        route:
+          cluster: www2
+          request_coalescing: {}
+      - match: { prefix: "/bar" }
+        route:
+          cluster: www2
+          request_coalescing:
+            max_waiters: 10
+            max_wait: 0.5s
+      - match: { prefix: "/baz" }
+        route:
+          cluster: www2
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+
+  const RequestCoalescingPolicy* policy =
+      config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
+          ->routeEntry()
+          ->requestCoalescingPolicy();
+  ASSERT_NE(nullptr, policy);
+  EXPECT_EQ(1000U, policy->maxWaiters());
+  EXPECT_EQ(std::chrono::milliseconds(5000), policy->maxWait());
+
+  policy = config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
+               ->routeEntry()
+               ->requestCoalescingPolicy();
+  ASSERT_NE(nullptr, policy);
+  EXPECT_EQ(10U, policy->maxWaiters());
+  EXPECT_EQ(std::chrono::milliseconds(500), policy->maxWait());
+
+  EXPECT_EQ(nullptr, config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)
+                         ->routeEntry()
+                         ->requestCoalescingPolicy());
+}
+
 TEST(RouteMatcherTest, Retry) {
   std::string json = R"EOF(
 {
@@ -2070,6 +2115,54 @@ TEST(RouteMatcherTest, Retry) {
                 .retryOn());
 }
 
+TEST(RouteMatcherTest, HedgePolicy) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: www2
+    domains: ["www.lyft.com"]
+    routes:
+      - match: { prefix: "/foo" }
+        route:
+          cluster: www2
+          retry_policy:
+            hedge_policy: { delay: 0.05s }
+      - match: { prefix: "/bar" }
+        route:
+          cluster: www2
+          retry_policy:
+            retry_on: 5xx
+            hedge_policy:
+              delay: 0.1s
+              latency_percentile: 99.5
+      - match: { prefix: "/baz" }
+        route:
+          cluster: www2
+          retry_policy:
+            retry_on: 5xx
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+
+  const RetryPolicy& foo_policy =
+      config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)->routeEntry()->retryPolicy();
+  EXPECT_EQ(std::chrono::milliseconds(50), foo_policy.hedgeDelay());
+  EXPECT_EQ(0, foo_policy.hedgeLatencyPercentile());
+  EXPECT_EQ(0U, foo_policy.retryOn());
+
+  const RetryPolicy& bar_policy =
+      config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->retryPolicy();
+  EXPECT_EQ(std::chrono::milliseconds(100), bar_policy.hedgeDelay());
+  EXPECT_EQ(99.5, bar_policy.hedgeLatencyPercentile());
+  EXPECT_EQ(RetryPolicy::RETRY_ON_5XX, bar_policy.retryOn());
+
+  const RetryPolicy& baz_policy =
+      config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)->routeEntry()->retryPolicy();
+  EXPECT_EQ(std::chrono::milliseconds(0), baz_policy.hedgeDelay());
+  EXPECT_EQ(0, baz_policy.hedgeLatencyPercentile());
+}
+
 TEST(RouteMatcherTest, GrpcRetry) {
   std::string json = R"EOF(
 {
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdint>
+
+#include "common/router/latency_estimator.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+
+TEST(LatencyEstimatorTest, NoEstimateUntilEnoughSamples) {
+  LatencyEstimator estimator;
+  for (uint32_t i = 0; i < LatencyEstimator::MIN_SAMPLES - 1; i++) {
+    estimator.addSample(std::chrono::milliseconds(10));
+  }
+  EXPECT_FALSE(estimator.percentile(50));
+  estimator.addSample(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::chrono::milliseconds(11), estimator.percentile(50).value());
+}
+
+TEST(LatencyEstimatorTest, Percentiles) {
+  LatencyEstimator estimator;
+  // 1ms to 100ms, once each.
+  for (uint32_t i = 1; i <= 100; i++) {
+    estimator.addSample(std::chrono::milliseconds(i));
+  }
+
+  // Small values are exact, and larger ones at most a quarter above the actual percentile.
+  EXPECT_EQ(std::chrono::milliseconds(1), estimator.percentile(1).value());
+  EXPECT_EQ(std::chrono::milliseconds(3), estimator.percentile(3).value());
+  EXPECT_EQ(std::chrono::milliseconds(55), estimator.percentile(50).value());
+  EXPECT_EQ(std::chrono::milliseconds(111), estimator.percentile(99).value());
+  EXPECT_EQ(std::chrono::milliseconds(111), estimator.percentile(100).value());
+  for (double percentile = 1; percentile <= 100; percentile++) {
+    const uint64_t estimate = estimator.percentile(percentile).value().count();
+    EXPECT_LE(percentile, estimate);
+    EXPECT_LE(estimate, percentile * 1.25);
+  }
+}
+
+TEST(LatencyEstimatorTest, ZeroAndNegative) {
+  LatencyEstimator estimator;
+  for (uint32_t i = 0; i < LatencyEstimator::MIN_SAMPLES; i++) {
+    estimator.addSample(std::chrono::milliseconds(i % 2 == 0 ? 0 : -5));
+  }
+  EXPECT_EQ(std::chrono::milliseconds(0), estimator.percentile(100).value());
+}
+
+// Old samples weigh less than recent ones.
+TEST(LatencyEstimatorTest, Decay) {
+  LatencyEstimator estimator;
+  for (uint32_t i = 0; i < LatencyEstimator::DECAY_SAMPLES; i++) {
+    estimator.addSample(std::chrono::milliseconds(1000));
+  }
+  EXPECT_EQ(std::chrono::milliseconds(1023), estimator.percentile(50).value());
+
+  // After a decay, the old samples count half as much as the new ones, which become the majority
+  // before as many new samples as old ones have been added.
+  for (uint32_t i = 0; i < LatencyEstimator::DECAY_SAMPLES * 3 / 4; i++) {
+    estimator.addSample(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(std::chrono::milliseconds(11), estimator.percentile(50).value());
+  EXPECT_EQ(std::chrono::milliseconds(1023), estimator.percentile(75).value());
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -19,6 +19,7 @@
 #include "test/mocks/router/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/printers.h"
@@ -183,6 +184,7 @@ public:
   NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
   MockShadowWriter* shadow_writer_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
   FilterConfig config_;
   TestFilter router_;
   Event::MockTimer* response_timeout_{};
@@ -2129,6 +2131,555 @@ TEST_F(RouterTest, AutoHostRewriteDisabled) {
   router_.decodeHeaders(incoming_headers, true);
 }
 
+class RouterCoalescingTest : public RouterTest {
+public:
+  RouterCoalescingTest() : waiter_(config_) {
+    config_.enableRequestCoalescing(tls_);
+    waiter_.setDecoderFilterCallbacks(waiter_callbacks_);
+    waiter_.downstream_connection_.local_address_ = host_address_;
+    waiter_.downstream_connection_.remote_address_ =
+        Network::Utility::parseInternetAddressAndPort("1.2.3.5:80");
+    ON_CALL(callbacks_.route_->route_entry_, requestCoalescingPolicy())
+        .WillByDefault(Return(&policy_));
+    ON_CALL(waiter_callbacks_.route_->route_entry_, requestCoalescingPolicy())
+        .WillByDefault(Return(&policy_));
+  }
+
+  // Send the request of router_ upstream, which makes it the one identical requests wait for.
+  void sendLeaderRequest() {
+    EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+        .WillOnce(Invoke(
+            [&](Http::StreamDecoder& decoder,
+                Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+              response_decoder_ = &decoder;
+              callbacks.onPoolReady(encoder_, cm_.conn_pool_.host_);
+              return nullptr;
+            }));
+    expectResponseTimerCreate();
+    HttpTestUtility::addDefaultHeaders(headers_);
+    router_.decodeHeaders(headers_, true);
+  }
+
+  void joinWaiter() {
+    coalescing_timeout_ = new Event::MockTimer(&waiter_callbacks_.dispatcher_);
+    EXPECT_CALL(*coalescing_timeout_, enableTimer(std::chrono::milliseconds(5000)));
+    HttpTestUtility::addDefaultHeaders(waiter_headers_);
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              waiter_.decodeHeaders(waiter_headers_, true));
+  }
+
+  // Expect the waiter to send its own request upstream.
+  void expectWaiterRequest() {
+    EXPECT_CALL(cm_.conn_pool_, newStream(_, _)).WillOnce(Return(&cancellable_));
+    Event::MockTimer* response_timeout = new Event::MockTimer(&waiter_callbacks_.dispatcher_);
+    EXPECT_CALL(*response_timeout, enableTimer(_));
+    EXPECT_CALL(*response_timeout, disableTimer());
+  }
+
+  TestRequestCoalescingPolicy policy_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> waiter_callbacks_;
+  TestFilter waiter_;
+  NiceMock<Http::MockStreamEncoder> encoder_;
+  Http::StreamDecoder* response_decoder_{};
+  Http::TestHeaderMapImpl headers_;
+  Http::TestHeaderMapImpl waiter_headers_;
+  Event::MockTimer* coalescing_timeout_{};
+};
+
+// An identical request gets the response of the request in flight, without going upstream.
+TEST_F(RouterCoalescingTest, CoalescedResponse) {
+  sendLeaderRequest();
+  joinWaiter();
+  EXPECT_EQ(1U, config_.stats_.rq_coalesced_.value());
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer()).Times(2);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("200", headers.Status()->value().c_str());
+      }));
+  EXPECT_CALL(waiter_callbacks_.route_->route_entry_, finalizeResponseHeaders(_, _));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, false);
+
+  std::string leader_body;
+  std::string waiter_body;
+  EXPECT_CALL(callbacks_, encodeData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        leader_body = TestUtility::bufferToString(data);
+      }));
+  EXPECT_CALL(waiter_callbacks_, encodeData(_, false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        waiter_body = TestUtility::bufferToString(data);
+        data.drain(data.length());
+      }));
+  Buffer::OwnedImpl data("hello");
+  response_decoder_->decodeData(data, false);
+  EXPECT_EQ("hello", leader_body);
+  EXPECT_EQ("hello", waiter_body);
+
+  EXPECT_CALL(callbacks_, encodeTrailers_(_));
+  EXPECT_CALL(waiter_callbacks_, encodeTrailers_(_));
+  response_decoder_->decodeTrailers(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{"some", "trailer"}}});
+
+  router_.onDestroy();
+  waiter_.onDestroy();
+}
+
+TEST_F(RouterCoalescingTest, Overflow) {
+  policy_.max_waiters_ = 1;
+  sendLeaderRequest();
+  joinWaiter();
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> overflow_callbacks;
+  TestFilter overflow(config_);
+  overflow.setDecoderFilterCallbacks(overflow_callbacks);
+  ON_CALL(overflow_callbacks.route_->route_entry_, requestCoalescingPolicy())
+      .WillByDefault(Return(&policy_));
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _)).WillOnce(Return(&cancellable_));
+  Event::MockTimer* response_timeout = new Event::MockTimer(&overflow_callbacks.dispatcher_);
+  EXPECT_CALL(*response_timeout, enableTimer(_));
+  EXPECT_CALL(*response_timeout, disableTimer());
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  overflow.decodeHeaders(headers, true);
+  EXPECT_EQ(1U, config_.stats_.rq_coalesced_.value());
+  EXPECT_EQ(1U, config_.stats_.rq_coalesced_overflow_.value());
+
+  EXPECT_CALL(cancellable_, cancel());
+  overflow.onDestroy();
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  waiter_.onDestroy();
+  router_.onDestroy();
+}
+
+// A request that has waited too long goes upstream itself.
+TEST_F(RouterCoalescingTest, WaitTimeout) {
+  sendLeaderRequest();
+  joinWaiter();
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  expectWaiterRequest();
+  coalescing_timeout_->callback_();
+  EXPECT_EQ(1U, config_.stats_.rq_coalesced_timeout_.value());
+
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+
+  router_.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// A response that is specific to the client is not shared, and the waiters go upstream.
+TEST_F(RouterCoalescingTest, ResponseNotShared) {
+  EXPECT_TRUE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "public, max-age=60"}}));
+  EXPECT_FALSE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60, private"}}));
+  EXPECT_FALSE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "no-store"}}));
+  EXPECT_FALSE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "no-cache"}}));
+  EXPECT_FALSE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "accept-encoding, *"}}));
+  EXPECT_TRUE(FilterUtility::shareableResponse(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "accept-encoding"}}));
+
+  sendLeaderRequest();
+  joinWaiter();
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  expectWaiterRequest();
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}, {"set-cookie", "a=b"}}},
+      true);
+
+  router_.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// A no-cache response must be revalidated for each request, so it is not shared.
+TEST_F(RouterCoalescingTest, NoCacheResponseNotShared) {
+  sendLeaderRequest();
+  joinWaiter();
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  expectWaiterRequest();
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"},
+                                                     {"cache-control", "no-cache"}}},
+      true);
+
+  router_.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// Requests with cookies may get personalized responses, so they always go upstream themselves.
+TEST_F(RouterCoalescingTest, CookieNotCoalesced) {
+  EXPECT_FALSE(FilterUtility::coalescable(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {"cookie", "session=secret"}}));
+
+  sendLeaderRequest();
+  waiter_headers_.addCopy("cookie", "session=secret");
+  HttpTestUtility::addDefaultHeaders(waiter_headers_);
+  expectWaiterRequest();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter_.decodeHeaders(waiter_headers_, true));
+  EXPECT_EQ(0U, config_.stats_.rq_coalesced_.value());
+
+  router_.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// Requests for the same authority and path over different downstream schemes are not coalesced.
+TEST_F(RouterCoalescingTest, SchemeMismatchNotCoalesced) {
+  Http::TestHeaderMapImpl http_headers{
+      {":scheme", "http"}, {"x-forwarded-proto", "http"}, {":authority", "host"}, {":path", "/"}};
+  Http::TestHeaderMapImpl https_headers{
+      {":scheme", "http"}, {"x-forwarded-proto", "https"}, {":authority", "host"}, {":path", "/"}};
+  EXPECT_NE(FilterUtility::coalescingKey("cluster", http_headers),
+            FilterUtility::coalescingKey("cluster", https_headers));
+
+  headers_.addCopy("x-forwarded-proto", "http");
+  sendLeaderRequest();
+  waiter_headers_.addCopy("x-forwarded-proto", "https");
+  HttpTestUtility::addDefaultHeaders(waiter_headers_);
+  expectWaiterRequest();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter_.decodeHeaders(waiter_headers_, true));
+  EXPECT_EQ(0U, config_.stats_.rq_coalesced_.value());
+
+  router_.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// A response that varies on a header gets shared with the waiters whose value of it matches, and
+// the others go upstream themselves.
+TEST_F(RouterCoalescingTest, VaryMismatchNotShared) {
+  EXPECT_TRUE(FilterUtility::varyMatches(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "Accept-Encoding, Accept-Language"}},
+      Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}},
+      Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}}));
+  EXPECT_FALSE(FilterUtility::varyMatches(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "Accept-Encoding"}},
+      Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}}, Http::TestHeaderMapImpl{}));
+  EXPECT_FALSE(FilterUtility::varyMatches(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "accept-language"}},
+      Http::TestHeaderMapImpl{{"accept-language", "en"}},
+      Http::TestHeaderMapImpl{{"accept-language", "fr"}}));
+
+  headers_.addCopy("accept-encoding", "gzip");
+  sendLeaderRequest();
+  joinWaiter();
+
+  // A second waiter that accepts the same encoding as the leader.
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> gzip_callbacks;
+  TestFilter gzip_waiter(config_);
+  gzip_waiter.setDecoderFilterCallbacks(gzip_callbacks);
+  ON_CALL(gzip_callbacks.route_->route_entry_, requestCoalescingPolicy())
+      .WillByDefault(Return(&policy_));
+  Event::MockTimer* gzip_timeout = new Event::MockTimer(&gzip_callbacks.dispatcher_);
+  EXPECT_CALL(*gzip_timeout, enableTimer(_));
+  Http::TestHeaderMapImpl gzip_headers{{"accept-encoding", "gzip"}};
+  HttpTestUtility::addDefaultHeaders(gzip_headers);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            gzip_waiter.decodeHeaders(gzip_headers, true));
+  EXPECT_EQ(2U, config_.stats_.rq_coalesced_.value());
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  expectWaiterRequest();
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(*gzip_timeout, disableTimer());
+  EXPECT_CALL(gzip_callbacks, encodeHeaders_(_, true));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{
+          {":status", "200"}, {"content-encoding", "gzip"}, {"vary", "accept-encoding"}}},
+      true);
+
+  router_.onDestroy();
+  gzip_waiter.onDestroy();
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// Waiters go upstream when the request they wait for ends before its response starts.
+TEST_F(RouterCoalescingTest, LeaderResetBeforeResponse) {
+  sendLeaderRequest();
+  joinWaiter();
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer());
+  expectWaiterRequest();
+  router_.onDestroy();
+
+  EXPECT_CALL(cancellable_, cancel());
+  waiter_.onDestroy();
+}
+
+// Waiters are reset when the request they wait for fails after its response has started.
+TEST_F(RouterCoalescingTest, LeaderResetAfterResponseStarted) {
+  sendLeaderRequest();
+  joinWaiter();
+
+  EXPECT_CALL(*coalescing_timeout_, disableTimer()).Times(2);
+  EXPECT_CALL(waiter_callbacks_, encodeHeaders_(_, false));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, false);
+
+  EXPECT_CALL(waiter_callbacks_, resetStream());
+  EXPECT_CALL(callbacks_, resetStream());
+  encoder_.stream_.resetStream(Http::StreamResetReason::RemoteReset);
+
+  router_.onDestroy();
+  waiter_.onDestroy();
+}
+
+class RouterHedgingTest : public RouterTest {
+public:
+  RouterHedgingTest() {
+    callbacks_.route_->route_entry_.retry_policy_.hedge_delay_ = std::chrono::milliseconds(50);
+    ON_CALL(*hedge_conn_pool_.host_, address()).WillByDefault(Return(host_address_));
+  }
+
+  // Send a complete request upstream, expecting a hedge to be scheduled after hedge_delay.
+  void sendRequest(std::chrono::milliseconds hedge_delay = std::chrono::milliseconds(50)) {
+    EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+        .WillOnce(Invoke(
+            [&](Http::StreamDecoder& decoder,
+                Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+              response_decoder_ = &decoder;
+              callbacks.onPoolReady(encoder_, cm_.conn_pool_.host_);
+              return nullptr;
+            }));
+    // The hedge timer is created after the response timer.
+    hedge_timer_ = new Event::MockTimer(&callbacks_.dispatcher_);
+    EXPECT_CALL(*hedge_timer_, enableTimer(hedge_delay));
+    EXPECT_CALL(*hedge_timer_, disableTimer());
+    expectResponseTimerCreate();
+    HttpTestUtility::addDefaultHeaders(headers_);
+    router_.decodeHeaders(headers_, true);
+  }
+
+  // Fire the hedge timer, expecting the hedge to go to another host.
+  void sendHedge() {
+    EXPECT_CALL(cm_, httpConnPoolForCluster(_, _, _, _)).WillOnce(Return(&hedge_conn_pool_));
+    EXPECT_CALL(hedge_conn_pool_, newStream(_, _))
+        .WillOnce(Invoke(
+            [&](Http::StreamDecoder& decoder,
+                Http::ConnectionPool::Callbacks& callbacks) -> Http::ConnectionPool::Cancellable* {
+              hedge_response_decoder_ = &decoder;
+              callbacks.onPoolReady(hedge_encoder_, hedge_conn_pool_.host_);
+              return nullptr;
+            }));
+    EXPECT_CALL(hedge_encoder_, encodeHeaders(_, true));
+    hedge_timer_->callback_();
+    EXPECT_EQ(1U, clusterCounter("upstream_rq_hedge"));
+  }
+
+  uint64_t clusterCounter(const std::string& name) {
+    return cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter(name).value();
+  }
+
+  Upstream::Resource& hedges() {
+    return cm_.thread_local_cluster_.cluster_.info_->resource_manager_->retries();
+  }
+
+  NiceMock<Http::ConnectionPool::MockInstance> hedge_conn_pool_;
+  NiceMock<Http::MockStreamEncoder> encoder_;
+  NiceMock<Http::MockStreamEncoder> hedge_encoder_;
+  Http::StreamDecoder* response_decoder_{};
+  Http::StreamDecoder* hedge_response_decoder_{};
+  Http::TestHeaderMapImpl headers_;
+  Event::MockTimer* hedge_timer_{};
+};
+
+// The first attempt responds first, and the hedge is reset.
+TEST_F(RouterHedgingTest, FirstAttemptWins) {
+  sendRequest();
+  sendHedge();
+  EXPECT_FALSE(hedges().canCreate());
+
+  EXPECT_CALL(hedge_encoder_.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+  EXPECT_EQ(0U, clusterCounter("upstream_rq_hedge_won"));
+  EXPECT_TRUE(hedges().canCreate());
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// The hedge responds first, and the first attempt is reset.
+TEST_F(RouterHedgingTest, HedgeWins) {
+  sendRequest();
+  sendHedge();
+
+  EXPECT_CALL(encoder_.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  EXPECT_CALL(callbacks_.request_info_, onUpstreamHostSelected(_))
+      .WillOnce(Invoke([&](Upstream::HostDescriptionConstSharedPtr host) -> void {
+        EXPECT_EQ(hedge_conn_pool_.host_, host);
+      }));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  hedge_response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, false);
+  EXPECT_EQ(1U, clusterCounter("upstream_rq_hedge_won"));
+  EXPECT_TRUE(hedges().canCreate());
+
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  Buffer::OwnedImpl data("hello");
+  hedge_response_decoder_->decodeData(data, true);
+  EXPECT_EQ(1U, hedge_conn_pool_.host_->stats_store_.counter("rq_success").value());
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 0));
+}
+
+// An attempt that fails waits for the response of the other one.
+TEST_F(RouterHedgingTest, AttemptResetWaitsForOther) {
+  sendRequest();
+  sendHedge();
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  encoder_.stream_.resetStream(Http::StreamResetReason::RemoteReset);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+  EXPECT_TRUE(hedges().canCreate());
+  EXPECT_EQ(0U, clusterCounter("upstream_rq_hedge_won"));
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("200", headers.Status()->value().c_str());
+      }));
+  hedge_response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+}
+
+// An attempt that gets a 5xx response waits for the response of the other one.
+TEST_F(RouterHedgingTest, ErrorResponseWaitsForOther) {
+  sendRequest();
+  sendHedge();
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, _)).Times(0);
+  EXPECT_CALL(hedge_conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  EXPECT_CALL(hedge_encoder_.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  hedge_response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "503"}}}, false);
+  EXPECT_EQ(1U, hedge_conn_pool_.host_->stats_store_.counter("rq_error").value());
+  EXPECT_TRUE(hedges().canCreate());
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("200", headers.Status()->value().c_str());
+      }));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// The last attempt's 5xx response is the response.
+TEST_F(RouterHedgingTest, BothAttemptsFail) {
+  sendRequest();
+  sendHedge();
+
+  hedge_response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "503"}}}, true);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("500", headers.Status()->value().c_str());
+      }));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "500"}}}, true);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+}
+
+// Hedges are not sent once the cluster's retry budget is used up.
+TEST_F(RouterHedgingTest, Overflow) {
+  sendRequest();
+
+  hedges().inc();
+  EXPECT_CALL(hedge_conn_pool_, newStream(_, _)).Times(0);
+  hedge_timer_->callback_();
+  EXPECT_EQ(0U, clusterCounter("upstream_rq_hedge"));
+  EXPECT_EQ(1U, clusterCounter("upstream_rq_hedge_overflow"));
+  hedges().dec();
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+}
+
+// Hedges are not sent when the load balancer picks the host of the first attempt each time.
+TEST_F(RouterHedgingTest, NoOtherHost) {
+  sendRequest();
+
+  EXPECT_CALL(cm_, httpConnPoolForCluster(_, _, _, _)).Times(3);
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _)).Times(0);
+  hedge_timer_->callback_();
+  EXPECT_EQ(0U, clusterCounter("upstream_rq_hedge"));
+  EXPECT_TRUE(hedges().canCreate());
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+}
+
+// Resetting the downstream request resets both attempts.
+TEST_F(RouterHedgingTest, DownstreamReset) {
+  sendRequest();
+  sendHedge();
+
+  EXPECT_CALL(encoder_.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  EXPECT_CALL(hedge_encoder_.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  router_.onDestroy();
+  EXPECT_TRUE(hedges().canCreate());
+}
+
+// A route that hedges after a percentile of the cluster's response times uses its fixed delay
+// until there are enough of them.
+TEST_F(RouterHedgingTest, LatencyPercentile) {
+  config_.enableResponseTimeTracking(tls_);
+  callbacks_.route_->route_entry_.retry_policy_.hedge_latency_percentile_ = 90;
+  LatencyEstimator& response_times =
+      config_.response_times_->getTyped<ClusterResponseTimes>().clusters_["fake_cluster"];
+  for (uint32_t i = 0; i < LatencyEstimator::MIN_SAMPLES - 1; i++) {
+    response_times.addSample(std::chrono::milliseconds(20));
+  }
+  EXPECT_FALSE(response_times.percentile(90));
+  sendRequest(std::chrono::milliseconds(50));
+
+  // This response time makes for enough of them.
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+  EXPECT_TRUE(response_times.percentile(90));
+}
+
+// The percentile is estimated from the response times of the cluster.
+TEST_F(RouterHedgingTest, LatencyPercentileDelay) {
+  config_.enableResponseTimeTracking(tls_);
+  callbacks_.route_->route_entry_.retry_policy_.hedge_latency_percentile_ = 90;
+  LatencyEstimator& response_times =
+      config_.response_times_->getTyped<ClusterResponseTimes>().clusters_["fake_cluster"];
+  for (uint32_t i = 0; i < LatencyEstimator::MIN_SAMPLES; i++) {
+    response_times.addSample(std::chrono::milliseconds(20));
+  }
+  // The estimate is the upper bound of the bucket of 20ms.
+  sendRequest(std::chrono::milliseconds(23));
+
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  response_decoder_->decodeHeaders(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}}, true);
+}
+
 class WatermarkTest : public RouterTest {
 public:
   void sendRequest(bool header_only_request = true, bool pool_ready = true) {
@@ -1,3 +1,6 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -19,6 +22,7 @@
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/ssl/mocks.h"
 #include "test/mocks/upstream/host.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
@@ -988,6 +992,122 @@ TEST_F(TcpProxyTest, UpstreamFlushReceiveUpstreamData) {
   upstream_read_filter_->onData(buffer, false);
 }
 
+class TcpProxySpliceTest : public TcpProxyTest {
+public:
+  TcpProxySpliceTest() {
+    // Socket pairs stand in for the downstream and upstream sockets so the pumps get real
+    // descriptors to create their pipes against; the file events themselves are mocked.
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, downstream_fds_));
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, upstream_fds_));
+    ON_CALL(filter_callbacks_.connection_, fd()).WillByDefault(Return(downstream_fds_[0]));
+  }
+
+  ~TcpProxySpliceTest() {
+    filter_.reset();
+    for (int fd : {downstream_fds_[0], downstream_fds_[1], upstream_fds_[0], upstream_fds_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  void setupSplice() {
+    envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
+    config.set_use_splice(true);
+    setup(1, config);
+    ON_CALL(*upstream_connections_.at(0), fd()).WillByDefault(Return(upstream_fds_[0]));
+    ON_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _))
+        .WillByDefault(testing::InvokeWithoutArgs(
+            []() -> Event::FileEvent* { return new NiceMock<Event::MockFileEvent>(); }));
+  }
+
+  int downstream_fds_[2];
+  int upstream_fds_[2];
+};
+
+// Tests that the downstream socket is handed to a splice pump once the upstream connects, and that
+// the upstream socket follows on the next loop iteration.
+TEST_F(TcpProxySpliceTest, Splice) {
+  setupSplice();
+
+  Event::MockTimer* splice_timer =
+      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
+  EXPECT_CALL(*splice_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _)).Times(2);
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(true));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_splice_total_.value());
+
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _)).Times(2);
+  EXPECT_CALL(*upstream_connections_.at(0), readDisable(true));
+  splice_timer->callback_();
+
+  // Tearing down releases both sockets back to their connections.
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
+  EXPECT_CALL(*upstream_connections_.at(0), readDisable(false));
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
+              deferredDelete_(upstream_connections_.at(0)));
+  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
+// Tests that the upstream pump waits until upstream bytes already written to the downstream
+// connection have been sent, so spliced bytes cannot overtake them.
+TEST_F(TcpProxySpliceTest, SpliceUpstreamWaitsForBufferedData) {
+  setupSplice();
+
+  Event::MockTimer* splice_timer =
+      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(true));
+  raiseEventUpstreamConnected(0);
+
+  Buffer::OwnedImpl response("world");
+  EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), false));
+  upstream_read_filter_->onData(response, false);
+
+  EXPECT_CALL(*upstream_connections_.at(0), readDisable(true)).Times(0);
+  splice_timer->callback_();
+
+  EXPECT_CALL(*splice_timer, enableTimer(std::chrono::milliseconds(0))).Times(0);
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(2);
+
+  EXPECT_CALL(*splice_timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(3);
+
+  EXPECT_CALL(*upstream_connections_.at(0), readDisable(true));
+  splice_timer->callback_();
+
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
+  EXPECT_CALL(*upstream_connections_.at(0), readDisable(false));
+  filter_.reset();
+}
+
+// Tests that splice is not used when either connection carries TLS.
+TEST_F(TcpProxySpliceTest, NoSpliceWithTls) {
+  setupSplice();
+
+  NiceMock<Ssl::MockConnection> ssl;
+  ON_CALL(filter_callbacks_.connection_, ssl()).WillByDefault(Return(&ssl));
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _)).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_splice_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+}
+
+// Tests that splice is not used when other filters would miss the payload.
+TEST_F(TcpProxySpliceTest, NoSpliceWithOtherFilters) {
+  setupSplice();
+
+  ON_CALL(filter_callbacks_, hasOtherFilters()).WillByDefault(Return(true));
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, createFileEvent_(_, _, _, _)).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_splice_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+}
+
 class TcpProxyRoutingTest : public testing::Test {
 public:
   TcpProxyRoutingTest() {
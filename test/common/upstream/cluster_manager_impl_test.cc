@@ -1337,6 +1337,60 @@ TEST_F(ClusterManagerImplTest, DynamicHostRemoveDefaultPriority) {
   factory_.tls_.shutdownThread();
 }
 
+// Verify that the pool of each host is warmed as soon as the host is added.
+TEST_F(ClusterManagerImplTest, WarmConnectionsOnHostAdd) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STRICT_DNS
+      dns_resolvers:
+      - socket_address:
+          address: 1.2.3.4
+          port_value: 80
+      lb_policy: ROUND_ROBIN
+      hosts:
+      - socket_address:
+          address: localhost
+          port_value: 11001
+      prefetch_policy:
+        warm_connections_per_host: 2
+  )EOF";
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  Event::MockTimer* dns_timer_ = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromV2Yaml(yaml));
+
+  // The cluster initializes with two hosts, and each gets a pool with its warm connections.
+  Http::ConnectionPool::MockInstance* cp1 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  Http::ConnectionPool::MockInstance* cp2 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp1)).WillOnce(Return(cp2));
+  EXPECT_CALL(*cp1, prefetch(2));
+  EXPECT_CALL(*cp2, prefetch(2));
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2"}));
+
+  // Requests use the warmed pools.
+  Http::ConnectionPool::Instance* cp = cluster_manager_->httpConnPoolForCluster(
+      "cluster_1", ResourcePriority::Default, Http::Protocol::Http11, nullptr);
+  EXPECT_TRUE(cp == cp1 || cp == cp2);
+
+  // A host added later is warmed too.
+  Http::ConnectionPool::MockInstance* cp3 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp3));
+  EXPECT_CALL(*cp3, prefetch(2));
+  dns_timer_->callback_();
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2", "127.0.0.3"}));
+
+  factory_.tls_.shutdownThread();
+}
+
 TEST_F(ClusterManagerImplTest, OriginalDstInitialization) {
   const std::string json = R"EOF(
   {
@@ -636,6 +636,10 @@ TEST(StaticClusterImplTest, UrlConfig) {
   EXPECT_EQ(1024U, cluster.info()->resourceManager(ResourcePriority::High).requests().max());
   EXPECT_EQ(3U, cluster.info()->resourceManager(ResourcePriority::High).retries().max());
   EXPECT_EQ(0U, cluster.info()->maxRequestsPerConnection());
+  EXPECT_EQ(1U, cluster.info()->http2MaxConnectionsPerHost());
+  EXPECT_EQ(100U, cluster.info()->http2BusyStreamThreshold());
+  EXPECT_EQ(1.0, cluster.info()->perUpstreamPrefetchRatio());
+  EXPECT_EQ(0U, cluster.info()->warmConnectionsPerHost());
   EXPECT_EQ(Http::Http2Settings::DEFAULT_HPACK_TABLE_SIZE,
             cluster.info()->http2Settings().hpack_table_size_);
   EXPECT_EQ(LoadBalancerType::Random, cluster.info()->lbType());
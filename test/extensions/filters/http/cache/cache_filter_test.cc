@@ -0,0 +1,297 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnPointee;
+using testing::_;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+TEST(CacheControlTest, Parse) {
+  const CacheControl cache_control(" public, MAX-AGE=60 ,s-maxage=\"30\", no-cache=\"set-cookie\"");
+  EXPECT_TRUE(cache_control.no_cache_);
+  EXPECT_FALSE(cache_control.no_store_);
+  EXPECT_FALSE(cache_control.private_);
+  EXPECT_EQ(std::chrono::seconds(60), cache_control.max_age_.value());
+  EXPECT_EQ(std::chrono::seconds(30), cache_control.s_maxage_.value());
+
+  const CacheControl other("private,no-store, max-age=soon");
+  EXPECT_FALSE(other.no_cache_);
+  EXPECT_TRUE(other.no_store_);
+  EXPECT_TRUE(other.private_);
+  EXPECT_EQ(std::chrono::seconds(0), other.max_age_.value());
+  EXPECT_FALSE(other.s_maxage_);
+}
+
+TEST(CacheFilterUtilityTest, ParseHttpDate) {
+  EXPECT_EQ(std::chrono::system_clock::from_time_t(784111777),
+            CacheFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT").value());
+  EXPECT_FALSE(CacheFilter::parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT"));
+  EXPECT_FALSE(CacheFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT+1"));
+}
+
+TEST(CacheFilterUtilityTest, FreshnessLifetime) {
+  const SystemTime now = std::chrono::system_clock::from_time_t(784111777);
+  const auto lifetime = [now](const Http::TestHeaderMapImpl& headers) {
+    return CacheFilter::freshnessLifetime(headers, now);
+  };
+
+  EXPECT_EQ(std::chrono::seconds(60),
+            lifetime({{":status", "200"}, {"cache-control", "max-age=60"}}).value());
+  EXPECT_EQ(std::chrono::seconds(30),
+            lifetime({{":status", "200"}, {"cache-control", "max-age=60, s-maxage=30"}}).value());
+  EXPECT_EQ(std::chrono::seconds(100), lifetime({{":status", "200"},
+                                                 {"date", "Sun, 06 Nov 1994 08:48:37 GMT"},
+                                                 {"expires", "Sun, 06 Nov 1994 08:50:17 GMT"}})
+                                           .value());
+  // Without a date header, the expiry is relative to now.
+  EXPECT_EQ(std::chrono::seconds(40),
+            lifetime({{":status", "200"}, {"expires", "Sun, 06 Nov 1994 08:50:17 GMT"}}).value());
+  // max-age takes precedence over expires.
+  EXPECT_EQ(std::chrono::seconds(5),
+            lifetime({{":status", "200"},
+                      {"cache-control", "max-age=5"},
+                      {"expires", "Sun, 06 Nov 1994 08:50:17 GMT"}})
+                .value());
+
+  EXPECT_FALSE(lifetime({{":status", "200"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"expires", "0"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"cache-control", "max-age=0"}}));
+  EXPECT_FALSE(lifetime({{":status", "404"}, {"cache-control", "max-age=60"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"cache-control", "private, max-age=60"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"cache-control", "no-store, max-age=60"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"cache-control", "no-cache, max-age=60"}}));
+  EXPECT_FALSE(
+      lifetime({{":status", "200"}, {"cache-control", "max-age=60"}, {"set-cookie", "a=b"}}));
+  EXPECT_FALSE(lifetime({{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "*"}}));
+}
+
+class CacheFilterTest : public testing::Test {
+public:
+  CacheFilterTest() {
+    ON_CALL(system_time_, currentTime()).WillByDefault(ReturnPointee(&system_now_));
+    ON_CALL(monotonic_time_, currentTime()).WillByDefault(ReturnPointee(&monotonic_now_));
+    setUpConfig(envoy::config::filter::http::cache::v2alpha::Cache());
+  }
+
+  void setUpConfig(const envoy::config::filter::http::cache::v2alpha::Cache& proto_config) {
+    config_ = std::make_shared<CacheFilterConfig>(proto_config, "test.", stats_, system_time_,
+                                                  monotonic_time_);
+  }
+
+  // Send a request through a new filter and the given response back through it.
+  void sendRequest(Http::HeaderMap& request_headers, Http::HeaderMap& response_headers,
+                   const std::string& body = "hello") {
+    CacheFilter filter(config_);
+    filter.setDecoderFilterCallbacks(decoder_callbacks_);
+    filter.setEncoderFilterCallbacks(encoder_callbacks_);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter.decodeHeaders(request_headers, true));
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter.encodeHeaders(response_headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, filter.encodeData(data, true));
+      EXPECT_EQ(body, TestUtility::bufferToString(data));
+    }
+  }
+
+  // Send a request through a new filter and return whether it was served from the cache.
+  bool lookup(Http::HeaderMap& request_headers) {
+    CacheFilter filter(config_);
+    filter.setDecoderFilterCallbacks(decoder_callbacks_);
+    filter.setEncoderFilterCallbacks(encoder_callbacks_);
+    served_headers_.reset();
+    served_body_.clear();
+    return filter.decodeHeaders(request_headers, true) == Http::FilterHeadersStatus::StopIteration;
+  }
+
+  Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/page"}, {":authority", "host"}};
+  Http::TestHeaderMapImpl response_headers_{{":status", "200"}, {"cache-control", "max-age=60"}};
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<MockSystemTimeSource> system_time_;
+  NiceMock<MockMonotonicTimeSource> monotonic_time_;
+  SystemTime system_now_;
+  MonotonicTime monotonic_now_;
+  CacheFilterConfigSharedPtr config_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  std::unique_ptr<Http::TestHeaderMapImpl> served_headers_;
+  std::string served_body_;
+};
+
+// A stored response is served for as long as it is fresh.
+TEST_F(CacheFilterTest, Hit) {
+  EXPECT_FALSE(lookup(request_headers_));
+  sendRequest(request_headers_, response_headers_);
+  EXPECT_EQ(1U, config_->stats().miss_.value());
+  EXPECT_EQ(1U, config_->stats().insert_.value());
+
+  monotonic_now_ += std::chrono::seconds(10);
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([&](Http::HeaderMap& headers, bool) -> void {
+        served_headers_.reset(new Http::TestHeaderMapImpl(headers));
+      }));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        served_body_ = TestUtility::bufferToString(data);
+      }));
+  EXPECT_TRUE(lookup(request_headers_));
+  EXPECT_EQ(1U, config_->stats().hit_.value());
+  EXPECT_EQ("200", served_headers_->get_(":status"));
+  EXPECT_EQ("10", served_headers_->get_("age"));
+  EXPECT_EQ("hello", served_body_);
+
+  // Once it is stale, the response is removed.
+  monotonic_now_ += std::chrono::seconds(50);
+  EXPECT_FALSE(lookup(request_headers_));
+  EXPECT_EQ(2U, config_->stats().miss_.value());
+  EXPECT_EQ(0U, config_->stats().entries_.value());
+}
+
+TEST_F(CacheFilterTest, HitWithoutBody) {
+  sendRequest(request_headers_, response_headers_, "");
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, true));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, _)).Times(0);
+  EXPECT_TRUE(lookup(request_headers_));
+}
+
+// The age of a response when it was received counts against its freshness.
+TEST_F(CacheFilterTest, InitialAge) {
+  Http::TestHeaderMapImpl response_headers{
+      {":status", "200"}, {"cache-control", "max-age=60"}, {"age", "50"}};
+  sendRequest(request_headers_, response_headers);
+
+  monotonic_now_ += std::chrono::seconds(5);
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([&](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_EQ("55", Http::TestHeaderMapImpl(headers).get_("age"));
+      }));
+  EXPECT_TRUE(lookup(request_headers_));
+
+  monotonic_now_ += std::chrono::seconds(5);
+  EXPECT_FALSE(lookup(request_headers_));
+
+  response_headers.remove(Http::LowerCaseString("age"));
+  response_headers.addCopy("age", "60");
+  sendRequest(request_headers_, response_headers);
+  EXPECT_FALSE(lookup(request_headers_));
+}
+
+TEST_F(CacheFilterTest, Vary) {
+  request_headers_.addCopy("accept-encoding", "gzip");
+  response_headers_.addCopy("vary", "Accept-Encoding");
+  sendRequest(request_headers_, response_headers_);
+  EXPECT_TRUE(lookup(request_headers_));
+
+  Http::TestHeaderMapImpl other_request{
+      {":method", "GET"}, {":path", "/page"}, {":authority", "host"}};
+  EXPECT_FALSE(lookup(other_request));
+  other_request.addCopy("accept-encoding", "br");
+  EXPECT_FALSE(lookup(other_request));
+}
+
+// http and https requests for the same authority and path have their own responses.
+TEST_F(CacheFilterTest, Scheme) {
+  request_headers_.addCopy("x-forwarded-proto", "http");
+  sendRequest(request_headers_, response_headers_);
+  EXPECT_TRUE(lookup(request_headers_));
+
+  Http::TestHeaderMapImpl https_request{{":method", "GET"},
+                                        {":path", "/page"},
+                                        {":authority", "host"},
+                                        {"x-forwarded-proto", "https"}};
+  EXPECT_FALSE(lookup(https_request));
+  EXPECT_NE(CacheFilter::cacheKey(request_headers_), CacheFilter::cacheKey(https_request));
+}
+
+// Requests that are not served from the cache do not store their response in it either.
+TEST_F(CacheFilterTest, RequestNotCacheable) {
+  Http::TestHeaderMapImpl post_request{
+      {":method", "POST"}, {":path", "/page"}, {":authority", "host"}};
+  sendRequest(post_request, response_headers_);
+
+  for (const auto& header : std::vector<std::pair<std::string, std::string>>{
+           {"authorization", "secret"}, {"range", "bytes=0-1"}, {"cache-control", "no-store"}}) {
+    Http::TestHeaderMapImpl request{
+        {":method", "GET"}, {":path", "/page"}, {":authority", "host"}, header};
+    sendRequest(request, response_headers_);
+  }
+  EXPECT_FALSE(lookup(request_headers_));
+
+  EXPECT_EQ(0U, config_->stats().insert_.value());
+  EXPECT_EQ(0U, config_->stats().miss_.value());
+}
+
+// A request that asks for a validated response goes upstream and refreshes the cache.
+TEST_F(CacheFilterTest, NoCacheRequest) {
+  sendRequest(request_headers_, response_headers_);
+
+  Http::TestHeaderMapImpl no_cache_request{{":method", "GET"},
+                                           {":path", "/page"},
+                                           {":authority", "host"},
+                                           {"cache-control", "no-cache"}};
+  EXPECT_FALSE(lookup(no_cache_request));
+  sendRequest(no_cache_request, response_headers_, "world");
+  EXPECT_EQ(2U, config_->stats().insert_.value());
+
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ("world", TestUtility::bufferToString(data));
+      }));
+  EXPECT_TRUE(lookup(request_headers_));
+}
+
+TEST_F(CacheFilterTest, ResponseNotStored) {
+  Http::TestHeaderMapImpl private_response{
+      {":status", "200"}, {"cache-control", "private, max-age=60"}};
+  sendRequest(request_headers_, private_response);
+  Http::TestHeaderMapImpl large_response{
+      {":status", "200"}, {"cache-control", "max-age=60"}, {"content-length", "2000000"}};
+  sendRequest(request_headers_, large_response);
+
+  // Bodies beyond the limit and responses with trailers are not stored.
+  envoy::config::filter::http::cache::v2alpha::Cache proto_config;
+  proto_config.mutable_max_body_bytes()->set_value(4);
+  setUpConfig(proto_config);
+  sendRequest(request_headers_, response_headers_);
+
+  CacheFilter filter(config_);
+  filter.setDecoderFilterCallbacks(decoder_callbacks_);
+  filter.setEncoderFilterCallbacks(encoder_callbacks_);
+  filter.decodeHeaders(request_headers_, true);
+  filter.encodeHeaders(response_headers_, false);
+  Buffer::OwnedImpl data("hi");
+  filter.encodeData(data, false);
+  Http::TestHeaderMapImpl trailers{{"some", "trailer"}};
+  filter.encodeTrailers(trailers);
+
+  EXPECT_FALSE(lookup(request_headers_));
+  EXPECT_EQ(0U, config_->stats().insert_.value());
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,39 @@
+#include "extensions/filters/http/cache/config.h"
+
+#include "test/mocks/server/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::_;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+TEST(CacheFilterFactoryTest, CacheFilter) {
+  envoy::config::filter::http::cache::v2alpha::Cache config;
+  config.mutable_max_bytes()->set_value(1024 * 1024);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  CacheFilterFactory factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(config, "stats.", context);
+  Http::MockFilterChainFactoryCallbacks filter_callbacks;
+  EXPECT_CALL(filter_callbacks, addStreamFilter(_));
+  cb(filter_callbacks);
+}
+
+TEST(CacheFilterFactoryTest, EmptyProto) {
+  CacheFilterFactory factory;
+  EXPECT_NE(nullptr, dynamic_cast<envoy::config::filter::http::cache::v2alpha::Cache*>(
+                         factory.createEmptyConfigProto().get()));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
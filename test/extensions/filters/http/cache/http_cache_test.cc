@@ -0,0 +1,118 @@
+#include <string>
+#include <vector>
+
+#include "common/common/hash.h"
+#include "common/stats/stats_impl.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class HttpCacheTest : public testing::Test {
+public:
+  // Each shard has room for two of the responses made by response().
+  HttpCacheTest()
+      : stats_{ALL_CACHE_STATS(POOL_COUNTER_PREFIX(store_, "cache."),
+                               POOL_GAUGE_PREFIX(store_, "cache."))},
+        cache_(HttpCache::SHARDS * 2 * (responseSize() + 2 * KeySize), stats_) {
+    // Find keys that share a shard, so that they compete for its budget.
+    const uint64_t shard = HashUtil::xxHash64("key0") % HttpCache::SHARDS;
+    for (uint32_t i = 0; keys_.size() < 3; i++) {
+      const std::string key = fmt::format("key{}", i);
+      if (HashUtil::xxHash64(key) % HttpCache::SHARDS == shard) {
+        keys_.push_back(key);
+      }
+    }
+  }
+
+  static CachedResponseConstSharedPtr response(uint64_t body_length = 1000) {
+    std::shared_ptr<CachedResponse> response = std::make_shared<CachedResponse>();
+    response->headers_.reset(new Http::TestHeaderMapImpl{{":status", "200"}});
+    const std::string body(body_length, 'a');
+    response->body_.emplace_back(Buffer::OwnedSlice::create(body.data(), body.size()));
+    response->body_length_ = body_length;
+    return response;
+  }
+
+  // The size the cache charges for a response made by response(): its headers and all of the
+  // memory of its body slice.
+  static uint64_t responseSize(uint64_t body_length = 1000) {
+    CachedResponseConstSharedPtr response = HttpCacheTest::response(body_length);
+    return response->headers_->byteSize() + response->body_[0]->size();
+  }
+
+  static const uint64_t KeySize = 4;
+
+  Stats::IsolatedStoreImpl store_;
+  CacheStats stats_;
+  HttpCache cache_;
+  std::vector<std::string> keys_;
+};
+
+TEST_F(HttpCacheTest, InsertAndLookup) {
+  EXPECT_EQ(nullptr, cache_.lookup(keys_[0]));
+
+  CachedResponseConstSharedPtr first = response();
+  cache_.insert(keys_[0], first);
+  EXPECT_EQ(first, cache_.lookup(keys_[0]));
+  EXPECT_EQ(1U, stats_.insert_.value());
+  EXPECT_EQ(1U, stats_.entries_.value());
+  EXPECT_EQ(responseSize() + 2 * KeySize, stats_.size_bytes_.value());
+
+  // A new response for the key replaces the old one.
+  CachedResponseConstSharedPtr second = response();
+  cache_.insert(keys_[0], second);
+  EXPECT_EQ(second, cache_.lookup(keys_[0]));
+  EXPECT_EQ(1U, stats_.entries_.value());
+  EXPECT_EQ(0U, stats_.eviction_.value());
+
+  // Removal only removes the given response.
+  cache_.remove(keys_[0], *first);
+  EXPECT_EQ(second, cache_.lookup(keys_[0]));
+  cache_.remove(keys_[0], *second);
+  EXPECT_EQ(nullptr, cache_.lookup(keys_[0]));
+  EXPECT_EQ(0U, stats_.entries_.value());
+  EXPECT_EQ(0U, stats_.size_bytes_.value());
+}
+
+TEST_F(HttpCacheTest, EvictLeastRecentlyUsed) {
+  cache_.insert(keys_[0], response());
+  cache_.insert(keys_[1], response());
+  // A lookup makes the first response the most recently used.
+  EXPECT_NE(nullptr, cache_.lookup(keys_[0]));
+
+  cache_.insert(keys_[2], response());
+  EXPECT_EQ(1U, stats_.eviction_.value());
+  EXPECT_EQ(2U, stats_.entries_.value());
+  EXPECT_NE(nullptr, cache_.lookup(keys_[0]));
+  EXPECT_EQ(nullptr, cache_.lookup(keys_[1]));
+  EXPECT_NE(nullptr, cache_.lookup(keys_[2]));
+}
+
+TEST_F(HttpCacheTest, TooLarge) {
+  HttpCache cache(HttpCache::SHARDS * responseSize(), stats_);
+  cache.insert(keys_[0], response());
+  EXPECT_EQ(nullptr, cache.lookup(keys_[0]));
+  EXPECT_EQ(0U, stats_.insert_.value());
+}
+
+// A small body is charged for the whole slice it keeps, not for the bytes it uses.
+TEST_F(HttpCacheTest, BodyChargedForWholeSlices) {
+  cache_.insert(keys_[0], response(200));
+  EXPECT_EQ(responseSize(200) + 2 * KeySize, stats_.size_bytes_.value());
+  EXPECT_LT(10 * 200U, stats_.size_bytes_.value());
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
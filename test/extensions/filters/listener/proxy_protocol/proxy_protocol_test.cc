@@ -58,9 +58,16 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
+  Network::Socket* workerSocket(uint32_t) override { return nullptr; }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
+  uint32_t acceptBatchSize() const override { return 0; }
+  uint32_t maxConnectionsPerWorker() const override { return 0; }
+  Network::Address::SocketType socketType() const override {
+    return Network::Address::SocketType::Stream;
+  }
+  Network::ConnectionBalancer* connectionBalancer() override { return nullptr; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
@@ -354,9 +361,16 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
+  Network::Socket* workerSocket(uint32_t) override { return nullptr; }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
+  uint32_t acceptBatchSize() const override { return 0; }
+  uint32_t maxConnectionsPerWorker() const override { return 0; }
+  Network::Address::SocketType socketType() const override {
+    return Network::Address::SocketType::Stream;
+  }
+  Network::ConnectionBalancer* connectionBalancer() override { return nullptr; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
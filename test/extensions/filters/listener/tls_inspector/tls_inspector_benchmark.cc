@@ -61,6 +61,8 @@ public:
 class FastMockFileEvent : public Event::FileEvent {
   void activate(uint32_t) override {}
   void setEnabled(uint32_t) override {}
+  bool enableReceive() override { return false; }
+  int receive(Buffer::Instance&, uint64_t) override { return -1; }
 };
 
 class FastMockDispatcher : public Event::MockDispatcher {
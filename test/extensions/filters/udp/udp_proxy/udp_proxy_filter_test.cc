@@ -0,0 +1,271 @@
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/hash.h"
+#include "common/network/udp_io.h"
+#include "common/network/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnNew;
+using testing::SaveArg;
+using testing::_;
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+class UdpProxyFilterTest : public testing::TestWithParam<Network::Address::IpVersion> {
+public:
+  struct TestSession {
+    Event::FileReadyCb file_event_cb_;
+    Event::MockTimer* idle_timer_{};
+  };
+
+  UdpProxyFilterTest() {
+    auto upstream =
+        Network::Test::bindFreeLoopbackPort(GetParam(), Network::Address::SocketType::Datagram);
+    upstream_address_ = upstream.first;
+    upstream_fd_ = upstream.second;
+    ON_CALL(*cluster_manager_.thread_local_cluster_.lb_.host_, address())
+        .WillByDefault(Return(upstream_address_));
+  }
+
+  ~UdpProxyFilterTest() {
+    filter_.reset();
+    if (upstream_fd_ != -1) {
+      ::close(upstream_fd_);
+    }
+  }
+
+  void setup(const std::string& yaml) {
+    envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig config;
+    MessageUtil::loadFromYaml(yaml, config);
+    config_ = std::make_shared<const UdpProxyFilterConfig>(cluster_manager_, stats_store_, config);
+    filter_ = std::make_unique<UdpProxyFilter>(callbacks_, config_);
+  }
+
+  void expectSession(TestSession& session) {
+    EXPECT_CALL(callbacks_.dispatcher_, createFileEvent_(_, _, Event::FileTriggerType::Level,
+                                                         Event::FileReadyType::Read))
+        .WillOnce(DoAll(SaveArg<1>(&session.file_event_cb_),
+                        ReturnNew<NiceMock<Event::MockFileEvent>>()));
+    session.idle_timer_ = new Event::MockTimer(&callbacks_.dispatcher_);
+    EXPECT_CALL(*session.idle_timer_, enableTimer(std::chrono::milliseconds(60000)));
+  }
+
+  void recvDataFromDownstream(const std::string& peer, const std::string& payload) {
+    Network::UdpRecvData data{callbacks_.udp_listener_.local_address_,
+                              Network::Utility::parseInternetAddressAndPort(peer),
+                              std::make_unique<Buffer::OwnedImpl>(payload)};
+    filter_->onData(data);
+  }
+
+  // Read what the upstream host received, remembering who sent each payload so that it can be
+  // answered.
+  std::vector<std::string> upstreamReceive() {
+    std::vector<std::string> payloads;
+    Network::UdpReader reader;
+    reader.read(upstream_fd_, true,
+                [&](const Network::Address::InstanceConstSharedPtr& peer_address,
+                    Buffer::InstancePtr&& buffer) {
+                  upstream_peers_[TestUtility::bufferToString(*buffer)] = peer_address;
+                  payloads.push_back(TestUtility::bufferToString(*buffer));
+                });
+    return payloads;
+  }
+
+  // Answer the session that sent the given payload.
+  void upstreamSend(const std::string& payload, const std::string& to_payload) {
+    Buffer::OwnedImpl data(payload);
+    Network::UdpSendQueue queue;
+    queue.add(upstream_peers_[to_payload], data);
+    EXPECT_EQ(1, queue.flush(upstream_fd_).datagrams_);
+  }
+
+  void expectReply(const std::string& peer, const std::string& payload) {
+    EXPECT_CALL(callbacks_.udp_listener_, send(_, _))
+        .WillOnce(Invoke([peer, payload](const Network::Address::InstanceConstSharedPtr& address,
+                                         Buffer::Instance& data) -> void {
+          EXPECT_EQ(peer, address->asString());
+          EXPECT_EQ(payload, TestUtility::bufferToString(data));
+        }))
+        .RetiresOnSaturation();
+  }
+
+  const std::string config_yaml_ = R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+)EOF";
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks_;
+  UdpProxyFilterConfigSharedPtr config_;
+  std::unique_ptr<UdpProxyFilter> filter_;
+  Network::Address::InstanceConstSharedPtr upstream_address_;
+  int upstream_fd_;
+  std::map<std::string, Network::Address::InstanceConstSharedPtr> upstream_peers_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpProxyFilterTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Datagrams are queued until the listener batch is complete, and replies go back to the peer.
+TEST_P(UdpProxyFilterTest, BasicFlow) {
+  setup(config_yaml_);
+  TestSession session;
+  expectSession(session);
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "world");
+  EXPECT_TRUE(upstreamReceive().empty());
+  filter_->onReadComplete();
+  EXPECT_EQ((std::vector<std::string>{"hello", "world"}), upstreamReceive());
+
+  upstreamSend("reply1", "hello");
+  upstreamSend("reply2", "hello");
+  expectReply("10.0.0.1:1000", "reply1");
+  expectReply("10.0.0.1:1000", "reply2");
+  EXPECT_CALL(callbacks_.udp_listener_, flush());
+  EXPECT_CALL(*session.idle_timer_, enableTimer(std::chrono::milliseconds(60000)));
+  session.file_event_cb_(Event::FileReadyType::Read);
+
+  EXPECT_EQ(1, stats_store_.counter("udp.foo.downstream_sess_total").value());
+  EXPECT_EQ(1, stats_store_.gauge("udp.foo.downstream_sess_active").value());
+  EXPECT_EQ(2, stats_store_.counter("udp.foo.downstream_sess_rx_datagrams").value());
+  EXPECT_EQ(10, stats_store_.counter("udp.foo.downstream_sess_rx_bytes").value());
+  EXPECT_EQ(2, stats_store_.counter("udp.foo.downstream_sess_tx_datagrams").value());
+  EXPECT_EQ(12, stats_store_.counter("udp.foo.downstream_sess_tx_bytes").value());
+
+  filter_.reset();
+  EXPECT_EQ(0, stats_store_.gauge("udp.foo.downstream_sess_active").value());
+}
+
+// Each peer gets its own session and upstream socket.
+TEST_P(UdpProxyFilterTest, MultiplePeers) {
+  setup(config_yaml_);
+  TestSession session1;
+  expectSession(session1);
+  recvDataFromDownstream("10.0.0.1:1000", "hello1");
+  TestSession session2;
+  expectSession(session2);
+  recvDataFromDownstream("10.0.0.2:1000", "hello2");
+  filter_->onReadComplete();
+
+  EXPECT_EQ((std::vector<std::string>{"hello1", "hello2"}), upstreamReceive());
+  EXPECT_NE(*upstream_peers_["hello1"], *upstream_peers_["hello2"]);
+
+  // Answer the second session first.
+  upstreamSend("reply2", "hello2");
+  expectReply("10.0.0.2:1000", "reply2");
+  EXPECT_CALL(*session2.idle_timer_, enableTimer(_));
+  session2.file_event_cb_(Event::FileReadyType::Read);
+
+  upstreamSend("reply1", "hello1");
+  expectReply("10.0.0.1:1000", "reply1");
+  EXPECT_CALL(*session1.idle_timer_, enableTimer(_));
+  session1.file_event_cb_(Event::FileReadyType::Read);
+
+  EXPECT_EQ(2, stats_store_.counter("udp.foo.downstream_sess_total").value());
+  EXPECT_EQ(2, stats_store_.gauge("udp.foo.downstream_sess_active").value());
+}
+
+// Idle sessions are removed, and the next datagram of the peer starts a new one.
+TEST_P(UdpProxyFilterTest, IdleTimeout) {
+  setup(R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+idle_timeout: 10s
+)EOF");
+  TestSession session;
+  EXPECT_CALL(callbacks_.dispatcher_, createFileEvent_(_, _, _, _))
+      .WillOnce(ReturnNew<NiceMock<Event::MockFileEvent>>());
+  session.idle_timer_ = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*session.idle_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  filter_->onReadComplete();
+
+  session.idle_timer_->callback_();
+  EXPECT_EQ(1, stats_store_.counter("udp.foo.idle_timeout").value());
+  EXPECT_EQ(0, stats_store_.gauge("udp.foo.downstream_sess_active").value());
+
+  EXPECT_CALL(callbacks_.dispatcher_, createFileEvent_(_, _, _, _))
+      .WillOnce(ReturnNew<NiceMock<Event::MockFileEvent>>());
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_EQ(2, stats_store_.counter("udp.foo.downstream_sess_total").value());
+  EXPECT_EQ(1, stats_store_.gauge("udp.foo.downstream_sess_active").value());
+}
+
+// Peers are hashed so that hash based load balancers keep them on the same host.
+TEST_P(UdpProxyFilterTest, HashKey) {
+  setup(config_yaml_);
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.lb_, chooseHost(_))
+      .WillOnce(Invoke([this](Upstream::LoadBalancerContext* context) {
+        EXPECT_EQ(HashUtil::xxHash64("10.0.0.1:1000"), context->computeHashKey().value());
+        EXPECT_EQ(nullptr, context->downstreamConnection());
+        return cluster_manager_.thread_local_cluster_.lb_.host_;
+      }));
+  TestSession session;
+  expectSession(session);
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+}
+
+TEST_P(UdpProxyFilterTest, NoCluster) {
+  setup(config_yaml_);
+  EXPECT_CALL(cluster_manager_, get("fake_cluster")).WillOnce(Return(nullptr));
+  EXPECT_CALL(callbacks_.dispatcher_, createFileEvent_(_, _, _, _)).Times(0);
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  filter_->onReadComplete();
+  EXPECT_EQ(1, stats_store_.counter("udp.foo.downstream_sess_no_route").value());
+  EXPECT_EQ(0, stats_store_.counter("udp.foo.downstream_sess_total").value());
+}
+
+TEST_P(UdpProxyFilterTest, NoHealthyHost) {
+  setup(config_yaml_);
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_EQ(1, stats_store_.counter("udp.foo.downstream_sess_no_route").value());
+  EXPECT_EQ(
+      1, cluster_manager_.thread_local_cluster_.cluster_.info_->stats_.upstream_cx_none_healthy_
+             .value());
+}
+
+// A host that is gone answers with an ICMP port unreachable, which the session reads as an error.
+TEST_P(UdpProxyFilterTest, UpstreamReadError) {
+  setup(config_yaml_);
+  TestSession session;
+  expectSession(session);
+  ::close(upstream_fd_);
+  upstream_fd_ = -1;
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  filter_->onReadComplete();
+
+  EXPECT_CALL(callbacks_.udp_listener_, send(_, _)).Times(0);
+  session.file_event_cb_(Event::FileReadyType::Read);
+  EXPECT_EQ(1, stats_store_.counter("udp.foo.upstream_sess_rx_errors").value());
+}
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
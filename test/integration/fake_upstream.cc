@@ -324,6 +324,11 @@ bool FakeUpstream::createNetworkFilterChain(Network::Connection& connection,
 
 bool FakeUpstream::createListenerFilterChain(Network::ListenerFilterManager&) { return true; }
 
+bool FakeUpstream::createUdpListenerFilterChain(Network::UdpListenerFilterManager&,
+                                                Network::UdpReadFilterCallbacks&) {
+  return true;
+}
+
 void FakeUpstream::threadRoutine() {
   handler_->addListener(listener_);
 
@@ -64,6 +64,10 @@ public:
   uint64_t maxStats() const override { return 16384; }
   uint64_t maxObjNameLength() const override { return 60; }
   bool hotRestartDisabled() const override { return false; }
+  bool libeventBuffersEnabled() const override { return false; }
+  bool ioUringEnabled() const override { return false; }
+  bool workerCpuAffinity() const override { return false; }
+  bool timerWheelEnabled() const override { return false; }
 
   // asConfigYaml returns a new config that empties the configPath() and populates configYaml()
   Server::TestOptionsImpl asConfigYaml();
@@ -60,6 +60,11 @@ public:
         createListener_(socket, cb, bind_to_port, hand_off_restored_destination_connections)};
   }
 
+  Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                            Network::UdpListenerCallbacks& cb) override {
+    return Network::UdpListenerPtr{createUdpListener_(socket, cb)};
+  }
+
   TimerPtr createTimer(TimerCb cb) override { return TimerPtr{createTimer_(cb)}; }
 
   void deferredDelete(DeferredDeletablePtr&& to_delete) override {
@@ -74,6 +79,8 @@ public:
   }
 
   // Event::Dispatcher
+  MOCK_METHOD2(initializeStats, void(Stats::Scope& scope, const std::string& prefix));
+  MOCK_CONST_METHOD0(loopUtilization, uint32_t());
   MOCK_METHOD0(clearDeferredDeleteList, void());
   MOCK_METHOD2(createServerConnection_,
                Network::Connection*(Network::ConnectionSocket* socket,
@@ -94,6 +101,8 @@ public:
                Network::Listener*(Network::Socket& socket, Network::ListenerCallbacks& cb,
                                   bool bind_to_port,
                                   bool hand_off_restored_destination_connections));
+  MOCK_METHOD2(createUdpListener_,
+               Network::UdpListener*(Network::Socket& socket, Network::UdpListenerCallbacks& cb));
   MOCK_METHOD1(createTimer_, Timer*(TimerCb cb));
   MOCK_METHOD1(deferredDelete_, void(DeferredDeletable* to_delete));
   MOCK_METHOD0(exit, void());
@@ -134,6 +143,8 @@ public:
 
   MOCK_METHOD1(activate, void(uint32_t events));
   MOCK_METHOD1(setEnabled, void(uint32_t events));
+  MOCK_METHOD0(enableReceive, bool());
+  MOCK_METHOD2(receive, int(Buffer::Instance& buffer, uint64_t max_length));
 };
 
 } // namespace Event
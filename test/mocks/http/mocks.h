@@ -439,6 +439,7 @@ public:
   MOCK_CONST_METHOD0(protocol, Http::Protocol());
   MOCK_METHOD1(addDrainedCallback, void(DrainedCb cb));
   MOCK_METHOD0(drainConnections, void());
+  MOCK_METHOD1(prefetch, void(uint32_t connections));
   MOCK_METHOD2(newStream, Cancellable*(Http::StreamDecoder& response_decoder,
                                        Http::ConnectionPool::Callbacks& callbacks));
 
@@ -28,6 +28,7 @@ MockListenerConfig::MockListenerConfig() {
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
   ON_CALL(*this, listenerScope()).WillByDefault(ReturnRef(scope_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
+  ON_CALL(*this, socketType()).WillByDefault(Return(Address::SocketType::Stream));
 }
 MockListenerConfig::~MockListenerConfig() {}
 
@@ -87,6 +88,7 @@ template <class T> static void initializeMockConnection(T& connection) {
   ON_CALL(connection, localAddress()).WillByDefault(ReturnRef(connection.local_address_));
   ON_CALL(connection, id()).WillByDefault(Return(connection.next_id_));
   ON_CALL(connection, state()).WillByDefault(ReturnPointee(&connection.state_));
+  ON_CALL(connection, fd()).WillByDefault(Return(-1));
 
   // The real implementation will move the buffer data into the socket.
   ON_CALL(connection, write(_, _)).WillByDefault(Invoke([](Buffer::Instance& buffer, bool) -> void {
@@ -174,6 +176,7 @@ MockFilterChainManager::~MockFilterChainManager() {}
 
 MockFilterChainFactory::MockFilterChainFactory() {
   ON_CALL(*this, createListenerFilterChain(_)).WillByDefault(Return(true));
+  ON_CALL(*this, createUdpListenerFilterChain(_, _)).WillByDefault(Return(true));
 }
 MockFilterChainFactory::~MockFilterChainFactory() {}
 
@@ -200,9 +203,35 @@ MockConnectionSocket::~MockConnectionSocket() {}
 MockListener::MockListener() {}
 MockListener::~MockListener() { onDestroy(); }
 
+MockUdpListener::MockUdpListener() : local_address_(new Address::Ipv4Instance("127.0.0.1", 53)) {
+  ON_CALL(*this, localAddress()).WillByDefault(ReturnRef(local_address_));
+}
+MockUdpListener::~MockUdpListener() { onDestroy(); }
+
+MockUdpListenerCallbacks::MockUdpListenerCallbacks() {}
+MockUdpListenerCallbacks::~MockUdpListenerCallbacks() {}
+
+MockUdpListenerReadFilter::MockUdpListenerReadFilter() {}
+MockUdpListenerReadFilter::~MockUdpListenerReadFilter() {}
+
+MockUdpListenerFilterManager::MockUdpListenerFilterManager() {}
+MockUdpListenerFilterManager::~MockUdpListenerFilterManager() {}
+
+MockUdpReadFilterCallbacks::MockUdpReadFilterCallbacks() {
+  ON_CALL(*this, udpListener()).WillByDefault(ReturnRef(udp_listener_));
+  ON_CALL(*this, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+}
+MockUdpReadFilterCallbacks::~MockUdpReadFilterCallbacks() {}
+
 MockConnectionHandler::MockConnectionHandler() {}
 MockConnectionHandler::~MockConnectionHandler() {}
 
+MockBalancedConnectionHandler::MockBalancedConnectionHandler() {}
+MockBalancedConnectionHandler::~MockBalancedConnectionHandler() {}
+
+MockConnectionBalancer::MockConnectionBalancer() {}
+MockConnectionBalancer::~MockConnectionBalancer() {}
+
 MockTransportSocket::MockTransportSocket() {}
 MockTransportSocket::~MockTransportSocket() {}
 
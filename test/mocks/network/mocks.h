@@ -7,6 +7,7 @@
 
 #include "envoy/api/v2/core/address.pb.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/drain_decision.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/resolver.h"
@@ -85,6 +86,7 @@ public:
   MOCK_CONST_METHOD0(localAddressRestored, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
   MOCK_CONST_METHOD0(socketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
+  MOCK_CONST_METHOD0(fd, int());
 };
 
 /**
@@ -124,6 +126,7 @@ public:
   MOCK_CONST_METHOD0(localAddressRestored, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
   MOCK_CONST_METHOD0(socketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
+  MOCK_CONST_METHOD0(fd, int());
 
   // Network::ClientConnection
   MOCK_METHOD0(connect, void());
@@ -169,6 +172,7 @@ public:
   MOCK_METHOD0(continueReading, void());
   MOCK_METHOD0(upstreamHost, Upstream::HostDescriptionConstSharedPtr());
   MOCK_METHOD1(upstreamHost, void(Upstream::HostDescriptionConstSharedPtr host));
+  MOCK_METHOD0(hasOtherFilters, bool());
 
   testing::NiceMock<MockConnection> connection_;
   Upstream::HostDescriptionConstSharedPtr host_;
@@ -285,6 +289,8 @@ public:
                bool(Connection& connection,
                     const std::vector<Network::FilterFactoryCb>& filter_factories));
   MOCK_METHOD1(createListenerFilterChain, bool(ListenerFilterManager& listener));
+  MOCK_METHOD2(createUdpListenerFilterChain,
+               bool(UdpListenerFilterManager& udp_listener, UdpReadFilterCallbacks& callbacks));
 };
 
 class MockListenSocket : public Socket {
@@ -351,9 +357,14 @@ public:
   MOCK_METHOD0(filterChainManager, FilterChainManager&());
   MOCK_METHOD0(filterChainFactory, FilterChainFactory&());
   MOCK_METHOD0(socket, Socket&());
+  MOCK_METHOD1(workerSocket, Socket*(uint32_t worker_index));
   MOCK_METHOD0(bindToPort, bool());
   MOCK_CONST_METHOD0(handOffRestoredDestinationConnections, bool());
   MOCK_METHOD0(perConnectionBufferLimitBytes, uint32_t());
+  MOCK_CONST_METHOD0(acceptBatchSize, uint32_t());
+  MOCK_CONST_METHOD0(maxConnectionsPerWorker, uint32_t());
+  MOCK_CONST_METHOD0(socketType, Address::SocketType());
+  MOCK_METHOD0(connectionBalancer, ConnectionBalancer*());
   MOCK_METHOD0(listenerScope, Stats::Scope&());
   MOCK_CONST_METHOD0(listenerTag, uint64_t());
   MOCK_CONST_METHOD0(name, const std::string&());
@@ -370,6 +381,67 @@ public:
   ~MockListener();
 
   MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(enable, void());
+  MOCK_METHOD1(setAcceptBatchSize, void(uint32_t batch_size));
+  MOCK_METHOD1(setAcceptStats, void(const AcceptStats& stats));
+};
+
+class MockUdpListener : public UdpListener {
+public:
+  MockUdpListener();
+  ~MockUdpListener();
+
+  MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(enable, void());
+  MOCK_CONST_METHOD0(localAddress, const Address::InstanceConstSharedPtr&());
+  MOCK_METHOD2(send,
+               void(const Address::InstanceConstSharedPtr& peer_address, Buffer::Instance& data));
+  MOCK_METHOD0(flush, void());
+  MOCK_METHOD1(setStats, void(const UdpStats& stats));
+
+  Address::InstanceConstSharedPtr local_address_;
+};
+
+class MockUdpListenerCallbacks : public UdpListenerCallbacks {
+public:
+  MockUdpListenerCallbacks();
+  ~MockUdpListenerCallbacks();
+
+  MOCK_METHOD1(onData, void(UdpRecvData& data));
+  MOCK_METHOD0(onReadComplete, void());
+};
+
+class MockUdpListenerReadFilter : public UdpListenerReadFilter {
+public:
+  MockUdpListenerReadFilter();
+  ~MockUdpListenerReadFilter();
+
+  MOCK_METHOD1(onData, void(UdpRecvData& data));
+  MOCK_METHOD0(onReadComplete, void());
+};
+
+class MockUdpListenerFilterManager : public UdpListenerFilterManager {
+public:
+  MockUdpListenerFilterManager();
+  ~MockUdpListenerFilterManager();
+
+  void addReadFilter(UdpListenerReadFilterPtr&& filter) override { addReadFilter_(filter); }
+
+  MOCK_METHOD1(addReadFilter_, void(UdpListenerReadFilterPtr& filter));
+};
+
+class MockUdpReadFilterCallbacks : public UdpReadFilterCallbacks {
+public:
+  MockUdpReadFilterCallbacks();
+  ~MockUdpReadFilterCallbacks();
+
+  MOCK_METHOD0(udpListener, UdpListener&());
+  MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+
+  testing::NiceMock<MockUdpListener> udp_listener_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
 };
 
 class MockConnectionHandler : public ConnectionHandler {
@@ -386,6 +458,30 @@ public:
   MOCK_METHOD0(stopListeners, void());
 };
 
+class MockBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  MockBalancedConnectionHandler();
+  ~MockBalancedConnectionHandler();
+
+  void post(uint64_t listener_tag, ConnectionSocketPtr&& socket) override {
+    post_(listener_tag, socket);
+  }
+
+  MOCK_CONST_METHOD0(loopUtilization, uint32_t());
+  MOCK_METHOD2(post_, void(uint64_t listener_tag, ConnectionSocketPtr& socket));
+};
+
+class MockConnectionBalancer : public ConnectionBalancer {
+public:
+  MockConnectionBalancer();
+  ~MockConnectionBalancer();
+
+  MOCK_METHOD2(registerHandler, void(uint32_t worker_index, BalancedConnectionHandler& handler));
+  MOCK_METHOD1(unregisterHandler, void(uint32_t worker_index));
+  MOCK_METHOD2(onConnectionCount, void(uint32_t worker_index, uint64_t connections));
+  MOCK_METHOD1(pickTargetHandler, BalancedConnectionHandler&(uint32_t worker_index));
+};
+
 class MockIp : public Address::Ip {
 public:
   MOCK_CONST_METHOD0(addressAsString, const std::string&());
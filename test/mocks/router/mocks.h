@@ -68,10 +68,14 @@ public:
   std::chrono::milliseconds perTryTimeout() const override { return per_try_timeout_; }
   uint32_t numRetries() const override { return num_retries_; }
   uint32_t retryOn() const override { return retry_on_; }
+  std::chrono::milliseconds hedgeDelay() const override { return hedge_delay_; }
+  double hedgeLatencyPercentile() const override { return hedge_latency_percentile_; }
 
   std::chrono::milliseconds per_try_timeout_{0};
   uint32_t num_retries_{};
   uint32_t retry_on_{};
+  std::chrono::milliseconds hedge_delay_{0};
+  double hedge_latency_percentile_{};
 };
 
 class MockRetryState : public RetryState {
@@ -131,6 +135,16 @@ public:
   std::string runtime_key_;
 };
 
+class TestRequestCoalescingPolicy : public RequestCoalescingPolicy {
+public:
+  // Router::RequestCoalescingPolicy
+  uint32_t maxWaiters() const override { return max_waiters_; }
+  std::chrono::milliseconds maxWait() const override { return max_wait_; }
+
+  uint32_t max_waiters_{1000};
+  std::chrono::milliseconds max_wait_{5000};
+};
+
 class MockShadowWriter : public ShadowWriter {
 public:
   MockShadowWriter();
@@ -226,6 +240,7 @@ public:
   MOCK_CONST_METHOD0(rateLimitPolicy, const RateLimitPolicy&());
   MOCK_CONST_METHOD0(retryPolicy, const RetryPolicy&());
   MOCK_CONST_METHOD0(shadowPolicy, const ShadowPolicy&());
+  MOCK_CONST_METHOD0(requestCoalescingPolicy, const RequestCoalescingPolicy*());
   MOCK_CONST_METHOD0(timeout, std::chrono::milliseconds());
   MOCK_CONST_METHOD1(virtualCluster, const VirtualCluster*(const Http::HeaderMap& headers));
   MOCK_CONST_METHOD0(virtualHostName, const std::string&());
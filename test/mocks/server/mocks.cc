@@ -30,6 +30,11 @@ MockOptions::MockOptions(const std::string& config_path) : config_path_(config_p
   ON_CALL(*this, maxStats()).WillByDefault(Return(1000));
   ON_CALL(*this, maxObjNameLength()).WillByDefault(Return(150));
   ON_CALL(*this, hotRestartDisabled()).WillByDefault(ReturnPointee(&hot_restart_disabled_));
+  ON_CALL(*this, libeventBuffersEnabled())
+      .WillByDefault(ReturnPointee(&libevent_buffers_enabled_));
+  ON_CALL(*this, ioUringEnabled()).WillByDefault(ReturnPointee(&io_uring_enabled_));
+  ON_CALL(*this, workerCpuAffinity()).WillByDefault(ReturnPointee(&worker_cpu_affinity_));
+  ON_CALL(*this, timerWheelEnabled()).WillByDefault(ReturnPointee(&timer_wheel_enabled_));
 }
 MockOptions::~MockOptions() {}
 
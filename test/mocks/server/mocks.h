@@ -67,6 +67,10 @@ public:
   MOCK_CONST_METHOD0(maxStats, uint64_t());
   MOCK_CONST_METHOD0(maxObjNameLength, uint64_t());
   MOCK_CONST_METHOD0(hotRestartDisabled, bool());
+  MOCK_CONST_METHOD0(libeventBuffersEnabled, bool());
+  MOCK_CONST_METHOD0(ioUringEnabled, bool());
+  MOCK_CONST_METHOD0(workerCpuAffinity, bool());
+  MOCK_CONST_METHOD0(timerWheelEnabled, bool());
 
   std::string config_path_;
   std::string config_yaml_;
@@ -77,6 +81,10 @@ public:
   std::string service_zone_name_;
   std::string log_path_;
   bool hot_restart_disabled_{};
+  bool libevent_buffers_enabled_{};
+  bool io_uring_enabled_{};
+  bool worker_cpu_affinity_{};
+  bool timer_wheel_enabled_{};
 };
 
 class MockConfigTracker : public ConfigTracker {
@@ -157,6 +165,8 @@ public:
   // Server::HotRestart
   MOCK_METHOD0(drainParentListeners, void());
   MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
+  MOCK_METHOD2(duplicateParentWorkerListenSocket,
+               int(const std::string& address, uint32_t worker_index));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
@@ -194,10 +204,24 @@ public:
                std::vector<Network::ListenerFilterFactoryCb>(
                    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>&,
                    Configuration::ListenerFactoryContext& context));
+  MOCK_METHOD2(createUdpListenerFilterFactoryList,
+               std::vector<Network::UdpListenerFilterFactoryCb>(
+                   const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+                   Configuration::ListenerFactoryContext& context));
   MOCK_METHOD3(createListenSocket,
                Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
                                         const Network::Socket::OptionsSharedPtr& options,
                                         bool bind_to_port));
+  MOCK_METHOD4(createWorkerListenSockets,
+               std::vector<Network::SocketSharedPtr>(
+                   Network::Address::InstanceConstSharedPtr address,
+                   const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets,
+                   bool cpu_steering));
+  MOCK_METHOD4(createUdpListenSockets,
+               std::vector<Network::SocketSharedPtr>(
+                   Network::Address::InstanceConstSharedPtr address,
+                   const Network::Socket::OptionsSharedPtr& options, uint32_t num_sockets,
+                   bool cpu_steering));
   MOCK_METHOD1(createDrainManager_, DrainManager*(envoy::api::v2::Listener::DrainType drain_type));
   MOCK_METHOD0(nextListenerTag, uint64_t());
 
@@ -226,7 +250,7 @@ public:
   ~MockWorkerFactory();
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override { return WorkerPtr{createWorker_()}; }
+  WorkerPtr createWorker(uint32_t) override { return WorkerPtr{createWorker_()}; }
 
   MOCK_METHOD0(createWorker_, Worker*());
 };
@@ -251,6 +275,7 @@ public:
   // Server::Worker
   MOCK_METHOD2(addListener,
                void(Network::ListenerConfig& listener, AddListenerCompletion completion));
+  MOCK_METHOD2(initializeStats, void(Stats::Scope& scope, const std::string& prefix));
   MOCK_METHOD0(numConnections, uint64_t());
   MOCK_METHOD2(removeListener,
                void(Network::ListenerConfig& listener, std::function<void()> completion));
@@ -37,6 +37,13 @@ MockClusterInfo::MockClusterInfo()
   ON_CALL(*this, idleTimeout()).WillByDefault(Return(absl::optional<std::chrono::milliseconds>()));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
   ON_CALL(*this, http2Settings()).WillByDefault(ReturnRef(http2_settings_));
+  ON_CALL(*this, http2MaxConnectionsPerHost())
+      .WillByDefault(ReturnPointee(&http2_max_connections_per_host_));
+  ON_CALL(*this, http2BusyStreamThreshold())
+      .WillByDefault(ReturnPointee(&http2_busy_stream_threshold_));
+  ON_CALL(*this, perUpstreamPrefetchRatio())
+      .WillByDefault(ReturnPointee(&per_upstream_prefetch_ratio_));
+  ON_CALL(*this, warmConnectionsPerHost()).WillByDefault(ReturnPointee(&warm_connections_per_host_));
   ON_CALL(*this, maxRequestsPerConnection())
       .WillByDefault(ReturnPointee(&max_requests_per_connection_));
   ON_CALL(*this, stats()).WillByDefault(ReturnRef(stats_));
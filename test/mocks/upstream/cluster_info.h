@@ -46,6 +46,10 @@ public:
   MOCK_CONST_METHOD0(perConnectionBufferLimitBytes, uint32_t());
   MOCK_CONST_METHOD0(features, uint64_t());
   MOCK_CONST_METHOD0(http2Settings, const Http::Http2Settings&());
+  MOCK_CONST_METHOD0(http2MaxConnectionsPerHost, uint32_t());
+  MOCK_CONST_METHOD0(http2BusyStreamThreshold, uint32_t());
+  MOCK_CONST_METHOD0(perUpstreamPrefetchRatio, float());
+  MOCK_CONST_METHOD0(warmConnectionsPerHost, uint32_t());
   MOCK_CONST_METHOD0(lbConfig, const envoy::api::v2::Cluster::CommonLbConfig&());
   MOCK_CONST_METHOD0(lbType, LoadBalancerType());
   MOCK_CONST_METHOD0(type, envoy::api::v2::Cluster::DiscoveryType());
@@ -68,6 +72,10 @@ public:
   std::string name_{"fake_cluster"};
   Http::Http2Settings http2_settings_{};
   uint64_t max_requests_per_connection_{};
+  uint32_t http2_max_connections_per_host_{1};
+  uint32_t http2_busy_stream_threshold_{100};
+  float per_upstream_prefetch_ratio_{1.0};
+  uint32_t warm_connections_per_host_{};
   NiceMock<Stats::MockIsolatedStatsStore> stats_store_;
   ClusterStats stats_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
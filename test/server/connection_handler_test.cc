@@ -1,3 +1,4 @@
+#include "common/buffer/buffer_impl.h"
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
 #include "common/network/raw_buffer_socket.h"
@@ -17,6 +18,7 @@ using testing::ByRef;
 using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::_;
@@ -42,11 +44,18 @@ public:
     Network::FilterChainManager& filterChainManager() override { return parent_.manager_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_.factory_; }
     Network::Socket& socket() override { return socket_; }
+    Network::Socket* workerSocket(uint32_t worker_index) override {
+      return worker_index < worker_sockets_.size() ? worker_sockets_[worker_index] : nullptr;
+    }
     bool bindToPort() override { return bind_to_port_; }
     bool handOffRestoredDestinationConnections() const override {
       return hand_off_restored_destination_connections_;
     }
     uint32_t perConnectionBufferLimitBytes() override { return 0; }
+    uint32_t acceptBatchSize() const override { return accept_batch_size_; }
+    uint32_t maxConnectionsPerWorker() const override { return max_connections_per_worker_; }
+    Network::Address::SocketType socketType() const override { return socket_type_; }
+    Network::ConnectionBalancer* connectionBalancer() override { return balancer_; }
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
@@ -57,6 +66,11 @@ public:
     bool bind_to_port_;
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
+    uint32_t accept_batch_size_{};
+    uint32_t max_connections_per_worker_{};
+    std::vector<Network::Socket*> worker_sockets_;
+    Network::ConnectionBalancer* balancer_{};
+    Network::Address::SocketType socket_type_{Network::Address::SocketType::Stream};
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -200,6 +214,141 @@ TEST_F(ConnectionHandlerTest, CloseConnectionOnEmptyFilterChain) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+TEST_F(ConnectionHandlerTest, MaxConnectionsPerWorker) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->accept_batch_size_ = 16;
+  test_listener->max_connections_per_worker_ = 2;
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  EXPECT_CALL(*listener, setAcceptBatchSize(16));
+  handler_->addListener(*test_listener);
+
+  std::vector<Network::MockConnection*> connections;
+  EXPECT_CALL(manager_, findFilterChain(_)).WillRepeatedly(Return(filter_chain_.get()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillRepeatedly(Return(true));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillRepeatedly(Invoke([&](Network::ConnectionSocket*,
+                                 Network::TransportSocket*) -> Network::Connection* {
+        connections.push_back(new NiceMock<Network::MockConnection>());
+        return connections.back();
+      }));
+
+  // Accepting stops once the worker has two connections on the listener.
+  EXPECT_CALL(*listener, disable()).Times(0);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_CALL(*listener, disable());
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(2UL, handler_->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_accept_paused").value());
+
+  // And resumes when one of them closes.
+  EXPECT_CALL(*listener, enable());
+  connections[0]->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
+TEST_F(ConnectionHandlerTest, WorkerSocket) {
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 1));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  Network::MockListenSocket worker_socket_0;
+  Network::MockListenSocket worker_socket_1;
+  test_listener->worker_sockets_ = {&worker_socket_0, &worker_socket_1};
+
+  // The handler of the second worker listens on the second worker socket.
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(Ref(worker_socket_1), _, _, _))
+      .WillOnce(Return(listener));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+TEST_F(ConnectionHandlerTest, RebalanceToOtherWorker) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  NiceMock<Network::MockConnectionBalancer> balancer;
+  test_listener->balancer_ = &balancer;
+  Network::BalancedConnectionHandler& balanced_handler =
+      dynamic_cast<Network::BalancedConnectionHandler&>(*handler_);
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  EXPECT_CALL(balancer, registerHandler(0, Ref(balanced_handler)));
+  handler_->addListener(*test_listener);
+
+  // The socket goes to the other worker before any filter runs on it.
+  NiceMock<Network::MockBalancedConnectionHandler> other_worker;
+  Network::MockConnectionSocket* accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  EXPECT_CALL(balancer, pickTargetHandler(0)).WillOnce(ReturnRef(other_worker));
+  EXPECT_CALL(factory_, createListenerFilterChain(_)).Times(0);
+  EXPECT_CALL(other_worker, post_(1, _))
+      .WillOnce(Invoke([&](uint64_t, Network::ConnectionSocketPtr& socket) -> void {
+        EXPECT_EQ(accepted_socket, socket.get());
+      }));
+  listener_callbacks->onAccept(Network::ConnectionSocketPtr{accepted_socket}, true);
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_rebalanced").value());
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  // A stopped listener no longer takes part in balancing.
+  EXPECT_CALL(balancer, unregisterHandler(0));
+  EXPECT_CALL(*listener, onDestroy());
+  handler_->stopListeners(1);
+}
+
+TEST_F(ConnectionHandlerTest, AcceptRebalancedSocket) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _)).WillOnce(Return(listener));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  NiceMock<Network::MockConnectionBalancer> balancer;
+  test_listener->balancer_ = &balancer;
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  // A socket handed over by another worker is processed on this worker's dispatcher without
+  // being balanced again, and the new connection count is reported.
+  Network::BalancedConnectionHandler& balanced_handler =
+      dynamic_cast<Network::BalancedConnectionHandler&>(*handler_);
+  EXPECT_CALL(balancer, pickTargetHandler(_)).Times(0);
+  EXPECT_CALL(dispatcher_, post(_));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  EXPECT_CALL(balancer, onConnectionCount(0, 1));
+  balanced_handler.post(
+      1, Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  // Sockets for a listener the worker doesn't run are dropped.
+  EXPECT_CALL(dispatcher_, post(_));
+  balanced_handler.post(
+      2, Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(balancer, unregisterHandler(0));
+  EXPECT_CALL(balancer, onConnectionCount(0, 0));
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
 TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::Address::InstanceConstSharedPtr alt_address(
@@ -513,5 +662,45 @@ TEST_F(ConnectionHandlerTest, TransportProtocolCustom) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+// A UDP listener hands the datagrams of a worker to the filters installed for that worker.
+TEST_F(ConnectionHandlerTest, UdpListener) {
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->socket_type_ = Network::Address::SocketType::Datagram;
+  Network::MockUdpListener* udp_listener = new NiceMock<Network::MockUdpListener>();
+  Network::UdpListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createUdpListener_(Ref(test_listener->socket_), _))
+      .WillOnce(Invoke([&](Network::Socket&,
+                           Network::UdpListenerCallbacks& cb) -> Network::UdpListener* {
+        listener_callbacks = &cb;
+        return udp_listener;
+      }));
+  EXPECT_CALL(*udp_listener, setStats(_))
+      .WillOnce(Invoke([&](const Network::UdpListener::UdpStats& stats) -> void {
+        EXPECT_EQ(&stats_store_.counter("downstream_rx_datagrams"), &stats.rx_datagrams_);
+      }));
+  Network::MockUdpListenerReadFilter* filter = new Network::MockUdpListenerReadFilter();
+  EXPECT_CALL(factory_, createUdpListenerFilterChain(_, _))
+      .WillOnce(Invoke([&](Network::UdpListenerFilterManager& manager,
+                           Network::UdpReadFilterCallbacks& callbacks) -> bool {
+        EXPECT_EQ(udp_listener, &callbacks.udpListener());
+        EXPECT_EQ(&dispatcher_, &callbacks.dispatcher());
+        manager.addReadFilter(Network::UdpListenerReadFilterPtr{filter});
+        return true;
+      }));
+  handler_->addListener(*test_listener);
+
+  Network::UdpRecvData data{Network::Utility::parseInternetAddressAndPort("127.0.0.1:53"),
+                            Network::Utility::parseInternetAddressAndPort("127.0.0.1:1000"),
+                            std::make_unique<Buffer::OwnedImpl>("hello")};
+  EXPECT_CALL(*filter, onData(Ref(data)));
+  listener_callbacks->onData(data);
+  EXPECT_CALL(*filter, onReadComplete());
+  listener_callbacks->onReadComplete();
+
+  EXPECT_CALL(*udp_listener, onDestroy());
+  handler_->stopListeners(1);
+  handler_->removeListeners(1);
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -1,3 +1,5 @@
+#include <unistd.h>
+
 #include "envoy/admin/v2alpha/config_dump.pb.h"
 #include "envoy/registry/registry.h"
 #include "envoy/server/filter_config.h"
@@ -134,6 +136,14 @@ public:
               return ProdListenerComponentFactory::createListenerFilterFactoryList_(filters,
                                                                                     context);
             }));
+    ON_CALL(listener_factory_, createUdpListenerFilterFactoryList(_, _))
+        .WillByDefault(Invoke(
+            [](const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>& filters,
+               Configuration::ListenerFactoryContext& context)
+                -> std::vector<Network::UdpListenerFilterFactoryCb> {
+              return ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(filters,
+                                                                                       context);
+            }));
     socket_.reset(new NiceMock<Network::MockConnectionSocket>());
   }
 
@@ -208,6 +218,185 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SetListenerPerConnectionBufferLim
   EXPECT_EQ(8192U, manager_->listeners().back().get().perConnectionBufferLimitBytes());
 }
 
+TEST_F(ListenerManagerImplWithRealFiltersTest, DefaultListenerAcceptLimits) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains: {}
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  EXPECT_EQ(64U, manager_->listeners().back().get().acceptBatchSize());
+  EXPECT_EQ(0U, manager_->listeners().back().get().maxConnectionsPerWorker());
+  EXPECT_EQ(nullptr, manager_->listeners().back().get().connectionBalancer());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, SetListenerAcceptLimits) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains: {}
+accept_batch_size: 16
+max_connections_per_worker: 1000
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  EXPECT_EQ(16U, manager_->listeners().back().get().acceptBatchSize());
+  EXPECT_EQ(1000U, manager_->listeners().back().get().maxConnectionsPerWorker());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ConnectionBalance) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains: {}
+connection_balance:
+  load_metric: LOOP_UTILIZATION
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  EXPECT_NE(nullptr, manager_->listeners().back().get().connectionBalancer());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortWorkerSockets) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains: {}
+reuse_port:
+  cpu_steering: true
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _)).Times(0);
+  EXPECT_CALL(listener_factory_, createWorkerListenSockets(_, _, 1, true))
+      .WillOnce(Return(std::vector<Network::SocketSharedPtr>{listener_factory_.socket_}));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  Network::ListenerConfig& listener = manager_->listeners().back().get();
+  EXPECT_EQ(listener_factory_.socket_.get(), &listener.socket());
+  EXPECT_EQ(listener_factory_.socket_.get(), listener.workerSocket(0));
+  EXPECT_EQ(nullptr, listener.workerSocket(1));
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortPipeAddress) {
+  const std::string yaml = R"EOF(
+address:
+  pipe:
+    path: "/foo"
+filter_chains: {}
+reuse_port: {}
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "error adding listener '/foo': reuse_port requires an IP address and "
+                            "a listener that binds to its port");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListener) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    protocol: UDP
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains:
+- filters:
+  - name: envoy.filters.udp_listener.udp_proxy
+    config:
+      stat_prefix: dns
+      cluster: dns
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _)).Times(0);
+  EXPECT_CALL(listener_factory_, createWorkerListenSockets(_, _, _, _)).Times(0);
+  EXPECT_CALL(listener_factory_, createUdpListenSockets(_, _, 1, false))
+      .WillOnce(Return(std::vector<Network::SocketSharedPtr>{listener_factory_.socket_}));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  Network::ListenerConfig& listener = manager_->listeners().back().get();
+  EXPECT_EQ(Network::Address::SocketType::Datagram, listener.socketType());
+  EXPECT_EQ(listener_factory_.socket_.get(), listener.workerSocket(0));
+
+  NiceMock<Network::MockUdpListenerFilterManager> filter_manager;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks;
+  EXPECT_CALL(filter_manager, addReadFilter_(_));
+  EXPECT_TRUE(
+      listener.filterChainFactory().createUdpListenerFilterChain(filter_manager, callbacks));
+
+  // Listener stats are kept apart from those of a TCP listener on the same address.
+  listener.listenerScope().counter("foo").inc();
+  EXPECT_EQ(1UL, server_.stats_store_.counter("listener.udp.127.0.0.1:1234.foo").value());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListenerWithListenerFilters) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    protocol: UDP
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains:
+- filters:
+  - name: envoy.filters.udp_listener.udp_proxy
+    config:
+      stat_prefix: dns
+      cluster: dns
+listener_filters:
+- name: envoy.listener.tls_inspector
+  config: {}
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true), EnvoyException,
+      "error adding listener '127.0.0.1:1234': UDP listeners take a single filter chain without "
+      "match rules or TLS, and do not support listener filters, use_original_dst, "
+      "connection_balance or tcp_fast_open_queue_length");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListenerWithoutFilterChain) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    protocol: UDP
+    address: "127.0.0.1"
+    port_value: 1234
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true), EnvoyException,
+      "error adding listener '127.0.0.1:1234': UDP listeners take a single filter chain without "
+      "match rules or TLS, and do not support listener filters, use_original_dst, "
+      "connection_balance or tcp_fast_open_queue_length");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListenerBadFilterName) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    protocol: UDP
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains:
+- filters:
+  - name: envoy.tcp_proxy
+    config: {}
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "Didn't find a registered implementation for name: 'envoy.tcp_proxy'");
+}
+
 TEST_F(ListenerManagerImplWithRealFiltersTest, SslContext) {
   const std::string json = TestEnvironment::substitute(R"EOF(
   {
@@ -384,6 +573,112 @@ TEST_F(ListenerManagerImplTest, AddListenerAddressNotMatching) {
   EXPECT_CALL(*listener_foo, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, CreateWorkerListenSockets) {
+  ProdListenerComponentFactory factory(server_);
+  Network::Address::InstanceConstSharedPtr address =
+      Network::Utility::parseInternetAddress("127.0.0.1", 0);
+
+  EXPECT_CALL(server_.hot_restart_, duplicateParentWorkerListenSocket("tcp://127.0.0.1:0", _))
+      .Times(2)
+      .WillRepeatedly(Return(-1));
+  std::vector<Network::SocketSharedPtr> sockets =
+      factory.createWorkerListenSockets(address, nullptr, 2, false);
+  ASSERT_EQ(2U, sockets.size());
+  // Both sockets share the port that the first one was given.
+  EXPECT_NE(0U, sockets[0]->localAddress()->ip()->port());
+  EXPECT_EQ(*sockets[0]->localAddress(), *sockets[1]->localAddress());
+
+  // After a hot restart with more workers, the new socket joins the parent's group.
+  address = sockets[0]->localAddress();
+  const std::string url = fmt::format("tcp://{}", address->asString());
+  EXPECT_CALL(server_.hot_restart_, duplicateParentWorkerListenSocket(url, 0))
+      .WillOnce(Return(dup(sockets[0]->fd())));
+  EXPECT_CALL(server_.hot_restart_, duplicateParentWorkerListenSocket(url, 1))
+      .WillOnce(Return(dup(sockets[1]->fd())));
+  EXPECT_CALL(server_.hot_restart_, duplicateParentWorkerListenSocket(url, 2)).WillOnce(Return(-1));
+  std::vector<Network::SocketSharedPtr> child_sockets =
+      factory.createWorkerListenSockets(address, nullptr, 3, false);
+  ASSERT_EQ(3U, child_sockets.size());
+  EXPECT_EQ(*address, *child_sockets[2]->localAddress());
+}
+
+TEST_F(ListenerManagerImplTest, UpdateListenerReusePortNotMatching) {
+  InSequence s;
+
+  // Add foo listener.
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 10000 }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  checkStats(1, 0, 0, 0, 1, 0);
+
+  // Update foo listener to use a socket per worker. Should throw as the socket is kept.
+  const std::string listener_foo_reuse_port_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 10000 }
+    filter_chains:
+    - filters:
+    reuse_port: {}
+  )EOF";
+
+  ListenerHandle* listener_foo_reuse_port = expectListenerCreate(false);
+  EXPECT_CALL(*listener_foo_reuse_port, onDestroy());
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_reuse_port_yaml), "",
+                                    true),
+      EnvoyException,
+      "error updating listener: 'foo' has a different reuse_port setting from existing listener");
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
+TEST_F(ListenerManagerImplTest, UpdateListenerProtocolNotMatching) {
+  InSequence s;
+
+  // Add foo listener.
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 10000 }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  checkStats(1, 0, 0, 0, 1, 0);
+
+  // Update foo listener to receive datagrams on the same address. Should throw as the socket is
+  // kept.
+  const std::string listener_foo_udp_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { protocol: UDP, address: 127.0.0.1, port_value: 10000 }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createDrainManager_(_))
+      .WillOnce(Return(new NiceMock<MockDrainManager>()));
+  EXPECT_CALL(listener_factory_, createUdpListenerFilterFactoryList(_, _))
+      .WillOnce(Return(std::vector<Network::UdpListenerFilterFactoryCb>{}));
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_udp_yaml), "", true),
+      EnvoyException, "error updating listener: 'foo' has a different protocol from existing "
+                      "listener");
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
 // Make sure that a listener that is not modifiable cannot be updated or removed.
 TEST_F(ListenerManagerImplTest, UpdateRemoveNotModifiableListener) {
   InSequence s;
@@ -524,6 +819,7 @@ dynamic_draining_listeners:
 
   // Start workers.
   EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*worker_, initializeStats(_, "listener_manager.worker_0."));
   EXPECT_CALL(*worker_, start(_));
   manager_->startWorkers(guard_dog_);
   worker_->callAddCompletion(true);
@@ -65,7 +65,8 @@ TEST(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --service-cluster cluster --service-node node "
       "--service-zone zone --file-flush-interval-msec 9000 --drain-time-s 60 --log-format [%v] "
-      "--parent-shutdown-time-s 90 --log-path /foo/bar --v2-config-only --disable-hot-restart");
+      "--parent-shutdown-time-s 90 --log-path /foo/bar --v2-config-only --disable-hot-restart "
+      "--use-libevent-buffers --use-io-uring --worker-cpu-affinity --use-timer-wheel");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -83,6 +84,10 @@ TEST(OptionsImplTest, All) {
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
   EXPECT_EQ(true, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBuffersEnabled());
+  EXPECT_EQ(true, options->ioUringEnabled());
+  EXPECT_EQ(true, options->workerCpuAffinity());
+  EXPECT_EQ(true, options->timerWheelEnabled());
 }
 
 TEST(OptionsImplTest, SetAll) {
@@ -110,6 +115,10 @@ TEST(OptionsImplTest, SetAll) {
   options->setMaxStats(12345);
   options->setMaxObjNameLength(54321);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
+  options->setLibeventBuffersEnabled(true);
+  options->setIoUringEnabled(true);
+  options->setWorkerCpuAffinity(true);
+  options->setTimerWheelEnabled(true);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -132,6 +141,10 @@ TEST(OptionsImplTest, SetAll) {
   EXPECT_EQ(12345U, options->maxStats());
   EXPECT_EQ(54321U, options->maxObjNameLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBuffersEnabled());
+  EXPECT_EQ(true, options->ioUringEnabled());
+  EXPECT_EQ(true, options->workerCpuAffinity());
+  EXPECT_EQ(true, options->timerWheelEnabled());
 }
 
 TEST(OptionsImplTest, DefaultParams) {
@@ -142,6 +155,10 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(false, options->libeventBuffersEnabled());
+  EXPECT_EQ(false, options->ioUringEnabled());
+  EXPECT_EQ(false, options->workerCpuAffinity());
+  EXPECT_EQ(false, options->timerWheelEnabled());
 }
 
 TEST(OptionsImplTest, BadCliOption) {